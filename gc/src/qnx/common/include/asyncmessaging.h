@@ -0,0 +1,189 @@
+//
+//	asyncmessaging.h  --  asynchronous requests on top of MsgClientPort
+//
+//	QNX MsgSend blocks the sending thread until the server replies. So a client
+//	which needs answers from several servers pays for each round trip in turn.
+//	An MsgAsyncClientPort has its own sending thread. The caller starts a request,
+//	goes on with other work, and later waits for the reply, or is called back when
+//	it arrives. Requests on different ports are in flight at the same time.
+//
+//	Typical usage is
+//
+//		MsgAsyncClientPort gpsport("GPSINS", 0.1);						// set up the connection
+//		MsgAsyncClientPort moveport("MOVE", 0.1);
+//		...
+//		gpsport.MsgSendStart(gpsreq, gpsreply);							// both requests go out
+//		moveport.MsgSendStart(movereq, movereply);
+//		MsgAsyncGroup group;
+//		group.add(gpsport); group.add(moveport);
+//		group.waitall(gettimenowns() + 50000000);						// wait up to 50ms for both
+//		int stat = gpsport.MsgSendWait();								// then collect each result
+//
+//	The message and reply buffers belong to the caller, and must stay put until
+//	the request has been collected with MsgSendWait. One request at a time per port.
+//	Don't use the synchronous MsgSend forms on a port while a request is pending.
+//
+//	Team Overbot
+//	October, 2026
+//
+#ifndef ASYNCMESSAGING_H
+#define ASYNCMESSAGING_H
+#include <vector>
+#include "messaging.h"
+#include "mutexlock.h"
+#include "threadobject.h"
+#include "timeutil.h"
+//
+//	MsgAsyncCallback  -- called, on the port's sending thread, when a reply arrives
+//
+//	stat is what MsgSend returned, and err the errno if stat < 0. Must not block;
+//	usually it just notes the result for another thread.
+//
+typedef void (*MsgAsyncCallback)(void* arg, int stat, int err);
+//
+//	MsgAsyncClientPort  -- client port which can have a request in progress
+//
+class MsgAsyncClientPort: public MsgClientPort, private ost::Pthread {
+private:
+	ost::Semaphore m_request;												// posted when there is a request to send
+	ost::Semaphore m_done;													// posted when the reply is in
+	const void* m_msg;															// request being sent
+	int m_msgbytes;
+	void* m_rmsg;																// where the reply goes
+	int m_rmsgbytes;
+	MsgAsyncCallback m_callback;											// called when done, if nonnull
+	void* m_callbackarg;
+	int m_stat;																		// MsgSend status of last request
+	int m_err;																		// and its errno
+	bool m_pending;																// request started and not yet collected
+	bool m_replyin;																// m_done already taken for pending request
+	volatile bool m_quit;														// sending thread should exit
+public:
+	MsgAsyncClientPort(const char* name, double timeout = 0.0)
+	: MsgClientPort(name, timeout), m_msg(0), m_msgbytes(0), m_rmsg(0), m_rmsgbytes(0),
+		m_callback(0), m_callbackarg(0), m_stat(0), m_err(EOK), m_pending(false), m_replyin(false), m_quit(false)
+	{}
+	virtual ~MsgAsyncClientPort();
+	//	Start a request. Returns -1, with errno set, if it can't be started.
+	int MsgSendStart(const void* msg, int msgbytes, void* rmsg, int rmsgbytes,
+		MsgAsyncCallback callback = 0, void* callbackarg = 0);
+	template<class TIN, class TOUT> int MsgSendStart(const TIN& msg, TOUT& rmsg,
+		MsgAsyncCallback callback = 0, void* callbackarg = 0)
+	{	return(MsgSendStart(&msg, sizeof(msg), &rmsg, sizeof(rmsg), callback, callbackarg)); }
+	//	Collect the result. Returns what MsgSend returned, with errno set.
+	//	Waits until deadlinens (CLOCK_REALTIME), or forever if 0. If the deadline passes first,
+	//	returns -1 with errno ETIMEDOUT, and the request is still pending.
+	int MsgSendWait(uint64_t deadlinens = 0);
+	bool MsgSendPending() const { return(m_pending); }				// started and not yet collected
+	bool MsgSendDone() { return(MsgSendWaitDone(1)); }						// reply in, can collect without waiting
+	bool MsgSendWaitDone(uint64_t deadlinens = 0);							// wait for reply, but don't collect it
+private:
+	void run();																			// the sending thread
+};
+//
+//	MsgAsyncGroup  -- wait for replies on several ports, with one deadline
+//
+class MsgAsyncGroup {
+private:
+	std::vector<MsgAsyncClientPort*> m_ports;
+public:
+	void add(MsgAsyncClientPort& port) { m_ports.push_back(&port); }
+	void clear() { m_ports.clear(); }
+	int waitall(uint64_t deadlinens);												// returns number of replies not in by the deadline
+};
+//
+//	Implementation
+//
+//
+//	Destructor  -- stops the sending thread
+//
+//	If a request is in progress, waits for it; the port timeout limits that.
+//
+inline MsgAsyncClientPort::~MsgAsyncClientPort()
+{	if (!isrunning()) return;
+	m_quit = true;
+	m_request.post();																	// wake up thread so it sees m_quit
+	join();
+}
+//
+//	MsgSendStart  -- start a request
+//
+inline int MsgAsyncClientPort::MsgSendStart(const void* msg, int msgbytes, void* rmsg, int rmsgbytes,
+		MsgAsyncCallback callback, void* callbackarg)
+{	if (m_pending) { errno = EBUSY; return(-1);	}							// one at a time
+	if (!isrunning())																	// first time, start the sending thread
+	{	int stat = create();
+		if (stat != EOK) { errno = stat; return(-1); }
+	}
+	m_msg = msg;
+	m_msgbytes = msgbytes;
+	m_rmsg = rmsg;
+	m_rmsgbytes = rmsgbytes;
+	m_callback = callback;
+	m_callbackarg = callbackarg;
+	m_pending = true;
+	m_replyin = false;
+	m_request.post();																	// sending thread takes it from here
+	return(0);
+}
+//
+//	MsgSendWaitDone  -- wait until the reply is in, or the deadline passes
+//
+//	Returns true if the reply is in; MsgSendWait will then return immediately.
+//	A deadline in the past just checks.
+//
+inline bool MsgAsyncClientPort::MsgSendWaitDone(uint64_t deadlinens)
+{	if (!m_pending) return(false);													// nothing to wait for
+	if (m_replyin) return(true);													// already seen
+	if (deadlinens == 0)
+	{	m_done.wait();	}																// no deadline
+	else
+	{	const uint64_t now = gettimenowns();
+		bool done = (now < deadlinens) ? m_done.timedwaitns(deadlinens - now) : m_done.trywait();
+		if (!done) return(false);
+	}
+	m_replyin = true;
+	return(true);
+}
+//
+//	MsgSendWait  -- collect the result of a request
+//
+inline int MsgAsyncClientPort::MsgSendWait(uint64_t deadlinens)
+{	if (!m_pending) { errno = EINVAL; return(-1);	}						// nothing to wait for
+	if (!MsgSendWaitDone(deadlinens)) { errno = ETIMEDOUT; return(-1);	}	// still pending
+	m_pending = false;
+	m_replyin = false;
+	errno = m_err;
+	return(m_stat);
+}
+//
+//	run  -- the sending thread
+//
+//	MsgClientPort's timeout applies, since it is set for the thread that sends.
+//
+inline void MsgAsyncClientPort::run()
+{	for (;;)
+	{	m_request.wait();																// wait for something to send
+		if (m_quit) return;
+		int stat = MsgClientPort::MsgSend(m_msg, m_msgbytes, m_rmsg, m_rmsgbytes);
+		m_stat = stat;
+		m_err = (stat < 0) ? errno : EOK;										// errno is per-thread; save it for the caller
+		if (m_callback) (*m_callback)(m_callbackarg, m_stat, m_err);
+		m_done.post();																	// reply is in
+	}
+}
+//
+//	waitall  -- wait for all the replies, until the deadline (CLOCK_REALTIME)
+//
+//	Waiting for each in turn, until the same deadline, is the same as waiting for all.
+//	The results are still collected from each port with MsgSendWait.
+//
+inline int MsgAsyncGroup::waitall(uint64_t deadlinens)
+{	int late = 0;
+	for (size_t i=0; i<m_ports.size(); i++)
+	{	MsgAsyncClientPort& port = *m_ports[i];
+		if (port.MsgSendPending() && !port.MsgSendWaitDone(deadlinens)) late++;
+	}
+	return(late);
+}
+#endif // ASYNCMESSAGING_H
@@ -843,6 +843,17 @@ OPENCVAPI  void  cvReleaseMemStorage( CvMemStorage** storage );
    A child storage returns all the blocks to the parent when it is cleared */
 OPENCVAPI  void  cvClearMemStorage( CvMemStorage* storage );
 
+/* Gets the allocation counts of the memory storages of the calling thread,
+   and optionally resets them. Blocks of released root storages, and the
+   headers of released storages, are kept by the thread for reuse, so a frame
+   loop that clears a root storage each frame, and whose functions create and
+   release temporary storages, reaches a steady state with no heap_blocks or
+   heap_headers counted */
+OPENCVAPI  void  cvGetMemStorageStats( CvMemStorageStats* stats, int reset CV_DEFAULT(0));
+
+/* Frees the storage blocks and headers the calling thread keeps for reuse */
+OPENCVAPI  void  cvReleaseMemStorageCache( void );
+
 /* Remember a storage "free memory" position */
 OPENCVAPI  void  cvSaveMemStoragePos( const CvMemStorage* storage, CvMemStoragePos* pos );
 
@@ -1176,6 +1187,23 @@ OPENCVAPI  void cvSmooth( const CvArr* srcarr, CvArr* dstarr,
                           int param1 CV_DEFAULT(3),
                           int param2 CV_DEFAULT(0));
 
+/* Reusable state for separable CV_BLUR/CV_GAUSSIAN smoothing of 8u or 32f images
+   with 1, 3 or 4 channels and up to max_width pixels per row.  All kernels and
+   working buffers are allocated once, here.  If param2 is 0 the aperture is
+   square.  With threads > 1 the image is split into horizontal bands which are
+   smoothed in parallel by worker threads owned by the state. */
+typedef struct CvSmoothState CvSmoothState;
+
+OPENCVAPI  CvSmoothState* cvCreateSmoothState( int smoothtype, int param1, int param2,
+                                               int type, int max_width,
+                                               int threads CV_DEFAULT(1) );
+
+OPENCVAPI  void cvReleaseSmoothState( CvSmoothState** state );
+
+/* Same as cvSmooth, but uses the precomputed state; no memory is allocated */
+OPENCVAPI  void cvSmoothWithState( const CvArr* srcarr, CvArr* dstarr,
+                                   CvSmoothState* state );
+
 /* Finds integral image: SUM(X,Y) = sum(x<X,y<Y)I(x,y) */
 OPENCVAPI void cvIntegral( const CvArr* image, CvArr* sumImage,
                            CvArr* sumSqImage CV_DEFAULT(NULL),
@@ -1551,6 +1579,20 @@ OPENCVAPI  void  cvGetQuadrangleSubPix( const CvArr* src, CvArr* dstarr,
 OPENCVAPI  void  cvMatchTemplate( const CvArr* arr, const CvArr* templ,
                                   CvArr* result, int method );
 
+/* Reusable state for matching one template against many images.  The template
+   is copied, and its spectrum is kept between calls, so each call only
+   transforms the image.  Large templates are matched in the frequency domain
+   (cvDFT, tiled overlap-save), small ones as by cvMatchTemplate. */
+typedef struct CvMatchTemplateState CvMatchTemplateState;
+
+OPENCVAPI  CvMatchTemplateState* cvCreateMatchTemplateState( const CvArr* templ );
+
+OPENCVAPI  void cvReleaseMatchTemplateState( CvMatchTemplateState** state );
+
+/* Same as cvMatchTemplate, with the template of the state */
+OPENCVAPI  void cvMatchTemplateWithState( const CvArr* arr, CvArr* result, int method,
+                                          CvMatchTemplateState* state );
+
 CV_EXTERN_C_FUNCPTR( float (CV_CDECL * CvDistanceFunction)
                      ( const float* a, const float* b, void* user_param ));
 
@@ -1739,6 +1781,53 @@ OPENCVAPI  void  cvCalcOpticalFlowPyrLK( const CvArr*  imgA, const CvArr*  imgB,
                                          CvTermCriteria criteria,
                                          int       flags );
 
+/* Pyramids and working buffers for tracking points through a sequence of
+   frames.  cvUpdatePyrLKState makes the current frame the previous one and
+   builds the pyramid of the new frame in the other buffer, so each frame's
+   pyramid is built once, and nothing is allocated while tracking. */
+#define CV_PYRLK_MAX_LEVEL  8
+
+typedef struct CvPyrLKState
+{
+    CvSize imgSize;          /* frame size; frames are 8uC1 */
+    CvSize winSize;          /* half size of the search window, as for cvCalcOpticalFlowPyrLK */
+    int level;               /* top pyramid level, 0..CV_PYRLK_MAX_LEVEL */
+    int frameCount;          /* frames given to cvUpdatePyrLKState, counting up to 2 */
+
+    /* working buffers, for internal use */
+    int current;                                /* which of pyrBuf holds the current frame */
+    CvMat* pyrBuf[2];                           /* all levels of each pyramid, level 0 included */
+    int levelOfs[CV_PYRLK_MAX_LEVEL+1];         /* offset of each level in a pyramid buffer */
+    int levelStep[CV_PYRLK_MAX_LEVEL+1];
+    CvSize levelSize[CV_PYRLK_MAX_LEVEL+1];
+    CvMat* patchBuf;                            /* patches and derivatives for one point */
+    CvMat* pyrDownBuf;
+}
+CvPyrLKState;
+
+OPENCVAPI  CvPyrLKState* cvCreatePyrLKState( CvSize imgSize,
+                                            CvSize winSize CV_DEFAULT(cvSize(7,7)),
+                                            int level CV_DEFAULT(3) );
+
+OPENCVAPI  void  cvReleasePyrLKState( CvPyrLKState** state );
+
+/* Adds a frame (8uC1, state->imgSize) to the sequence; it becomes the current
+   frame, and the former current frame becomes the previous one */
+OPENCVAPI  void  cvUpdatePyrLKState( CvPyrLKState* state, const CvArr* frame );
+
+/* Tracks points from the previous frame to the current one, like
+   cvCalcOpticalFlowPyrLK.  Only CV_LKFLOW_INITIAL_GUESSES is meaningful in
+   flags.  Pixels beyond the frame are replicated from its border, and points
+   that end up outside the frame get status 0 */
+OPENCVAPI  void  cvCalcOpticalFlowPyrLKState( CvPyrLKState* state,
+                                              const CvPoint2D32f* featuresA,
+                                              CvPoint2D32f* featuresB,
+                                              int       count,
+                                              char*     status,
+                                              float*    error,
+                                              CvTermCriteria criteria,
+                                              int       flags );
+
 
 /* Modification of a previous sparse optical flow algorithm to calculate
    affine flow */
@@ -2278,6 +2367,31 @@ OPENCVAPI  void  cvCalcArrBackProjectPatch( CvArr** img, CvArr* dst, CvSize rang
 OPENCVAPI  void  cvCalcProbDensity( const CvHistogram* hist, const CvHistogram* hist_mask,
                                     CvHistogram* hist_dens, double scale CV_DEFAULT(255) );
 
+/* Bin lookup tables for a dense 3-D histogram of 3-channel 8-bit pixels:
+   the bin of pixel (c0,c1,c2) is tab[0][c0] + tab[1][c1] + tab[2][c2],
+   and is negative if any channel is outside the histogram's ranges */
+typedef struct CvColorHistLUT
+{
+    int tab[3][256];
+}
+CvColorHistLUT;
+
+/* Builds the lookup tables for a histogram; must be rebuilt if its ranges change */
+OPENCVAPI  void  cvCalcColorHistLUT( const CvHistogram* hist, CvColorHistLUT* lut );
+
+/* Blends the normalized histogram of the (masked) pixels of a 3-channel 8-bit
+   image into a histogram: hist = (1-alpha)*hist + alpha*hist(img).
+   Leaves the histogram alone if no pixels are selected */
+OPENCVAPI  void  cvAccColorHist( const CvArr* img, CvHistogram* hist,
+                                 const CvColorHistLUT* lut, double alpha,
+                                 const CvArr* mask CV_DEFAULT(NULL) );
+
+/* Back projects a histogram onto a 3-channel 8-bit image: dst = hist(bin of img)*scale,
+   saturated to 8 bits. With a mask, only the masked pixels of dst are written */
+OPENCVAPI  void  cvColorBackProject( const CvArr* img, CvArr* dst,
+                                     const CvHistogram* hist, const CvColorHistLUT* lut,
+                                     double scale, const CvArr* mask CV_DEFAULT(NULL) );
+
 
 #define  CV_VALUE  1
 #define  CV_ARRAY  2
@@ -2294,7 +2408,8 @@ OPENCVAPI  void  cvCalcImageHomography(float *line, CvPoint3D32f* center,
                                      float* intrinsic, float* homography);
 
 #define CV_DIST_MASK_3   3
-#define CV_DIST_MASK_5   5 
+#define CV_DIST_MASK_5   5
+#define CV_DIST_MASK_PRECISE 0  /* exact Euclidean distance, CV_DIST_L2 only */
 
 /* Applies distance transform to binary image */
 OPENCVAPI  void  cvDistTransform( const CvArr* src, CvArr* dst,
@@ -2302,6 +2417,28 @@ OPENCVAPI  void  cvDistTransform( const CvArr* src, CvArr* dst,
                                   int maskSize CV_DEFAULT(3),
                                   const float* mask CV_DEFAULT(NULL));
 
+/* Reusable state for the exact Euclidean distance transform of 8u masks up to
+   max_size.  Distances beyond max_dist (in pixels) are reported as max_dist,
+   which also bounds how far around an updated rectangle the source is read;
+   0 means no limit.  With threads > 1 both separable passes are split among
+   worker threads owned by the state. */
+typedef struct CvDistTransformState CvDistTransformState;
+
+OPENCVAPI  CvDistTransformState* cvCreateDistTransformState( CvSize max_size,
+                                                 float max_dist CV_DEFAULT(0),
+                                                 int threads CV_DEFAULT(1) );
+
+OPENCVAPI  void cvReleaseDistTransformState( CvDistTransformState** state );
+
+/* Exact Euclidean distance from each pixel of rect to the nearest zero pixel
+   of src, written to the 32fC1 dst; an empty rect means the whole image.  src
+   and dst may be ring buffers: pixel (x,y) is then stored at
+   ((x + origin.x) mod width, (y + origin.y) mod height), and rect is in the
+   unwrapped coordinates.  No memory is allocated. */
+OPENCVAPI  void cvDistTransformWithState( const CvArr* src, CvArr* dst,
+                                          CvDistTransformState* state,
+                                          CvRect rect, CvPoint origin );
+
 
 /* Defines for Threshold functions */
 #define CV_THRESH_BINARY      0  /* val = (val>thresh? MAX:0)      */
@@ -2393,6 +2530,68 @@ OPENCVAPI  CvSeq*  cvHoughLines2( CvArr* image, void* line_storage, int method,
                                   double rho, double theta, int threshold,
                                   double param1 CV_DEFAULT(0), double param2 CV_DEFAULT(0));
 
+/* A straight edge found by cvFindEdgeLines */
+typedef struct CvEdgeLine
+{
+    CvPoint2D32f pt1, pt2;   /* ends of the segment */
+    float rho, theta;        /* its line, x*cos(theta) + y*sin(theta) = rho, 0 <= theta < pi */
+    int id;                  /* a line tracked from frame to frame keeps its id */
+    int age;                 /* frames the line has been found in */
+    int missed;              /* frames since it was last found, 0 if found in this one */
+    int length;              /* edge pixels on the segment */
+}
+CvEdgeLine;
+
+/* Parameters, lines and working buffers of cvFindEdgeLines.
+   The parameters may be changed between calls.  Lines found in one frame
+   are looked for first near where they were, and only the edge pixels
+   left over go to the probabilistic Hough transform, so a line keeps its
+   id while it moves a little from frame to frame. */
+typedef struct CvEdgeLineState
+{
+    int cannyLow;            /* hysteresis thresholds on |dx|+|dy| of the 3x3 Sobel */
+    int cannyHigh;
+    int threshold;           /* accumulator votes needed for a new line */
+    int minLineLength;       /* shortest segment kept, in pixels */
+    int maxLineGap;          /* longest gap bridged within a segment */
+    int trackRho;            /* a tracked line is searched for up to this far, in pixels, */
+    int trackTheta;          /* and up to this many degrees from where it was */
+    int maxMissed;           /* frames a line is kept after it was last found */
+
+    int maxLines;            /* room in lines[] */
+    int lineCount;           /* lines found or still tracked, tracked ones first */
+    CvEdgeLine* lines;
+
+    /* working buffers, for internal use */
+    CvSize imgSize;
+    CvRect roiRect;          /* bounding box of the region of interest */
+    int nextId;
+    int rhoCount;            /* accumulator is [degree][rho], rho offset by rhoCount/2 */
+    CvMat* roiSpan;          /* for each row, first and last+1 column in the region */
+    CvMat* dx;               /* gradient, 16sC1 */
+    CvMat* dy;
+    CvMat* edges;            /* 8uC1, 255 for an edge pixel, 128 once it has voted */
+    CvMat* cannyBuf;
+    CvMat* accum;            /* 180 x rhoCount, 32sC1 */
+    CvMat* trigTab;          /* cos and sin of each degree */
+    CvMat* points;           /* edge pixels, 32sC2 */
+}
+CvEdgeLineState;
+
+OPENCVAPI  CvEdgeLineState* cvCreateEdgeLineState( CvSize imgSize,
+                                                  int maxLines CV_DEFAULT(16) );
+
+OPENCVAPI  void  cvReleaseEdgeLineState( CvEdgeLineState** state );
+
+/* Restricts edge finding to a convex polygon; count = 0 for the whole image */
+OPENCVAPI  void  cvSetEdgeLineROI( CvEdgeLineState* state, const CvPoint* polygon,
+                                   int count );
+
+/* Finds Canny edges of image (8uC1, state->imgSize) in the region of interest,
+   follows the lines already known and looks for new ones in the edges left.
+   Returns state->lineCount; lines with missed > 0 were not seen this time */
+OPENCVAPI  int  cvFindEdgeLines( CvEdgeLineState* state, const CvArr* image );
+
 /* Projects 2d points to one of standard coordinate planes
    (i.e. removes one of coordinates) */
 OPENCVAPI  void  cvProject3D( CvPoint3D32f* points3D, int count,
@@ -2709,6 +2908,42 @@ OPENCVAPI  void cvComputeCorrespondEpilines(CvMat* points,
                                             CvMat* fundMatr,
                                             CvMat* corrLines);
 
+/************************** Block Matching Stereo ***************************/
+
+/* Parameters and working buffers of cvFindStereoCorrespondenceBM.
+   The parameters may be changed between calls; the buffers are resized
+   as needed.  Disparity d means that left image pixel (x,y) matches right
+   image pixel (x-d,y), so the images must be rectified. */
+typedef struct CvStereoBMState
+{
+    int preFilterCap;        /* horizontal Sobel response is clipped to +-cap, 1..63 */
+    int SADWindowSize;       /* odd, 5..255 */
+    int minDisparity;        /* smallest disparity searched, may be negative */
+    int numberOfDisparities; /* disparities searched, from minDisparity up */
+    int textureThreshold;    /* minimum sum of clipped |Sobel| over the window */
+    int uniquenessRatio;     /* best match must be this % better than any other
+                                disparity more than 1 away, 0..100 */
+    int disp12MaxDiff;       /* left-right consistency tolerance in pixels,
+                                < 0 to skip the check */
+
+    /* working buffers, for internal use */
+    CvMat* preFilteredImg0;
+    CvMat* preFilteredImg1;
+    CvMat* slidingSumBuf;
+}
+CvStereoBMState;
+
+OPENCVAPI  CvStereoBMState* cvCreateStereoBMState( int numberOfDisparities CV_DEFAULT(64),
+                                                  int SADWindowSize CV_DEFAULT(9) );
+
+OPENCVAPI  void cvReleaseStereoBMState( CvStereoBMState** state );
+
+/* Finds disparity, in pixels with subpixel precision, for each pixel of the
+   left image (8uC1) against the right image (8uC1).  disparity is 32fC1, and
+   pixels without a good match are set to state->minDisparity-1 */
+OPENCVAPI  void cvFindStereoCorrespondenceBM( const CvArr* left, const CvArr* right,
+                                              CvArr* disparity, CvStereoBMState* state );
+
 /*************************** View Morphing Functions ************************/
 
 /* The order of the function corresponds to the order they should appear in
@@ -2802,6 +3037,10 @@ OPENCVAPI  int  cvFillInternalFuncsTable(void* table);
 OPENCVAPI  void  cvGetLibraryInfo( const char** version, int* loaded,
                                    const char** loaded_modules );
 
+/* Returns the variant ("generic", "sse2", "sse4.1", "avx2") installed for
+   a low-level primitive, e.g. "icvAdd_8u_C1R", or NULL if there is no such primitive */
+OPENCVAPI  const char*  cvGetPrimitiveVariant( const char* func_name );
+
 /* Get current OpenCV error status */
 OPENCVAPI CVStatus cvGetErrStatus( void );
 
@@ -1025,6 +1025,18 @@ typedef struct CvMemStoragePos
 CvMemStoragePos;
 
 
+/* allocation counts of the memory storages of one thread */
+typedef struct CvMemStorageStats
+{
+    int  heap_blocks;    /* storage blocks taken from the heap */
+    int  cached_blocks;  /* storage blocks reused from the thread's cache instead */
+    int  freed_blocks;   /* storage blocks returned to the heap */
+    int  heap_headers;   /* storage headers taken from the heap */
+    int  cached_headers; /* storage headers reused from the thread's cache instead */
+}
+CvMemStorageStats;
+
+
 /*********************************** Sequence *******************************************/
 
 typedef struct CvSeqBlock
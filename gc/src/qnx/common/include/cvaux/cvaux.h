@@ -671,6 +671,20 @@ OPENCVAUXAPI void cvGetGLCMDescriptorStatistics( CvGLCM* GLCM, int descriptor,
 
 OPENCVAUXAPI IplImage* cvCreateGLCMImage( CvGLCM* GLCM, int step );
 
+/* Contrast, homogeneity and entropy of the GLCM of each patch of a grid over
+   an 8-bit image, quantized to <levels> gray levels (2..16), for pixel pairs
+   offset by (dx,dy). descriptors is 32fC3, one element per patch, channels in
+   the order of the CV_GLCMPATCH_ constants; patch (i,j) has its top left corner
+   at (j*patchStep.width, i*patchStep.height). The co-occurrence counts are
+   updated incrementally as the patch slides along each row of the grid. */
+#define CV_GLCMPATCH_CONTRAST                       0
+#define CV_GLCMPATCH_HOMOGENITY                     1
+#define CV_GLCMPATCH_ENTROPY                        2
+
+OPENCVAUXAPI void cvCalcGLCMPatchDescriptors( const CvArr* image, CvArr* descriptors,
+                                              int levels, CvSize patchSize, CvSize patchStep,
+                                              int dx CV_DEFAULT(1), int dy CV_DEFAULT(0) );
+
 
 /****************************************************************************************\
 *                             Haar-like object detection                                 *
@@ -128,12 +128,30 @@ struct GPSINSGetBasepointRep {
 		double llh[3];										// Latitude(deg), Longitude(deg) Height(m)
 };
 //
+//	GPSINSVisualOdometry  -- vehicle motion seen by the road camera
+//
+//	Motion over the ground between two camera frames, in vehicle axes at the
+//	earlier frame. Used as a velocity measurement between GPS fixes.
+//
+struct GPSINSVisualOdometry: public MsgBase
+{
+    static const uint32_t k_msgtype = char4('G','P','V','O');
+	uint64_t timestamp;									// time of later frame, nanoseconds since epoch
+	float dt;													// time between frames (s)
+	float forward;											// distance moved forward (m)
+	float left;												// distance moved to the left (m)
+	float yaw;												// heading change, counterclockwise (deg)
+	float unc;												// 1-sigma uncertainty of the distances (m)
+	uint16_t points;										// ground points in the fit
+};
+//
 //	All GPSINS messages as a union
 //
 union GPSINSMsg {
 	GPSINSMsgReq	m_req;						// request for GPS/INS fix
 	GPSINSBasepoint m_basepoint;			// set new basepoint
 	GPSINSGetBasepoint m_getbasepoint;	// get current basepoint
+	GPSINSVisualOdometry m_visualodometry;	// motion from road camera
 };
 //////////////////////////////////////////////////////////////////////////////////////////////////
 // some useful inline functions
@@ -27,6 +27,8 @@
 #include "voradserver.h"
 #include "moveservermsg.h"
 #include "simplesonar.h"
+#include "stereoserver.h"
+#include "roadserver.h"
 
 const char MAPSERVER_ID[] = "MAP";						// watchdog ID of this server
 
@@ -47,6 +49,8 @@ public:
 	MoveServerMsg::MsgMoveQuery		m_query;				// query only, no command
 	MoveServerMsg::MsgMoveStop		m_stop;					// do E-stop
 	SonarObstacleMsgReq		m_sonar;								// incoming SONAR data
+	StereoServerMsgSTEL		m_stereodata;						// incoming stereo vision elevation data
+	RoadServerMsgRDGR		m_roaddata;							// incoming road likelihood grid from camera
     } m_un;
 
 	//
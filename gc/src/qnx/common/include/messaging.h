@@ -174,6 +174,8 @@ public:
 	: MsgPort(name,timeout), m_coid(-1) {}
 	//	Standard QNX form
 	int MsgSend(const void* msg, int msgbytes, void* rmsg, int rmsgbytes);
+	//	Scatter-gather form
+	int MsgSendv(const iov_t* siov, int sparts, const iov_t* riov, int rparts);
 	//	Safer, more convenient template form
 	template<class TIN, class TOUT> int MsgSend(const TIN& msg, TOUT& rmsg)
 	{	return(MsgSend(&msg,sizeof(msg),&rmsg, sizeof(rmsg))); }
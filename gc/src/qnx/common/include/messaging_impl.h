@@ -359,6 +359,25 @@ inline int MsgClientPort::MsgSend(const void* msg, int msgbytes, void* rmsg, int
 	return(stat);																	// return status
 }
 //
+//	MsgSendv  -- send a message from and to I/O vectors, setting up the connection if necessary
+//
+inline int MsgClientPort::MsgSendv(const iov_t* siov, int sparts, const iov_t* riov, int rparts)
+{	if (updatecoid())															// update connection info
+	{	if (verbose()) { perror("MsgClientPort cannot locate server"); }
+		assert(errno); return(-1);											// fails
+	}
+	const uint64_t timeoutns = gettimeoutns();					// timeout in nanoseconds
+	if (timeoutns != 0)														// if timeout
+	{	TimerTimeout( CLOCK_REALTIME,  _NTO_TIMEOUT_SEND | _NTO_TIMEOUT_REPLY, NULL, &timeoutns, NULL );	}
+	int stat = ::MsgSendv(m_coid, siov, sparts, riov, rparts);	// send the message
+	if (stat < 0)																	// if communications trouble
+	{	if (verbose()) {	perror("MsgSendv failed in client"); }	// report the problem
+		if (errno == ETIMEDOUT) { return(stat); }					// timeout is normal; we're still attached
+		ConnectDetach();														// break connection. Next call will remake it
+	}
+	return(stat);																	// return status
+}
+//
 //	Dump  -- dump to standard output
 //
 inline void MsgClientPort::Dump()
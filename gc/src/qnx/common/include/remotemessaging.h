@@ -45,6 +45,8 @@ public:
 	{}
 	//	Standard QNX form
 	int MsgSend(const void* msg, int msgbytes, void* rmsg, int rmsgbytes);
+	//	Scatter-gather form
+	int MsgSendv(const iov_t* siov, int sparts, const iov_t* riov, int rparts);
 	//	Safer, more convenient template form
 	template<class TIN, class TOUT> int MsgSend(const TIN& msg, TOUT& rmsg)
 	{	return(MsgSend(&msg,sizeof(msg),&rmsg, sizeof(rmsg))); }
@@ -76,6 +78,23 @@ inline int RemoteMsgClientPort::MsgSend(const void* msg, int msgbytes, void* rms
 	return(stat);																	// return status
 }
 //
+//	MsgSendv  -- send a message from and to I/O vectors, setting up the connection if necessary
+//
+inline int RemoteMsgClientPort::MsgSendv(const iov_t* siov, int sparts, const iov_t* riov, int rparts)
+{	if (updatecoid())															// update connection info
+	{	 return(-1);																// fails, error in errno.
+	}
+	const uint64_t timeoutns = m_timeout;							// timeout in nanoseconds
+	if (timeoutns != 0)														// if timeout
+	{	TimerTimeout( CLOCK_REALTIME,  _NTO_TIMEOUT_SEND | _NTO_TIMEOUT_REPLY, NULL, &timeoutns, NULL );	}
+	int stat = ::MsgSendv(m_coid, siov, sparts, riov, rparts);	// send the message
+	if (stat < 0)																	// if communications trouble
+	{	if (errno == ETIMEDOUT) { return(stat); }					// timeout is normal; we're still attached
+		ConnectDetach();														// break connection. Next call will remake it
+	}
+	return(stat);																	// return status
+}
+//
 //	updatecoid -- update connection ID
 //
 //	Connects if necessary.  This allows us to recover from disconnection.
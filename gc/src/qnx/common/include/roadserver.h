@@ -41,6 +41,7 @@ struct RoadServerMsgRDDR: public MsgBase {
 	enum RoadPavement { RoadPaved, RoadUnpaved, RoadUnknown };
 	RoadPavement pavement;					// paved or unpaved; selects which road follower algorithm to use
 	float upvector[3];									// which way is up, as a unit vector, from INS.  Used to adjust image
+	float m_cleardist;									// ground straight ahead the map has CLEAR across the vehicle's width, m; 0 if none
 };
 //
 //	Reply from RoadServerMsgRDDR
@@ -65,6 +66,29 @@ struct RoadServerMsgRDPC: public MsgBase {
 	int debuglevel;										// overlay with graphic debug info - 0=none, 1=normal, 2=debug
 };
 
+//
+//  RoadServerMsgRDGR - RDGR: Road Grid
+//
+//	How road-like the ground ahead looked to the camera, on a grid in vehicle axes,
+//	from one frame. Sent by the road server to the map server after each frame in
+//	which the road classifier has a road model. The map server places it with the
+//	vehicle pose at the time the frame was taken.
+//
+//	Cell (row, col) covers x (forward) from m_nearx + row*m_cellsize, and y (left)
+//	from (col - k_cols/2)*m_cellsize, each for m_cellsize, relative to the camera
+//	position projected onto the ground.
+//
+struct RoadServerMsgRDGR: public MsgBase {
+	static const uint32_t k_msgtype = char4('R','D','G','R');
+	static const int k_rows = 64;						// cells ahead
+	static const int k_cols = 32;						// cells across
+	static const uint8_t k_nodata = 255;			// cell not seen by the camera
+	uint64_t m_timestamp;							// time frame was taken, nanoseconds since epoch
+	float m_cellsize;										// size of a cell, m
+	float m_nearx;											// near edge of row 0, m ahead of camera
+	uint8_t m_cells[k_rows][k_cols];				// road likelihood 0-254, or k_nodata
+};
+
 //
 //  RoadServerMsg - all MVP Server messages as a union
 //
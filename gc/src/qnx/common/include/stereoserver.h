@@ -0,0 +1,53 @@
+/////////////////////////////////////////////////////////////////////////////
+//
+//    File: stereoserver.h
+//
+//    Usage:
+//        In the watchdog startup file (startfile.txt):
+//				ID=STEREO stereoserver /dev/fw/camera0 /dev/fw/camera1 stereocalib.txt
+///
+//    Description:
+//       The Stereo Server reads a pair of FireWire cameras, finds disparity by
+//			block matching, and sends elevation samples of the terrain ahead to
+//			the map server, as a second terrain source alongside the LIDAR.
+//
+//    Written By:
+//        Team Overbot
+//        October, 2026
+//
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef STEREOSERVER_H
+#define STEREOSERVER_H
+#include "messaging.h"
+
+//
+//  StereoServer - stereo vision messages
+//
+//
+//	StereoElevSample  -- what the cameras saw in one small patch of ground
+//
+//	Positions are relative to the left camera, in vehicle axes: x forward, y left,
+//	z up, meters. The map server adds the camera offset and the vehicle pose.
+//
+struct StereoElevSample {
+	float m_x, m_y;										// center of patch
+	float m_minz, m_maxz;							// lowest and highest point seen in patch
+	uint16_t m_range;									// distance from camera, cm
+	uint16_t m_count;									// number of disparity points in patch
+};
+//
+//  StereoServerMsgSTEL - STEL: Stereo Elevation
+//
+// 	Elevation samples from one stereo frame, to the map server.
+//	A frame with more samples than fit goes as several messages with the same timestamp.
+//
+struct StereoServerMsgSTEL: public MsgBase {
+	static const uint32_t k_msgtype = char4('S','T','E','L');
+	uint64_t	m_timestamp;							// time frame was taken, nanoseconds since epoch
+	static const int k_maxsamples = 256;		// max samples per message
+	uint16_t m_samplecount;							// samples in use
+	StereoElevSample m_samples[k_maxsamples];	// the samples
+};
+
+#endif // STEREOSERVER_H
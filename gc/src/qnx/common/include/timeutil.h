@@ -10,6 +10,8 @@
 #include <inttypes.h>
 #include <time.h>
 #include <pthread.h>
+#include <sys/neutrino.h>
+#include <sys/syspage.h>
 //
 //	gettimenowns  -- get time now, in nanoseconds
 //
@@ -26,6 +28,19 @@ inline double gettimenow()
 {		return(gettimenowns()*0.000000001);			// time in seconds since epoch
 }
 //
+//	getcyclecount  -- CPU cycle counter, for timing short sections of code
+//
+//	The realtime clock only advances once per tick, which is too coarse
+//	for timing anything shorter than a steering cycle.
+//
+inline uint64_t getcyclecount()
+{	return(ClockCycles());	}
+//
+//	cyclestosecs  -- convert a difference in cycle counts to seconds
+//
+inline double cyclestosecs(uint64_t cycles)
+{	return(double(cycles) / double(SYSPAGE_ENTRY(qtime)->cycles_per_sec));	}
+//
 //	Priority support
 //
 //
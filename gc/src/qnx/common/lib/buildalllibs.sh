@@ -39,6 +39,7 @@ echo "Build and install test programs for libraries"
 # (cd check_actserver &&   make &&   make install)
 (cd check_ask &&    make &&   make install)
 (cd check_controller &&    make &&   make install)
+(cd check_cvsimd &&    make &&   make install)
 (cd check_ethernet &&    make &&   make install)
 (cd check_getoptions &&    make &&   make install)
 (cd check_ideconsole &&    make &&   make install)
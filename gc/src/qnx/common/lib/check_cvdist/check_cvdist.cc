@@ -0,0 +1,183 @@
+//
+//	check_cvdist.cc  -- benchmark and check the exact Euclidean distance transform
+//
+//	Checks cvDistTransformWithState against brute force on a small mask, and
+//	checks that threads, partial rectangles with a distance limit, and ring
+//	origins all give the same answer as the plain transform. Then times the
+//	chamfer transforms and the exact one on a camera-sized mask, and reports
+//	how far the chamfer distances are from the exact ones.
+//
+//	Usage: check_cvdist [iterations] [threads]
+//
+//	Team Overbot
+//	October, 2026
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <cv.h>
+#include "timeutil.h"
+
+const int k_width = 640;													// camera frame size
+const int k_height = 480;
+const int k_small = 97;														// brute force check size
+const float k_maxdist = 20.0f;												// limit for the partial updates
+//
+//	fillmask  -- repeatable mask with scattered zero pixels and a few zero blocks
+//
+static void fillmask(CvMat* mask, unsigned seed, int onein)
+{	cvSet(mask, cvScalarAll(255));
+	for (int y=0; y<mask->rows; y++)
+	{	uchar* row = mask->data.ptr + y*mask->step;
+		for (int x=0; x<mask->cols; x++)
+		{	seed = seed*1103515245 + 12345;
+			if ((seed >> 16) % onein == 0) row[x] = 0;
+		}
+	}
+	for (int i=0; i<4; i++)
+	{	seed = seed*1103515245 + 12345;
+		const int x = (seed >> 16) % mask->cols, y = (seed >> 4) % mask->rows;
+		cvRectangle(mask, cvPoint(x, y), cvPoint(x + mask->cols/16, y + mask->rows/16), 0, CV_FILLED);
+	}
+}
+//
+//	maxdiff  -- largest difference between two distance images, within a rectangle
+//
+static double maxdiff(const CvMat* a, const CvMat* b, CvRect rect)
+{	double worst = 0;
+	for (int y=rect.y; y<rect.y+rect.height; y++)
+		for (int x=rect.x; x<rect.x+rect.width; x++)
+			worst = std::max(worst, fabs(double(CV_MAT_ELEM(*a, float, y, x)) - CV_MAT_ELEM(*b, float, y, x)));
+	return(worst);
+}
+//
+//	check  -- report one check
+//
+static int check(const char* what, double err, double tolerance)
+{	printf("%-40s max error %8.5f  %s\n", what, err, err <= tolerance ? "ok" : "FAILED");
+	return(err <= tolerance ? 0 : 1);
+}
+//
+//	checksmall  -- exact transform against brute force
+//
+static int checksmall()
+{	CvMat* mask = cvCreateMat(k_small, k_small, CV_8UC1);
+	CvMat* exact = cvCreateMat(k_small, k_small, CV_32FC1);
+	CvMat* brute = cvCreateMat(k_small, k_small, CV_32FC1);
+	fillmask(mask, 4321, 300);
+	cvDistTransform(mask, exact, CV_DIST_L2, CV_DIST_MASK_PRECISE);
+	for (int y=0; y<k_small; y++)
+		for (int x=0; x<k_small; x++)
+		{	double best = 1e30;
+			for (int v=0; v<k_small; v++)
+				for (int u=0; u<k_small; u++)
+					if (CV_MAT_ELEM(*mask, uchar, v, u) == 0)
+						best = std::min(best, double((u-x)*(u-x) + (v-y)*(v-y)));
+			CV_MAT_ELEM(*brute, float, y, x) = float(sqrt(best));
+		}
+	int errors = check("exact vs brute force", maxdiff(exact, brute, cvRect(0, 0, k_small, k_small)), 1e-4);
+	cvReleaseMat(&mask);
+	cvReleaseMat(&exact);
+	cvReleaseMat(&brute);
+	return(errors);
+}
+//
+//	checkvariants  -- threads, partial rectangles, and ring origins against the plain transform
+//
+static int checkvariants(const CvMat* mask, const CvMat* exact, int threads)
+{	int errors = 0;
+	const CvSize size = cvGetSize(mask);
+	CvMat* out = cvCreateMat(size.height, size.width, CV_32FC1);
+	CvMat* clamped = cvCreateMat(size.height, size.width, CV_32FC1);
+	CvMat* ring = cvCreateMat(size.height, size.width, CV_8UC1);
+	CvDistTransformState* state = cvCreateDistTransformState(size, 0, threads);
+	cvDistTransformWithState(mask, out, state, cvRect(0, 0, 0, 0), cvPoint(0, 0));
+	errors += check("threads vs single thread", maxdiff(out, exact, cvRect(0, 0, size.width, size.height)), 0);
+	cvReleaseDistTransformState(&state);
+	//	Partial rectangles, with the distance limit
+	cvMinS(exact, k_maxdist, clamped);
+	state = cvCreateDistTransformState(size, k_maxdist, threads);
+	cvSet(out, cvScalarAll(-1));
+	const CvRect rects[3] = { cvRect(0, 0, 40, 30), cvRect(300, 200, 64, 48), cvRect(size.width-17, size.height-50, 17, 50) };
+	double worst = 0;
+	for (int i=0; i<3; i++)
+	{	cvDistTransformWithState(mask, out, state, rects[i], cvPoint(0, 0));
+		worst = std::max(worst, maxdiff(out, clamped, rects[i]));
+	}
+	errors += check("rectangles with limit vs full", worst, 1e-5);
+	//	Ring origin: the same mask, stored rotated, as a scrolling map would be
+	const CvPoint origin = cvPoint(123, 77);
+	for (int y=0; y<size.height; y++)
+		for (int x=0; x<size.width; x++)
+			CV_MAT_ELEM(*ring, uchar, (y+origin.y) % size.height, (x+origin.x) % size.width) = CV_MAT_ELEM(*mask, uchar, y, x);
+	cvDistTransformWithState(ring, out, state, cvRect(0, 0, 0, 0), origin);
+	worst = 0;
+	for (int y=0; y<size.height; y++)
+		for (int x=0; x<size.width; x++)
+			worst = std::max(worst, fabs(double(CV_MAT_ELEM(*out, float, (y+origin.y) % size.height, (x+origin.x) % size.width))
+				- CV_MAT_ELEM(*clamped, float, y, x)));
+	errors += check("ring origin vs full", worst, 1e-5);
+	cvReleaseDistTransformState(&state);
+	cvReleaseMat(&out);
+	cvReleaseMat(&clamped);
+	cvReleaseMat(&ring);
+	return(errors);
+}
+
+int main(int argc, char* argv[])
+{
+	int iterations = 100;
+	int threads = 4;
+	if (argc > 1) iterations = atoi(argv[1]);
+	if (argc > 2) threads = atoi(argv[2]);
+	if (iterations < 1) iterations = 1;
+	if (threads < 1) threads = 1;
+	const CvSize size = cvSize(k_width, k_height);
+	CvMat* mask = cvCreateMat(k_height, k_width, CV_8UC1);
+	CvMat* exact = cvCreateMat(k_height, k_width, CV_32FC1);
+	CvMat* out = cvCreateMat(k_height, k_width, CV_32FC1);
+	fillmask(mask, 12345, 2000);
+	cvDistTransform(mask, exact, CV_DIST_L2, CV_DIST_MASK_PRECISE);
+	int errors = checksmall();
+	errors += checkvariants(mask, exact, threads);
+	//	Timing
+	CvDistTransformState* single = cvCreateDistTransformState(size);
+	CvDistTransformState* multi = cvCreateDistTransformState(size, 0, threads);
+	CvDistTransformState* limited = cvCreateDistTransformState(size, k_maxdist);
+	const int k_runs = 6;
+	static const char* labels[k_runs] = { "chamfer 3x3", "chamfer 5x5", "exact", "exact, state",
+		"exact, state, threads", "exact, 64x48 rect, limit" };
+	printf("\n%-28s %10s %8s %12s\n", "transform", "usec/call", "speedup", "max error");
+	double basetime = 0;
+	for (int run = 0; run < k_runs; run++)
+	{	double starttime = gettimenow();
+		for (int i=0; i<iterations; i++)
+		{	switch (run) {
+			case 0: cvDistTransform(mask, out, CV_DIST_L2, CV_DIST_MASK_3); break;
+			case 1: cvDistTransform(mask, out, CV_DIST_L2, CV_DIST_MASK_5); break;
+			case 2: cvDistTransform(mask, out, CV_DIST_L2, CV_DIST_MASK_PRECISE); break;
+			case 3: cvDistTransformWithState(mask, out, single, cvRect(0, 0, 0, 0), cvPoint(0, 0)); break;
+			case 4: cvDistTransformWithState(mask, out, multi, cvRect(0, 0, 0, 0), cvPoint(0, 0)); break;
+			case 5: cvDistTransformWithState(mask, out, limited, cvRect(300, 200, 64, 48), cvPoint(0, 0)); break;
+			}
+		}
+		double usec = (gettimenow() - starttime)*1000000.0/iterations;
+		if (run == 0) basetime = usec;
+		if (run < 5)
+			printf("%-28s %10.1f %7.2fx %12.4f\n", labels[run], usec, basetime/usec,
+				maxdiff(out, exact, cvRect(0, 0, k_width, k_height)));
+		else
+			printf("%-28s %10.1f %7.2fx\n", labels[run], usec, basetime/usec);
+	}
+	cvReleaseDistTransformState(&single);
+	cvReleaseDistTransformState(&multi);
+	cvReleaseDistTransformState(&limited);
+	if (errors)
+	{	printf("FAILED: %d checks\n", errors);
+		return(1);
+	}
+	printf("OK\n");
+	return(0);
+}
@@ -0,0 +1,249 @@
+//
+//	check_cvsimd.cc  -- benchmark and check the OpenCV SIMD primitives
+//
+//	For each instruction set level the CPU supports, loads the primitives
+//	at that level, times each dispatched primitive on camera-sized
+//	images (through cvSmooth, cvErode/cvDilate, cvFindStereoCorrespondenceBM,
+//	cvCalcOpticalFlowPyrLKState and cvFindEdgeLines for the smoothing,
+//	morphology, stereo, feature tracking and edge primitives), reports which
+//	variant actually ran, and checks that the output is identical to the
+//	generic C code.
+//
+//	Usage: check_cvsimd [iterations]
+//
+//	Team Overbot
+//	October, 2026
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cv.h>
+#include "timeutil.h"
+
+//
+//	Primitive signatures, as in the library's internal _ipcv.h
+//
+typedef CvStatus (CV_STDCALL *BinFunc8u)(const uchar* src1, int step1, const uchar* src2, int step2,
+	uchar* dst, int step, CvSize size);
+typedef CvStatus (CV_STDCALL *BinFunc32f)(const float* src1, int step1, const float* src2, int step2,
+	float* dst, int step, CvSize size);
+typedef CvStatus (CV_STDCALL *CvtFunc8u)(const uchar* src, int srcstep, uchar* dst, int dststep, CvSize size);
+typedef CvStatus (CV_STDCALL *ResizeFunc8u)(const uchar* src, int srcstep, CvSize srcsize,
+	uchar* dst, int dststep, CvSize dstsize);
+typedef CvStatus (CV_STDCALL *PyrFunc8u)(const uchar* src, int srcstep, uchar* dst, int dststep,
+	CvSize size, void* buf);
+//
+//	Layout expected by cvFillInternalFuncsTable
+//
+struct FuncEntry {
+	void (**addr)(void);													// where to store the function
+	const char* name;														// primitive name
+	int loaded;																	// set if found
+};
+
+static BinFunc8u add8u, sub8u, absdiff8u;
+static BinFunc32f add32f, sub32f, absdiff32f;
+static CvtFunc8u bgr2gray;
+static ResizeFunc8u resize8u;
+static PyrFunc8u pyrdown8u;
+
+#define FUNC_ENTRY(var, name) { (void (**)(void))&var, name, 0 }
+static FuncEntry functab[] = {
+	FUNC_ENTRY(add8u, "icvAdd_8u_C1R"),
+	FUNC_ENTRY(sub8u, "icvSub_8u_C1R"),
+	FUNC_ENTRY(absdiff8u, "icvAbsDiff_8u_C1R"),
+	FUNC_ENTRY(add32f, "icvAdd_32f_C1R"),
+	FUNC_ENTRY(sub32f, "icvSub_32f_C1R"),
+	FUNC_ENTRY(absdiff32f, "icvAbsDiff_32f_C1R"),
+	FUNC_ENTRY(bgr2gray, "icvCvt_BGR2GRAY_8u_C3C1R"),
+	FUNC_ENTRY(resize8u, "icvResize_Bilinear_8u_C1R"),
+	FUNC_ENTRY(pyrdown8u, "icvPyrDown_Gauss5x5_8u_C1R"),
+	{ 0, 0, 0 }
+};
+
+const int k_width = 640;													// camera frame size
+const int k_height = 480;
+const int k_tests = 18;														// entries in test list
+//
+//	Test buffers. Outputs are compared against the generic run.
+//
+static uchar* src8u[2];
+static float* src32f[2];
+static uchar* bgr;
+static uchar* dst8u;
+static float* dst32f;
+static int* pyrbuf;
+static uchar* golden[k_tests];
+static CvMat mat8u, matdst8u, mat32f, matdst32f;						// headers for the cv function tests
+static IplConvKernel* rect15;												// morphology elements
+static IplConvKernel* rect5;
+static CvMat stereoleft, stereoright, stereodisp;						// right is left moved 8 pixels
+static CvStereoBMState* stereostate;
+const int k_lkgrid = 20;														// tracked points, k_lkgrid squared
+static CvPyrLKState* lkstate;													// previous frame is next one moved (3,2)
+static CvPoint2D32f lkprev[k_lkgrid*k_lkgrid];
+static CvMat* edgeimage;														// smoothed texture with two road edges
+static CvEdgeLineState* edgestate;
+//
+//	runtest  -- run one primitive once. Returns output size in bytes.
+//
+static size_t runtest(int test, void*& out)
+{
+	const CvSize full = cvSize(k_width, k_height);
+	const CvSize half = cvSize(k_width/2, k_height/2);
+	const int step8u = k_width;
+	const int step32f = k_width*sizeof(float);
+	switch (test) {
+	case 0: add8u(src8u[0], step8u, src8u[1], step8u, dst8u, step8u, full); break;
+	case 1: sub8u(src8u[0], step8u, src8u[1], step8u, dst8u, step8u, full); break;
+	case 2: absdiff8u(src8u[0], step8u, src8u[1], step8u, dst8u, step8u, full); break;
+	case 3: add32f(src32f[0], step32f, src32f[1], step32f, dst32f, step32f, full); out = dst32f; return(k_width*k_height*sizeof(float));
+	case 4: sub32f(src32f[0], step32f, src32f[1], step32f, dst32f, step32f, full); out = dst32f; return(k_width*k_height*sizeof(float));
+	case 5: absdiff32f(src32f[0], step32f, src32f[1], step32f, dst32f, step32f, full); out = dst32f; return(k_width*k_height*sizeof(float));
+	case 6: bgr2gray(bgr, k_width*3, dst8u, step8u, full); break;
+	case 7: resize8u(src8u[0], step8u, full, dst8u, step8u, cvSize(400, 300)); break;		// downsample
+	case 8: resize8u(src8u[0], step8u, half, dst8u, step8u, full); break;						// upsample
+	case 9: pyrdown8u(src8u[0], step8u, dst8u, step8u, full, pyrbuf); out = dst8u; return(half.width*half.height);
+	case 10: cvSmooth(&mat8u, &matdst8u, CV_GAUSSIAN, 5, 5); break;
+	case 11: cvSmooth(&mat8u, &matdst8u, CV_BLUR, 5, 5); break;
+	case 12: cvSmooth(&mat32f, &matdst32f, CV_GAUSSIAN, 5, 5); out = dst32f; return(k_width*k_height*sizeof(float));
+	case 13: cvErode(&mat8u, &matdst8u, rect15, 1); break;
+	case 14: cvDilate(&mat32f, &matdst32f, rect5, 1); out = dst32f; return(k_width*k_height*sizeof(float));
+	case 15: cvFindStereoCorrespondenceBM(&stereoleft, &stereoright, &stereodisp, stereostate);
+		out = dst32f; return((k_width-8)*k_height*sizeof(float));
+	case 16:
+	{	CvPoint2D32f* next = (CvPoint2D32f*)dst32f;
+		char* status = (char*)(next + k_lkgrid*k_lkgrid);
+		cvCalcOpticalFlowPyrLKState(lkstate, lkprev, next, k_lkgrid*k_lkgrid, status, 0,
+			cvTermCriteria(CV_TERMCRIT_ITER | CV_TERMCRIT_EPS, 20, 0.01), 0);
+		out = dst32f; return(k_lkgrid*k_lkgrid*(sizeof(CvPoint2D32f)+1));
+	}
+	case 17:
+		edgestate->lineCount = 0;												// no tracking, same work every time
+		cvFindEdgeLines(edgestate, edgeimage);
+		out = edgestate->edges->data.ptr;									// edges left after the lines are taken
+		return(k_width*k_height);
+	}
+	out = dst8u;
+	return(k_width*k_height);
+}
+
+static const char* testnames[k_tests] = {
+	"icvAdd_8u_C1R", "icvSub_8u_C1R", "icvAbsDiff_8u_C1R",
+	"icvAdd_32f_C1R", "icvSub_32f_C1R", "icvAbsDiff_32f_C1R",
+	"icvCvt_BGR2GRAY_8u_C3C1R", "icvResize_Bilinear_8u_C1R",
+	"icvResize_Bilinear_8u_C1R", "icvPyrDown_Gauss5x5_8u_C1R",
+	"icvFilterCol_32f8u_C1R", "icvSumCol_32f8u_C1R", "icvFilterCol_32f_C1R",
+	"icvMinVec_8u", "icvMaxRow_32f_CnR", "icvUpdateSADCol_8u16u_C1R",
+	"icvLKMismatch_32f_C1R", "icvSobel3x3Row_8u16s_C1R" };
+static const char* testlabels[k_tests] = {
+	"add 8u", "sub 8u", "absdiff 8u", "add 32f", "sub 32f", "absdiff 32f",
+	"BGR->gray", "resize 8u down", "resize 8u up", "pyrdown 8u",
+	"gaussian 5x5 8u", "blur 5x5 8u", "gaussian 5x5 32f",
+	"erode 15x15 8u", "dilate 5x5 32f", "stereo BM 9x9", "LK track 400",
+	"edge lines" };
+
+int main(int argc, char* argv[])
+{
+	int iterations = 200;
+	if (argc > 1) iterations = atoi(argv[1]);
+	if (iterations < 1) iterations = 1;
+	//	Fill the inputs with repeatable pseudo-random data
+	const size_t npix = k_width*k_height;
+	for (int i=0; i<2; i++)
+	{	src8u[i] = new uchar[npix];
+		src32f[i] = new float[npix];
+	}
+	bgr = new uchar[npix*3];
+	dst8u = new uchar[npix];
+	dst32f = new float[npix];
+	pyrbuf = new int[k_width*16];
+	cvInitMatHeader(&mat8u, k_height, k_width, CV_8UC1, src8u[0]);
+	cvInitMatHeader(&matdst8u, k_height, k_width, CV_8UC1, dst8u);
+	cvInitMatHeader(&mat32f, k_height, k_width, CV_32FC1, src32f[0]);
+	cvInitMatHeader(&matdst32f, k_height, k_width, CV_32FC1, dst32f);
+	rect15 = cvCreateStructuringElementEx(15, 15, 7, 7, CV_SHAPE_RECT);
+	rect5 = cvCreateStructuringElementEx(5, 5, 2, 2, CV_SHAPE_RECT);
+	cvInitMatHeader(&stereoleft, k_height, k_width-8, CV_8UC1, src8u[0], k_width);
+	cvInitMatHeader(&stereoright, k_height, k_width-8, CV_8UC1, src8u[0]+8, k_width);
+	cvInitMatHeader(&stereodisp, k_height, k_width-8, CV_32FC1, dst32f);
+	stereostate = cvCreateStereoBMState(32, 9);
+	for (int i=0; i<k_lkgrid*k_lkgrid; i++)
+		lkprev[i] = cvPoint2D32f(40 + (i % k_lkgrid)*27.5f, 30 + (i / k_lkgrid)*20.5f);
+	unsigned seed = 12345;
+	for (size_t i=0; i<npix; i++)
+	{	for (int j=0; j<2; j++)
+		{	seed = seed*1103515245 + 12345;
+			src8u[j][i] = uchar(seed >> 16);
+			src32f[j][i] = float(int(seed >> 8) & 0xffff)*0.01f - 300.0f;
+		}
+		for (int j=0; j<3; j++)
+		{	seed = seed*1103515245 + 12345;
+			bgr[i*3+j] = uchar(seed >> 16);
+		}
+	}
+	{	CvMat* smooth = cvCreateMat(k_height, k_width, CV_8UC1);			// tracking needs texture, not noise
+		CvMat prevframe, nextframe;
+		cvSmooth(&mat8u, smooth, CV_GAUSSIAN, 7, 7);
+		cvGetSubRect(smooth, &prevframe, cvRect(3, 2, k_width-8, k_height-8));
+		cvGetSubRect(smooth, &nextframe, cvRect(0, 0, k_width-8, k_height-8));
+		lkstate = cvCreatePyrLKState(cvSize(k_width-8, k_height-8), cvSize(7, 7), 3);
+		cvUpdatePyrLKState(lkstate, &prevframe);
+		cvUpdatePyrLKState(lkstate, &nextframe);
+		edgeimage = smooth;
+	}
+	{	const CvPoint trapezoid[4] = { {0, 240}, {639, 240}, {460, 470}, {180, 470} };
+		for (int y=240; y<480; y++)												// road edges converging upwards
+		{	uchar* row = edgeimage->data.ptr + edgeimage->step*y;
+			int xl = 60 + (y-240)*3/4, xr = 580 - (y-240)*3/4;
+			for (int k=-1; k<=1; k++)
+			{	row[xl+k] = 255;
+				row[xr+k] = 255;
+			}
+		}
+		edgestate = cvCreateEdgeLineState(cvSize(k_width, k_height), 16);
+		cvSetEdgeLineROI(edgestate, trapezoid, 4);
+	}
+	static const char* levels[] = { "generic", "sse2", "sse4.1", "avx2", 0 };
+	int errors = 0;
+	printf("%-16s %-8s %-8s %10s %8s\n", "primitive", "level", "ran", "usec/call", "speedup");
+	double generictime[k_tests];
+	for (int lev = 0; levels[lev]; lev++)
+	{	cvLoadPrimitives(levels[lev]);										// install this level or below
+		cvFillInternalFuncsTable(functab);									// fetch the installed primitives
+		for (int test = 0; test < k_tests; test++)
+		{	const char* ran = cvGetPrimitiveVariant(testnames[test]);
+			if (lev > 0 && strcmp(ran, levels[lev]) != 0) continue;	// nothing new at this level
+			void* out = 0;
+			memset(dst8u, 0, npix);												// parts not written must match
+			memset(dst32f, 0, npix*sizeof(float));
+			size_t outsize = runtest(test, out);							// warm up, and get output
+			if (lev == 0)																// save generic output
+			{	golden[test] = new uchar[outsize];
+				memcpy(golden[test], out, outsize);
+			} else if (memcmp(golden[test], out, outsize) != 0)
+			{	printf("ERROR: %s at level %s differs from generic output\n", testlabels[test], levels[lev]);
+				errors++;
+			}
+			double starttime = gettimenow();
+			for (int i=0; i<iterations; i++)
+				runtest(test, out);
+			double usec = (gettimenow() - starttime)*1000000.0/iterations;
+			if (lev == 0) generictime[test] = usec;
+			printf("%-16s %-8s %-8s %10.1f %7.2fx\n", testlabels[test], levels[lev], ran, usec,
+				generictime[test]/usec);
+		}
+	}
+	cvLoadPrimitives();															// back to the best available
+	const char* version;
+	int loaded;
+	const char* modules;
+	cvGetLibraryInfo(&version, &loaded, &modules);
+	printf("Default: %d primitives loaded, levels: %s\n", loaded, modules);
+	if (errors)
+	{	printf("FAILED: %d mismatches\n", errors);
+		return(1);
+	}
+	printf("OK\n");
+	return(0);
+}
@@ -356,6 +356,15 @@ void icvCheckMaskImageHeader( const IplImage* image, const char* img_name );
 CvTermCriteria icvCheckTermCriteria( CvTermCriteria criteria,
                                      double default_eps, int max_iters );
 
+/* returns the calling thread's CvSmoothState for cvSmooth, rebuilding it only
+   when the parameters, type or width change; 0 if none could be built */
+CvSmoothState* icvGetSmoothCache( int smoothtype, int param1, int param2,
+                                  int type, int width );
+
+/* nonzero if cvMatchTemplate should correlate in the frequency domain
+   (cvtemplmatchdft.cpp), by estimated cost */
+int icvMatchTemplateUseDFT( CvSize img_size, CvSize templ_size );
+
 CV_INLINE bool icvIsRectInRect( CvRect subrect, CvRect mainrect );
 CV_INLINE bool icvIsRectInRect( CvRect subrect, CvRect mainrect )
 {
@@ -0,0 +1,57 @@
+/*
+//
+//  _cvsimd.h  -- run-time selection of in-tree SIMD primitives
+//
+//  cvLoadPrimitives() resets every function pointer declared in _ipcv.h
+//  to the generic C implementation, then walks icvSimdFuncTab and
+//  replaces each primitive with the best variant the CPU can run.
+//
+//  Team Overbot
+//  October, 2026
+//
+*/
+
+#ifndef _CVSIMD_H_
+#define _CVSIMD_H_
+
+/* instruction set levels, in increasing order */
+#define  CV_CPU_NONE        0
+#define  CV_CPU_SSE2        1
+#define  CV_CPU_SSE4_1      2
+#define  CV_CPU_AVX2        4
+
+/*
+   SIMD variants are compiled with per-function target attributes, so the
+   library as a whole still runs on any x86.  Older compilers (including
+   the QNX 6.x gcc) build the generic code only.
+*/
+#if defined __GNUC__ && __GNUC__ >= 5 && (defined __i386__ || defined __x86_64__)
+    #define  CV_SIMD_DISPATCH   1
+    #define  ICV_TARGET_SSE2    __attribute__((target("sse2")))
+    #define  ICV_TARGET_SSE4_1  __attribute__((target("sse4.1")))
+    #define  ICV_TARGET_AVX2    __attribute__((target("avx2")))
+#else
+    #define  CV_SIMD_DISPATCH   0
+#endif
+
+typedef struct CvSimdFuncDesc
+{
+    const char* name;   /* primitive name as declared in _ipcv.h */
+    void* addr;         /* implementation */
+    int cpu;            /* CV_CPU_xxx level it requires */
+}
+CvSimdFuncDesc;
+
+/* terminated by a null name; for each primitive, entries are ordered
+   from the lowest to the highest instruction set level */
+extern const CvSimdFuncDesc icvSimdFuncTab[];
+
+/* returns the set of CV_CPU_xxx levels this processor and OS support */
+int icvGetCpuFeatures( void );
+
+/* returns the name of a CV_CPU_xxx level ("generic" for CV_CPU_NONE) */
+const char* icvGetCpuLevelName( int cpu );
+
+#endif/*_CVSIMD_H_*/
+
+/* End of file. */
@@ -554,10 +554,113 @@ ICV_PYRAMID( PyrDown_Gauss5x5, 64f, double )
 
 #undef ICV_PYRAMID
 
+/****************************************************************************************/
+/*                                 Geometrical transforms                               */
+/****************************************************************************************/
+
+IPCVAPI( CvStatus, icvResize_NN_8u_C1R, ( const uchar* src, int srcstep, CvSize srcsize,
+                                uchar* dst, int dststep, CvSize dstsize, int pix_size ))
+
+#define IPCV_RESIZE_BILINEAR( flavor, cn, arrtype )                     \
+IPCVAPI( CvStatus, icvResize_Bilinear_##flavor##_C##cn##R, (            \
+                   const arrtype* src, int srcstep, CvSize srcsize,     \
+                   arrtype* dst, int dststep, CvSize dstsize ))
+
+IPCV_RESIZE_BILINEAR( 8u, 1, uchar )
+IPCV_RESIZE_BILINEAR( 8u, 2, uchar )
+IPCV_RESIZE_BILINEAR( 8u, 3, uchar )
+IPCV_RESIZE_BILINEAR( 8u, 4, uchar )
+
+#undef IPCV_RESIZE_BILINEAR
+
+
+/****************************************************************************************/
+/*                                   Color conversion                                   */
+/****************************************************************************************/
+
+IPCVAPI( CvStatus, icvCvt_BGR2GRAY_8u_C3C1R, ( const uchar* src, int srcstep,
+                                               uchar* dst, int dststep, CvSize size ))
+
+/****************************************************************************************/
+/*                                 Separable smoothing                                  */
+/****************************************************************************************/
+
+/* dst[i] = sum_k kernel[k]*src[i + k*cn],  i = 0..len-1 */
+IPCVAPI( CvStatus, icvFilterRow_32f_CnR, ( const float* src, float* dst, int len,
+                                           int cn, const float* kernel, int ksize ))
+
+/* dst[i] = (sum_k kernel[k]*rows[k][i])*scale + delta */
+IPCVAPI( CvStatus, icvFilterCol_32f_C1R, ( const float** rows, float* dst, int len,
+                                           const float* kernel, int ksize,
+                                           float scale, float delta ))
+
+/* the same, truncated and saturated to 8u */
+IPCVAPI( CvStatus, icvFilterCol_32f8u_C1R, ( const float** rows, uchar* dst, int len,
+                                             const float* kernel, int ksize,
+                                             float scale, float delta ))
+
+/* sum[i] += add[i] - sub[i] (skipped if add is 0), then dst[i] = sum[i]*scale + delta */
+IPCVAPI( CvStatus, icvSumCol_32f_C1R, ( float* sum, const float* add, const float* sub,
+                                        float* dst, int len, float scale, float delta ))
+
+/* the same, truncated and saturated to 8u */
+IPCVAPI( CvStatus, icvSumCol_32f8u_C1R, ( float* sum, const float* add, const float* sub,
+                                          uchar* dst, int len, float scale, float delta ))
+
 /****************************************************************************************/
 /*                              Morphological primitives                                */
 /****************************************************************************************/
 
+/* rectangular elements (van Herk/Gil-Werman, cvmorph.cpp):
+   Row: dst[i] = min/max over k < ksize of src[i + k*cn],  i = 0..len-1
+   Vec: dst[i] = min/max( src1[i], src2[i] ) */
+#define IPCV_MORPH_RUN( name, flavor, arrtype )                                 \
+IPCVAPI( CvStatus, icv##name##Row_##flavor##_CnR, ( const arrtype* src,         \
+                   arrtype* dst, int len, int cn, int ksize ))                  \
+IPCVAPI( CvStatus, icv##name##Vec_##flavor, ( const arrtype* src1,              \
+                   const arrtype* src2, arrtype* dst, int len ))
+
+IPCV_MORPH_RUN( Min, 8u, uchar )
+IPCV_MORPH_RUN( Max, 8u, uchar )
+IPCV_MORPH_RUN( Min, 32f, float )
+IPCV_MORPH_RUN( Max, 32f, float )
+
+#undef IPCV_MORPH_RUN
+
+/****************************************************************************************/
+/*                                 Block matching stereo                                */
+/****************************************************************************************/
+
+/* sum[i] += |addl[i] - addr[i]| - |subl[i] - subr[i]|,  i = 0..len-1, modulo 2^16
+   (cvstereobm.cpp; passing subl == subr just adds a row) */
+IPCVAPI( CvStatus, icvUpdateSADCol_8u16u_C1R, ( const uchar* addl, const uchar* addr,
+                                                const uchar* subl, const uchar* subr,
+                                                ushort* sum, int len ))
+
+/****************************************************************************************/
+/*                               Lucas-Kanade feature tracking                          */
+/****************************************************************************************/
+
+/* b[0] = sum((I[i] - J[i])*Ix[i]), b[1] = sum((I[i] - J[i])*Iy[i]),  i = 0..len-1
+   (cvlkpyramid.cpp).  The sums are kept in 8 interleaved float partial sums,
+   element i going to partial sum i%8, and the partial sums are added as
+   ((s0+s4)+(s2+s6))+((s1+s5)+(s3+s7)), so vector versions can match exactly */
+IPCVAPI( CvStatus, icvLKMismatch_32f_C1R, ( const float* I, const float* J,
+                                            const float* Ix, const float* Iy,
+                                            int len, float* b ))
+
+/****************************************************************************************/
+/*                                  Edge lines (Canny)                                  */
+/****************************************************************************************/
+
+/* 3x3 Sobel of one row: src0, src1, src2 are the rows above, at and below it,
+   and src*[-1] .. src*[len] are read (cvedgelines.cpp).
+   dx[i] = s0[i+1]-s0[i-1] + 2*(s1[i+1]-s1[i-1]) + s2[i+1]-s2[i-1],
+   dy[i] = s2[i-1]+2*s2[i]+s2[i+1] - (s0[i-1]+2*s0[i]+s0[i+1]) */
+IPCVAPI( CvStatus, icvSobel3x3Row_8u16s_C1R, ( const uchar* src0, const uchar* src1,
+                                               const uchar* src2, short* dx, short* dy,
+                                               int len ))
+
 /****************************************************************************************/
 /*                                  Erosion primitives                                  */
 /****************************************************************************************/
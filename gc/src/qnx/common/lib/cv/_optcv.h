@@ -398,24 +398,6 @@ IPCVAPI( CvStatus, icvPyrDownBorder_64f_CnR, ( const double *src, int src_step,
                                                double *dst, int dst_step, CvSize dst_size,
                                                int channels ))
 
-/****************************************************************************************/
-/*                                 Geometrical transforms                               */
-/****************************************************************************************/
-
-IPCVAPI( CvStatus, icvResize_NN_8u_C1R, ( const uchar* src, int srcstep, CvSize srcsize,
-                                uchar* dst, int dststep, CvSize dstsize, int pix_size ))
-
-#define IPCV_RESIZE_BILINEAR( flavor, cn, arrtype )                     \
-IPCVAPI( CvStatus, icvResize_Bilinear_##flavor##_C##cn##R, (            \
-                   const arrtype* src, int srcstep, CvSize srcsize,     \
-                   arrtype* dst, int dststep, CvSize dstsize ))
-
-IPCV_RESIZE_BILINEAR( 8u, 1, uchar )
-IPCV_RESIZE_BILINEAR( 8u, 2, uchar )
-IPCV_RESIZE_BILINEAR( 8u, 3, uchar )
-IPCV_RESIZE_BILINEAR( 8u, 4, uchar )
-
-
 /****************************************************************************************/
 /*                                 Copy/Set with mask                                   */
 /****************************************************************************************/
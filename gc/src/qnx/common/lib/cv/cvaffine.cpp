@@ -318,7 +318,7 @@ icvResize_Bilinear_##flavor##_C##cn##R, ( const uchar* src, int srcstep, CvSize
                                     descale_macro, cast_macro, shift_val );             \
         }                                                                               \
                                                                                         \
-        if( xmax < dw )                                                                 \
+        if( xmax <= dw )                                                                \
             process_bilinear_vert_c##cn( worktype, arrtype, scale_macro,                \
                                      descale_macro, cast_macro, shift_val);             \
     }                                                                                   \
@@ -610,7 +610,20 @@ ICV_COLORCVT_FUNC( BGRA2BGR, 8u_C4C3R, uchar, 4, 3 )
 ICV_COLORCVT_FUNC( BGR2RGBA, 8u_C3C4R, uchar, 3, 4 )
 ICV_COLORCVT_FUNC( BGRA2RGBA, 8u_C4C4R, uchar, 4, 4 )
 ICV_COLORCVT_FUNC( RGBA2BGR, 8u_C4C3R, uchar, 4, 3 )
-ICV_COLORCVT_FUNC( BGR2GRAY, 8u_C3C1R, uchar, 3, 1 )
+/* BGR->Gray is the camera's hot path, so it is a dispatched primitive (see cvswitcher.cpp) */
+IPCVAPI_IMPL( CvStatus, icvCvt_BGR2GRAY_8u_C3C1R, ( const uchar* src, int srcstep,
+                                                    uchar* dst, int dststep, CvSize size ))
+{
+    for( ; size.height--; src += srcstep, dst += dststep )
+    {
+        int i;
+        for( i = 0; i < size.width; i++ )
+            ICV_CVT_BGR2GRAY( src + i*3, dst + i );
+    }
+
+    return CV_OK;
+}
+
 ICV_COLORCVT_FUNC( RGB2GRAY, 8u_C3C1R, uchar, 3, 1 )
 ICV_COLORCVT_FUNC( BGRA2GRAY, 8u_C4C1R, uchar, 4, 1 )
 ICV_COLORCVT_FUNC( RGBA2GRAY, 8u_C4C1R, uchar, 4, 1 )
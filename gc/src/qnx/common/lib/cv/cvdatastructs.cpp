@@ -93,6 +93,275 @@ icvInitChildMemStorage( CvMemStorage* parent, CvMemStorage* storage )
 }
 
 
+/****************************************************************************************\
+*                           Per-thread storage block and header cache                    *
+\****************************************************************************************/
+
+/* Blocks of root storages, and storage headers, are kept by each thread for reuse,
+   under a pthread key of their own, instead of being returned to the heap. Functions
+   that create and release a temporary storage on each call then allocate nothing in
+   steady state. Where there are no pthreads nothing is cached */
+
+#ifndef WIN32
+#include <pthread.h>
+#define ICV_MEM_CACHE_THREADS  1
+#else
+#define ICV_MEM_CACHE_THREADS  0
+#endif
+
+#define ICV_MEM_CACHE_SIZES    4   /* block sizes cached at once */
+#define ICV_MEM_CACHE_BLOCKS   16  /* most blocks cached, of all sizes */
+#define ICV_MEM_CACHE_HEADERS  16  /* most storage headers cached */
+
+typedef struct CvMemCache
+{
+    int             block_size[ICV_MEM_CACHE_SIZES];
+    CvMemBlock*     blocks[ICV_MEM_CACHE_SIZES]; /* free blocks of each size, linked by next */
+    int             block_count;
+    CvMemStorage*   headers;                     /* free headers, linked by parent */
+    int             header_count;
+    CvMemStorageStats stats;
+}
+CvMemCache;
+
+
+/* frees everything in a cache, leaving it empty */
+static void
+icvReleaseMemCache( CvMemCache* cache )
+{
+    int i;
+
+    for( i = 0; i < ICV_MEM_CACHE_SIZES; i++ )
+    {
+        while( cache->blocks[i] )
+        {
+            CvMemBlock* block = cache->blocks[i];
+            cache->blocks[i] = block->next;
+            icvFree( &block );
+        }
+        cache->block_size[i] = 0;
+    }
+    cache->block_count = 0;
+
+    while( cache->headers )
+    {
+        CvMemStorage* storage = cache->headers;
+        cache->headers = storage->parent;
+        icvFree( &storage );
+    }
+    cache->header_count = 0;
+}
+
+
+#if ICV_MEM_CACHE_THREADS
+
+static pthread_key_t icvMemCacheKey;
+static pthread_once_t icvMemCacheOnce = PTHREAD_ONCE_INIT;
+
+static void
+icvMemCacheDestructor( void* ptr )
+{
+    icvReleaseMemCache( (CvMemCache*)ptr );
+    free( ptr );
+}
+
+static void
+icvMemCacheInit( void )
+{
+    pthread_key_create( &icvMemCacheKey, icvMemCacheDestructor );
+}
+
+/* the calling thread's cache, created on first use; 0 if it can't be */
+static CvMemCache*
+icvGetMemCache( void )
+{
+    CvMemCache* cache;
+
+    pthread_once( &icvMemCacheOnce, icvMemCacheInit );
+    cache = (CvMemCache*)pthread_getspecific( icvMemCacheKey );
+
+    if( !cache )
+    {
+        cache = (CvMemCache*)calloc( 1, sizeof(*cache) );
+        if( cache && pthread_setspecific( icvMemCacheKey, cache ) != 0 )
+        {
+            free( cache );
+            cache = 0;
+        }
+    }
+
+    return cache;
+}
+
+#else
+
+static CvMemCache*
+icvGetMemCache( void )
+{
+    return 0;
+}
+
+#endif
+
+/* takes a block for a root storage from the thread's cache, or from the heap */
+static CvMemBlock*
+icvAllocMemBlock( int block_size )
+{
+    CvMemBlock* block = 0;
+
+    CV_FUNCNAME( "icvAllocMemBlock" );
+
+    __BEGIN__;
+
+    CvMemCache* cache = icvGetMemCache();
+    int i;
+
+    for( i = 0; cache && i < ICV_MEM_CACHE_SIZES; i++ )
+    {
+        if( cache->block_size[i] == block_size && cache->blocks[i] )
+        {
+            block = cache->blocks[i];
+            cache->blocks[i] = block->next;
+            cache->block_count--;
+            cache->stats.cached_blocks++;
+            EXIT;
+        }
+    }
+
+    CV_CALL( block = (CvMemBlock*)cvAlloc( block_size ));
+    if( cache )
+        cache->stats.heap_blocks++;
+
+    __END__;
+
+    return block;
+}
+
+
+/* gives a block of a root storage to the thread's cache, or back to the heap
+   if the cache is full or already holds blocks of other sizes */
+static void
+icvFreeMemBlock( CvMemBlock* block, int block_size )
+{
+    CvMemCache* cache = icvGetMemCache();
+    int i, empty = -1;
+
+    if( cache && cache->block_count < ICV_MEM_CACHE_BLOCKS )
+    {
+        for( i = 0; i < ICV_MEM_CACHE_SIZES; i++ )
+        {
+            if( cache->block_size[i] == block_size )
+                break;
+            if( !cache->blocks[i] && empty < 0 )
+                empty = i;
+        }
+
+        if( i == ICV_MEM_CACHE_SIZES )
+            i = empty;
+
+        if( i >= 0 )
+        {
+            cache->block_size[i] = block_size;
+            block->next = cache->blocks[i];
+            cache->blocks[i] = block;
+            cache->block_count++;
+            return;
+        }
+    }
+
+    cvFree( (void**)&block );
+    if( cache )
+        cache->stats.freed_blocks++;
+}
+
+
+/* takes a storage header from the thread's cache, or from the heap */
+static CvMemStorage*
+icvAllocMemStorageHeader( void )
+{
+    CvMemStorage* storage = 0;
+
+    CV_FUNCNAME( "icvAllocMemStorageHeader" );
+
+    __BEGIN__;
+
+    CvMemCache* cache = icvGetMemCache();
+
+    if( cache && cache->headers )
+    {
+        storage = cache->headers;
+        cache->headers = storage->parent;
+        cache->header_count--;
+        cache->stats.cached_headers++;
+        EXIT;
+    }
+
+    CV_CALL( storage = (CvMemStorage*)cvAlloc( sizeof( CvMemStorage )));
+    if( cache )
+        cache->stats.heap_headers++;
+
+    __END__;
+
+    return storage;
+}
+
+
+/* gives a storage header to the thread's cache, or back to the heap */
+static void
+icvFreeMemStorageHeader( CvMemStorage* storage )
+{
+    CvMemCache* cache = icvGetMemCache();
+
+    if( cache && cache->header_count < ICV_MEM_CACHE_HEADERS )
+    {
+        storage->signature = 0;
+        storage->parent = cache->headers;
+        cache->headers = storage;
+        cache->header_count++;
+        return;
+    }
+
+    cvFree( (void**)&storage );
+}
+
+
+CV_IMPL void
+cvGetMemStorageStats( CvMemStorageStats* stats, int reset )
+{
+    CV_FUNCNAME( "cvGetMemStorageStats" );
+
+    __BEGIN__;
+
+    CvMemCache* cache = icvGetMemCache();
+
+    if( !stats )
+        CV_ERROR( CV_StsNullPtr, "" );
+
+    if( !cache )
+    {
+        memset( stats, 0, sizeof(*stats) );
+        EXIT;
+    }
+
+    *stats = cache->stats;
+
+    if( reset )
+        memset( &cache->stats, 0, sizeof(cache->stats) );
+
+    __END__;
+}
+
+
+CV_IMPL void
+cvReleaseMemStorageCache( void )
+{
+    CvMemCache* cache = icvGetMemCache();
+
+    if( cache )
+        icvReleaseMemCache( cache );
+}
+
+
 /* creates root memory storage */
 CV_IMPL CvMemStorage*
 cvCreateMemStorage( int block_size )
@@ -103,7 +372,7 @@ cvCreateMemStorage( int block_size )
 
     __BEGIN__;
 
-    CV_CALL( storage = (CvMemStorage *)cvAlloc( sizeof( CvMemStorage )));
+    CV_CALL( storage = icvAllocMemStorageHeader());
     CV_CALL( icvInitMemStorage( storage, block_size ));
 
     __END__;
@@ -182,7 +451,7 @@ icvDestroyMemStorage( CvMemStorage* storage )
         }
         else
         {
-            cvFree( (void**)&temp );
+            icvFreeMemBlock( temp, storage->block_size );
         }
     }
 
@@ -211,7 +480,7 @@ cvReleaseMemStorage( CvMemStorage** storage )
     if( st )
     {
         CV_CALL( icvDestroyMemStorage( st ));
-        cvFree( (void**)&st );
+        icvFreeMemStorageHeader( st );
     }
 
     __END__;
@@ -261,7 +530,7 @@ icvGoNextMemBlock( CvMemStorage * storage )
 
         if( !(storage->parent) )
         {
-            CV_CALL( block = (CvMemBlock *)cvAlloc( storage->block_size ));
+            CV_CALL( block = icvAllocMemBlock( storage->block_size ));
         }
         else
         {
@@ -0,0 +1,517 @@
+/*
+//
+//  cvdistexact.cpp  -- exact Euclidean distance transform with reusable state
+//
+//  The chamfer transforms in cvdistransform.cpp approximate the Euclidean
+//  distance with 3x3 or 5x5 masks, and their error grows with the distance.
+//  This is the exact separable transform of Meijster et al., with the row
+//  pass done as the lower envelope of parabolas of Felzenszwalb and
+//  Huttenlocher.  The column pass finds, for each pixel, the distance g to
+//  the nearest zero pixel in its column, with one sweep down and one up the
+//  image; the sweeps walk along rows, so memory is read in order.  The row
+//  pass then finds, for each pixel, min over q of (x-q)^2 + g(q)^2 along its
+//  row.  Both passes are linear in the number of pixels.
+//
+//  Every column of the first pass and every row of the second is
+//  independent, so with more than one thread the columns, then the rows, are
+//  split into bands handled in parallel by worker threads owned by the state.
+//
+//  When only a rectangle of the output is wanted, only the source within
+//  max_dist of the rectangle can matter, so only that much is read.  With a
+//  ring origin the same code works on wraparound buffers, such as the maps
+//  in nav/map, whose rows and columns start at an arbitrary position.
+//
+//  Team Overbot
+//  October, 2026
+//
+*/
+
+#include "_cv.h"
+#include <float.h>
+
+#ifndef WIN32
+#include <pthread.h>
+#define ICV_DIST_THREADS  1
+#else
+#define ICV_DIST_THREADS  0
+#endif
+
+#define ICV_DIST_MAX_THREADS  16
+
+/* column distance of pixels with no zero pixel above or below within reach;
+   well above any image height, and room to count up from without overflow */
+#define ICV_DIST_INF  (1 << 28)
+
+typedef struct CvDistBand
+{
+    int* v;             /* columns of the parabolas of the lower envelope */
+    float* h;           /* their squared column distances plus squared columns */
+    float* z;           /* where each parabola starts being the lowest */
+}
+CvDistBand;
+
+struct CvDistTransformState;
+
+typedef struct CvDistWorker
+{
+    struct CvDistTransformState* state;
+    int idx;
+}
+CvDistWorker;
+
+struct CvDistTransformState
+{
+    CvSize max_size;
+    float max_dist;     /* 0 if unlimited */
+    int nbands;         /* bands (= threads, including the caller) */
+    CvDistBand band[ICV_DIST_MAX_THREADS];
+    int* g;             /* column distances of the rows read */
+    void* buffer;
+
+    /* current job */
+    const uchar* src;
+    int srcstep;
+    uchar* dst;
+    int dststep;
+    CvSize size;
+    CvPoint origin;     /* ring origin, reduced to the image */
+    CvRect rect;        /* output rectangle */
+    int x0, x1;         /* columns read */
+    int y0, y1;         /* rows read */
+    int margin;         /* column distances beyond this can't be within max_dist */
+    int phase;          /* 0 for the column pass, 1 for the row pass */
+
+#if ICV_DIST_THREADS
+    int nworkers;       /* worker threads running (nbands - 1) */
+    CvDistWorker worker[ICV_DIST_MAX_THREADS];
+    pthread_t thread[ICV_DIST_MAX_THREADS];
+    pthread_mutex_t lock;
+    pthread_cond_t start_cond;
+    pthread_cond_t done_cond;
+    int generation;     /* incremented for each pass */
+    int pending;        /* workers that have not finished the pass */
+    int quit;
+#endif
+};
+
+
+/* column pass over columns x0..x1-1 of the current job */
+static void
+icvDistColumns( CvDistTransformState* state, int x0, int x1 )
+{
+    int width = state->size.width, height = state->size.height;
+    int gstep = state->x1 - state->x0;
+    int* g0 = state->g - state->x0;
+    int p0 = (x0 + state->origin.x) % width;
+    int len0 = MIN( x1 - x0, width - p0 );      /* columns before the ring wraps */
+    int x, y;
+
+    if( x0 >= x1 )
+        return;
+
+    /* down: distance to the nearest zero pixel above */
+    for( y = state->y0; y < state->y1; y++ )
+    {
+        const uchar* src = state->src + ((y + state->origin.y) % height)*state->srcstep;
+        int* g = g0 + (y - state->y0)*gstep;
+        const int* above = g - gstep;
+        int piece;
+
+        for( piece = 0; piece < 2; piece++ )
+        {
+            const uchar* s = piece == 0 ? src + p0 - x0 : src - x0 - len0;
+            int xa = piece == 0 ? x0 : x0 + len0;
+            int xb = piece == 0 ? x0 + len0 : x1;
+
+            if( y == state->y0 )
+                for( x = xa; x < xb; x++ )
+                    g[x] = s[x] == 0 ? 0 : ICV_DIST_INF;
+            else
+                for( x = xa; x < xb; x++ )
+                    g[x] = s[x] == 0 ? 0 : above[x] + 1;
+        }
+    }
+
+    /* up: or below */
+    for( y = state->y1 - 2; y >= state->y0; y-- )
+    {
+        int* g = g0 + (y - state->y0)*gstep;
+        const int* below = g + gstep;
+
+        for( x = x0; x < x1; x++ )
+        {
+            int t = below[x] + 1;
+            g[x] = g[x] < t ? g[x] : t;
+        }
+    }
+}
+
+
+/* row pass over rows y0..y1-1 of rect */
+static void
+icvDistRows( CvDistTransformState* state, CvDistBand* band, int y0, int y1 )
+{
+    int width = state->size.width, height = state->size.height;
+    int n = state->x1 - state->x0;
+    int xa = state->rect.x - state->x0, xb = xa + state->rect.width;
+    int margin = state->margin;
+    float none = state->max_dist > 0 ? state->max_dist : FLT_MAX;
+    int* v = band->v;
+    float* h = band->h;
+    float* z = band->z;
+    int y, q;
+
+    for( y = y0; y < y1; y++ )
+    {
+        const int* g = state->g + (y - state->y0)*n;
+        float* dst = (float*)(state->dst + ((y + state->origin.y) % height)*state->dststep);
+        int px = (state->rect.x + state->origin.x) % width;
+        int k = -1, j = 0;
+
+        /* lower envelope of the parabolas (x-q)^2 + g(q)^2; h is g(q)^2 + q^2 */
+        for( q = 0; q < n; q++ )
+        {
+            float fq = (float)q, hq, s = -FLT_MAX;
+
+            if( g[q] > margin )
+                continue;
+
+            hq = (float)g[q]*g[q] + fq*fq;
+
+            while( k >= 0 )
+            {
+                s = (hq - h[k])/(2.f*(fq - v[k]));
+                if( s > z[k] )
+                    break;
+                k--;
+            }
+
+            if( k < 0 )
+                s = -FLT_MAX;
+
+            k++;
+            v[k] = q;
+            h[k] = hq;
+            z[k] = s;
+        }
+
+        if( k < 0 )
+        {
+            /* no zero pixel within reach of this row */
+            for( q = xa; q < xb; q++ )
+            {
+                dst[px] = none;
+                if( ++px == width )
+                    px = 0;
+            }
+            continue;
+        }
+
+        z[k+1] = FLT_MAX;
+
+        for( q = xa; q < xb; q++ )
+        {
+            int p, dq;
+            float d;
+
+            while( z[j+1] < q )
+                j++;
+
+            /* in integers, so exact however far from the origin */
+            p = v[j];
+            dq = q - p;
+            d = sqrtf( (float)(dq*dq + g[p]*g[p]) );
+            dst[px] = d > none ? none : d;
+            if( ++px == width )
+                px = 0;
+        }
+    }
+}
+
+
+/* runs band idx of the current pass split into nbands bands */
+static void
+icvDistRunBand( CvDistTransformState* state, int idx, int nbands )
+{
+    if( state->phase == 0 )
+    {
+        int n = state->x1 - state->x0;
+        icvDistColumns( state, state->x0 + n*idx/nbands, state->x0 + n*(idx + 1)/nbands );
+    }
+    else
+    {
+        int n = state->rect.height;
+        int y0 = state->rect.y + n*idx/nbands, y1 = state->rect.y + n*(idx + 1)/nbands;
+
+        if( y0 < y1 )
+            icvDistRows( state, state->band + idx, y0, y1 );
+    }
+}
+
+
+#if ICV_DIST_THREADS
+
+static void*
+icvDistWorkerProc( void* arg )
+{
+    CvDistWorker* worker = (CvDistWorker*)arg;
+    CvDistTransformState* state = worker->state;
+    int seen = 0;
+
+    for( ;; )
+    {
+        int quit;
+
+        pthread_mutex_lock( &state->lock );
+        while( state->generation == seen && !state->quit )
+            pthread_cond_wait( &state->start_cond, &state->lock );
+        seen = state->generation;
+        quit = state->quit;
+        pthread_mutex_unlock( &state->lock );
+
+        if( quit )
+            break;
+
+        icvDistRunBand( state, worker->idx, state->nbands );
+
+        pthread_mutex_lock( &state->lock );
+        if( --state->pending == 0 )
+            pthread_cond_signal( &state->done_cond );
+        pthread_mutex_unlock( &state->lock );
+    }
+
+    return 0;
+}
+
+#endif
+
+
+/* runs one pass of the current job, in parallel if there are workers */
+static void
+icvDistRunPass( CvDistTransformState* state, int phase )
+{
+    state->phase = phase;
+
+#if ICV_DIST_THREADS
+    if( state->nworkers > 0 )
+    {
+        pthread_mutex_lock( &state->lock );
+        state->pending = state->nworkers;
+        state->generation++;
+        pthread_cond_broadcast( &state->start_cond );
+        pthread_mutex_unlock( &state->lock );
+
+        icvDistRunBand( state, 0, state->nbands );
+
+        pthread_mutex_lock( &state->lock );
+        while( state->pending > 0 )
+            pthread_cond_wait( &state->done_cond, &state->lock );
+        pthread_mutex_unlock( &state->lock );
+        return;
+    }
+#endif
+
+    icvDistRunBand( state, 0, 1 );
+}
+
+
+static void
+icvFreeDistTransformState( CvDistTransformState* state )
+{
+    if( !state )
+        return;
+
+#if ICV_DIST_THREADS
+    if( state->nworkers > 0 )
+    {
+        int i;
+
+        pthread_mutex_lock( &state->lock );
+        state->quit = 1;
+        pthread_cond_broadcast( &state->start_cond );
+        pthread_mutex_unlock( &state->lock );
+
+        for( i = 0; i < state->nworkers; i++ )
+            pthread_join( state->thread[i], 0 );
+    }
+
+    pthread_cond_destroy( &state->done_cond );
+    pthread_cond_destroy( &state->start_cond );
+    pthread_mutex_destroy( &state->lock );
+#endif
+
+    cvFree( &state->buffer );
+    cvFree( (void**)&state );
+}
+
+
+CV_IMPL CvDistTransformState*
+cvCreateDistTransformState( CvSize max_size, float max_dist, int threads )
+{
+    CvDistTransformState* state = 0;
+
+    CV_FUNCNAME( "cvCreateDistTransformState" );
+
+    __BEGIN__;
+
+    int w = max_size.width, bufsize, bandsize, i;
+    char* ptr;
+
+    if( max_size.width <= 0 || max_size.height <= 0 )
+        CV_ERROR( CV_StsOutOfRange, "Maximal image size should be positive" );
+
+    if( max_dist < 0 )
+        CV_ERROR( CV_StsOutOfRange, "Maximal distance should be non-negative" );
+
+#if ICV_DIST_THREADS
+    threads = MIN( MAX( threads, 1 ), ICV_DIST_MAX_THREADS );
+#else
+    threads = 1;
+#endif
+
+    /* column distances, then for each band the envelope */
+    bandsize = icvAlign( w*sizeof(int), 32 ) + icvAlign( w*sizeof(float), 32 ) +
+               icvAlign( (w + 1)*sizeof(float), 32 );
+    bufsize = icvAlign( w*max_size.height*sizeof(int), 32 ) + bandsize*threads + 32;
+
+    CV_CALL( state = (CvDistTransformState*)cvAlloc( sizeof(*state) ));
+    memset( state, 0, sizeof(*state) );
+
+#if ICV_DIST_THREADS
+    pthread_mutex_init( &state->lock, 0 );
+    pthread_cond_init( &state->start_cond, 0 );
+    pthread_cond_init( &state->done_cond, 0 );
+#endif
+
+    CV_CALL( state->buffer = cvAlloc( bufsize ));
+
+    state->max_size = max_size;
+    state->max_dist = max_dist;
+
+    ptr = (char*)icvAlignPtr( state->buffer, 32 );
+    state->g = (int*)ptr;
+    ptr += icvAlign( w*max_size.height*sizeof(int), 32 );
+
+    for( i = 0; i < threads; i++ )
+    {
+        CvDistBand* band = state->band + i;
+
+        band->v = (int*)ptr;
+        ptr += icvAlign( w*sizeof(int), 32 );
+        band->h = (float*)ptr;
+        ptr += icvAlign( w*sizeof(float), 32 );
+        band->z = (float*)ptr;
+        ptr += icvAlign( (w + 1)*sizeof(float), 32 );
+    }
+
+    state->nbands = 1;
+
+#if ICV_DIST_THREADS
+    for( i = 1; i < threads; i++ )
+    {
+        state->worker[i].state = state;
+        state->worker[i].idx = i;
+        if( pthread_create( &state->thread[i-1], 0, icvDistWorkerProc,
+                            state->worker + i ) != 0 )
+            break;
+        state->nworkers++;
+        state->nbands++;
+    }
+#endif
+
+    __END__;
+
+    if( cvGetErrStatus() < 0 )
+    {
+        icvFreeDistTransformState( state );
+        state = 0;
+    }
+
+    return state;
+}
+
+
+CV_IMPL void
+cvReleaseDistTransformState( CvDistTransformState** state )
+{
+    CV_FUNCNAME( "cvReleaseDistTransformState" );
+
+    __BEGIN__;
+
+    if( !state )
+        CV_ERROR( CV_StsNullPtr, "" );
+
+    icvFreeDistTransformState( *state );
+    *state = 0;
+
+    __END__;
+}
+
+
+CV_IMPL void
+cvDistTransformWithState( const void* srcarr, void* dstarr,
+                          CvDistTransformState* state,
+                          CvRect rect, CvPoint origin )
+{
+    CV_FUNCNAME( "cvDistTransformWithState" );
+
+    __BEGIN__;
+
+    CvMat srcstub, *src = (CvMat*)srcarr;
+    CvMat dststub, *dst = (CvMat*)dstarr;
+    CvSize size;
+    int margin;
+
+    if( !state )
+        CV_ERROR( CV_StsNullPtr, "" );
+
+    CV_CALL( src = cvGetMat( src, &srcstub ));
+    CV_CALL( dst = cvGetMat( dst, &dststub ));
+
+    if( !CV_IS_MASK_ARR( src ) || CV_MAT_TYPE( dst->type ) != CV_32FC1 )
+        CV_ERROR( CV_StsUnsupportedFormat, "" );
+
+    if( !CV_ARE_SIZES_EQ( src, dst ))
+        CV_ERROR( CV_StsUnmatchedSizes, "" );
+
+    size = icvGetMatSize( src );
+
+    if( size.width > state->max_size.width || size.height > state->max_size.height )
+        CV_ERROR( CV_StsOutOfRange, "The image is larger than the state was created for" );
+
+    /* clip the rectangle to the image; empty means all of it */
+    if( rect.width <= 0 || rect.height <= 0 )
+        rect = cvRect( 0, 0, size.width, size.height );
+    rect.width += rect.x;
+    rect.height += rect.y;
+    rect.x = MAX( rect.x, 0 );
+    rect.y = MAX( rect.y, 0 );
+    rect.width = MIN( rect.width, size.width ) - rect.x;
+    rect.height = MIN( rect.height, size.height ) - rect.y;
+
+    if( rect.width <= 0 || rect.height <= 0 )
+        EXIT;
+
+    margin = state->max_dist > 0 ? cvCeil( state->max_dist ) : MAX( size.width, size.height );
+
+    state->src = src->data.ptr;
+    state->srcstep = src->step;
+    state->dst = dst->data.ptr;
+    state->dststep = dst->step;
+    state->size = size;
+    state->origin.x = (origin.x % size.width + size.width) % size.width;
+    state->origin.y = (origin.y % size.height + size.height) % size.height;
+    state->rect = rect;
+    state->margin = margin;
+    state->x0 = MAX( rect.x - margin, 0 );
+    state->x1 = MIN( rect.x + rect.width + margin, size.width );
+    state->y0 = MAX( rect.y - margin, 0 );
+    state->y1 = MIN( rect.y + rect.height + margin, size.height );
+
+    icvDistRunPass( state, 0 );
+    icvDistRunPass( state, 1 );
+
+    __END__;
+}
+
+/* End of file. */
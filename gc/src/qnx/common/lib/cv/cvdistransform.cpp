@@ -970,6 +970,8 @@ cvDistTransform( const void* srcarr, void* dstarr,
                  CvDisType distType, int maskSize,
                  const float *mask )
 {
+    CvDistTransformState* state = 0;
+
     CV_FUNCNAME( "cvDistTransform" );
 
     __BEGIN__;
@@ -987,6 +989,17 @@ cvDistTransform( const void* srcarr, void* dstarr,
     if( !CV_ARE_SIZES_EQ( src, dst ))
         CV_ERROR( CV_StsUnmatchedSizes, "" );
 
+    if( maskSize == CV_DIST_MASK_PRECISE )
+    {
+        if( distType != CV_DIST_L2 )
+            CV_ERROR( CV_StsBadArg, "Only CV_DIST_L2 is computed exactly" );
+
+        CV_CALL( state = cvCreateDistTransformState( icvGetMatSize(src) ));
+        CV_CALL( cvDistTransformWithState( src, dst, state,
+                                           cvRect( 0, 0, 0, 0 ), cvPoint( 0, 0 )));
+        EXIT;
+    }
+
     if( maskSize != CV_DIST_MASK_3 && maskSize != CV_DIST_MASK_5 )
         CV_ERROR( CV_StsBadSize, "" );
 
@@ -1023,5 +1036,8 @@ cvDistTransform( const void* srcarr, void* dstarr,
     }
 
     __END__;
+
+    if( state )
+        cvReleaseDistTransformState( &state );
 }
 
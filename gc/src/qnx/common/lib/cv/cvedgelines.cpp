@@ -0,0 +1,679 @@
+/*
+//
+//  cvedgelines.cpp  -- Canny edges and tracked Hough lines in a region of interest
+//
+//  cvCanny and cvHoughLines2 work on the whole image, and allocate their
+//  buffers, and a CvSeq for the result, on every call.  A road follower wants
+//  the straight edges inside the road trapezoid on every frame, and they are
+//  mostly the same edges as on the last frame.  So here:
+//      - the state holds every buffer, allocated once for the frame size;
+//      - the gradient is found only inside the region of interest, a row at a
+//        time (icvSobel3x3Row_8u16s_C1R, which has SSE2 and AVX2 versions),
+//        and is set to zero outside it, so that icvCanny_16s8u_C1R on the
+//        bounding box finds no edges outside the region;
+//      - each line of the last frame is looked for first, along the lines a
+//        few pixels and degrees either side of it, and the edge pixels of the
+//        best of those are taken out;
+//      - the edge pixels left over go to the probabilistic Hough transform
+//        (Matas, Galambos and Kittler), which finds the new lines.  Its
+//        accumulator is cleared, not reallocated, for each frame.
+//
+//  Team Overbot
+//  October, 2026
+//
+*/
+
+#include "_cv.h"
+
+#define ICV_EDGE_THETA_COUNT    180         /* accumulator has one degree steps */
+#define ICV_EDGE_WALK_SHIFT     16          /* fixed point fraction when walking a line */
+#define ICV_EDGE_VOTED          128         /* an edge pixel that has voted; Canny marks 255 */
+
+
+IPCVAPI_IMPL( CvStatus, icvSobel3x3Row_8u16s_C1R, ( const uchar* src0, const uchar* src1,
+                                                    const uchar* src2, short* dx, short* dy,
+                                                    int len ))
+{
+    int i;
+
+    for( i = 0; i < len; i++ )
+    {
+        dx[i] = (short)(src0[i+1] - src0[i-1] + 2*(src1[i+1] - src1[i-1]) +
+                        src2[i+1] - src2[i-1]);
+        dy[i] = (short)(src2[i-1] + 2*src2[i] + src2[i+1] -
+                        (src0[i-1] + 2*src0[i] + src0[i+1]));
+    }
+
+    return CV_OK;
+}
+
+
+/* gradient inside the region of interest, zero elsewhere in its bounding box;
+   rows beyond the top and bottom of the image are replicated, and the
+   region never includes the first and last columns */
+static void
+icvEdgeLineGradient( CvEdgeLineState* state, const CvMat* img )
+{
+    const CvRect r = state->roiRect;
+    const int* span = state->roiSpan->data.i;
+    const int height = img->rows;
+    int y;
+
+    for( y = r.y; y < r.y + r.height; y++ )
+    {
+        const uchar* s0 = img->data.ptr + img->step*MAX( y - 1, 0 );
+        const uchar* s1 = img->data.ptr + img->step*y;
+        const uchar* s2 = img->data.ptr + img->step*MIN( y + 1, height - 1 );
+        short* dx = (short*)(state->dx->data.ptr + state->dx->step*y);
+        short* dy = (short*)(state->dy->data.ptr + state->dy->step*y);
+        int x0 = span[y*2], x1 = span[y*2+1];
+
+        if( x0 >= x1 )
+            x0 = x1 = r.x;
+
+        memset( dx + r.x, 0, (x0 - r.x)*sizeof(dx[0]) );
+        memset( dy + r.x, 0, (x0 - r.x)*sizeof(dy[0]) );
+        if( x0 < x1 )
+            icvSobel3x3Row_8u16s_C1R( s0 + x0, s1 + x0, s2 + x0, dx + x0, dy + x0, x1 - x0 );
+        memset( dx + x1, 0, (r.x + r.width - x1)*sizeof(dx[0]) );
+        memset( dy + x1, 0, (r.x + r.width - x1)*sizeof(dy[0]) );
+    }
+}
+
+
+/* Walks along x*cos + y*sin = rho, for the given degree, across the region of
+   interest, one pixel at a time along whichever axis the line is closer to.
+   Returns the number of edge pixels in the longest run with no gap longer
+   than maxLineGap, and the first and last edge pixels of that run. */
+static int
+icvFollowEdgeLine( const CvEdgeLineState* state, float rho, int t,
+                   CvPoint* pt1, CvPoint* pt2 )
+{
+    const CvRect r = state->roiRect;
+    const uchar* mask = state->edges->data.ptr;
+    const int mstep = state->edges->step;
+    const float c = state->trigTab->data.fl[t*2], s = state->trigTab->data.fl[t*2+1];
+    const int horizontal = fabs( s ) >= fabs( c );
+    float u0, du;
+    int i, n, vmin, vmax;
+    int best = 0, count = 0, gap = 0;
+    CvPoint start = { 0, 0 }, last = { 0, 0 };
+
+    if( horizontal )
+    {
+        n = r.width;
+        u0 = (rho - r.x*c)/s;
+        du = -c/s;
+        vmin = r.y;
+        vmax = r.y + r.height;
+    }
+    else
+    {
+        n = r.height;
+        u0 = (rho - r.y*s)/c;
+        du = -s/c;
+        vmin = r.x;
+        vmax = r.x + r.width;
+    }
+
+    for( i = 0; i < n; i++ )
+    {
+        int v = cvRound( u0 + i*du );
+        CvPoint p;
+
+        if( horizontal )
+            p.x = r.x + i, p.y = v;
+        else
+            p.x = v, p.y = r.y + i;
+
+        if( v >= vmin && v < vmax && mask[mstep*p.y + p.x] )
+        {
+            if( count == 0 )
+                start = p;
+            count++;
+            last = p;
+            gap = 0;
+        }
+        else if( count > 0 && ++gap > state->maxLineGap )
+        {
+            if( count > best )
+            {
+                best = count;
+                *pt1 = start;
+                *pt2 = last;
+            }
+            count = gap = 0;
+        }
+    }
+
+    if( count > best )
+    {
+        best = count;
+        *pt1 = start;
+        *pt2 = last;
+    }
+
+    return best;
+}
+
+
+/* takes the pixels of a tracked segment, and those either side of it, out
+   of the edges, so that the Hough transform doesn't find it again */
+static void
+icvEraseEdgeLine( CvEdgeLineState* state, float rho, int t, CvPoint pt1, CvPoint pt2 )
+{
+    const CvRect r = state->roiRect;
+    uchar* mask = state->edges->data.ptr;
+    const int mstep = state->edges->step;
+    const float c = state->trigTab->data.fl[t*2], s = state->trigTab->data.fl[t*2+1];
+    int i, i0, i1, k;
+
+    if( fabs( s ) >= fabs( c ))
+    {
+        i0 = MIN( pt1.x, pt2.x ), i1 = MAX( pt1.x, pt2.x );
+        for( i = i0; i <= i1; i++ )
+        {
+            int v = cvRound( (rho - i*c)/s );
+
+            for( k = MAX( v - 1, r.y ); k <= MIN( v + 1, r.y + r.height - 1 ); k++ )
+                mask[mstep*k + i] = 0;
+        }
+    }
+    else
+    {
+        i0 = MIN( pt1.y, pt2.y ), i1 = MAX( pt1.y, pt2.y );
+        for( i = i0; i <= i1; i++ )
+        {
+            int v = cvRound( (rho - i*s)/c );
+
+            for( k = MAX( v - 1, r.x ); k <= MIN( v + 1, r.x + r.width - 1 ); k++ )
+                mask[mstep*i + k] = 0;
+        }
+    }
+}
+
+
+/* Looks for each known line near where it was: the line with the longest
+   run of edge pixels, within trackRho pixels and trackTheta degrees, wins,
+   the nearer one on a tie.  Lines not found for more than maxMissed frames
+   are dropped. */
+static void
+icvTrackEdgeLines( CvEdgeLineState* state )
+{
+    int i, kept = 0;
+
+    for( i = 0; i < state->lineCount; i++ )
+    {
+        CvEdgeLine line = state->lines[i];
+        int t0 = cvRound( line.theta*(float)(180/CV_PI) );
+        int dt, dr, bestLen = 0, bestDist = 0, bestT = 0;
+        float bestRho = 0;
+        CvPoint best1 = { 0, 0 }, best2 = { 0, 0 };
+
+        for( dt = -state->trackTheta; dt <= state->trackTheta; dt++ )
+            for( dr = -state->trackRho; dr <= state->trackRho; dr++ )
+            {
+                int t = t0 + dt, len, dist = abs( dt ) + abs( dr );
+                float rho = line.rho + dr;
+                CvPoint p1, p2;
+
+                /* (t, rho) is the same line as (t - 180, -rho) */
+                if( t < 0 )
+                    t += ICV_EDGE_THETA_COUNT, rho = -rho;
+                else if( t >= ICV_EDGE_THETA_COUNT )
+                    t -= ICV_EDGE_THETA_COUNT, rho = -rho;
+
+                len = icvFollowEdgeLine( state, rho, t, &p1, &p2 );
+                if( len > bestLen || (len == bestLen && len > 0 && dist < bestDist) )
+                {
+                    bestLen = len;
+                    bestDist = dist;
+                    bestT = t;
+                    bestRho = rho;
+                    best1 = p1;
+                    best2 = p2;
+                }
+            }
+
+        if( bestLen >= state->minLineLength )
+        {
+            line.pt1 = cvPoint2D32f( best1.x, best1.y );
+            line.pt2 = cvPoint2D32f( best2.x, best2.y );
+            line.rho = bestRho;
+            line.theta = bestT*(float)(CV_PI/180);
+            line.length = bestLen;
+            line.age++;
+            line.missed = 0;
+            icvEraseEdgeLine( state, bestRho, bestT, best1, best2 );
+        }
+        else
+            line.missed++;
+
+        if( line.missed <= state->maxMissed )
+            state->lines[kept++] = line;
+    }
+
+    state->lineCount = kept;
+}
+
+
+/* adds a new line through two edge pixels */
+static void
+icvAddEdgeLine( CvEdgeLineState* state, CvPoint pt1, CvPoint pt2, int length )
+{
+    CvEdgeLine* line = state->lines + state->lineCount++;
+    double theta = atan2( (double)(pt2.x - pt1.x), (double)(pt1.y - pt2.y) );
+
+    if( theta < 0 )
+        theta += CV_PI;
+    if( theta >= CV_PI )
+        theta -= CV_PI;
+
+    line->pt1 = cvPoint2D32f( pt1.x, pt1.y );
+    line->pt2 = cvPoint2D32f( pt2.x, pt2.y );
+    line->theta = (float)theta;
+    line->rho = (float)((pt1.x + pt2.x)*0.5*cos( theta ) + (pt1.y + pt2.y)*0.5*sin( theta ));
+    line->id = state->nextId++;
+    line->age = 1;
+    line->missed = 0;
+    line->length = length;
+}
+
+
+/* The progressive probabilistic Hough transform, on the edge pixels left by
+   the tracking.  Pixels are taken in random order and vote; when a vote
+   brings some line to the threshold, the segment through that pixel is
+   followed both ways, and its pixels are taken out of the edges and their
+   votes out of the accumulator.  The random sequence starts the same way
+   every frame, so a frame always gives the same lines. */
+static void
+icvFindNewEdgeLines( CvEdgeLineState* state )
+{
+    const CvRect r = state->roiRect;
+    const int* span = state->roiSpan->data.i;
+    const float* trig = state->trigTab->data.fl;
+    const int rhoCount = state->rhoCount, rhoOfs = rhoCount/2;
+    const int shift = ICV_EDGE_WALK_SHIFT;
+    uchar* mask = state->edges->data.ptr;
+    const int mstep = state->edges->step;
+    int* accum = state->accum->data.i;
+    CvPoint* pts = (CvPoint*)state->points->data.ptr;
+    int count = 0, x, y, t, k;
+    CvRandState rng;
+
+    if( state->lineCount >= state->maxLines || r.width <= 0 || r.height <= 0 )
+        return;
+
+    for( y = r.y; y < r.y + r.height; y++ )
+        for( x = span[y*2]; x < span[y*2+1]; x++ )
+            if( mask[mstep*y + x] )
+                pts[count++] = cvPoint( x, y );
+
+    memset( accum, 0, ICV_EDGE_THETA_COUNT*rhoCount*sizeof(accum[0]) );
+    cvRandInit( &rng, 0, 1, -1, CV_RAND_UNI );
+
+    while( count > 0 && state->lineCount < state->maxLines )
+    {
+        int idx = cvRandNext( &rng ) % count;
+        CvPoint p = pts[idx], ends[2];
+        int maxVal = state->threshold - 1, maxT = 0;
+        int x0, y0, dx0, dy0, xflag, good, length = 0;
+        float a, b;
+
+        pts[idx] = pts[--count];
+
+        /* already taken by a line */
+        if( !mask[mstep*p.y + p.x] )
+            continue;
+
+        for( t = 0; t < ICV_EDGE_THETA_COUNT; t++ )
+        {
+            int* acc = accum + t*rhoCount + rhoOfs + cvRound( p.x*trig[t*2] + p.y*trig[t*2+1] );
+            int val = ++*acc;
+
+            if( val > maxVal )
+            {
+                maxVal = val;
+                maxT = t;
+            }
+        }
+        mask[mstep*p.y + p.x] = ICV_EDGE_VOTED;
+
+        if( maxVal < state->threshold )
+            continue;
+
+        /* step one pixel at a time along the longer axis of the line,
+           direction (-sin, cos), keeping the other coordinate in fixed point */
+        a = -trig[maxT*2+1];
+        b = trig[maxT*2];
+        x0 = p.x;
+        y0 = p.y;
+        if( fabs( a ) > fabs( b ))
+        {
+            xflag = 1;
+            dx0 = a > 0 ? 1 : -1;
+            dy0 = cvRound( b*(1 << shift)/fabs( a ));
+            y0 = (y0 << shift) + (1 << (shift - 1));
+        }
+        else
+        {
+            xflag = 0;
+            dy0 = b > 0 ? 1 : -1;
+            dx0 = cvRound( a*(1 << shift)/fabs( b ));
+            x0 = (x0 << shift) + (1 << (shift - 1));
+        }
+
+        /* find the ends of the segment */
+        for( k = 0; k < 2; k++ )
+        {
+            int gap = 0, dx = k ? -dx0 : dx0, dy = k ? -dy0 : dy0;
+
+            ends[k] = p;
+            for( x = x0, y = y0;; x += dx, y += dy )
+            {
+                int i1, j1;
+
+                if( xflag )
+                    j1 = x, i1 = y >> shift;
+                else
+                    j1 = x >> shift, i1 = y;
+
+                if( j1 < r.x || j1 >= r.x + r.width || i1 < r.y || i1 >= r.y + r.height )
+                    break;
+
+                if( mask[mstep*i1 + j1] )
+                {
+                    gap = 0;
+                    ends[k].x = j1;
+                    ends[k].y = i1;
+                }
+                else if( ++gap > state->maxLineGap )
+                    break;
+            }
+        }
+
+        good = abs( ends[1].x - ends[0].x ) >= state->minLineLength ||
+               abs( ends[1].y - ends[0].y ) >= state->minLineLength;
+
+        /* take its pixels out, and their votes if it is a line */
+        for( k = 0; k < 2; k++ )
+        {
+            int dx = k ? -dx0 : dx0, dy = k ? -dy0 : dy0;
+
+            for( x = x0, y = y0;; x += dx, y += dy )
+            {
+                uchar* m;
+                int i1, j1;
+
+                if( xflag )
+                    j1 = x, i1 = y >> shift;
+                else
+                    j1 = x >> shift, i1 = y;
+
+                m = mask + mstep*i1 + j1;
+                if( *m )
+                {
+                    if( good )
+                    {
+                        if( *m == ICV_EDGE_VOTED )
+                            for( t = 0; t < ICV_EDGE_THETA_COUNT; t++ )
+                                accum[t*rhoCount + rhoOfs +
+                                      cvRound( j1*trig[t*2] + i1*trig[t*2+1] )]--;
+                        length++;
+                    }
+                    *m = 0;
+                }
+
+                if( i1 == ends[k].y && j1 == ends[k].x )
+                    break;
+            }
+        }
+
+        if( good )
+            icvAddEdgeLine( state, ends[0], ends[1], length );
+    }
+}
+
+
+static void
+icvFreeEdgeLineState( CvEdgeLineState* state )
+{
+    if( !state )
+        return;
+
+    cvFree( (void**)&state->lines );
+    cvReleaseMat( &state->roiSpan );
+    cvReleaseMat( &state->dx );
+    cvReleaseMat( &state->dy );
+    cvReleaseMat( &state->edges );
+    cvReleaseMat( &state->cannyBuf );
+    cvReleaseMat( &state->accum );
+    cvReleaseMat( &state->trigTab );
+    cvReleaseMat( &state->points );
+    cvFree( (void**)&state );
+}
+
+
+CV_IMPL CvEdgeLineState*
+cvCreateEdgeLineState( CvSize imgSize, int maxLines )
+{
+    CvEdgeLineState* state = 0;
+
+    CV_FUNCNAME( "cvCreateEdgeLineState" );
+
+    __BEGIN__;
+
+    int bufSize, diag, t;
+
+    if( imgSize.width < 3 || imgSize.height < 3 )
+        CV_ERROR( CV_StsOutOfRange, "Image must be at least 3x3" );
+
+    if( maxLines <= 0 )
+        CV_ERROR( CV_StsOutOfRange, "maxLines must be positive" );
+
+    CV_CALL( state = (CvEdgeLineState*)cvAlloc( sizeof(*state) ));
+    memset( state, 0, sizeof(*state) );
+
+    state->cannyLow = 50;
+    state->cannyHigh = 150;
+    state->threshold = 30;
+    state->minLineLength = 30;
+    state->maxLineGap = 5;
+    state->trackRho = 4;
+    state->trackTheta = 3;
+    state->maxMissed = 3;
+    state->maxLines = maxLines;
+    state->imgSize = imgSize;
+
+    diag = cvCeil( sqrt( (double)imgSize.width*imgSize.width +
+                         (double)imgSize.height*imgSize.height ));
+    state->rhoCount = 2*diag + 1;
+
+    CV_CALL( state->lines = (CvEdgeLine*)cvAlloc( maxLines*sizeof(state->lines[0]) ));
+    CV_CALL( state->roiSpan = cvCreateMat( imgSize.height, 2, CV_32SC1 ));
+    CV_CALL( state->dx = cvCreateMat( imgSize.height, imgSize.width, CV_16SC1 ));
+    CV_CALL( state->dy = cvCreateMat( imgSize.height, imgSize.width, CV_16SC1 ));
+    CV_CALL( state->edges = cvCreateMat( imgSize.height, imgSize.width, CV_8UC1 ));
+    IPPI_CALL( icvCannyGetSize( imgSize, &bufSize ));
+    CV_CALL( state->cannyBuf = cvCreateMat( 1, bufSize, CV_8UC1 ));
+    CV_CALL( state->accum = cvCreateMat( ICV_EDGE_THETA_COUNT, state->rhoCount, CV_32SC1 ));
+    CV_CALL( state->trigTab = cvCreateMat( ICV_EDGE_THETA_COUNT, 2, CV_32FC1 ));
+    CV_CALL( state->points = cvCreateMat( 1, imgSize.width*imgSize.height, CV_32SC2 ));
+
+    for( t = 0; t < ICV_EDGE_THETA_COUNT; t++ )
+    {
+        state->trigTab->data.fl[t*2] = (float)cos( t*CV_PI/ICV_EDGE_THETA_COUNT );
+        state->trigTab->data.fl[t*2+1] = (float)sin( t*CV_PI/ICV_EDGE_THETA_COUNT );
+    }
+
+    CV_CALL( cvSetEdgeLineROI( state, 0, 0 ));
+
+    __END__;
+
+    if( cvGetErrStatus() < 0 )
+    {
+        icvFreeEdgeLineState( state );
+        state = 0;
+    }
+
+    return state;
+}
+
+
+CV_IMPL void
+cvReleaseEdgeLineState( CvEdgeLineState** state )
+{
+    CV_FUNCNAME( "cvReleaseEdgeLineState" );
+
+    __BEGIN__;
+
+    if( !state )
+        CV_ERROR( CV_StsNullPtr, "" );
+
+    icvFreeEdgeLineState( *state );
+    *state = 0;
+
+    __END__;
+}
+
+
+CV_IMPL void
+cvSetEdgeLineROI( CvEdgeLineState* state, const CvPoint* polygon, int count )
+{
+    CV_FUNCNAME( "cvSetEdgeLineROI" );
+
+    __BEGIN__;
+
+    int* span;
+    int width, height, y, i;
+    int top, bottom, left, right;
+
+    if( !state || (count > 0 && !polygon) )
+        CV_ERROR( CV_StsNullPtr, "" );
+
+    if( count < 0 || (count > 0 && count < 3) )
+        CV_ERROR( CV_StsOutOfRange, "The polygon needs at least 3 points" );
+
+    span = state->roiSpan->data.i;
+    width = state->imgSize.width;
+    height = state->imgSize.height;
+    top = height, bottom = 0;
+    left = width, right = 0;
+
+    for( y = 0; y < height; y++ )
+    {
+        /* the Sobel needs a column either side */
+        int x0 = 1, x1 = width - 1;
+
+        if( count > 0 )
+        {
+            double xmin = DBL_MAX, xmax = -DBL_MAX;
+
+            for( i = 0; i < count; i++ )
+            {
+                CvPoint p = polygon[i], q = polygon[(i + 1) % count];
+
+                if( (y < p.y && y < q.y) || (y > p.y && y > q.y) )
+                    continue;
+
+                if( p.y == q.y )
+                {
+                    xmin = MIN( xmin, MIN( p.x, q.x ));
+                    xmax = MAX( xmax, MAX( p.x, q.x ));
+                }
+                else
+                {
+                    double xe = p.x + (double)(y - p.y)*(q.x - p.x)/(q.y - p.y);
+
+                    xmin = MIN( xmin, xe );
+                    xmax = MAX( xmax, xe );
+                }
+            }
+
+            if( xmin > xmax )
+                x0 = x1;
+            else
+            {
+                x0 = MAX( x0, cvCeil( xmin ));
+                x1 = MIN( x1, cvFloor( xmax ) + 1 );
+            }
+        }
+
+        if( x0 >= x1 )
+            x0 = x1 = 0;
+        else
+        {
+            top = MIN( top, y );
+            bottom = y + 1;
+            left = MIN( left, x0 );
+            right = MAX( right, x1 );
+        }
+
+        span[y*2] = x0;
+        span[y*2+1] = x1;
+    }
+
+    if( top >= bottom )
+        state->roiRect = cvRect( 0, 0, 0, 0 );
+    else
+        state->roiRect = cvRect( left, top, right - left, bottom - top );
+
+    /* edges are only ever written inside the bounding box */
+    CV_CALL( cvZero( state->edges ));
+
+    __END__;
+}
+
+
+CV_IMPL int
+cvFindEdgeLines( CvEdgeLineState* state, const CvArr* image )
+{
+    int result = 0;
+
+    CV_FUNCNAME( "cvFindEdgeLines" );
+
+    __BEGIN__;
+
+    CvMat stub, *img = (CvMat*)image;
+    CvRect r;
+
+    if( !state )
+        CV_ERROR( CV_StsNullPtr, "" );
+
+    CV_CALL( img = cvGetMat( img, &stub ));
+
+    if( CV_MAT_TYPE( img->type ) != CV_8UC1 )
+        CV_ERROR( CV_StsUnsupportedFormat, "Image must be 8uC1" );
+
+    if( img->cols != state->imgSize.width || img->rows != state->imgSize.height )
+        CV_ERROR( CV_StsUnmatchedSizes, "" );
+
+    if( state->cannyLow < 0 || state->cannyHigh < state->cannyLow ||
+        state->threshold < 1 || state->minLineLength < 1 || state->maxLineGap < 0 ||
+        state->trackRho < 0 || state->trackTheta < 0 || state->trackTheta >= 90 ||
+        state->maxMissed < 0 )
+        CV_ERROR( CV_StsOutOfRange, "" );
+
+    r = state->roiRect;
+    if( r.width > 0 && r.height > 0 )
+    {
+        icvEdgeLineGradient( state, img );
+
+        IPPI_CALL( icvCanny_16s8u_C1R(
+            (short*)(state->dx->data.ptr + state->dx->step*r.y) + r.x, state->dx->step,
+            (short*)(state->dy->data.ptr + state->dy->step*r.y) + r.x, state->dy->step,
+            state->edges->data.ptr + state->edges->step*r.y + r.x, state->edges->step,
+            cvSize( r.width, r.height ), (float)state->cannyLow, (float)state->cannyHigh,
+            state->cannyBuf->data.ptr ));
+    }
+
+    icvTrackEdgeLines( state );
+    icvFindNewEdgeLines( state );
+    result = state->lineCount;
+
+    __END__;
+
+    return result;
+}
+
+/* End of file. */
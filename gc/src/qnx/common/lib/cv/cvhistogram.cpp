@@ -2256,5 +2256,227 @@ cvCalcProbDensity( const CvHistogram* hist, const CvHistogram* hist_mask,
     __END__;
 }
 
+/************************ C O L O R   H I S T O G R A M S **************************/
+
+/*
+   The road classifier keeps a color histogram of the road, blended with each
+   new frame, and back projects it over part of every frame. cvCalcArrHist and
+   cvCalcArrBackProject need the image split into planes, and find the bin of
+   each pixel through code for any number of dimensions; these work on
+   3-channel 8-bit pixels in place, through lookup tables built once.
+*/
+
+static void
+icvCheckColorHist( const CvHistogram* hist, const CvColorHistLUT* lut )
+{
+    CV_FUNCNAME( "icvCheckColorHist" );
+
+    __BEGIN__;
+
+    if( !CV_IS_HIST(hist) || CV_IS_SPARSE_HIST(hist) )
+        CV_ERROR( CV_StsBadArg, "Bad histogram pointer, or sparse histogram" );
+
+    if( !lut )
+        CV_ERROR( CV_StsNullPtr, "Null lookup table pointer" );
+
+    if( cvGetDims( hist->bins ) != 3 )
+        CV_ERROR( CV_StsBadSize, "The histogram must be 3-dimensional" );
+
+    __END__;
+}
+
+
+CV_IMPL void
+cvCalcColorHistLUT( const CvHistogram* hist, CvColorHistLUT* lut )
+{
+    CV_FUNCNAME( "cvCalcColorHistLUT" );
+
+    __BEGIN__;
+
+    int size[CV_MAX_DIM];
+
+    CV_CALL( icvCheckColorHist( hist, lut ));
+    CV_CALL( cvGetDims( hist->bins, size ));
+    IPPI_CALL( icvCalcHistLookupTables8x( hist, 0, 256, 3, size, lut->tab[0] ));
+
+    __END__;
+}
+
+
+CV_IMPL void
+cvAccColorHist( const CvArr* img, CvHistogram* hist,
+                const CvColorHistLUT* lut, double alpha, const CvArr* mask )
+{
+    int* counts = 0;
+
+    CV_FUNCNAME( "cvAccColorHist" );
+
+    __BEGIN__;
+
+    CvMat stub, *mat = (CvMat*)img;
+    CvMat maskstub, *maskmat = 0;
+    CvMat binstub, *bins;
+    const int *tab0 = lut ? lut->tab[0] : 0;
+    const int *tab1 = lut ? lut->tab[1] : 0;
+    const int *tab2 = lut ? lut->tab[2] : 0;
+    float* h;
+    float a, w;
+    int i, x, y, total, count = 0;
+
+    CV_CALL( icvCheckColorHist( hist, lut ));
+
+    if( alpha < 0 || alpha > 1 )
+        CV_ERROR( CV_StsOutOfRange, "alpha must be within 0..1" );
+
+    CV_CALL( mat = cvGetMat( mat, &stub ));
+
+    if( CV_MAT_TYPE( mat->type ) != CV_8UC3 )
+        CV_ERROR( CV_StsUnsupportedFormat, "Only 8-bit 3-channel images are supported" );
+
+    if( mask )
+    {
+        CV_CALL( maskmat = cvGetMat( mask, &maskstub ));
+
+        if( !CV_IS_MASK_ARR(maskmat))
+            CV_ERROR( CV_StsBadMask, "Bad mask array" );
+
+        if( !CV_ARE_SIZES_EQ( mat, maskmat ))
+            CV_ERROR( CV_StsUnmatchedSizes,
+                "Mask size does not match to other arrays\' size" );
+    }
+
+    CV_CALL( bins = cvGetMat( hist->bins, &binstub, 0, 1 ));
+    h = bins->data.fl;
+    total = bins->rows*bins->cols;
+
+    /* count into integer bins first, then blend them in with one pass over the bins */
+    CV_CALL( counts = (int*)cvAlloc( total*sizeof(counts[0]) ));
+    memset( counts, 0, total*sizeof(counts[0]) );
+
+    for( y = 0; y < mat->rows; y++ )
+    {
+        const uchar* src = mat->data.ptr + y*mat->step;
+        const uchar* m = maskmat ? maskmat->data.ptr + y*maskmat->step : 0;
+
+        if( !m )
+        {
+            for( x = 0; x < mat->cols; x++, src += 3 )
+            {
+                int idx = tab0[src[0]] + tab1[src[1]] + tab2[src[2]];
+                if( idx >= 0 )
+                    counts[idx]++;
+            }
+            count += mat->cols;
+        }
+        else
+        {
+            for( x = 0; x < mat->cols; x++, src += 3 )
+            {
+                if( m[x] )
+                {
+                    int idx = tab0[src[0]] + tab1[src[1]] + tab2[src[2]];
+                    if( idx >= 0 )
+                        counts[idx]++;
+                    count++;
+                }
+            }
+        }
+    }
+
+    if( count == 0 )
+        EXIT;
+
+    a = (float)(1 - alpha);
+    w = (float)(alpha/count);
+
+    for( i = 0; i < total; i++ )
+        h[i] = h[i]*a + counts[i]*w;
+
+    __END__;
+
+    cvFree( (void**)&counts );
+}
+
+
+CV_IMPL void
+cvColorBackProject( const CvArr* img, CvArr* dst, const CvHistogram* hist,
+                    const CvColorHistLUT* lut, double scale, const CvArr* mask )
+{
+    uchar* vals = 0;
+
+    CV_FUNCNAME( "cvColorBackProject" );
+
+    __BEGIN__;
+
+    CvMat stub, *mat = (CvMat*)img;
+    CvMat dststub, *dstmat = (CvMat*)dst;
+    CvMat maskstub, *maskmat = 0;
+    CvMat binstub, *bins;
+    const int *tab0 = lut ? lut->tab[0] : 0;
+    const int *tab1 = lut ? lut->tab[1] : 0;
+    const int *tab2 = lut ? lut->tab[2] : 0;
+    const float* h;
+    float s = (float)scale;
+    int i, x, y, total;
+
+    CV_CALL( icvCheckColorHist( hist, lut ));
+    CV_CALL( mat = cvGetMat( mat, &stub ));
+    CV_CALL( dstmat = cvGetMat( dstmat, &dststub ));
+
+    if( CV_MAT_TYPE( mat->type ) != CV_8UC3 )
+        CV_ERROR( CV_StsUnsupportedFormat, "Only 8-bit 3-channel images are supported" );
+
+    if( CV_MAT_TYPE( dstmat->type ) != CV_8UC1 )
+        CV_ERROR( CV_StsUnsupportedFormat, "The destination must be 8-bit 1-channel" );
+
+    if( !CV_ARE_SIZES_EQ( mat, dstmat ))
+        CV_ERROR( CV_StsUnmatchedSizes, "" );
+
+    if( mask )
+    {
+        CV_CALL( maskmat = cvGetMat( mask, &maskstub ));
+
+        if( !CV_IS_MASK_ARR(maskmat))
+            CV_ERROR( CV_StsBadMask, "Bad mask array" );
+
+        if( !CV_ARE_SIZES_EQ( mat, maskmat ))
+            CV_ERROR( CV_StsUnmatchedSizes,
+                "Mask size does not match to other arrays\' size" );
+    }
+
+    CV_CALL( bins = cvGetMat( hist->bins, &binstub, 0, 1 ));
+    h = bins->data.fl;
+    total = bins->rows*bins->cols;
+
+    /* scale and saturate each bin once, rather than each pixel */
+    CV_CALL( vals = (uchar*)cvAlloc( total ));
+
+    for( i = 0; i < total; i++ )
+    {
+        int t = cvRound( h[i]*s );
+        vals[i] = CV_CAST_8U(t);
+    }
+
+    for( y = 0; y < mat->rows; y++ )
+    {
+        const uchar* src = mat->data.ptr + y*mat->step;
+        const uchar* m = maskmat ? maskmat->data.ptr + y*maskmat->step : 0;
+        uchar* d = dstmat->data.ptr + y*dstmat->step;
+
+        for( x = 0; x < mat->cols; x++, src += 3 )
+        {
+            if( m && !m[x] )
+                continue;
+
+            int idx = tab0[src[0]] + tab1[src[1]] + tab2[src[2]];
+            d[x] = idx >= 0 ? vals[idx] : 0;
+        }
+    }
+
+    __END__;
+
+    cvFree( (void**)&vals );
+}
+
 /* End of file. */
 
@@ -1053,5 +1053,424 @@ cvCalcAffineFlowPyrLK( const void* arrA, const void* arrB,
 }
 
 
+/****************************************************************************************\
+*                   Tracking through a frame sequence (CvPyrLKState)                     *
+\****************************************************************************************/
+
+/* For a video stream, cvCalcOpticalFlowPyrLK builds both pyramids and
+   allocates its buffers on every call, though the first frame's pyramid was
+   built on the call before.  CvPyrLKState keeps two pyramids and swaps them
+   as frames come in, so each frame is decimated once, and the per-point
+   buffers are allocated once.
+
+   The per-point solve is that of icvCalcOpticalFlowPyrLK_8uC1R: the window is
+   clipped to the part inside the image in both frames, since replicated border
+   pixels do not move with the scene and would pull the point towards the
+   border.  When the window is wholly inside both images, which is nearly
+   always, the gradient matrix is found once per point per level, and each
+   iteration is one pass over the whole window, as one vector
+   (icvLKMismatch_32f_C1R), rather than row by row. */
+
+IPCVAPI_IMPL( CvStatus, icvLKMismatch_32f_C1R, ( const float* I, const float* J,
+                                                 const float* Ix, const float* Iy,
+                                                 int len, float* b ))
+{
+    float sx[8], sy[8];
+    int i, k;
+
+    for( k = 0; k < 8; k++ )
+        sx[k] = sy[k] = 0.f;
+
+    for( i = 0; i <= len - 8; i += 8 )
+        for( k = 0; k < 8; k++ )
+        {
+            float t = I[i+k] - J[i+k];
+            sx[k] += t*Ix[i+k];
+            sy[k] += t*Iy[i+k];
+        }
+
+    for( k = 0; i < len; i++, k++ )
+    {
+        float t = I[i] - J[i];
+        sx[k] += t*Ix[i];
+        sy[k] += t*Iy[i];
+    }
+
+    b[0] = ((sx[0] + sx[4]) + (sx[2] + sx[6])) + ((sx[1] + sx[5]) + (sx[3] + sx[7]));
+    b[1] = ((sy[0] + sy[4]) + (sy[2] + sy[6])) + ((sy[1] + sy[5]) + (sy[3] + sy[7]));
+
+    return CV_OK;
+}
+
+
+static void
+icvFreePyrLKState( CvPyrLKState* state )
+{
+    if( !state )
+        return;
+
+    cvReleaseMat( &state->pyrBuf[0] );
+    cvReleaseMat( &state->pyrBuf[1] );
+    cvReleaseMat( &state->patchBuf );
+    cvReleaseMat( &state->pyrDownBuf );
+    cvFree( (void**)&state );
+}
+
+
+CV_IMPL CvPyrLKState*
+cvCreatePyrLKState( CvSize imgSize, CvSize winSize, int level )
+{
+    CvPyrLKState* state = 0;
+
+    CV_FUNCNAME( "cvCreatePyrLKState" );
+
+    __BEGIN__;
+
+    CvSize levelSize = imgSize;
+    int i, pyrBytes = 0, patchLen, srcPatchLen, pyrDownBytes = 0;
+
+    if( imgSize.width <= 0 || imgSize.height <= 0 )
+        CV_ERROR( CV_StsBadSize, "" );
+
+    if( winSize.width <= 1 || winSize.height <= 1 )
+        CV_ERROR( CV_StsBadSize, "winSize must be 2 or more each way" );
+
+    if( level < 0 || level > CV_PYRLK_MAX_LEVEL )
+        CV_ERROR( CV_StsOutOfRange, "level must be 0..CV_PYRLK_MAX_LEVEL" );
+
+    CV_CALL( state = (CvPyrLKState*)cvAlloc( sizeof(*state) ));
+    memset( state, 0, sizeof(*state) );
+
+    state->imgSize = imgSize;
+    state->winSize = winSize;
+    state->level = level;
+
+    /* same level sizes and steps as icvInitPyramidalAlgorithm */
+    for( i = 0; i <= level; i++ )
+    {
+        if( i > 0 )
+        {
+            levelSize.width = (levelSize.width + 1) >> 1;
+            levelSize.height = (levelSize.height + 1) >> 1;
+        }
+        state->levelSize[i] = levelSize;
+        state->levelStep[i] = icvAlign( levelSize.width, 8 );
+        state->levelOfs[i] = pyrBytes;
+        pyrBytes += state->levelStep[i]*levelSize.height;
+    }
+
+    CV_CALL( state->pyrBuf[0] = cvCreateMat( 1, pyrBytes, CV_8UC1 ));
+    CV_CALL( state->pyrBuf[1] = cvCreateMat( 1, pyrBytes, CV_8UC1 ));
+
+    /* I with a 1 pixel border for the derivatives, then J, Ix, Iy, and
+       the temporary row for icvSepConvSmall3_32f */
+    patchLen = (winSize.width*2 + 1)*(winSize.height*2 + 1);
+    srcPatchLen = (winSize.width*2 + 3)*(winSize.height*2 + 3);
+    CV_CALL( state->patchBuf = cvCreateMat( 1, srcPatchLen + patchLen*3, CV_32FC1 ));
+
+    IPPI_CALL( icvPyrDownGetBufSize_Gauss5x5( imgSize.width, cv8u, 1, &pyrDownBytes ));
+    CV_CALL( state->pyrDownBuf = cvCreateMat( 1, MAX(pyrDownBytes,1), CV_8UC1 ));
+
+    __END__;
+
+    if( cvGetErrStatus() < 0 )
+    {
+        icvFreePyrLKState( state );
+        state = 0;
+    }
+
+    return state;
+}
+
+
+CV_IMPL void
+cvReleasePyrLKState( CvPyrLKState** state )
+{
+    CV_FUNCNAME( "cvReleasePyrLKState" );
+
+    __BEGIN__;
+
+    if( !state )
+        CV_ERROR( CV_StsNullPtr, "" );
+
+    icvFreePyrLKState( *state );
+    *state = 0;
+
+    __END__;
+}
+
+
+CV_IMPL void
+cvUpdatePyrLKState( CvPyrLKState* state, const CvArr* frame )
+{
+    CV_FUNCNAME( "cvUpdatePyrLKState" );
+
+    __BEGIN__;
+
+    CvMat stub, *img = (CvMat*)frame;
+    uchar* pyr;
+    int i, y;
+
+    if( !state )
+        CV_ERROR( CV_StsNullPtr, "" );
+
+    CV_CALL( img = cvGetMat( img, &stub ));
+
+    if( CV_MAT_TYPE( img->type ) != CV_8UC1 )
+        CV_ERROR( CV_StsUnsupportedFormat, "" );
+
+    if( img->cols != state->imgSize.width || img->rows != state->imgSize.height )
+        CV_ERROR( CV_StsUnmatchedSizes, "" );
+
+    /* the old current frame becomes the previous frame */
+    state->current ^= 1;
+    if( state->frameCount < 2 )
+        state->frameCount++;
+
+    pyr = state->pyrBuf[state->current]->data.ptr;
+
+    /* level 0 is copied, since the caller's frame is usually reused */
+    for( y = 0; y < img->rows; y++ )
+        memcpy( pyr + y*state->levelStep[0], img->data.ptr + y*img->step, img->cols );
+
+    for( i = 1; i <= state->level; i++ )
+    {
+        uchar* src = pyr + state->levelOfs[i-1];
+        uchar* dst = pyr + state->levelOfs[i];
+        CvSize srcSize = state->levelSize[i-1];
+
+        srcSize.width &= -2;
+        srcSize.height &= -2;
+
+        IPPI_CALL( icvPyrDown_Gauss5x5_8u_C1R( src, state->levelStep[i-1],
+                                               dst, state->levelStep[i],
+                                               srcSize, state->pyrDownBuf->data.ptr ));
+        icvPyrDownBorder_8u_CnR( src, state->levelStep[i-1], state->levelSize[i-1],
+                                 dst, state->levelStep[i], state->levelSize[i], 1 );
+    }
+
+    __END__;
+}
+
+
+CV_IMPL void
+cvCalcOpticalFlowPyrLKState( CvPyrLKState* state,
+                             const CvPoint2D32f* featuresA,
+                             CvPoint2D32f* featuresB,
+                             int count, char* status, float* error,
+                             CvTermCriteria criteria, int flags )
+{
+    CV_FUNCNAME( "cvCalcOpticalFlowPyrLKState" );
+
+    __BEGIN__;
+
+    static const float kerX[] = { -1, 0, 1 }, kerY[] =
+    {
+    0.09375, 0.3125, 0.09375};  /* 3/32, 10/32, 3/32 */
+
+    const uchar *prev, *curr;
+    CvSize winSize, patchSize, srcPatchSize;
+    int patchLen, srcPatchLen, patchStep, srcPatchStep;
+    float *patchI, *patchJ, *Ix, *Iy, *convBuf;
+    int i, k, l, x, y, level;
+
+    if( !state || !featuresA || !featuresB )
+        CV_ERROR( CV_StsNullPtr, "" );
+
+    if( state->frameCount < 2 )
+        CV_ERROR( CV_StsError, "two frames are needed before tracking" );
+
+    if( (flags & ~CV_LKFLOW_INITIAL_GUESSES) != 0 )
+        CV_ERROR( CV_StsBadFlag, "" );
+
+    if( count <= 0 )
+        EXIT;
+
+    switch( criteria.type )
+    {
+    case CV_TERMCRIT_ITER:
+        criteria.epsilon = 0.f;
+        break;
+    case CV_TERMCRIT_EPS:
+        criteria.maxIter = 100;
+        break;
+    case CV_TERMCRIT_ITER | CV_TERMCRIT_EPS:
+        break;
+    default:
+        CV_ERROR( CV_StsBadFlag, "" );
+    }
+
+    /* compare squared values */
+    criteria.epsilon *= criteria.epsilon;
+
+    level = state->level;
+    prev = state->pyrBuf[state->current ^ 1]->data.ptr;
+    curr = state->pyrBuf[state->current]->data.ptr;
+
+    winSize = state->winSize;
+    patchSize = cvSize( winSize.width*2 + 1, winSize.height*2 + 1 );
+    srcPatchSize = cvSize( patchSize.width + 2, patchSize.height + 2 );
+    patchLen = patchSize.width*patchSize.height;
+    srcPatchLen = srcPatchSize.width*srcPatchSize.height;
+    patchStep = patchSize.width*sizeof(float);
+    srcPatchStep = srcPatchSize.width*sizeof(float);
+
+    patchI = state->patchBuf->data.fl;
+    patchJ = patchI + srcPatchLen;
+    Ix = patchJ + patchLen;
+    Iy = Ix + patchLen;
+    convBuf = patchJ;           /* patchJ is free while the derivatives are found */
+
+    if( !(flags & CV_LKFLOW_INITIAL_GUESSES) )
+        memcpy( featuresB, featuresA, count*sizeof(featuresA[0]) );
+
+    for( i = 0; i < count; i++ )
+    {
+        CvPoint2D32f v;
+        CvPoint minI, maxI, minJ, maxJ;
+        double scale = 1./(1 << level);
+        int pt_status = 1;
+
+        minI = maxI = minJ = maxJ = cvPoint( 0, 0 );
+
+        v.x = (float)(featuresB[i].x*scale*0.5);
+        v.y = (float)(featuresB[i].y*scale*0.5);
+
+        /* from the top pyramid level (smallest image) down */
+        for( l = level; l >= 0; l--, scale *= 2 )
+        {
+            const uchar* imgI = prev + state->levelOfs[l];
+            const uchar* imgJ = curr + state->levelOfs[l];
+            int step = state->levelStep[l];
+            CvSize levelSize = state->levelSize[l];
+            CvPoint2D32f u;
+            double Gxx0 = 0, Gxy0 = 0, Gyy0 = 0;
+            int fullI;
+
+            v.x += v.x;
+            v.y += v.y;
+
+            u.x = (float)(featuresA[i].x*scale);
+            u.y = (float)(featuresA[i].y*scale);
+
+            icvGetRectSubPix_8u32f_C1R( imgI, step, levelSize,
+                                        patchI, srcPatchStep, srcPatchSize, u );
+
+            icvSepConvSmall3_32f( patchI, srcPatchStep, Ix, patchStep,
+                                  srcPatchSize, kerX, kerY, convBuf );
+            icvSepConvSmall3_32f( patchI, srcPatchStep, Iy, patchStep,
+                                  srcPatchSize, kerY, kerX, convBuf );
+
+            /* repack patchI (remove borders) */
+            for( k = 0; k < patchSize.height; k++ )
+                memmove( patchI + k*patchSize.width,
+                         patchI + (k + 1)*srcPatchSize.width + 1, patchStep );
+
+            intersect( u, winSize, levelSize, &minI, &maxI );
+            fullI = maxI.x - minI.x == patchSize.width &&
+                    maxI.y - minI.y == patchSize.height;
+
+            if( fullI )
+            {
+                for( k = 0; k < patchLen; k++ )
+                {
+                    Gxx0 += Ix[k]*Ix[k];
+                    Gxy0 += Ix[k]*Iy[k];
+                    Gyy0 += Iy[k]*Iy[k];
+                }
+            }
+
+            for( k = 0; k < criteria.maxIter; k++ )
+            {
+                double bx = 0, by = 0, Gxx, Gxy, Gyy, D;
+                float mx, my;
+
+                icvGetRectSubPix_8u32f_C1R( imgJ, step, levelSize,
+                                            patchJ, patchStep, patchSize, v );
+
+                intersect( v, winSize, levelSize, &minJ, &maxJ );
+
+                minJ.x = MAX( minJ.x, minI.x );
+                minJ.y = MAX( minJ.y, minI.y );
+                maxJ.x = MIN( maxJ.x, maxI.x );
+                maxJ.y = MIN( maxJ.y, maxI.y );
+
+                if( fullI && maxJ.x - minJ.x == patchSize.width &&
+                    maxJ.y - minJ.y == patchSize.height )
+                {
+                    float b[2];
+
+                    icvLKMismatch_32f_C1R( patchI, patchJ, Ix, Iy, patchLen, b );
+                    bx = b[0];
+                    by = b[1];
+                    Gxx = Gxx0; Gxy = Gxy0; Gyy = Gyy0;
+                }
+                else
+                {
+                    /* near the border; only the part inside both images counts */
+                    Gxx = Gxy = Gyy = 0;
+
+                    for( y = minJ.y; y < maxJ.y; y++ )
+                        for( x = minJ.x; x < maxJ.x; x++ )
+                        {
+                            int idx = y*patchSize.width + x;
+                            double t = patchI[idx] - patchJ[idx];
+
+                            bx += t*Ix[idx];
+                            by += t*Iy[idx];
+                            Gxx += Ix[idx]*Ix[idx];
+                            Gxy += Ix[idx]*Iy[idx];
+                            Gyy += Iy[idx]*Iy[idx];
+                        }
+                }
+
+                D = Gxx*Gyy - Gxy*Gxy;
+                if( D < DBL_EPSILON )
+                {
+                    pt_status = 0;
+                    break;
+                }
+                D = 1./D;
+
+                mx = (float)((Gyy*bx - Gxy*by)*D);
+                my = (float)((Gxx*by - Gxy*bx)*D);
+
+                v.x += mx;
+                v.y += my;
+
+                if( mx*mx + my*my < criteria.epsilon )
+                    break;
+            }
+
+            if( !pt_status )
+                break;
+        }
+
+        if( pt_status )
+        {
+            featuresB[i] = v;
+
+            if( error )
+            {
+                double err = 0;
+
+                for( y = minJ.y; y < maxJ.y; y++ )
+                    for( x = minJ.x; x < maxJ.x; x++ )
+                    {
+                        int idx = y*patchSize.width + x;
+                        double t = patchI[idx] - patchJ[idx];
+                        err += t*t;
+                    }
+                error[i] = (float)sqrt( err );
+            }
+        }
+
+        if( status )
+            status[i] = (char)pt_status;
+    }
+
+    __END__;
+}
+
 
 /* End of file. */
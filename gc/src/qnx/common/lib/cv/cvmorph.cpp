@@ -41,6 +41,7 @@
 
 #include "_cv.h"
 #include <limits.h>
+#include <float.h>
 
 IPCVAPI_IMPL( CvStatus,
     icvMorphologyInitAlloc, ( int roiWidth, CvDataType dataType, int channels,
@@ -2545,6 +2546,281 @@ cvReleaseStructuringElement( IplConvKernel ** element )
 }
 
 
+/****************************************************************************************\
+*                Rectangular elements: van Herk/Gil-Werman running min/max               *
+\****************************************************************************************/
+
+/*
+   A rectangular element is separable: a horizontal pass followed by a vertical
+   pass.  Each pass uses the van Herk/Gil-Werman scheme: the line is cut into
+   blocks of ksize samples, g is the running min (max) forward within each
+   block and h the running min (max) backward, and the result over the window
+   starting at x is op( h[x], g[x + ksize - 1] ).  That is three operations per
+   sample whatever the element size.  Short horizontal windows are cheaper to
+   do directly with the vectorized row primitive.
+
+   Samples outside the image are replaced by the neutral value of the operation,
+   which gives the same result as the replicated border used by the strip
+   functions above.  The vertical pass works in place on the output of the
+   horizontal pass; each block of output rows is written only after the rows
+   of the next block have been read.
+*/
+
+#define ICV_MORPH_MAX_DIRECT  9    /* wider horizontal windows use g/h runs */
+
+#define ICV_MORPH_MIN( a, b )  ((a) < (b) ? (a) : (b))
+#define ICV_MORPH_MAX( a, b )  ((a) > (b) ? (a) : (b))
+
+#define ICV_DEF_MORPH_RUN_FUNCS( name, flavor, arrtype, op )                            \
+IPCVAPI_IMPL( CvStatus, icv##name##Row_##flavor##_CnR, ( const arrtype* src,            \
+              arrtype* dst, int len, int cn, int ksize ))                               \
+{                                                                                       \
+    int i, k;                                                                           \
+                                                                                        \
+    for( i = 0; i < len; i++ )                                                          \
+    {                                                                                   \
+        const arrtype* s = src + i;                                                     \
+        arrtype t = s[0];                                                               \
+                                                                                        \
+        for( k = 1; k < ksize; k++ )                                                    \
+            t = op( t, s[k*cn] );                                                       \
+        dst[i] = t;                                                                     \
+    }                                                                                   \
+                                                                                        \
+    return CV_OK;                                                                       \
+}                                                                                       \
+                                                                                        \
+IPCVAPI_IMPL( CvStatus, icv##name##Vec_##flavor, ( const arrtype* src1,                 \
+              const arrtype* src2, arrtype* dst, int len ))                             \
+{                                                                                       \
+    int i;                                                                              \
+                                                                                        \
+    for( i = 0; i < len; i++ )                                                          \
+        dst[i] = op( src1[i], src2[i] );                                                \
+                                                                                        \
+    return CV_OK;                                                                       \
+}
+
+
+#define ICV_DEF_MORPH_RECT( name, flavor, arrtype, op, neutral )                        \
+static void                                                                             \
+icv##name##Rect_##flavor( const arrtype* src, int srcstep, arrtype* dst, int dststep,   \
+                          CvSize size, int cn, CvSize ksize, CvPoint anchor,            \
+                          arrtype* buf )                                                \
+{                                                                                       \
+    int kw = ksize.width, kh = ksize.height, ay = anchor.y;                             \
+    int len = size.width*cn, n = size.width + kw - 1, padlen = n*cn;                    \
+    arrtype* pad = buf;                                                                 \
+    arrtype* g = pad + padlen;                                                          \
+    arrtype* h = g + padlen;                                                            \
+    arrtype* empty = h + padlen;                                                        \
+    arrtype* vg = empty + len;                                                          \
+    arrtype* vh0 = vg + kh*len;                                                         \
+    arrtype* vh1 = vh0 + kh*len;                                                        \
+    int x, y, i, c, b;                                                                  \
+                                                                                        \
+    srcstep /= sizeof(src[0]);                                                          \
+    dststep /= sizeof(dst[0]);                                                          \
+                                                                                        \
+    for( i = 0; i < padlen; i++ )                                                       \
+        pad[i] = neutral;                                                               \
+    for( i = 0; i < len; i++ )                                                          \
+        empty[i] = neutral;                                                             \
+                                                                                        \
+    /* horizontal pass, src -> dst */                                                   \
+    for( y = 0; y < size.height; y++ )                                                  \
+    {                                                                                   \
+        const arrtype* s = src + y*srcstep;                                             \
+        arrtype* d = dst + y*dststep;                                                   \
+                                                                                        \
+        if( kw == 1 )                                                                   \
+        {                                                                               \
+            if( d != s )                                                                \
+                memcpy( d, s, len*sizeof(d[0]));                                        \
+            continue;                                                                   \
+        }                                                                               \
+                                                                                        \
+        memcpy( pad + anchor.x*cn, s, len*sizeof(pad[0]));                              \
+                                                                                        \
+        if( kw <= ICV_MORPH_MAX_DIRECT )                                                \
+        {                                                                               \
+            icv##name##Row_##flavor##_CnR( pad, d, len, cn, kw );                       \
+            continue;                                                                   \
+        }                                                                               \
+                                                                                        \
+        for( x = 0; x < n; x++ )                                                        \
+        {                                                                               \
+            const arrtype* p = pad + x*cn;                                              \
+            arrtype* t = g + x*cn;                                                      \
+                                                                                        \
+            if( x % kw == 0 )                                                           \
+                for( c = 0; c < cn; c++ )                                               \
+                    t[c] = p[c];                                                        \
+            else                                                                        \
+                for( c = 0; c < cn; c++ )                                               \
+                    t[c] = op( t[c - cn], p[c] );                                       \
+        }                                                                               \
+                                                                                        \
+        for( x = n - 1; x >= 0; x-- )                                                   \
+        {                                                                               \
+            const arrtype* p = pad + x*cn;                                              \
+            arrtype* t = h + x*cn;                                                      \
+                                                                                        \
+            if( x % kw == kw - 1 || x == n - 1 )                                        \
+                for( c = 0; c < cn; c++ )                                               \
+                    t[c] = p[c];                                                        \
+            else                                                                        \
+                for( c = 0; c < cn; c++ )                                               \
+                    t[c] = op( t[c + cn], p[c] );                                       \
+        }                                                                               \
+                                                                                        \
+        icv##name##Vec_##flavor( h, g + (kw - 1)*cn, d, len );                          \
+    }                                                                                   \
+                                                                                        \
+    /* vertical pass over blocks of kh rows, in place in dst */                         \
+    if( kh > 1 )                                                                        \
+    {                                                                                   \
+        arrtype* hcur = vh0;                                                            \
+        arrtype* hnext = vh1;                                                           \
+                                                                                        \
+        /* backward runs of the first block; (padded) row p is dst row p - ay */        \
+        for( i = kh - 1; i >= 0; i-- )                                                  \
+        {                                                                               \
+            int sy = i - ay;                                                            \
+            const arrtype* r = sy >= 0 && sy < size.height ? dst + sy*dststep : empty;  \
+                                                                                        \
+            if( i == kh - 1 )                                                           \
+                memcpy( hcur + i*len, r, len*sizeof(r[0]));                             \
+            else                                                                        \
+                icv##name##Vec_##flavor( hcur + (i + 1)*len, r, hcur + i*len, len );    \
+        }                                                                               \
+                                                                                        \
+        for( b = 0; b*kh < size.height; b++ )                                           \
+        {                                                                               \
+            arrtype* t;                                                                 \
+                                                                                        \
+            /* forward and backward runs of the next block */                           \
+            for( i = 0; i < kh; i++ )                                                   \
+            {                                                                           \
+                int sy = (b + 1)*kh + i - ay;                                           \
+                const arrtype* r = sy < size.height ? dst + sy*dststep : empty;         \
+                                                                                        \
+                if( i == 0 )                                                            \
+                    memcpy( vg, r, len*sizeof(r[0]));                                   \
+                else                                                                    \
+                    icv##name##Vec_##flavor( vg + (i - 1)*len, r, vg + i*len, len );    \
+            }                                                                           \
+                                                                                        \
+            for( i = kh - 1; i >= 0; i-- )                                              \
+            {                                                                           \
+                int sy = (b + 1)*kh + i - ay;                                           \
+                const arrtype* r = sy < size.height ? dst + sy*dststep : empty;         \
+                                                                                        \
+                if( i == kh - 1 )                                                       \
+                    memcpy( hnext + i*len, r, len*sizeof(r[0]));                        \
+                else                                                                    \
+                    icv##name##Vec_##flavor( hnext + (i + 1)*len, r,                    \
+                                             hnext + i*len, len );                      \
+            }                                                                           \
+                                                                                        \
+            /* output rows of this block; the first one spans exactly its block */      \
+            for( i = 0; i < kh && b*kh + i < size.height; i++ )                         \
+            {                                                                           \
+                arrtype* d = dst + (b*kh + i)*dststep;                                  \
+                                                                                        \
+                if( i == 0 )                                                            \
+                    memcpy( d, hcur, len*sizeof(d[0]));                                 \
+                else                                                                    \
+                    icv##name##Vec_##flavor( hcur + i*len, vg + (i - 1)*len, d, len );  \
+            }                                                                           \
+                                                                                        \
+            t = hcur, hcur = hnext, hnext = t;                                          \
+        }                                                                               \
+    }                                                                                   \
+}
+
+
+ICV_DEF_MORPH_RUN_FUNCS( Min, 8u, uchar, ICV_MORPH_MIN )
+ICV_DEF_MORPH_RUN_FUNCS( Max, 8u, uchar, ICV_MORPH_MAX )
+ICV_DEF_MORPH_RUN_FUNCS( Min, 32f, float, ICV_MORPH_MIN )
+ICV_DEF_MORPH_RUN_FUNCS( Max, 32f, float, ICV_MORPH_MAX )
+
+ICV_DEF_MORPH_RECT( Min, 8u, uchar, ICV_MORPH_MIN, 255 )
+ICV_DEF_MORPH_RECT( Max, 8u, uchar, ICV_MORPH_MAX, 0 )
+ICV_DEF_MORPH_RECT( Min, 32f, float, ICV_MORPH_MIN, FLT_MAX )
+ICV_DEF_MORPH_RECT( Max, 32f, float, ICV_MORPH_MAX, -FLT_MAX )
+
+
+/* true if the element covers its whole bounding rectangle */
+static int
+icvIsRectElement( const IplConvKernel* element )
+{
+    int i, size;
+
+    if( !element || element->nShiftR == CV_SHAPE_RECT )
+        return 1;
+
+    size = element->nCols*element->nRows;
+    for( i = 0; i < size; i++ )
+        if( !element->values[i] )
+            return 0;
+
+    return 1;
+}
+
+
+/* erodes (mop = 0) or dilates (mop = 1) with a rectangular element;
+   the iterations are folded into one larger rectangle */
+static void
+icvMorphRect( const CvMat* src, CvMat* dst, IplConvKernel* element,
+              int iterations, int mop )
+{
+    void* buffer = 0;
+
+    CV_FUNCNAME( "icvMorphRect" );
+
+    __BEGIN__;
+
+    int type = CV_MAT_TYPE( src->type ), cn = CV_MAT_CN( type );
+    CvSize size = icvGetMatSize( src );
+    CvSize ksize = element ? cvSize( element->nCols, element->nRows ) : cvSize( 3, 3 );
+    CvPoint anchor = element ? cvPoint( element->anchorX, element->anchorY ) : cvPoint( 1, 1 );
+    int bufsize;
+
+    ksize.width = (ksize.width - 1)*iterations + 1;
+    ksize.height = (ksize.height - 1)*iterations + 1;
+    anchor.x *= iterations;
+    anchor.y *= iterations;
+
+    bufsize = (3*(size.width + ksize.width - 1)*cn + (3*ksize.height + 1)*size.width*cn)*
+              icvPixSize[CV_MAT_DEPTH(type)];
+    CV_CALL( buffer = cvAlloc( bufsize ));
+
+    if( CV_MAT_DEPTH( type ) == CV_8U )
+    {
+        if( mop == 0 )
+            icvMinRect_8u( src->data.ptr, src->step, dst->data.ptr, dst->step,
+                           size, cn, ksize, anchor, (uchar*)buffer );
+        else
+            icvMaxRect_8u( src->data.ptr, src->step, dst->data.ptr, dst->step,
+                           size, cn, ksize, anchor, (uchar*)buffer );
+    }
+    else
+    {
+        if( mop == 0 )
+            icvMinRect_32f( src->data.fl, src->step, dst->data.fl, dst->step,
+                            size, cn, ksize, anchor, (float*)buffer );
+        else
+            icvMaxRect_32f( src->data.fl, src->step, dst->data.fl, dst->step,
+                            size, cn, ksize, anchor, (float*)buffer );
+    }
+
+    __END__;
+
+    cvFree( &buffer );
+}
+
+
 static void icvInitMorphologyTab( CvBigFuncTable* rect_erode, CvBigFuncTable* rect_dilate,
                                 CvBigFuncTable* cross_erode, CvBigFuncTable* cross_dilate,
                                 CvBigFuncTable* arb_erode, CvBigFuncTable* arb_dilate )
@@ -2660,6 +2936,16 @@ icvMorphOp( const void* srcarr, void* dstarr, IplConvKernel* element,
 
     type = CV_MAT_TYPE( src->type );
 
+    if( iterations > 0 && icvIsRectElement( element ) &&
+        (CV_MAT_DEPTH( type ) == CV_8U || CV_MAT_DEPTH( type ) == CV_32F) &&
+        CV_MAT_CN( type ) != 2 )
+    {
+        if( src->step == 0 )
+            src->step = dst->step = src->width*icvPixSize[type];
+        CV_CALL( icvMorphRect( src, dst, element, iterations, mop ));
+        EXIT;
+    }
+
     if( element )
     {
         IPPI_CALL(
@@ -0,0 +1,1080 @@
+/*
+//
+//  cvsimd.cpp  -- SSE2/SSE4.1/AVX2 versions of the hot primitives
+//
+//  Each function here is a drop-in replacement for the generic C primitive
+//  of the same name in _ipcv.h, and must produce bit-identical results.
+//  cvLoadPrimitives() (cvswitcher.cpp) installs them through icvSimdFuncTab
+//  according to what icvGetCpuFeatures() reports.
+//
+//  Primitives covered:
+//      icvAdd/Sub/AbsDiff_8u_C1R, icvAdd/Sub/AbsDiff_32f_C1R   (SSE2, AVX2)
+//      icvCvt_BGR2GRAY_8u_C3C1R                               (SSE4.1)
+//      icvResize_Bilinear_8u_C1R                              (SSE4.1, AVX2)
+//      icvPyrDown_Gauss5x5_8u_C1R                             (SSE2)
+//      icvFilterRow/FilterCol/SumCol (separable smoothing)    (SSE2, AVX2)
+//      icvMin/MaxRow, icvMin/MaxVec (rectangular morphology)  (SSE2, AVX2)
+//      icvUpdateSADCol_8u16u_C1R (block matching stereo)      (SSE2, AVX2)
+//      icvLKMismatch_32f_C1R (Lucas-Kanade tracking)          (SSE2, AVX2)
+//      icvSobel3x3Row_8u16s_C1R (edge lines)                  (SSE2, AVX2)
+//
+//  Team Overbot
+//  October, 2026
+//
+*/
+
+#include "_cv.h"
+#include "_cvsimd.h"
+
+#if CV_SIMD_DISPATCH
+
+#include <immintrin.h>
+
+/****************************************************************************************\
+*                              Arithmetic (+, -, |a-b|)                                  *
+\****************************************************************************************/
+
+/* 8u: the generic code saturates through icvSaturate8u, which is exactly
+   what the unsigned saturating byte instructions do. */
+#define ICV_SIMD_ABSDIFF_8U_SSE2( a, b ) \
+    _mm_or_si128( _mm_subs_epu8( a, b ), _mm_subs_epu8( b, a ))
+#define ICV_SIMD_ABSDIFF_8U_AVX2( a, b ) \
+    _mm256_or_si256( _mm256_subs_epu8( a, b ), _mm256_subs_epu8( b, a ))
+
+#define ICV_DEF_SIMD_BIN_8U( name, isa, target, vtype, vsize, load, store,     \
+                             vop, sop )                                         \
+static CvStatus CV_STDCALL target                                               \
+name##_##isa( const uchar* src1, int step1, const uchar* src2, int step2,       \
+              uchar* dst, int step, CvSize size )                               \
+{                                                                               \
+    for( ; size.height--; src1 += step1, src2 += step2, dst += step )           \
+    {                                                                           \
+        int i = 0;                                                              \
+                                                                                \
+        for( ; i <= size.width - vsize; i += vsize )                            \
+        {                                                                       \
+            vtype a = load( (const vtype*)(src1 + i) );                         \
+            vtype b = load( (const vtype*)(src2 + i) );                         \
+            store( (vtype*)(dst + i), vop( a, b ));                             \
+        }                                                                       \
+                                                                                \
+        for( ; i < size.width; i++ )                                            \
+        {                                                                       \
+            int t = sop( src1[i], src2[i] );                                    \
+            dst[i] = CV_FAST_CAST_8U( t );                                      \
+        }                                                                       \
+    }                                                                           \
+                                                                                \
+    return CV_OK;                                                               \
+}
+
+#define ICV_SIMD_ABS_SUB(a, b)   abs((a) - (b))
+
+ICV_DEF_SIMD_BIN_8U( icvAdd_8u_C1R, sse2, ICV_TARGET_SSE2, __m128i, 16,
+                     _mm_loadu_si128, _mm_storeu_si128, _mm_adds_epu8, CV_ADD )
+ICV_DEF_SIMD_BIN_8U( icvSub_8u_C1R, sse2, ICV_TARGET_SSE2, __m128i, 16,
+                     _mm_loadu_si128, _mm_storeu_si128, _mm_subs_epu8, CV_SUB )
+ICV_DEF_SIMD_BIN_8U( icvAbsDiff_8u_C1R, sse2, ICV_TARGET_SSE2, __m128i, 16,
+                     _mm_loadu_si128, _mm_storeu_si128, ICV_SIMD_ABSDIFF_8U_SSE2,
+                     ICV_SIMD_ABS_SUB )
+
+ICV_DEF_SIMD_BIN_8U( icvAdd_8u_C1R, avx2, ICV_TARGET_AVX2, __m256i, 32,
+                     _mm256_loadu_si256, _mm256_storeu_si256, _mm256_adds_epu8, CV_ADD )
+ICV_DEF_SIMD_BIN_8U( icvSub_8u_C1R, avx2, ICV_TARGET_AVX2, __m256i, 32,
+                     _mm256_loadu_si256, _mm256_storeu_si256, _mm256_subs_epu8, CV_SUB )
+ICV_DEF_SIMD_BIN_8U( icvAbsDiff_8u_C1R, avx2, ICV_TARGET_AVX2, __m256i, 32,
+                     _mm256_loadu_si256, _mm256_storeu_si256, ICV_SIMD_ABSDIFF_8U_AVX2,
+                     ICV_SIMD_ABS_SUB )
+
+
+#define ICV_SIMD_ABSDIFF_32F_SSE2( a, b ) \
+    _mm_andnot_ps( _mm_set1_ps( -0.f ), _mm_sub_ps( a, b ))
+#define ICV_SIMD_ABSDIFF_32F_AVX2( a, b ) \
+    _mm256_andnot_ps( _mm256_set1_ps( -0.f ), _mm256_sub_ps( a, b ))
+
+#define ICV_DEF_SIMD_BIN_32F( name, isa, target, vtype, vsize, load, store,    \
+                              vop, sop )                                        \
+static CvStatus CV_STDCALL target                                               \
+name##_##isa( const float* src1, int step1, const float* src2, int step2,       \
+              float* dst, int step, CvSize size )                               \
+{                                                                               \
+    for( ; size.height--; (char*&)src1 += step1, (char*&)src2 += step2,         \
+                          (char*&)dst += step )                                 \
+    {                                                                           \
+        int i = 0;                                                              \
+                                                                                \
+        for( ; i <= size.width - vsize; i += vsize )                            \
+        {                                                                       \
+            vtype a = load( src1 + i );                                         \
+            vtype b = load( src2 + i );                                         \
+            store( dst + i, vop( a, b ));                                       \
+        }                                                                       \
+                                                                                \
+        for( ; i < size.width; i++ )                                            \
+            dst[i] = (float)sop( src1[i], src2[i] );                            \
+    }                                                                           \
+                                                                                \
+    return CV_OK;                                                               \
+}
+
+#define ICV_SIMD_FABS_SUB(a, b)   fabs((a) - (b))
+
+ICV_DEF_SIMD_BIN_32F( icvAdd_32f_C1R, sse2, ICV_TARGET_SSE2, __m128, 4,
+                      _mm_loadu_ps, _mm_storeu_ps, _mm_add_ps, CV_ADD )
+ICV_DEF_SIMD_BIN_32F( icvSub_32f_C1R, sse2, ICV_TARGET_SSE2, __m128, 4,
+                      _mm_loadu_ps, _mm_storeu_ps, _mm_sub_ps, CV_SUB )
+ICV_DEF_SIMD_BIN_32F( icvAbsDiff_32f_C1R, sse2, ICV_TARGET_SSE2, __m128, 4,
+                      _mm_loadu_ps, _mm_storeu_ps, ICV_SIMD_ABSDIFF_32F_SSE2,
+                      ICV_SIMD_FABS_SUB )
+
+ICV_DEF_SIMD_BIN_32F( icvAdd_32f_C1R, avx2, ICV_TARGET_AVX2, __m256, 8,
+                      _mm256_loadu_ps, _mm256_storeu_ps, _mm256_add_ps, CV_ADD )
+ICV_DEF_SIMD_BIN_32F( icvSub_32f_C1R, avx2, ICV_TARGET_AVX2, __m256, 8,
+                      _mm256_loadu_ps, _mm256_storeu_ps, _mm256_sub_ps, CV_SUB )
+ICV_DEF_SIMD_BIN_32F( icvAbsDiff_32f_C1R, avx2, ICV_TARGET_AVX2, __m256, 8,
+                      _mm256_loadu_ps, _mm256_storeu_ps, ICV_SIMD_ABSDIFF_32F_AVX2,
+                      ICV_SIMD_FABS_SUB )
+
+
+/****************************************************************************************\
+*                                    BGR -> Gray                                         *
+\****************************************************************************************/
+
+/* same fixed-point weights as cvcolor.cpp: fix(w,10), descaled by 10 bits */
+#define  ICV_GRAY_B   74
+#define  ICV_GRAY_G   732
+#define  ICV_GRAY_R   218
+#define  ICV_GRAY_SHIFT  10
+
+static CvStatus CV_STDCALL ICV_TARGET_SSE4_1
+icvCvt_BGR2GRAY_8u_C3C1R_sse41( const uchar* src, int srcstep,
+                                uchar* dst, int dststep, CvSize size )
+{
+    /* spread two BGR pixels into 16-bit lanes [b g r 0 b g r 0] */
+    const __m128i sh01 = _mm_setr_epi8( 0, -1, 1, -1, 2, -1, -1, -1,
+                                        3, -1, 4, -1, 5, -1, -1, -1 );
+    const __m128i sh23 = _mm_setr_epi8( 6, -1, 7, -1, 8, -1, -1, -1,
+                                        9, -1, 10, -1, 11, -1, -1, -1 );
+    const __m128i coeffs = _mm_setr_epi16( ICV_GRAY_B, ICV_GRAY_G, ICV_GRAY_R, 0,
+                                           ICV_GRAY_B, ICV_GRAY_G, ICV_GRAY_R, 0 );
+    const __m128i delta = _mm_set1_epi32( 1 << (ICV_GRAY_SHIFT - 1) );
+
+    for( ; size.height--; src += srcstep, dst += dststep )
+    {
+        int i = 0;
+
+        /* 8 pixels per step; the second load reads 4 bytes beyond them */
+        for( ; i <= size.width - 10; i += 8 )
+        {
+            __m128i v0 = _mm_loadu_si128( (const __m128i*)(src + i*3) );
+            __m128i v1 = _mm_loadu_si128( (const __m128i*)(src + i*3 + 12) );
+
+            __m128i s0 = _mm_hadd_epi32(
+                _mm_madd_epi16( _mm_shuffle_epi8( v0, sh01 ), coeffs ),
+                _mm_madd_epi16( _mm_shuffle_epi8( v0, sh23 ), coeffs ));
+            __m128i s1 = _mm_hadd_epi32(
+                _mm_madd_epi16( _mm_shuffle_epi8( v1, sh01 ), coeffs ),
+                _mm_madd_epi16( _mm_shuffle_epi8( v1, sh23 ), coeffs ));
+
+            s0 = _mm_srai_epi32( _mm_add_epi32( s0, delta ), ICV_GRAY_SHIFT );
+            s1 = _mm_srai_epi32( _mm_add_epi32( s1, delta ), ICV_GRAY_SHIFT );
+            s0 = _mm_packs_epi32( s0, s1 );
+            _mm_storel_epi64( (__m128i*)(dst + i), _mm_packus_epi16( s0, s0 ));
+        }
+
+        for( ; i < size.width; i++ )
+        {
+            const uchar* s = src + i*3;
+            int t = s[0]*ICV_GRAY_B + s[1]*ICV_GRAY_G + s[2]*ICV_GRAY_R;
+            t = CV_DESCALE( t, ICV_GRAY_SHIFT );
+            dst[i] = CV_FAST_CAST_8U( t );
+        }
+    }
+
+    return CV_OK;
+}
+
+
+/****************************************************************************************\
+*                                 Bilinear resize, 8u C1                                 *
+\****************************************************************************************/
+
+/*
+   Horizontal interpolation is done once per source row into an int buffer
+   (scaled by 2^8) and reused while consecutive destination rows map onto
+   the same source rows; the vertical blend is vectorized.  Arithmetic is
+   the same as ICV_DEF_RESIZE_BILINEAR_FUNC in cvaffine.cpp.
+*/
+#define  ICV_RESIZE_SHIFT  8
+
+static void
+icvResizeBilinearRow_8u( const uchar* tsrc, int* buf, const int* x_ofs,
+                         const int* x_alpha, int xmax, int width )
+{
+    int x;
+
+    for( x = 0; x < xmax; x++ )
+    {
+        int sx = x_ofs[x], t = tsrc[sx];
+        buf[x] = (t << ICV_RESIZE_SHIFT) + (tsrc[sx+1] - t)*x_alpha[x];
+    }
+
+    for( ; x < width; x++ )
+        buf[x] = tsrc[x_ofs[x]] << ICV_RESIZE_SHIFT;
+}
+
+
+#define ICV_DEF_SIMD_RESIZE_BILINEAR( isa, target, vblend )                     \
+static CvStatus CV_STDCALL target                                               \
+icvResize_Bilinear_8u_C1R_##isa( const uchar* src, int srcstep, CvSize srcsize, \
+                                 uchar* dst, int dststep, CvSize dstsize )      \
+{                                                                               \
+    int* x_ofs = (int*)alloca( dstsize.width * sizeof(x_ofs[0]) * 4 );          \
+    int* x_alpha = x_ofs + dstsize.width;                                       \
+    int* rows[2] = { x_alpha + dstsize.width, x_alpha + dstsize.width*2 };      \
+    int row_y[2] = { -1, -1 };                                                  \
+                                                                                \
+    int sw = srcsize.width - 1;                                                 \
+    int sh = srcsize.height - 1;                                                \
+    int dw = dstsize.width - 1;                                                 \
+    int dh = dstsize.height - 1;                                                \
+    int x, y, xmax = dw+1;                                                      \
+                                                                                \
+    for( x = 0; x <= dw; x++ )                                                  \
+    {                                                                           \
+        float fx = (float)(sw+1)*x/(dw+1);                                      \
+        int ix = cvFloor(fx);                                                   \
+        x_ofs[x] = ix;                                                          \
+        if( ix >= sw && xmax > dw )                                             \
+            xmax = x;                                                           \
+        x_alpha[x] = cvRound((fx - ix)*(1 << ICV_RESIZE_SHIFT));                \
+    }                                                                           \
+                                                                                \
+    for( y = 0; y <= dh; y++, dst += dststep )                                  \
+    {                                                                           \
+        float fy = (float)(sh+1)*y/(dh+1);                                      \
+        int iy = cvFloor(fy);                                                   \
+        int iy2 = iy < sh ? iy + 1 : iy;                                        \
+        int y_alpha = cvRound((fy - iy)*(1 << ICV_RESIZE_SHIFT));               \
+        int *row0, *row1;                                                       \
+        assert( 0 <= iy && iy <= sh );                                          \
+                                                                                \
+        /* keep the two buffered rows in (iy, iy2) order, refilling only */     \
+        /* those that are not there already */                                  \
+        if( row_y[0] != iy )                                                    \
+        {                                                                       \
+            if( row_y[1] == iy )                                                \
+            {                                                                   \
+                int* t = rows[0]; rows[0] = rows[1]; rows[1] = t;               \
+                row_y[0] = iy; row_y[1] = -1;                                   \
+            }                                                                   \
+            else                                                                \
+            {                                                                   \
+                icvResizeBilinearRow_8u( src + iy*srcstep, rows[0], x_ofs,      \
+                                         x_alpha, xmax, dw+1 );                 \
+                row_y[0] = iy;                                                  \
+            }                                                                   \
+        }                                                                       \
+                                                                                \
+        if( iy2 == iy )                                                         \
+            row1 = rows[0];                                                     \
+        else                                                                    \
+        {                                                                       \
+            if( row_y[1] != iy2 )                                               \
+            {                                                                   \
+                icvResizeBilinearRow_8u( src + iy2*srcstep, rows[1], x_ofs,     \
+                                         x_alpha, xmax, dw+1 );                 \
+                row_y[1] = iy2;                                                 \
+            }                                                                   \
+            row1 = rows[1];                                                     \
+        }                                                                       \
+        row0 = rows[0];                                                         \
+                                                                                \
+        x = vblend( row0, row1, dst, dw+1, y_alpha );                           \
+                                                                                \
+        for( ; x <= dw; x++ )                                                   \
+        {                                                                       \
+            int t0 = row0[x];                                                   \
+            t0 = CV_DESCALE( (t0 << ICV_RESIZE_SHIFT) + (row1[x] - t0)*y_alpha, \
+                             ICV_RESIZE_SHIFT*2 );                              \
+            dst[x] = (uchar)t0;                                                 \
+        }                                                                       \
+    }                                                                           \
+                                                                                \
+    return CV_OK;                                                               \
+}
+
+
+/* blend as many whole vectors of the row as possible; returns columns done */
+static int ICV_TARGET_SSE4_1
+icvResizeBlend_8u_sse41( const int* row0, const int* row1, uchar* dst,
+                         int width, int y_alpha )
+{
+    const __m128i ya = _mm_set1_epi32( y_alpha );
+    const __m128i delta = _mm_set1_epi32( 1 << (ICV_RESIZE_SHIFT*2 - 1) );
+    int x = 0;
+
+    for( ; x <= width - 8; x += 8 )
+    {
+        __m128i a0 = _mm_loadu_si128( (const __m128i*)(row0 + x) );
+        __m128i a1 = _mm_loadu_si128( (const __m128i*)(row0 + x + 4) );
+        __m128i b0 = _mm_loadu_si128( (const __m128i*)(row1 + x) );
+        __m128i b1 = _mm_loadu_si128( (const __m128i*)(row1 + x + 4) );
+
+        a0 = _mm_add_epi32( _mm_slli_epi32( a0, ICV_RESIZE_SHIFT ),
+                            _mm_mullo_epi32( _mm_sub_epi32( b0, a0 ), ya ));
+        a1 = _mm_add_epi32( _mm_slli_epi32( a1, ICV_RESIZE_SHIFT ),
+                            _mm_mullo_epi32( _mm_sub_epi32( b1, a1 ), ya ));
+        a0 = _mm_srai_epi32( _mm_add_epi32( a0, delta ), ICV_RESIZE_SHIFT*2 );
+        a1 = _mm_srai_epi32( _mm_add_epi32( a1, delta ), ICV_RESIZE_SHIFT*2 );
+        a0 = _mm_packs_epi32( a0, a1 );
+        _mm_storel_epi64( (__m128i*)(dst + x), _mm_packus_epi16( a0, a0 ));
+    }
+
+    return x;
+}
+
+
+static int ICV_TARGET_AVX2
+icvResizeBlend_8u_avx2( const int* row0, const int* row1, uchar* dst,
+                        int width, int y_alpha )
+{
+    const __m256i ya = _mm256_set1_epi32( y_alpha );
+    const __m256i delta = _mm256_set1_epi32( 1 << (ICV_RESIZE_SHIFT*2 - 1) );
+    int x = 0;
+
+    for( ; x <= width - 8; x += 8 )
+    {
+        __m256i a = _mm256_loadu_si256( (const __m256i*)(row0 + x) );
+        __m256i b = _mm256_loadu_si256( (const __m256i*)(row1 + x) );
+        __m128i t;
+
+        a = _mm256_add_epi32( _mm256_slli_epi32( a, ICV_RESIZE_SHIFT ),
+                              _mm256_mullo_epi32( _mm256_sub_epi32( b, a ), ya ));
+        a = _mm256_srai_epi32( _mm256_add_epi32( a, delta ), ICV_RESIZE_SHIFT*2 );
+        t = _mm_packs_epi32( _mm256_castsi256_si128( a ),
+                             _mm256_extracti128_si256( a, 1 ));
+        _mm_storel_epi64( (__m128i*)(dst + x), _mm_packus_epi16( t, t ));
+    }
+
+    return x;
+}
+
+ICV_DEF_SIMD_RESIZE_BILINEAR( sse41, ICV_TARGET_SSE4_1, icvResizeBlend_8u_sse41 )
+ICV_DEF_SIMD_RESIZE_BILINEAR( avx2, ICV_TARGET_AVX2, icvResizeBlend_8u_avx2 )
+
+
+/****************************************************************************************\
+*                            Gaussian pyramid down, 8u C1                                *
+\****************************************************************************************/
+
+/*
+   Same row buffering and border handling as icvPyrDownG5x5_8u in
+   cvpyramids.cpp; the interior of both the horizontal and the vertical
+   1-4-6-4-1 passes is done 4 and 8 columns at a time.
+*/
+#define  ICV_PD_SZ  5
+#define  ICV_PD_FILTER( x0, x1, x2, x3, x4 ) ((x2)*6+((x1)+(x3))*4+(x0)+(x4))
+#define  ICV_PD_LT(x0,x1,x2)                 ((x0)*6 + (x1)*8 + (x2)*2)
+#define  ICV_PD_RB(x0,x1,x2,x3)              ((x0) + ((x1) + (x3))*4 + (x2)*7)
+#define  ICV_PD_SINGULAR(x0,x1)              (((x0) + (x1))*8)
+#define  ICV_PD_SCALE(x)                     (((x) + (1<<7)) >> 8)
+
+static CvStatus CV_STDCALL ICV_TARGET_SSE2
+icvPyrDown_Gauss5x5_8u_C1R_sse2( const uchar* src, int srcstep, uchar* dst,
+                                 int dststep, CvSize size, void* buf )
+{
+    const __m128i z = _mm_setzero_si128();
+    const __m128i lomask = _mm_set1_epi16( 0xff );
+    const __m128i delta = _mm_set1_epi32( 1 << 7 );
+    int* buffer = (int*)buf;
+    int* rows[ICV_PD_SZ];
+    int y, top_row = 0;
+    int Wd = size.width/2;
+    int buffer_step = Wd;
+    int pd_sz = (ICV_PD_SZ + 1)*buffer_step;
+    int fst = 0, lst = size.height <= ICV_PD_SZ/2 ? size.height : ICV_PD_SZ/2 + 1;
+
+    for( y = 0; y < size.height; y += 2, dst += dststep )
+    {
+        int x, y1, k = top_row;
+        int *row0, *row1, *row2, *row3, *row4;
+
+        for( y1 = 0; y1 < ICV_PD_SZ; y1++ )
+        {
+            rows[y1] = buffer + k;
+            k += buffer_step;
+            k &= k < pd_sz ? -1 : 0;
+        }
+
+        row0 = rows[0]; row1 = rows[1]; row2 = rows[2]; row3 = rows[3]; row4 = rows[4];
+
+        /* horizontal pass over the newly needed source rows */
+        if( size.width > ICV_PD_SZ/2 )
+            for( y1 = fst; y1 < lst; y1++, src += srcstep )
+            {
+                int* row = rows[y1];
+
+                row[0]    = ICV_PD_LT( src[0], src[1], src[2] );
+                row[Wd-1] = ICV_PD_RB( src[Wd*2-4], src[Wd*2-3],
+                                       src[Wd*2-2], src[Wd*2-1] );
+
+                /* 16 source bytes at 2x-2 give even/odd 16-bit lanes for 4 outputs */
+                for( x = 1; x <= Wd - 7; x += 4 )
+                {
+                    __m128i v = _mm_loadu_si128( (const __m128i*)(src + 2*x - 2) );
+                    __m128i e = _mm_and_si128( v, lomask );
+                    __m128i o = _mm_srli_epi16( v, 8 );
+                    __m128i e1 = _mm_srli_si128( e, 2 ), e2 = _mm_srli_si128( e, 4 );
+                    __m128i o1 = _mm_srli_si128( o, 2 );
+                    __m128i s = _mm_add_epi16( _mm_add_epi16( e, e2 ),
+                                _mm_slli_epi16( _mm_add_epi16( o, o1 ), 2 ));
+                    s = _mm_add_epi16( s, _mm_add_epi16( _mm_slli_epi16( e1, 2 ),
+                                                         _mm_slli_epi16( e1, 1 )));
+                    _mm_storeu_si128( (__m128i*)(row + x), _mm_unpacklo_epi16( s, z ));
+                }
+
+                for( ; x < Wd - 1; x++ )
+                    row[x] = ICV_PD_FILTER( src[2*x-2], src[2*x-1], src[2*x],
+                                            src[2*x+1], src[2*x+2] );
+            }
+        else
+            for( y1 = fst; y1 < lst; y1++, src += srcstep )
+                rows[y1][0] = ICV_PD_SINGULAR( src[0], src[1] );
+
+        /* vertical pass */
+        if( y > 0 )
+        {
+            if( y < size.height - ICV_PD_SZ/2 )
+            {
+                for( x = 0; x <= Wd - 8; x += 8 )
+                {
+                    __m128i r[2];
+                    int j;
+
+                    for( j = 0; j < 2; j++ )
+                    {
+                        int xj = x + j*4;
+                        __m128i a0 = _mm_loadu_si128( (const __m128i*)(row0 + xj) );
+                        __m128i a1 = _mm_loadu_si128( (const __m128i*)(row1 + xj) );
+                        __m128i a2 = _mm_loadu_si128( (const __m128i*)(row2 + xj) );
+                        __m128i a3 = _mm_loadu_si128( (const __m128i*)(row3 + xj) );
+                        __m128i a4 = _mm_loadu_si128( (const __m128i*)(row4 + xj) );
+                        __m128i s = _mm_add_epi32( _mm_add_epi32( a0, a4 ),
+                                    _mm_slli_epi32( _mm_add_epi32( a1, a3 ), 2 ));
+                        s = _mm_add_epi32( s, _mm_add_epi32( _mm_slli_epi32( a2, 2 ),
+                                                             _mm_slli_epi32( a2, 1 )));
+                        r[j] = _mm_srai_epi32( _mm_add_epi32( s, delta ), 8 );
+                    }
+
+                    r[0] = _mm_packs_epi32( r[0], r[1] );
+                    _mm_storel_epi64( (__m128i*)(dst + x), _mm_packus_epi16( r[0], r[0] ));
+                }
+
+                for( ; x < Wd; x++ )
+                    dst[x] = (uchar)ICV_PD_SCALE( ICV_PD_FILTER( row0[x], row1[x],
+                                                      row2[x], row3[x], row4[x] ));
+                top_row += 2*buffer_step;
+                top_row &= top_row < pd_sz ? -1 : 0;
+            }
+            else /* bottom */
+                for( x = 0; x < Wd; x++ )
+                    dst[x] = (uchar)ICV_PD_SCALE( ICV_PD_RB( row0[x], row1[x],
+                                                             row2[x], row3[x] ));
+        }
+        else
+        {
+            if( size.height > ICV_PD_SZ/2 ) /* top */
+            {
+                for( x = 0; x < Wd; x++ )
+                    dst[x] = (uchar)ICV_PD_SCALE( ICV_PD_LT( row0[x], row1[x], row2[x] ));
+            }
+            else
+            {
+                for( x = 0; x < Wd; x++ )
+                    dst[x] = (uchar)ICV_PD_SCALE( ICV_PD_SINGULAR( row0[x], row1[x] ));
+            }
+            fst = ICV_PD_SZ - 2;
+        }
+
+        lst = y + 2 + ICV_PD_SZ/2 < size.height ? ICV_PD_SZ : size.height - y;
+    }
+
+    return CV_OK;
+}
+
+
+/****************************************************************************************\
+*                                  Separable smoothing                                   *
+\****************************************************************************************/
+
+/* The generic code accumulates each output in the same order, one multiply
+   and one add at a time, so the vector versions match it exactly (the
+   "avx2" target does not enable FMA contraction). */
+
+CV_INLINE ICV_TARGET_SSE2 void icvStore8u_sse2( uchar* dst, __m128 v )
+{
+    __m128i t = _mm_cvttps_epi32( v );
+    int bytes;
+    t = _mm_packs_epi32( t, t );
+    bytes = _mm_cvtsi128_si32( _mm_packus_epi16( t, t ));
+    memcpy( dst, &bytes, 4 );
+}
+
+CV_INLINE ICV_TARGET_AVX2 void icvStore8u_avx2( uchar* dst, __m256 v )
+{
+    __m256i t = _mm256_cvttps_epi32( v );
+    __m128i s = _mm_packs_epi32( _mm256_castsi256_si128( t ), _mm256_extracti128_si256( t, 1 ));
+    _mm_storel_epi64( (__m128i*)dst, _mm_packus_epi16( s, s ));
+}
+
+#define ICV_DEF_SIMD_SEP_SMOOTH( isa, target, vtype, vsize, load, store,          \
+                                 add, sub, mul, set1, store8u )                   \
+static CvStatus CV_STDCALL target                                                 \
+icvFilterRow_32f_CnR_##isa( const float* src, float* dst, int len,                \
+                            int cn, const float* kernel, int ksize )              \
+{                                                                                 \
+    int i = 0, k;                                                                 \
+                                                                                  \
+    for( ; i <= len - vsize; i += vsize )                                         \
+    {                                                                             \
+        const float* s = src + i;                                                 \
+        vtype t = mul( set1( kernel[0] ), load( s ));                             \
+                                                                                  \
+        for( k = 1; k < ksize; k++ )                                              \
+            t = add( t, mul( set1( kernel[k] ), load( s + k*cn )));               \
+        store( dst + i, t );                                                      \
+    }                                                                             \
+                                                                                  \
+    for( ; i < len; i++ )                                                         \
+    {                                                                             \
+        const float* s = src + i;                                                 \
+        float t = kernel[0]*s[0];                                                 \
+                                                                                  \
+        for( k = 1; k < ksize; k++ )                                              \
+            t += kernel[k]*s[k*cn];                                               \
+        dst[i] = t;                                                               \
+    }                                                                             \
+                                                                                  \
+    return CV_OK;                                                                 \
+}                                                                                 \
+                                                                                  \
+static CvStatus CV_STDCALL target                                                 \
+icvFilterCol_32f_C1R_##isa( const float** rows, float* dst, int len,              \
+                            const float* kernel, int ksize,                       \
+                            float scale, float delta )                            \
+{                                                                                 \
+    vtype vscale = set1( scale ), vdelta = set1( delta );                         \
+    int i = 0, k;                                                                 \
+                                                                                  \
+    for( ; i <= len - vsize; i += vsize )                                         \
+    {                                                                             \
+        vtype t = mul( set1( kernel[0] ), load( rows[0] + i ));                   \
+                                                                                  \
+        for( k = 1; k < ksize; k++ )                                              \
+            t = add( t, mul( set1( kernel[k] ), load( rows[k] + i )));            \
+        store( dst + i, add( mul( t, vscale ), vdelta ));                         \
+    }                                                                             \
+                                                                                  \
+    for( ; i < len; i++ )                                                         \
+    {                                                                             \
+        float t = kernel[0]*rows[0][i];                                           \
+                                                                                  \
+        for( k = 1; k < ksize; k++ )                                              \
+            t += kernel[k]*rows[k][i];                                            \
+        dst[i] = t*scale + delta;                                                 \
+    }                                                                             \
+                                                                                  \
+    return CV_OK;                                                                 \
+}                                                                                 \
+                                                                                  \
+static CvStatus CV_STDCALL target                                                 \
+icvFilterCol_32f8u_C1R_##isa( const float** rows, uchar* dst, int len,            \
+                              const float* kernel, int ksize,                     \
+                              float scale, float delta )                          \
+{                                                                                 \
+    vtype vscale = set1( scale ), vdelta = set1( delta );                         \
+    int i = 0, k;                                                                 \
+                                                                                  \
+    for( ; i <= len - vsize; i += vsize )                                         \
+    {                                                                             \
+        vtype t = mul( set1( kernel[0] ), load( rows[0] + i ));                   \
+                                                                                  \
+        for( k = 1; k < ksize; k++ )                                              \
+            t = add( t, mul( set1( kernel[k] ), load( rows[k] + i )));            \
+        store8u( dst + i, add( mul( t, vscale ), vdelta ));                       \
+    }                                                                             \
+                                                                                  \
+    for( ; i < len; i++ )                                                         \
+    {                                                                             \
+        float t = kernel[0]*rows[0][i];                                           \
+        int it;                                                                   \
+                                                                                  \
+        for( k = 1; k < ksize; k++ )                                              \
+            t += kernel[k]*rows[k][i];                                            \
+        it = (int)(t*scale + delta);                                              \
+        dst[i] = CV_CAST_8U( it );                                                \
+    }                                                                             \
+                                                                                  \
+    return CV_OK;                                                                 \
+}                                                                                 \
+                                                                                  \
+static CvStatus CV_STDCALL target                                                 \
+icvSumCol_32f_C1R_##isa( float* sum, const float* add_row, const float* sub_row,  \
+                         float* dst, int len, float scale, float delta )          \
+{                                                                                 \
+    vtype vscale = set1( scale ), vdelta = set1( delta );                         \
+    int i = 0;                                                                    \
+                                                                                  \
+    for( ; i <= len - vsize; i += vsize )                                         \
+    {                                                                             \
+        vtype t = load( sum + i );                                                \
+        if( add_row )                                                             \
+        {                                                                         \
+            t = sub( add( t, load( add_row + i )), load( sub_row + i ));          \
+            store( sum + i, t );                                                  \
+        }                                                                         \
+        store( dst + i, add( mul( t, vscale ), vdelta ));                         \
+    }                                                                             \
+                                                                                  \
+    for( ; i < len; i++ )                                                         \
+    {                                                                             \
+        if( add_row )                                                             \
+            sum[i] = sum[i] + add_row[i] - sub_row[i];                            \
+        dst[i] = sum[i]*scale + delta;                                            \
+    }                                                                             \
+                                                                                  \
+    return CV_OK;                                                                 \
+}                                                                                 \
+                                                                                  \
+static CvStatus CV_STDCALL target                                                 \
+icvSumCol_32f8u_C1R_##isa( float* sum, const float* add_row, const float* sub_row,\
+                           uchar* dst, int len, float scale, float delta )        \
+{                                                                                 \
+    vtype vscale = set1( scale ), vdelta = set1( delta );                         \
+    int i = 0;                                                                    \
+                                                                                  \
+    for( ; i <= len - vsize; i += vsize )                                         \
+    {                                                                             \
+        vtype t = load( sum + i );                                                \
+        if( add_row )                                                             \
+        {                                                                         \
+            t = sub( add( t, load( add_row + i )), load( sub_row + i ));          \
+            store( sum + i, t );                                                  \
+        }                                                                         \
+        store8u( dst + i, add( mul( t, vscale ), vdelta ));                       \
+    }                                                                             \
+                                                                                  \
+    for( ; i < len; i++ )                                                         \
+    {                                                                             \
+        int it;                                                                   \
+        if( add_row )                                                             \
+            sum[i] = sum[i] + add_row[i] - sub_row[i];                            \
+        it = (int)(sum[i]*scale + delta);                                         \
+        dst[i] = CV_CAST_8U( it );                                                \
+    }                                                                             \
+                                                                                  \
+    return CV_OK;                                                                 \
+}
+
+ICV_DEF_SIMD_SEP_SMOOTH( sse2, ICV_TARGET_SSE2, __m128, 4, _mm_loadu_ps, _mm_storeu_ps,
+                         _mm_add_ps, _mm_sub_ps, _mm_mul_ps, _mm_set1_ps, icvStore8u_sse2 )
+ICV_DEF_SIMD_SEP_SMOOTH( avx2, ICV_TARGET_AVX2, __m256, 8, _mm256_loadu_ps, _mm256_storeu_ps,
+                         _mm256_add_ps, _mm256_sub_ps, _mm256_mul_ps, _mm256_set1_ps,
+                         icvStore8u_avx2 )
+
+#undef ICV_DEF_SIMD_SEP_SMOOTH
+
+
+/****************************************************************************************\
+*                            Morphology (running min and max)                            *
+\****************************************************************************************/
+
+/* minps/maxps return the second operand unless the first compares less
+   (greater), which is exactly ICV_MORPH_MIN/MAX in cvmorph.cpp */
+#define ICV_SIMD_MORPH_MIN( a, b )  ((a) < (b) ? (a) : (b))
+#define ICV_SIMD_MORPH_MAX( a, b )  ((a) > (b) ? (a) : (b))
+
+#define ICV_DEF_SIMD_MORPH_RUN( name, flavor, arrtype, isa, target, vtype, vsize,      \
+                                load, store, vop, sop )                                 \
+static CvStatus CV_STDCALL target                                                       \
+icv##name##Row_##flavor##_CnR_##isa( const arrtype* src, arrtype* dst, int len,         \
+                                     int cn, int ksize )                                \
+{                                                                                       \
+    int i = 0, k;                                                                       \
+                                                                                        \
+    for( ; i <= len - vsize; i += vsize )                                               \
+    {                                                                                   \
+        const arrtype* s = src + i;                                                     \
+        vtype t = load( (const vtype*)s );                                              \
+                                                                                        \
+        for( k = 1; k < ksize; k++ )                                                    \
+            t = vop( t, load( (const vtype*)(s + k*cn) ));                              \
+        store( (vtype*)(dst + i), t );                                                  \
+    }                                                                                   \
+                                                                                        \
+    for( ; i < len; i++ )                                                               \
+    {                                                                                   \
+        const arrtype* s = src + i;                                                     \
+        arrtype t = s[0];                                                               \
+                                                                                        \
+        for( k = 1; k < ksize; k++ )                                                    \
+            t = sop( t, s[k*cn] );                                                      \
+        dst[i] = t;                                                                     \
+    }                                                                                   \
+                                                                                        \
+    return CV_OK;                                                                       \
+}                                                                                       \
+                                                                                        \
+static CvStatus CV_STDCALL target                                                       \
+icv##name##Vec_##flavor##_##isa( const arrtype* src1, const arrtype* src2,              \
+                                 arrtype* dst, int len )                                \
+{                                                                                       \
+    int i = 0;                                                                          \
+                                                                                        \
+    for( ; i <= len - vsize; i += vsize )                                               \
+        store( (vtype*)(dst + i), vop( load( (const vtype*)(src1 + i) ),                \
+                                       load( (const vtype*)(src2 + i) )));              \
+                                                                                        \
+    for( ; i < len; i++ )                                                               \
+        dst[i] = sop( src1[i], src2[i] );                                               \
+                                                                                        \
+    return CV_OK;                                                                       \
+}
+
+#define ICV_SIMD_LOADU_PS( p )      _mm_loadu_ps( (const float*)(p) )
+#define ICV_SIMD_STOREU_PS( p, v )  _mm_storeu_ps( (float*)(p), v )
+#define ICV_SIMD_LOADU_PS256( p )      _mm256_loadu_ps( (const float*)(p) )
+#define ICV_SIMD_STOREU_PS256( p, v )  _mm256_storeu_ps( (float*)(p), v )
+
+ICV_DEF_SIMD_MORPH_RUN( Min, 8u, uchar, sse2, ICV_TARGET_SSE2, __m128i, 16,
+                        _mm_loadu_si128, _mm_storeu_si128, _mm_min_epu8, ICV_SIMD_MORPH_MIN )
+ICV_DEF_SIMD_MORPH_RUN( Max, 8u, uchar, sse2, ICV_TARGET_SSE2, __m128i, 16,
+                        _mm_loadu_si128, _mm_storeu_si128, _mm_max_epu8, ICV_SIMD_MORPH_MAX )
+ICV_DEF_SIMD_MORPH_RUN( Min, 32f, float, sse2, ICV_TARGET_SSE2, __m128, 4,
+                        ICV_SIMD_LOADU_PS, ICV_SIMD_STOREU_PS, _mm_min_ps, ICV_SIMD_MORPH_MIN )
+ICV_DEF_SIMD_MORPH_RUN( Max, 32f, float, sse2, ICV_TARGET_SSE2, __m128, 4,
+                        ICV_SIMD_LOADU_PS, ICV_SIMD_STOREU_PS, _mm_max_ps, ICV_SIMD_MORPH_MAX )
+
+ICV_DEF_SIMD_MORPH_RUN( Min, 8u, uchar, avx2, ICV_TARGET_AVX2, __m256i, 32,
+                        _mm256_loadu_si256, _mm256_storeu_si256, _mm256_min_epu8,
+                        ICV_SIMD_MORPH_MIN )
+ICV_DEF_SIMD_MORPH_RUN( Max, 8u, uchar, avx2, ICV_TARGET_AVX2, __m256i, 32,
+                        _mm256_loadu_si256, _mm256_storeu_si256, _mm256_max_epu8,
+                        ICV_SIMD_MORPH_MAX )
+ICV_DEF_SIMD_MORPH_RUN( Min, 32f, float, avx2, ICV_TARGET_AVX2, __m256, 8,
+                        ICV_SIMD_LOADU_PS256, ICV_SIMD_STOREU_PS256, _mm256_min_ps,
+                        ICV_SIMD_MORPH_MIN )
+ICV_DEF_SIMD_MORPH_RUN( Max, 32f, float, avx2, ICV_TARGET_AVX2, __m256, 8,
+                        ICV_SIMD_LOADU_PS256, ICV_SIMD_STOREU_PS256, _mm256_max_ps,
+                        ICV_SIMD_MORPH_MAX )
+
+#undef ICV_DEF_SIMD_MORPH_RUN
+
+
+/****************************************************************************************\
+*                          Block matching stereo (SAD column sums)                       *
+\****************************************************************************************/
+
+/* the 16-bit sums wrap exactly as the generic code's (ushort) cast does */
+static CvStatus CV_STDCALL ICV_TARGET_SSE2
+icvUpdateSADCol_8u16u_C1R_sse2( const uchar* addl, const uchar* addr,
+                                const uchar* subl, const uchar* subr,
+                                ushort* sum, int len )
+{
+    __m128i z = _mm_setzero_si128();
+    int i = 0;
+
+    for( ; i <= len - 16; i += 16 )
+    {
+        __m128i a = ICV_SIMD_ABSDIFF_8U_SSE2( _mm_loadu_si128( (const __m128i*)(addl + i) ),
+                                              _mm_loadu_si128( (const __m128i*)(addr + i) ));
+        __m128i b = ICV_SIMD_ABSDIFF_8U_SSE2( _mm_loadu_si128( (const __m128i*)(subl + i) ),
+                                              _mm_loadu_si128( (const __m128i*)(subr + i) ));
+        __m128i s0 = _mm_loadu_si128( (const __m128i*)(sum + i) );
+        __m128i s1 = _mm_loadu_si128( (const __m128i*)(sum + i + 8) );
+
+        s0 = _mm_sub_epi16( _mm_add_epi16( s0, _mm_unpacklo_epi8( a, z )), _mm_unpacklo_epi8( b, z ));
+        s1 = _mm_sub_epi16( _mm_add_epi16( s1, _mm_unpackhi_epi8( a, z )), _mm_unpackhi_epi8( b, z ));
+        _mm_storeu_si128( (__m128i*)(sum + i), s0 );
+        _mm_storeu_si128( (__m128i*)(sum + i + 8), s1 );
+    }
+
+    for( ; i < len; i++ )
+        sum[i] = (ushort)(sum[i] + abs( addl[i] - addr[i] ) - abs( subl[i] - subr[i] ));
+
+    return CV_OK;
+}
+
+/* unpacklo/hi work within 128-bit lanes, so widen each half separately
+   to keep the sums in memory order */
+static CvStatus CV_STDCALL ICV_TARGET_AVX2
+icvUpdateSADCol_8u16u_C1R_avx2( const uchar* addl, const uchar* addr,
+                                const uchar* subl, const uchar* subr,
+                                ushort* sum, int len )
+{
+    int i = 0;
+
+    for( ; i <= len - 32; i += 32 )
+    {
+        __m256i a = ICV_SIMD_ABSDIFF_8U_AVX2( _mm256_loadu_si256( (const __m256i*)(addl + i) ),
+                                              _mm256_loadu_si256( (const __m256i*)(addr + i) ));
+        __m256i b = ICV_SIMD_ABSDIFF_8U_AVX2( _mm256_loadu_si256( (const __m256i*)(subl + i) ),
+                                              _mm256_loadu_si256( (const __m256i*)(subr + i) ));
+        __m256i s0 = _mm256_loadu_si256( (const __m256i*)(sum + i) );
+        __m256i s1 = _mm256_loadu_si256( (const __m256i*)(sum + i + 16) );
+
+        s0 = _mm256_sub_epi16( _mm256_add_epi16( s0,
+                 _mm256_cvtepu8_epi16( _mm256_castsi256_si128( a ))),
+                 _mm256_cvtepu8_epi16( _mm256_castsi256_si128( b )));
+        s1 = _mm256_sub_epi16( _mm256_add_epi16( s1,
+                 _mm256_cvtepu8_epi16( _mm256_extracti128_si256( a, 1 ))),
+                 _mm256_cvtepu8_epi16( _mm256_extracti128_si256( b, 1 )));
+        _mm256_storeu_si256( (__m256i*)(sum + i), s0 );
+        _mm256_storeu_si256( (__m256i*)(sum + i + 16), s1 );
+    }
+
+    for( ; i < len; i++ )
+        sum[i] = (ushort)(sum[i] + abs( addl[i] - addr[i] ) - abs( subl[i] - subr[i] ));
+
+    return CV_OK;
+}
+
+
+/****************************************************************************************\
+*                        Lucas-Kanade feature tracking (mismatch)                        *
+\****************************************************************************************/
+
+/* The generic code keeps 8 partial sums, element i going to partial sum i%8:
+   here lanes 0..3 and 4..7 of the accumulators.  The tail goes into the
+   same partial sums in scalar code, and they are added up in the generic
+   order. */
+CV_INLINE void
+icvLKMismatchFinish( const float* I, const float* J, const float* Ix, const float* Iy,
+                     int i, int len, float* sx, float* sy, float* b )
+{
+    int k;
+
+    for( k = 0; i < len; i++, k++ )
+    {
+        float t = I[i] - J[i];
+        sx[k] += t*Ix[i];
+        sy[k] += t*Iy[i];
+    }
+
+    b[0] = ((sx[0] + sx[4]) + (sx[2] + sx[6])) + ((sx[1] + sx[5]) + (sx[3] + sx[7]));
+    b[1] = ((sy[0] + sy[4]) + (sy[2] + sy[6])) + ((sy[1] + sy[5]) + (sy[3] + sy[7]));
+}
+
+static CvStatus CV_STDCALL ICV_TARGET_SSE2
+icvLKMismatch_32f_C1R_sse2( const float* I, const float* J, const float* Ix,
+                            const float* Iy, int len, float* b )
+{
+    __m128 sx0 = _mm_setzero_ps(), sx1 = sx0, sy0 = sx0, sy1 = sx0;
+    float sx[8], sy[8];
+    int i = 0;
+
+    for( ; i <= len - 8; i += 8 )
+    {
+        __m128 t0 = _mm_sub_ps( _mm_loadu_ps( I + i ), _mm_loadu_ps( J + i ));
+        __m128 t1 = _mm_sub_ps( _mm_loadu_ps( I + i + 4 ), _mm_loadu_ps( J + i + 4 ));
+
+        sx0 = _mm_add_ps( sx0, _mm_mul_ps( t0, _mm_loadu_ps( Ix + i )));
+        sx1 = _mm_add_ps( sx1, _mm_mul_ps( t1, _mm_loadu_ps( Ix + i + 4 )));
+        sy0 = _mm_add_ps( sy0, _mm_mul_ps( t0, _mm_loadu_ps( Iy + i )));
+        sy1 = _mm_add_ps( sy1, _mm_mul_ps( t1, _mm_loadu_ps( Iy + i + 4 )));
+    }
+
+    _mm_storeu_ps( sx, sx0 );
+    _mm_storeu_ps( sx + 4, sx1 );
+    _mm_storeu_ps( sy, sy0 );
+    _mm_storeu_ps( sy + 4, sy1 );
+    icvLKMismatchFinish( I, J, Ix, Iy, i, len, sx, sy, b );
+
+    return CV_OK;
+}
+
+static CvStatus CV_STDCALL ICV_TARGET_AVX2
+icvLKMismatch_32f_C1R_avx2( const float* I, const float* J, const float* Ix,
+                            const float* Iy, int len, float* b )
+{
+    __m256 sx0 = _mm256_setzero_ps(), sy0 = sx0;
+    float sx[8], sy[8];
+    int i = 0;
+
+    for( ; i <= len - 8; i += 8 )
+    {
+        __m256 t = _mm256_sub_ps( _mm256_loadu_ps( I + i ), _mm256_loadu_ps( J + i ));
+
+        sx0 = _mm256_add_ps( sx0, _mm256_mul_ps( t, _mm256_loadu_ps( Ix + i )));
+        sy0 = _mm256_add_ps( sy0, _mm256_mul_ps( t, _mm256_loadu_ps( Iy + i )));
+    }
+
+    _mm256_storeu_ps( sx, sx0 );
+    _mm256_storeu_ps( sy, sy0 );
+    icvLKMismatchFinish( I, J, Ix, Iy, i, len, sx, sy, b );
+
+    return CV_OK;
+}
+
+
+/****************************************************************************************\
+*                                Edge lines (3x3 Sobel row)                              *
+\****************************************************************************************/
+
+/* Integer arithmetic, so exact: |dx|, |dy| <= 1020 fit in 16 bits.  The
+   column sums s0 + 2*s1 + s2 at i-1 and i+1 give dx, the row sums of s0 and
+   s2 give dy.  Loads at i-1 and i+1 read src*[-1] .. src*[len], as allowed. */
+#define ICV_SOBEL3X3_ROW_SSE2( m, z )                                                 \
+    _mm_unpacklo_epi8( _mm_loadl_epi64( (const __m128i*)(m) ), z )
+
+static CvStatus CV_STDCALL ICV_TARGET_SSE2
+icvSobel3x3Row_8u16s_C1R_sse2( const uchar* src0, const uchar* src1, const uchar* src2,
+                               short* dx, short* dy, int len )
+{
+    __m128i z = _mm_setzero_si128();
+    int i = 0;
+
+    for( ; i <= len - 8; i += 8 )
+    {
+        __m128i a0 = ICV_SOBEL3X3_ROW_SSE2( src0 + i - 1, z );
+        __m128i b0 = ICV_SOBEL3X3_ROW_SSE2( src0 + i, z );
+        __m128i c0 = ICV_SOBEL3X3_ROW_SSE2( src0 + i + 1, z );
+        __m128i a1 = ICV_SOBEL3X3_ROW_SSE2( src1 + i - 1, z );
+        __m128i c1 = ICV_SOBEL3X3_ROW_SSE2( src1 + i + 1, z );
+        __m128i a2 = ICV_SOBEL3X3_ROW_SSE2( src2 + i - 1, z );
+        __m128i b2 = ICV_SOBEL3X3_ROW_SSE2( src2 + i, z );
+        __m128i c2 = ICV_SOBEL3X3_ROW_SSE2( src2 + i + 1, z );
+        __m128i l = _mm_add_epi16( _mm_add_epi16( a0, a2 ), _mm_add_epi16( a1, a1 ));
+        __m128i r = _mm_add_epi16( _mm_add_epi16( c0, c2 ), _mm_add_epi16( c1, c1 ));
+        __m128i t = _mm_add_epi16( _mm_add_epi16( a0, c0 ), _mm_add_epi16( b0, b0 ));
+        __m128i b = _mm_add_epi16( _mm_add_epi16( a2, c2 ), _mm_add_epi16( b2, b2 ));
+
+        _mm_storeu_si128( (__m128i*)(dx + i), _mm_sub_epi16( r, l ));
+        _mm_storeu_si128( (__m128i*)(dy + i), _mm_sub_epi16( b, t ));
+    }
+
+    for( ; i < len; i++ )
+    {
+        dx[i] = (short)(src0[i+1] - src0[i-1] + 2*(src1[i+1] - src1[i-1]) +
+                        src2[i+1] - src2[i-1]);
+        dy[i] = (short)(src2[i-1] + 2*src2[i] + src2[i+1] -
+                        (src0[i-1] + 2*src0[i] + src0[i+1]));
+    }
+
+    return CV_OK;
+}
+
+#undef ICV_SOBEL3X3_ROW_SSE2
+
+#define ICV_SOBEL3X3_ROW_AVX2( m )                                                    \
+    _mm256_cvtepu8_epi16( _mm_loadu_si128( (const __m128i*)(m) ))
+
+static CvStatus CV_STDCALL ICV_TARGET_AVX2
+icvSobel3x3Row_8u16s_C1R_avx2( const uchar* src0, const uchar* src1, const uchar* src2,
+                               short* dx, short* dy, int len )
+{
+    int i = 0;
+
+    for( ; i <= len - 16; i += 16 )
+    {
+        __m256i a0 = ICV_SOBEL3X3_ROW_AVX2( src0 + i - 1 );
+        __m256i b0 = ICV_SOBEL3X3_ROW_AVX2( src0 + i );
+        __m256i c0 = ICV_SOBEL3X3_ROW_AVX2( src0 + i + 1 );
+        __m256i a1 = ICV_SOBEL3X3_ROW_AVX2( src1 + i - 1 );
+        __m256i c1 = ICV_SOBEL3X3_ROW_AVX2( src1 + i + 1 );
+        __m256i a2 = ICV_SOBEL3X3_ROW_AVX2( src2 + i - 1 );
+        __m256i b2 = ICV_SOBEL3X3_ROW_AVX2( src2 + i );
+        __m256i c2 = ICV_SOBEL3X3_ROW_AVX2( src2 + i + 1 );
+        __m256i l = _mm256_add_epi16( _mm256_add_epi16( a0, a2 ), _mm256_add_epi16( a1, a1 ));
+        __m256i r = _mm256_add_epi16( _mm256_add_epi16( c0, c2 ), _mm256_add_epi16( c1, c1 ));
+        __m256i t = _mm256_add_epi16( _mm256_add_epi16( a0, c0 ), _mm256_add_epi16( b0, b0 ));
+        __m256i b = _mm256_add_epi16( _mm256_add_epi16( a2, c2 ), _mm256_add_epi16( b2, b2 ));
+
+        _mm256_storeu_si256( (__m256i*)(dx + i), _mm256_sub_epi16( r, l ));
+        _mm256_storeu_si256( (__m256i*)(dy + i), _mm256_sub_epi16( b, t ));
+    }
+
+    for( ; i < len; i++ )
+    {
+        dx[i] = (short)(src0[i+1] - src0[i-1] + 2*(src1[i+1] - src1[i-1]) +
+                        src2[i+1] - src2[i-1]);
+        dy[i] = (short)(src2[i-1] + 2*src2[i] + src2[i+1] -
+                        (src0[i-1] + 2*src0[i] + src0[i+1]));
+    }
+
+    return CV_OK;
+}
+
+#undef ICV_SOBEL3X3_ROW_AVX2
+
+
+/****************************************************************************************\
+*                                   Registration table                                   *
+\****************************************************************************************/
+
+#define ICV_SIMD_FUNC( name, isa, cpu )  { #name, (void*)name##_##isa, cpu },
+
+const CvSimdFuncDesc icvSimdFuncTab[] =
+{
+    ICV_SIMD_FUNC( icvAdd_8u_C1R, sse2, CV_CPU_SSE2 )
+    ICV_SIMD_FUNC( icvAdd_8u_C1R, avx2, CV_CPU_AVX2 )
+    ICV_SIMD_FUNC( icvSub_8u_C1R, sse2, CV_CPU_SSE2 )
+    ICV_SIMD_FUNC( icvSub_8u_C1R, avx2, CV_CPU_AVX2 )
+    ICV_SIMD_FUNC( icvAbsDiff_8u_C1R, sse2, CV_CPU_SSE2 )
+    ICV_SIMD_FUNC( icvAbsDiff_8u_C1R, avx2, CV_CPU_AVX2 )
+    ICV_SIMD_FUNC( icvAdd_32f_C1R, sse2, CV_CPU_SSE2 )
+    ICV_SIMD_FUNC( icvAdd_32f_C1R, avx2, CV_CPU_AVX2 )
+    ICV_SIMD_FUNC( icvSub_32f_C1R, sse2, CV_CPU_SSE2 )
+    ICV_SIMD_FUNC( icvSub_32f_C1R, avx2, CV_CPU_AVX2 )
+    ICV_SIMD_FUNC( icvAbsDiff_32f_C1R, sse2, CV_CPU_SSE2 )
+    ICV_SIMD_FUNC( icvAbsDiff_32f_C1R, avx2, CV_CPU_AVX2 )
+    ICV_SIMD_FUNC( icvCvt_BGR2GRAY_8u_C3C1R, sse41, CV_CPU_SSE4_1 )
+    ICV_SIMD_FUNC( icvResize_Bilinear_8u_C1R, sse41, CV_CPU_SSE4_1 )
+    ICV_SIMD_FUNC( icvResize_Bilinear_8u_C1R, avx2, CV_CPU_AVX2 )
+    ICV_SIMD_FUNC( icvPyrDown_Gauss5x5_8u_C1R, sse2, CV_CPU_SSE2 )
+    ICV_SIMD_FUNC( icvFilterRow_32f_CnR, sse2, CV_CPU_SSE2 )
+    ICV_SIMD_FUNC( icvFilterRow_32f_CnR, avx2, CV_CPU_AVX2 )
+    ICV_SIMD_FUNC( icvFilterCol_32f_C1R, sse2, CV_CPU_SSE2 )
+    ICV_SIMD_FUNC( icvFilterCol_32f_C1R, avx2, CV_CPU_AVX2 )
+    ICV_SIMD_FUNC( icvFilterCol_32f8u_C1R, sse2, CV_CPU_SSE2 )
+    ICV_SIMD_FUNC( icvFilterCol_32f8u_C1R, avx2, CV_CPU_AVX2 )
+    ICV_SIMD_FUNC( icvSumCol_32f_C1R, sse2, CV_CPU_SSE2 )
+    ICV_SIMD_FUNC( icvSumCol_32f_C1R, avx2, CV_CPU_AVX2 )
+    ICV_SIMD_FUNC( icvSumCol_32f8u_C1R, sse2, CV_CPU_SSE2 )
+    ICV_SIMD_FUNC( icvSumCol_32f8u_C1R, avx2, CV_CPU_AVX2 )
+    ICV_SIMD_FUNC( icvMinRow_8u_CnR, sse2, CV_CPU_SSE2 )
+    ICV_SIMD_FUNC( icvMinRow_8u_CnR, avx2, CV_CPU_AVX2 )
+    ICV_SIMD_FUNC( icvMinVec_8u, sse2, CV_CPU_SSE2 )
+    ICV_SIMD_FUNC( icvMinVec_8u, avx2, CV_CPU_AVX2 )
+    ICV_SIMD_FUNC( icvMinRow_32f_CnR, sse2, CV_CPU_SSE2 )
+    ICV_SIMD_FUNC( icvMinRow_32f_CnR, avx2, CV_CPU_AVX2 )
+    ICV_SIMD_FUNC( icvMinVec_32f, sse2, CV_CPU_SSE2 )
+    ICV_SIMD_FUNC( icvMinVec_32f, avx2, CV_CPU_AVX2 )
+    ICV_SIMD_FUNC( icvMaxRow_8u_CnR, sse2, CV_CPU_SSE2 )
+    ICV_SIMD_FUNC( icvMaxRow_8u_CnR, avx2, CV_CPU_AVX2 )
+    ICV_SIMD_FUNC( icvMaxVec_8u, sse2, CV_CPU_SSE2 )
+    ICV_SIMD_FUNC( icvMaxVec_8u, avx2, CV_CPU_AVX2 )
+    ICV_SIMD_FUNC( icvMaxRow_32f_CnR, sse2, CV_CPU_SSE2 )
+    ICV_SIMD_FUNC( icvMaxRow_32f_CnR, avx2, CV_CPU_AVX2 )
+    ICV_SIMD_FUNC( icvMaxVec_32f, sse2, CV_CPU_SSE2 )
+    ICV_SIMD_FUNC( icvMaxVec_32f, avx2, CV_CPU_AVX2 )
+    ICV_SIMD_FUNC( icvUpdateSADCol_8u16u_C1R, sse2, CV_CPU_SSE2 )
+    ICV_SIMD_FUNC( icvUpdateSADCol_8u16u_C1R, avx2, CV_CPU_AVX2 )
+    ICV_SIMD_FUNC( icvLKMismatch_32f_C1R, sse2, CV_CPU_SSE2 )
+    ICV_SIMD_FUNC( icvLKMismatch_32f_C1R, avx2, CV_CPU_AVX2 )
+    ICV_SIMD_FUNC( icvSobel3x3Row_8u16s_C1R, sse2, CV_CPU_SSE2 )
+    ICV_SIMD_FUNC( icvSobel3x3Row_8u16s_C1R, avx2, CV_CPU_AVX2 )
+    { 0, 0, 0 }
+};
+
+#else
+
+const CvSimdFuncDesc icvSimdFuncTab[] =
+{
+    { 0, 0, 0 }
+};
+
+#endif /* CV_SIMD_DISPATCH */
+
+/* End of file. */
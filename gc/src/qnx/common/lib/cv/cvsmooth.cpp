@@ -2975,6 +2975,24 @@ cvSmooth( const void* srcarr, void* dstarr,
         param2 += param2 == 0;
     }
 
+    /* box and Gaussian filters of 8u and 32f images go through the separable
+       filter (cvsmoothsep.cpp), with a state kept per thread between calls */
+    if( (smoothtype == CV_BLUR || smoothtype == CV_GAUSSIAN) &&
+        (depth == CV_8U || depth == CV_32F) && CV_MAT_CN(type) != 2 &&
+        CV_ARE_TYPES_EQ( src, dst ))
+    {
+        CvSmoothState* sep_state = 0;
+
+        CV_CALL( sep_state = icvGetSmoothCache( smoothtype, param1,
+                                                size.height == 1 ? 1 : param2,
+                                                type, size.width ));
+        if( sep_state )
+        {
+            CV_CALL( cvSmoothWithState( src, dst, sep_state ));
+            EXIT;
+        }
+    }
+
     if( smoothtype <= CV_GAUSSIAN )
     {
         IPPI_CALL( icvSmoothInitAlloc( src->width, depth < CV_32F ? cv32s : cv32f,
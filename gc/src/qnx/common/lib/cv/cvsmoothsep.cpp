@@ -0,0 +1,732 @@
+/*
+//
+//  cvsmoothsep.cpp  -- separable box and Gaussian smoothing with reusable state
+//
+//  cvSmooth() used to build a CvFilterState (kernels plus a cyclic row
+//  buffer) on every call.  Here the kernels and all working rows live in a
+//  CvSmoothState that is built once and reused for every frame of the same
+//  type and width.  Each source row is converted to float, padded by border
+//  replication and filtered horizontally into a ring of ksize.height+1 rows;
+//  the vertical pass then combines the ring rows into one output row.  Both
+//  passes go through _ipcv.h primitives, which have SSE2/AVX2 versions in
+//  cvsimd.cpp.
+//
+//  For 8u images with apertures up to 7 the Gaussian uses the same integer
+//  kernels as before.  All intermediate sums are then integers below 2^24,
+//  so they are exact in float and the result is exactly the old
+//  (sum + 2^(n-1)) >> n.
+//
+//  With more than one thread the image is split into horizontal bands, each
+//  with its own ring buffer, and the bands are smoothed in parallel by
+//  worker threads owned by the state.
+//
+//  Team Overbot
+//  October, 2026
+//
+*/
+
+#include "_cv.h"
+
+#ifndef WIN32
+#include <pthread.h>
+#define ICV_SMOOTH_THREADS  1
+#else
+#define ICV_SMOOTH_THREADS  0
+#endif
+
+#define ICV_SMOOTH_MAX_THREADS  16
+
+/* wider box apertures are summed along the row with a running sum,
+   narrower ones by the (vectorized) row filter */
+#define ICV_SMOOTH_MAX_DIRECT_BOX  11
+
+/****************************************************************************************\
+*                               Row and column primitives                                *
+\****************************************************************************************/
+
+IPCVAPI_IMPL( CvStatus, icvFilterRow_32f_CnR, ( const float* src, float* dst, int len,
+                                                int cn, const float* kernel, int ksize ))
+{
+    int i, k;
+
+    for( i = 0; i < len; i++ )
+    {
+        const float* s = src + i;
+        float t = kernel[0]*s[0];
+
+        for( k = 1; k < ksize; k++ )
+            t += kernel[k]*s[k*cn];
+        dst[i] = t;
+    }
+
+    return CV_OK;
+}
+
+
+IPCVAPI_IMPL( CvStatus, icvFilterCol_32f_C1R, ( const float** rows, float* dst, int len,
+                                                const float* kernel, int ksize,
+                                                float scale, float delta ))
+{
+    int i, k;
+
+    for( i = 0; i < len; i++ )
+    {
+        float t = kernel[0]*rows[0][i];
+
+        for( k = 1; k < ksize; k++ )
+            t += kernel[k]*rows[k][i];
+        dst[i] = t*scale + delta;
+    }
+
+    return CV_OK;
+}
+
+
+IPCVAPI_IMPL( CvStatus, icvFilterCol_32f8u_C1R, ( const float** rows, uchar* dst, int len,
+                                                  const float* kernel, int ksize,
+                                                  float scale, float delta ))
+{
+    int i, k;
+
+    for( i = 0; i < len; i++ )
+    {
+        float t = kernel[0]*rows[0][i];
+        int it;
+
+        for( k = 1; k < ksize; k++ )
+            t += kernel[k]*rows[k][i];
+        it = (int)(t*scale + delta);
+        dst[i] = CV_CAST_8U( it );
+    }
+
+    return CV_OK;
+}
+
+
+IPCVAPI_IMPL( CvStatus, icvSumCol_32f_C1R, ( float* sum, const float* add, const float* sub,
+                                             float* dst, int len, float scale, float delta ))
+{
+    int i;
+
+    if( add )
+        for( i = 0; i < len; i++ )
+            sum[i] = sum[i] + add[i] - sub[i];
+
+    for( i = 0; i < len; i++ )
+        dst[i] = sum[i]*scale + delta;
+
+    return CV_OK;
+}
+
+
+IPCVAPI_IMPL( CvStatus, icvSumCol_32f8u_C1R, ( float* sum, const float* add, const float* sub,
+                                               uchar* dst, int len, float scale, float delta ))
+{
+    int i;
+
+    if( add )
+        for( i = 0; i < len; i++ )
+            sum[i] = sum[i] + add[i] - sub[i];
+
+    for( i = 0; i < len; i++ )
+    {
+        int it = (int)(sum[i]*scale + delta);
+        dst[i] = CV_CAST_8U( it );
+    }
+
+    return CV_OK;
+}
+
+
+/****************************************************************************************\
+*                                      Smoothing state                                   *
+\****************************************************************************************/
+
+/* working rows of one horizontal band */
+typedef struct CvSmoothBand
+{
+    float* pad;         /* source row as float, with ksize.width-1 replicated border pixels */
+    float** ring;       /* ksize.height+1 horizontally filtered rows */
+    const float** rows; /* the ksize.height rows under the aperture, top to bottom */
+    float* sum;         /* running column sums (box filter only) */
+}
+CvSmoothBand;
+
+struct CvSmoothState;
+
+typedef struct CvSmoothWorker
+{
+    struct CvSmoothState* state;
+    int idx;            /* band this worker smooths */
+}
+CvSmoothWorker;
+
+struct CvSmoothState
+{
+    int smoothtype;     /* CV_BLUR or CV_GAUSSIAN */
+    int type;           /* image type */
+    int max_width;
+    CvSize ksize;       /* aperture */
+    float* kx;          /* horizontal and vertical kernels (all ones for CV_BLUR) */
+    float* ky;
+    float scale;        /* output = sum*scale + delta */
+    float delta;
+    int nbands;         /* bands (= threads, including the caller) */
+    CvSmoothBand band[ICV_SMOOTH_MAX_THREADS];
+    void* buffer;       /* kernels and rows of all bands */
+
+    /* current job */
+    const uchar* src;
+    int srcstep;
+    uchar* dst;
+    int dststep;
+    CvSize size;
+
+#if ICV_SMOOTH_THREADS
+    int nworkers;       /* worker threads running (nbands - 1) */
+    CvSmoothWorker worker[ICV_SMOOTH_MAX_THREADS];
+    pthread_t thread[ICV_SMOOTH_MAX_THREADS];
+    pthread_mutex_t lock;
+    pthread_cond_t start_cond;
+    pthread_cond_t done_cond;
+    int generation;     /* incremented for each job */
+    int pending;        /* workers that have not finished the job */
+    int quit;
+#endif
+};
+
+
+/* builds one Gaussian kernel; returns the sum of the integer kernel used
+   for small apertures, or 0 if the kernel is normalized floating-point */
+static int
+icvSmoothGaussianKernel( int n, float* kernel )
+{
+    static const int small_gaussian_tab[][7] =
+    {
+        {1},
+        {1, 2, 1},
+        {1, 4, 6, 4, 1},
+        {2, 7, 14, 18, 14, 7, 2}
+    };
+    int i;
+
+    if( n <= 7 )
+    {
+        for( i = 0; i < n; i++ )
+            kernel[i] = (float)small_gaussian_tab[n>>1][i];
+        return n == 7 ? 64 : 1 << (n - 1);
+    }
+    else
+    {
+        /* the same kernel as icvSmoothInitAlloc() */
+        double sigma = (n/2 - 1)*0.3 + 0.8;
+        double scale = 0.39894228040143267793994605993438/sigma;
+        double scale2 = -0.5/(sigma*sigma);
+        double sum;
+
+        sum = kernel[n/2] = (float)scale;
+
+        for( i = 1; i < (n+1)/2; i++ )
+        {
+            kernel[n/2+i] = kernel[n/2-i] = (float)(exp(scale2*i*i)*scale);
+            sum += kernel[n/2+i]*2;
+        }
+
+        /* adjust endpoints to make sum = 1 */
+        kernel[0] = kernel[n-1] = (float)(kernel[0] + (1 - sum)*0.5);
+        return 0;
+    }
+}
+
+
+/* converts a source row to float, replicates the borders and filters it horizontally */
+static void
+icvSmoothRow( const CvSmoothState* state, float* pad,
+              const uchar* src, float* dst, int width )
+{
+    int cn = CV_MAT_CN( state->type );
+    int kw = state->ksize.width;
+    int len = width*cn, border = (kw/2)*cn;
+    float* p = pad + border;
+    int i;
+
+    if( CV_MAT_DEPTH( state->type ) == CV_8U )
+    {
+        for( i = 0; i < len; i++ )
+            p[i] = (float)src[i];
+    }
+    else
+        memcpy( p, src, len*sizeof(p[0]));
+
+    for( i = 0; i < border; i++ )
+    {
+        pad[i] = p[i % cn];
+        p[len + i] = p[len - cn + i % cn];
+    }
+
+    if( state->smoothtype == CV_GAUSSIAN || kw <= ICV_SMOOTH_MAX_DIRECT_BOX )
+    {
+        /* kx is all ones for the box filter */
+        icvFilterRow_32f_CnR( pad, dst, len, cn, state->kx, kw );
+    }
+    else
+    {
+        /* running sum along the row, one sum per channel */
+        for( i = 0; i < cn; i++ )
+        {
+            float t = 0;
+            int k;
+
+            for( k = 0; k < kw; k++ )
+                t += pad[i + k*cn];
+            dst[i] = t;
+        }
+
+        for( ; i < len; i++ )
+            dst[i] = dst[i - cn] + pad[i - cn + kw*cn] - pad[i - cn];
+    }
+}
+
+
+/* smooths rows y0..y1-1 of the current job using the working rows of one band */
+static void
+icvSmoothBand( const CvSmoothState* state, CvSmoothBand* band, int y0, int y1 )
+{
+    int kh = state->ksize.height, ay = kh/2;
+    int width = state->size.width, height = state->size.height;
+    int len = width*CV_MAT_CN( state->type );
+    int is_8u = CV_MAT_DEPTH( state->type ) == CV_8U;
+    int nring = kh + 1;
+    int first = y0 - ay;    /* first source row of the band, before border clipping */
+    int next = first;       /* next source row to filter */
+    int y, k, i;
+
+    for( y = y0; y < y1; y++ )
+    {
+        uchar* dst = state->dst + y*state->dststep;
+
+        /* filter the source rows entering the aperture */
+        for( ; next <= y + ay; next++ )
+        {
+            int sy = next < 0 ? 0 : next >= height ? height - 1 : next;
+            icvSmoothRow( state, band->pad, state->src + sy*state->srcstep,
+                          band->ring[(next - first) % nring], width );
+        }
+
+        for( k = 0; k < kh; k++ )
+            band->rows[k] = band->ring[(y - ay + k - first) % nring];
+
+        if( state->smoothtype == CV_GAUSSIAN )
+        {
+            if( is_8u )
+                icvFilterCol_32f8u_C1R( band->rows, dst, len, state->ky, kh,
+                                        state->scale, state->delta );
+            else
+                icvFilterCol_32f_C1R( band->rows, (float*)dst, len, state->ky, kh,
+                                      state->scale, state->delta );
+        }
+        else
+        {
+            const float* add = 0;
+            const float* sub = 0;
+
+            if( y == y0 )
+            {
+                memcpy( band->sum, band->rows[0], len*sizeof(band->sum[0]));
+                for( k = 1; k < kh; k++ )
+                    for( i = 0; i < len; i++ )
+                        band->sum[i] += band->rows[k][i];
+            }
+            else
+            {
+                /* the row that left the aperture is still in the ring */
+                add = band->rows[kh-1];
+                sub = band->ring[(y - ay - 1 - first) % nring];
+            }
+
+            if( is_8u )
+                icvSumCol_32f8u_C1R( band->sum, add, sub, dst, len,
+                                     state->scale, state->delta );
+            else
+                icvSumCol_32f_C1R( band->sum, add, sub, (float*)dst, len,
+                                   state->scale, state->delta );
+        }
+    }
+}
+
+
+/* smooths band idx of the current job split into nbands bands */
+static void
+icvSmoothRunBand( CvSmoothState* state, int idx, int nbands )
+{
+    int height = state->size.height;
+    int y0 = height*idx/nbands, y1 = height*(idx + 1)/nbands;
+
+    if( y0 < y1 )
+        icvSmoothBand( state, state->band + idx, y0, y1 );
+}
+
+
+#if ICV_SMOOTH_THREADS
+
+static void*
+icvSmoothWorkerProc( void* arg )
+{
+    CvSmoothWorker* worker = (CvSmoothWorker*)arg;
+    CvSmoothState* state = worker->state;
+    int seen = 0;
+
+    for( ;; )
+    {
+        int quit;
+
+        pthread_mutex_lock( &state->lock );
+        while( state->generation == seen && !state->quit )
+            pthread_cond_wait( &state->start_cond, &state->lock );
+        seen = state->generation;
+        quit = state->quit;
+        pthread_mutex_unlock( &state->lock );
+
+        if( quit )
+            break;
+
+        icvSmoothRunBand( state, worker->idx, state->nbands );
+
+        pthread_mutex_lock( &state->lock );
+        if( --state->pending == 0 )
+            pthread_cond_signal( &state->done_cond );
+        pthread_mutex_unlock( &state->lock );
+    }
+
+    return 0;
+}
+
+#endif
+
+
+/* frees the state without touching the error context; also used from
+   the thread-specific data destructor */
+static void
+icvFreeSmoothState( CvSmoothState* state )
+{
+    if( !state )
+        return;
+
+#if ICV_SMOOTH_THREADS
+    if( state->nworkers > 0 )
+    {
+        int i;
+
+        pthread_mutex_lock( &state->lock );
+        state->quit = 1;
+        pthread_cond_broadcast( &state->start_cond );
+        pthread_mutex_unlock( &state->lock );
+
+        for( i = 0; i < state->nworkers; i++ )
+            pthread_join( state->thread[i], 0 );
+    }
+
+    pthread_cond_destroy( &state->done_cond );
+    pthread_cond_destroy( &state->start_cond );
+    pthread_mutex_destroy( &state->lock );
+#endif
+
+    cvFree( &state->buffer );
+    cvFree( (void**)&state );
+}
+
+
+CV_IMPL CvSmoothState*
+cvCreateSmoothState( int smoothtype, int param1, int param2,
+                     int type, int max_width, int threads )
+{
+    CvSmoothState* state = 0;
+
+    CV_FUNCNAME( "cvCreateSmoothState" );
+
+    __BEGIN__;
+
+    int depth = CV_MAT_DEPTH( type ), cn = CV_MAT_CN( type );
+    int kw, kh, bufsize, bandsize, i, k;
+    int sumx = 0, sumy = 0;
+    char* ptr;
+
+    if( smoothtype != CV_BLUR && smoothtype != CV_GAUSSIAN )
+        CV_ERROR( CV_StsBadArg, "Only CV_BLUR and CV_GAUSSIAN smoothing is supported" );
+
+    if( (depth != CV_8U && depth != CV_32F) || cn == 2 )
+        CV_ERROR( CV_StsUnsupportedFormat, "" );
+
+    if( param2 == 0 )
+        param2 = param1;
+
+    if( param1 < 1 || (param1 & 1) == 0 || param2 < 1 || (param2 & 1) == 0 )
+        CV_ERROR( CV_StsOutOfRange, "Bad aperture size (should be >=1 and odd)" );
+
+    if( max_width <= 0 )
+        CV_ERROR( CV_StsOutOfRange, "Maximal image width should be positive" );
+
+#if ICV_SMOOTH_THREADS
+    threads = MIN( MAX( threads, 1 ), ICV_SMOOTH_MAX_THREADS );
+#else
+    threads = 1;
+#endif
+
+    kw = param1;
+    kh = param2;
+
+    /* kernels, then for each band: pad, ring rows, sums and row pointers */
+    bandsize = icvAlign( (max_width + kw - 1)*cn*sizeof(float), 32 ) +
+               (kh + 1)*icvAlign( max_width*cn*sizeof(float), 32 ) +
+               icvAlign( max_width*cn*sizeof(float), 32 ) +
+               icvAlign( (2*kh + 1)*sizeof(void*), 32 );
+    bufsize = icvAlign( (kw + kh)*sizeof(float), 32 ) + bandsize*threads + 32;
+
+    CV_CALL( state = (CvSmoothState*)cvAlloc( sizeof(*state) ));
+    memset( state, 0, sizeof(*state) );
+
+#if ICV_SMOOTH_THREADS
+    pthread_mutex_init( &state->lock, 0 );
+    pthread_cond_init( &state->start_cond, 0 );
+    pthread_cond_init( &state->done_cond, 0 );
+#endif
+
+    CV_CALL( state->buffer = cvAlloc( bufsize ));
+
+    state->smoothtype = smoothtype;
+    state->type = CV_MAT_TYPE( type );
+    state->max_width = max_width;
+    state->ksize = cvSize( kw, kh );
+
+    ptr = (char*)icvAlignPtr( state->buffer, 32 );
+    state->kx = (float*)ptr;
+    state->ky = state->kx + kw;
+    ptr += icvAlign( (kw + kh)*sizeof(float), 32 );
+
+    if( smoothtype == CV_GAUSSIAN )
+    {
+        sumx = icvSmoothGaussianKernel( kw, state->kx );
+        sumy = icvSmoothGaussianKernel( kh, state->ky );
+
+        if( sumx && sumy )
+        {
+            /* integer kernels; the scale is a power of 2 */
+            state->scale = (float)(1./((double)sumx*sumy));
+        }
+        else
+        {
+            if( sumx )
+                for( k = 0; k < kw; k++ )
+                    state->kx[k] /= sumx;
+            if( sumy )
+                for( k = 0; k < kh; k++ )
+                    state->ky[k] /= sumy;
+            state->scale = 1.f;
+        }
+    }
+    else
+    {
+        for( k = 0; k < kw; k++ )
+            state->kx[k] = 1.f;
+        for( k = 0; k < kh; k++ )
+            state->ky[k] = 1.f;
+        state->scale = (float)(1./((double)kw*kh));
+    }
+
+    /* round to nearest when storing 8u */
+    state->delta = depth == CV_8U ? 0.5f : 0.f;
+
+    for( i = 0; i < threads; i++ )
+    {
+        CvSmoothBand* band = state->band + i;
+
+        band->pad = (float*)ptr;
+        ptr += icvAlign( (max_width + kw - 1)*cn*sizeof(float), 32 );
+        band->sum = (float*)ptr;
+        ptr += icvAlign( max_width*cn*sizeof(float), 32 );
+        band->ring = (float**)ptr;
+        band->rows = (const float**)(band->ring + kh + 1);
+        ptr += icvAlign( (2*kh + 1)*sizeof(void*), 32 );
+
+        for( k = 0; k <= kh; k++ )
+        {
+            band->ring[k] = (float*)ptr;
+            ptr += icvAlign( max_width*cn*sizeof(float), 32 );
+        }
+    }
+
+    state->nbands = 1;
+
+#if ICV_SMOOTH_THREADS
+    for( i = 1; i < threads; i++ )
+    {
+        state->worker[i].state = state;
+        state->worker[i].idx = i;
+        if( pthread_create( &state->thread[i-1], 0, icvSmoothWorkerProc,
+                            state->worker + i ) != 0 )
+            break;
+        state->nworkers++;
+        state->nbands++;
+    }
+#endif
+
+    __END__;
+
+    if( cvGetErrStatus() < 0 )
+    {
+        icvFreeSmoothState( state );
+        state = 0;
+    }
+
+    return state;
+}
+
+
+CV_IMPL void
+cvReleaseSmoothState( CvSmoothState** state )
+{
+    CV_FUNCNAME( "cvReleaseSmoothState" );
+
+    __BEGIN__;
+
+    if( !state )
+        CV_ERROR( CV_StsNullPtr, "" );
+
+    icvFreeSmoothState( *state );
+    *state = 0;
+
+    __END__;
+}
+
+
+CV_IMPL void
+cvSmoothWithState( const void* srcarr, void* dstarr, CvSmoothState* state )
+{
+    CV_FUNCNAME( "cvSmoothWithState" );
+
+    __BEGIN__;
+
+    int coi1 = 0, coi2 = 0;
+    CvMat srcstub, *src = (CvMat*)srcarr;
+    CvMat dststub, *dst = (CvMat*)dstarr;
+    CvSize size;
+    int nbands;
+
+    if( !state )
+        CV_ERROR( CV_StsNullPtr, "" );
+
+    CV_CALL( src = cvGetMat( src, &srcstub, &coi1 ));
+    CV_CALL( dst = cvGetMat( dst, &dststub, &coi2 ));
+
+    if( CV_MAT_TYPE( src->type ) != state->type || !CV_ARE_TYPES_EQ( src, dst ))
+        CV_ERROR( CV_StsUnmatchedFormats, "" );
+
+    if( !CV_ARE_SIZES_EQ( src, dst ))
+        CV_ERROR( CV_StsUnmatchedSizes, "" );
+
+    if( coi1 != 0 || coi2 != 0 )
+        CV_ERROR( CV_BadCOI, "" );
+
+    size = icvGetMatSize( src );
+
+    if( size.width > state->max_width )
+        CV_ERROR( CV_StsOutOfRange, "The image is wider than the state was created for" );
+
+    state->src = src->data.ptr;
+    state->srcstep = src->step;
+    state->dst = dst->data.ptr;
+    state->dststep = dst->step;
+    state->size = size;
+
+    /* in-place smoothing reads each source row before it is overwritten
+       only if the rows are processed in order by a single band */
+    nbands = state->nbands;
+    if( src->data.ptr == dst->data.ptr || size.height < nbands*state->ksize.height )
+        nbands = 1;
+
+    if( nbands == 1 )
+    {
+        icvSmoothRunBand( state, 0, 1 );
+        EXIT;
+    }
+
+#if ICV_SMOOTH_THREADS
+    pthread_mutex_lock( &state->lock );
+    state->pending = state->nworkers;
+    state->generation++;
+    pthread_cond_broadcast( &state->start_cond );
+    pthread_mutex_unlock( &state->lock );
+
+    icvSmoothRunBand( state, 0, nbands );
+
+    pthread_mutex_lock( &state->lock );
+    while( state->pending > 0 )
+        pthread_cond_wait( &state->done_cond, &state->lock );
+    pthread_mutex_unlock( &state->lock );
+#endif
+
+    __END__;
+}
+
+
+/****************************************************************************************\
+*                                  Per-thread cvSmooth state                             *
+\****************************************************************************************/
+
+#if ICV_SMOOTH_THREADS
+
+static pthread_key_t icvSmoothCacheKey;
+static pthread_once_t icvSmoothCacheOnce = PTHREAD_ONCE_INIT;
+
+static void
+icvSmoothCacheDestructor( void* ptr )
+{
+    icvFreeSmoothState( (CvSmoothState*)ptr );
+}
+
+static void
+icvSmoothCacheInit( void )
+{
+    pthread_key_create( &icvSmoothCacheKey, icvSmoothCacheDestructor );
+}
+
+CvSmoothState*
+icvGetSmoothCache( int smoothtype, int param1, int param2, int type, int width )
+{
+    CvSmoothState* state;
+
+    pthread_once( &icvSmoothCacheOnce, icvSmoothCacheInit );
+    state = (CvSmoothState*)pthread_getspecific( icvSmoothCacheKey );
+
+    if( param2 == 0 )
+        param2 = param1;
+
+    if( state && (state->smoothtype != smoothtype || state->type != CV_MAT_TYPE(type) ||
+        state->ksize.width != param1 || state->ksize.height != param2 ||
+        state->max_width < width ))
+    {
+        icvFreeSmoothState( state );
+        state = 0;
+        pthread_setspecific( icvSmoothCacheKey, 0 );
+    }
+
+    if( !state )
+    {
+        state = cvCreateSmoothState( smoothtype, param1, param2, type, width, 1 );
+        pthread_setspecific( icvSmoothCacheKey, state );
+    }
+
+    return state;
+}
+
+#else
+
+CvSmoothState*
+icvGetSmoothCache( int, int, int, int, int )
+{
+    return 0;
+}
+
+#endif
+
+/* End of file. */
@@ -0,0 +1,415 @@
+/*
+//
+//  cvstereobm.cpp  -- block-matching stereo correspondence
+//
+//  cvFindStereoCorrespondence (cvaux) matches each scanline by dynamic
+//  programming, which is too slow for a vehicle.  This is the usual
+//  fixed-window matcher instead: both images are prefiltered with a clipped
+//  horizontal Sobel, which takes out the brightness difference between the
+//  cameras, and for each disparity the sum of absolute differences over an
+//  SADWindowSize square is found by running sums.  For each disparity there
+//  is a row of column sums, which moves down the image one row at a time
+//  by adding the row entering the window and subtracting the row leaving it
+//  (icvUpdateSADCol_8u16u_C1R, which has SSE2 and AVX2 versions); a running
+//  sum along the row then gives the window costs.  So the cost per pixel per
+//  disparity does not depend on the window size.
+//
+//  The lowest cost disparity is kept when
+//      - the window has enough texture (textureThreshold),
+//      - no disparity more than one away is nearly as good (uniquenessRatio),
+//      - matching the right image against the left gives back the same
+//        disparity (disp12MaxDiff).  The costs are the same both ways, so the
+//        right-to-left match comes from the same costs at no extra SAD work.
+//  The result is refined to subpixel by fitting a parabola to the costs
+//  either side of the minimum.
+//
+//  Team Overbot
+//  October, 2026
+//
+*/
+
+#include "_cv.h"
+
+#define ICV_BM_MAX_PREFILTER_CAP    63
+#define ICV_BM_MAX_WINDOW           255
+
+
+/* column sums of |left - right| fit in 16 bits: at most 255 rows of 2*63 */
+IPCVAPI_IMPL( CvStatus, icvUpdateSADCol_8u16u_C1R, ( const uchar* addl, const uchar* addr,
+                                                     const uchar* subl, const uchar* subr,
+                                                     ushort* sum, int len ))
+{
+    int i;
+
+    for( i = 0; i < len; i++ )
+        sum[i] = (ushort)(sum[i] + abs( addl[i] - addr[i] ) - abs( subl[i] - subr[i] ));
+
+    return CV_OK;
+}
+
+
+/* dst = clip( 3x3 horizontal Sobel of src, -cap, cap ) + cap, with the
+   rows at the top and bottom repeated and the side columns set to cap */
+static void
+icvPrefilterXSobel_8u( const CvMat* src, CvMat* dst, int cap )
+{
+    int x, y, width = src->cols, height = src->rows;
+
+    for( y = 0; y < height; y++ )
+    {
+        const uchar* r0 = src->data.ptr + src->step*MAX( y - 1, 0 );
+        const uchar* r1 = src->data.ptr + src->step*y;
+        const uchar* r2 = src->data.ptr + src->step*MIN( y + 1, height - 1 );
+        uchar* d = dst->data.ptr + dst->step*y;
+
+        d[0] = d[width - 1] = (uchar)cap;
+        for( x = 1; x < width - 1; x++ )
+        {
+            int v = r0[x+1] - r0[x-1] + 2*(r1[x+1] - r1[x-1]) + r2[x+1] - r2[x-1];
+            v = v < -cap ? -cap : v > cap ? cap : v;
+            d[x] = (uchar)(v + cap);
+        }
+    }
+}
+
+
+/* bytes of slidingSumBuf needed for a row of the given width */
+static int
+icvStereoBMBufSize( int width, int ndisp )
+{
+    return ndisp*width*(sizeof(ushort) + sizeof(int)) + width*7*sizeof(int);
+}
+
+
+/* the matcher proper, on the prefiltered images */
+static void
+icvFindStereoCorrespondenceBM_8u( const CvMat* left, const CvMat* right,
+                                  CvMat* disp, const CvStereoBMState* state )
+{
+    const int width = left->cols, height = left->rows;
+    const int mindisp = state->minDisparity, ndisp = state->numberOfDisparities;
+    const int maxdisp = mindisp + ndisp - 1;
+    const int wsz = state->SADWindowSize, r = wsz/2;
+    const int cap = state->preFilterCap;
+    const int ratio = state->uniquenessRatio;
+    const int maxdiff = state->disp12MaxDiff;
+    /* columns which can be matched at every disparity, and the columns
+       their windows cover, which are in both images at every disparity */
+    const int lofs = MAX( maxdisp, 0 ) + r;
+    const int rofs = width - r + MIN( mindisp, 0 );
+    const int x0 = lofs - r, len = rofs - lofs + 2*r;
+    const float invalid = (float)(mindisp - 1);
+
+    int* cost = (int*)state->slidingSumBuf->data.ptr;              /* [k][x], window SADs */
+    int* texcol = cost + ndisp*width;                               /* texture column sums */
+    int* mincost = texcol + width;                                  /* best cost and its k */
+    int* bestk = mincost + width;
+    int* rcost = bestk + width;                                     /* same, right to left */
+    int* rbestk = rcost + width;
+    int* tex = rbestk + width;                                      /* texture window sums */
+    int* ambig = tex + width;                                       /* set if ambiguous */
+    ushort* colsum = (ushort*)(ambig + width);                        /* [k][x], column SADs */
+    int x, y, k;
+
+    /* rows the window doesn't fit, or all of them if no column can be matched */
+    for( y = 0; y < height; y++ )
+    {
+        float* dptr = (float*)(disp->data.ptr + disp->step*y);
+
+        if( y >= r && y < height - r && lofs < rofs )
+            continue;
+        for( x = 0; x < width; x++ )
+            dptr[x] = invalid;
+    }
+
+    if( lofs >= rofs )
+        return;
+
+    /* column sums for the first window of rows */
+    memset( colsum, 0, ndisp*width*sizeof(colsum[0]) );
+    memset( texcol, 0, width*sizeof(texcol[0]) );
+    for( y = 0; y < wsz; y++ )
+    {
+        const uchar* lrow = left->data.ptr + left->step*y;
+        const uchar* rrow = right->data.ptr + right->step*y;
+
+        for( k = 0; k < ndisp; k++ )
+        {
+            int d = mindisp + k;
+            icvUpdateSADCol_8u16u_C1R( lrow + x0, rrow + x0 - d, lrow + x0, lrow + x0,
+                                       colsum + k*width + x0, len );
+        }
+        for( x = 0; x < width; x++ )
+            texcol[x] += abs( lrow[x] - cap );
+    }
+
+    for( y = r; y < height - r; y++ )
+    {
+        float* dptr = (float*)(disp->data.ptr + disp->step*y);
+
+        /* move the column sums down a row */
+        if( y > r )
+        {
+            const uchar* laddrow = left->data.ptr + left->step*(y + r);
+            const uchar* raddrow = right->data.ptr + right->step*(y + r);
+            const uchar* lsubrow = left->data.ptr + left->step*(y - r - 1);
+            const uchar* rsubrow = right->data.ptr + right->step*(y - r - 1);
+
+            for( k = 0; k < ndisp; k++ )
+            {
+                int d = mindisp + k;
+                icvUpdateSADCol_8u16u_C1R( laddrow + x0, raddrow + x0 - d,
+                                           lsubrow + x0, rsubrow + x0 - d,
+                                           colsum + k*width + x0, len );
+            }
+            for( x = 0; x < width; x++ )
+                texcol[x] += abs( laddrow[x] - cap ) - abs( lsubrow[x] - cap );
+        }
+
+        /* window sums along the row, and the best disparity both ways */
+        for( x = 0; x < width; x++ )
+        {
+            mincost[x] = rcost[x] = INT_MAX;
+            bestk[x] = rbestk[x] = -1;
+        }
+
+        for( k = 0; k < ndisp; k++ )
+        {
+            const int d = mindisp + k;
+            const ushort* cs = colsum + k*width;
+            int* c = cost + k*width;
+            int s = 0;
+
+            /* only the columns matched at every disparity are needed; the
+               compare is written without branches, so it pipelines */
+            for( x = lofs - r; x < lofs + r; x++ )
+                s += cs[x];
+            for( x = lofs; x < rofs; x++ )
+            {
+                int better;
+
+                s += cs[x + r];
+                c[x] = s;
+                better = s < mincost[x];
+                mincost[x] = better ? s : mincost[x];
+                bestk[x] = better ? k : bestk[x];
+                s -= cs[x - r];
+            }
+            for( x = lofs - d; x < rofs - d; x++ )
+            {
+                int v = c[x + d], better = v < rcost[x];
+
+                rcost[x] = better ? v : rcost[x];
+                rbestk[x] = better ? k : rbestk[x];
+            }
+        }
+
+        {
+            int s = 0;
+
+            for( x = lofs - r; x < lofs + r; x++ )
+                s += texcol[x];
+            for( x = lofs; x < rofs; x++ )
+            {
+                s += texcol[x + r];
+                tex[x] = s;
+                s -= texcol[x - r];
+            }
+        }
+
+        /* other disparities nearly as good mean the match is ambiguous.
+           rcost is done with, and holds the cost limit for other disparities */
+        if( ratio > 0 )
+        {
+            int* limit = rcost;
+
+            for( x = lofs; x < rofs; x++ )
+            {
+                limit[x] = mincost[x]*(100 + ratio)/100;
+                ambig[x] = 0;
+            }
+
+            for( k = 0; k < ndisp; k++ )
+            {
+                const int* c = cost + k*width;
+
+                for( x = lofs; x < rofs; x++ )
+                    ambig[x] |= (c[x] <= limit[x]) & ((unsigned)(k - bestk[x] + 1) > 2u);
+            }
+
+            for( x = lofs; x < rofs; x++ )
+                bestk[x] = ambig[x] ? -1 : bestk[x];
+        }
+
+        for( x = 0; x < lofs; x++ )
+            dptr[x] = invalid;
+        for( x = rofs; x < width; x++ )
+            dptr[x] = invalid;
+
+        for( x = lofs; x < rofs; x++ )
+        {
+            int bk = bestk[x];
+            float delta = 0.f;
+
+            if( bk < 0 || tex[x] < state->textureThreshold )
+            {
+                dptr[x] = invalid;
+                continue;
+            }
+
+            if( maxdiff >= 0 && abs( rbestk[x - mindisp - bk] - bk ) > maxdiff )
+            {
+                dptr[x] = invalid;
+                continue;
+            }
+
+            if( bk > 0 && bk < ndisp - 1 )
+            {
+                int c0 = cost[(bk - 1)*width + x], c1 = mincost[x];
+                int c2 = cost[(bk + 1)*width + x];
+                int denom = c0 + c2 - 2*c1;
+
+                if( denom > 0 )
+                    delta = (float)(c0 - c2)/(2*denom);
+            }
+
+            dptr[x] = mindisp + bk + delta;
+        }
+    }
+}
+
+
+static void
+icvFreeStereoBMState( CvStereoBMState* state )
+{
+    if( !state )
+        return;
+
+    cvReleaseMat( &state->preFilteredImg0 );
+    cvReleaseMat( &state->preFilteredImg1 );
+    cvReleaseMat( &state->slidingSumBuf );
+    cvFree( (void**)&state );
+}
+
+
+CV_IMPL CvStereoBMState*
+cvCreateStereoBMState( int numberOfDisparities, int SADWindowSize )
+{
+    CvStereoBMState* state = 0;
+
+    CV_FUNCNAME( "cvCreateStereoBMState" );
+
+    __BEGIN__;
+
+    if( numberOfDisparities <= 0 )
+        CV_ERROR( CV_StsOutOfRange, "numberOfDisparities must be positive" );
+
+    if( SADWindowSize < 5 || SADWindowSize > ICV_BM_MAX_WINDOW || SADWindowSize % 2 == 0 )
+        CV_ERROR( CV_StsOutOfRange, "SADWindowSize must be odd, 5..255" );
+
+    CV_CALL( state = (CvStereoBMState*)cvAlloc( sizeof(*state) ));
+    memset( state, 0, sizeof(*state) );
+
+    state->preFilterCap = 31;
+    state->SADWindowSize = SADWindowSize;
+    state->minDisparity = 0;
+    state->numberOfDisparities = numberOfDisparities;
+    state->textureThreshold = 10;
+    state->uniquenessRatio = 15;
+    state->disp12MaxDiff = 1;
+
+    __END__;
+
+    if( cvGetErrStatus() < 0 )
+    {
+        icvFreeStereoBMState( state );
+        state = 0;
+    }
+
+    return state;
+}
+
+
+CV_IMPL void
+cvReleaseStereoBMState( CvStereoBMState** state )
+{
+    CV_FUNCNAME( "cvReleaseStereoBMState" );
+
+    __BEGIN__;
+
+    if( !state )
+        CV_ERROR( CV_StsNullPtr, "" );
+
+    icvFreeStereoBMState( *state );
+    *state = 0;
+
+    __END__;
+}
+
+
+CV_IMPL void
+cvFindStereoCorrespondenceBM( const CvArr* leftarr, const CvArr* rightarr,
+                              CvArr* disparr, CvStereoBMState* state )
+{
+    CV_FUNCNAME( "cvFindStereoCorrespondenceBM" );
+
+    __BEGIN__;
+
+    CvMat lstub, *left = (CvMat*)leftarr;
+    CvMat rstub, *right = (CvMat*)rightarr;
+    CvMat dstub, *disp = (CvMat*)disparr;
+    int bufsize;
+
+    if( !state )
+        CV_ERROR( CV_StsNullPtr, "" );
+
+    CV_CALL( left = cvGetMat( left, &lstub ));
+    CV_CALL( right = cvGetMat( right, &rstub ));
+    CV_CALL( disp = cvGetMat( disp, &dstub ));
+
+    if( CV_MAT_TYPE( left->type ) != CV_8UC1 || !CV_ARE_TYPES_EQ( left, right ))
+        CV_ERROR( CV_StsUnsupportedFormat, "Both images must be 8uC1" );
+
+    if( CV_MAT_TYPE( disp->type ) != CV_32FC1 )
+        CV_ERROR( CV_StsUnsupportedFormat, "Disparity map must be 32fC1" );
+
+    if( !CV_ARE_SIZES_EQ( left, right ) || !CV_ARE_SIZES_EQ( left, disp ))
+        CV_ERROR( CV_StsUnmatchedSizes, "" );
+
+    if( state->preFilterCap < 1 || state->preFilterCap > ICV_BM_MAX_PREFILTER_CAP )
+        CV_ERROR( CV_StsOutOfRange, "preFilterCap must be 1..63" );
+
+    if( state->SADWindowSize < 5 || state->SADWindowSize > ICV_BM_MAX_WINDOW ||
+        state->SADWindowSize % 2 == 0 ||
+        state->SADWindowSize >= MIN( left->cols, left->rows ))
+        CV_ERROR( CV_StsOutOfRange, "SADWindowSize must be odd, 5..255, and less than the image" );
+
+    if( state->numberOfDisparities <= 0 || state->uniquenessRatio < 0 ||
+        state->uniquenessRatio > 100 || state->textureThreshold < 0 )
+        CV_ERROR( CV_StsOutOfRange, "" );
+
+    if( !state->preFilteredImg0 || !CV_ARE_SIZES_EQ( state->preFilteredImg0, left ))
+    {
+        cvReleaseMat( &state->preFilteredImg0 );
+        cvReleaseMat( &state->preFilteredImg1 );
+        CV_CALL( state->preFilteredImg0 = cvCreateMat( left->rows, left->cols, CV_8UC1 ));
+        CV_CALL( state->preFilteredImg1 = cvCreateMat( left->rows, left->cols, CV_8UC1 ));
+    }
+
+    bufsize = icvStereoBMBufSize( left->cols, state->numberOfDisparities );
+    if( !state->slidingSumBuf || state->slidingSumBuf->cols < bufsize )
+    {
+        cvReleaseMat( &state->slidingSumBuf );
+        CV_CALL( state->slidingSumBuf = cvCreateMat( 1, bufsize, CV_8UC1 ));
+    }
+
+    icvPrefilterXSobel_8u( left, state->preFilteredImg0, state->preFilterCap );
+    icvPrefilterXSobel_8u( right, state->preFilteredImg1, state->preFilterCap );
+
+    icvFindStereoCorrespondenceBM_8u( state->preFilteredImg0, state->preFilteredImg1,
+                                      disp, state );
+
+    __END__;
+}
+
+/* End of file. */
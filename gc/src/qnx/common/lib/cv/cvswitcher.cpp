@@ -52,127 +52,99 @@
 #pragma warning( disable: 4100 )        /* unreferenced formal paramter */
 #endif
 
-#ifdef WIN32
-#include <windows.h>
-#else
-#include <dlfcn.h>
-#include <string.h>
-#endif
+#include "_cvsimd.h"
 
 #include <stdio.h>
+#include <string.h>
 #include <ctype.h>
 
+#if CV_SIMD_DISPATCH
+#include <cpuid.h>
+#endif
 
-typedef const char* CvProcessorType;
-
-#define CV_PROC_GENERIC    ""
-#define CV_PROC_IA32_PII   "m6"
-#define CV_PROC_IA32_PIII  "a6"
-#define CV_PROC_IA32_P4    "w7"
 
 /*
-   determine processor type
+   determine which SIMD instruction sets the processor (and, for AVX2,
+   the OS register save support) allows
 */
-static CvProcessorType
-icvGetProcessorType( void )
+int
+icvGetCpuFeatures( void )
 {
-    CvProcessorType proc_type = CV_PROC_GENERIC;
-
-#ifdef  WIN32
-
-    SYSTEM_INFO sys;
-    GetSystemInfo( &sys );
-
-    if( sys.wProcessorArchitecture == PROCESSOR_ARCHITECTURE_INTEL &&
-        sys.dwProcessorType == PROCESSOR_INTEL_PENTIUM )
-    {
-        static const char cpuid_code[] =
-            "\x53\x56\x57\xb8\x01\x00\x00\x00\x0f\xa2\x5f\x5e\x5b\xc3";
-        typedef int64 (CV_CDECL * func_ptr)(void);
-        func_ptr cpuid = (func_ptr)(void*)cpuid_code;
+    int features = CV_CPU_NONE;
 
-        int version = 0, features = 0, family = 0;
-        int id = 0;
+#if CV_SIMD_DISPATCH
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
 
-        int64 val = cpuid();
-        version = (int)val;
-        features = (int)(val >> 32);
+    if( !__get_cpuid( 1, &eax, &ebx, &ecx, &edx ))
+        return features;
 
-        #define ICV_CPUID_M6     ((1<<15)|(1<<23)|6)  /* cmov + mmx */
-        #define ICV_CPUID_A6     ((1<<25)|ICV_CPUID_M6) /* <all above> + xmm */
-        #define ICV_CPUID_W7     ((1<<26)|ICV_CPUID_A6|(1<<3)|1) /* <all above> + emm */
+    if( edx & bit_SSE2 )
+        features |= CV_CPU_SSE2;
+    if( (features & CV_CPU_SSE2) && (ecx & bit_SSE4_1) )
+        features |= CV_CPU_SSE4_1;
 
-        family = (version >> 8) & 15;
-        if( family >= 6 && (features & (ICV_CPUID_M6 & ~6)) != 0 ) /* Pentium II or higher */
-        {
-            id = (features & ICV_CPUID_W7 & -256) | family;
-        }
+    /* AVX2 needs the OS to save the upper halves of the ymm registers */
+    if( (features & CV_CPU_SSE4_1) && (ecx & bit_OSXSAVE) && (ecx & bit_AVX) )
+    {
+        unsigned xcr0_lo, xcr0_hi;
+        __asm__ __volatile__( "xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0) );
 
-        switch( id )
+        if( (xcr0_lo & 6) == 6 && __get_cpuid_max( 0, 0 ) >= 7 )
         {
-        case ICV_CPUID_W7:
-            proc_type = CV_PROC_IA32_P4;
-            break;
-        case ICV_CPUID_A6:
-            proc_type = CV_PROC_IA32_PIII;
-            break;
-        case ICV_CPUID_M6:
-            proc_type = CV_PROC_IA32_PII;
-            break;
+            __cpuid_count( 7, 0, eax, ebx, ecx, edx );
+            if( ebx & bit_AVX2 )
+                features |= CV_CPU_AVX2;
         }
     }
+#endif
 
-#else
-    char buffer[1000] = "";
-
-    //reading /proc/cpuinfo file (proc file system must be supported)
-    FILE *file = fopen( "/proc/cpuinfo", "r" );
+    return features;
+}
 
-    memset( buffer, 0, sizeof(buffer));
 
-    if( file && fread( buffer, 1, 1000, file ))
+const char*
+icvGetCpuLevelName( int cpu )
+{
+    switch( cpu )
     {
-        if( strstr( buffer, "mmx" ) && strstr( buffer, "cmov" ))
-        {
-            proc_type = CV_PROC_IA32_PII;
-
-            if( strstr( buffer, "xmm" ) || strstr( buffer, "sse" ))
-            {
-                proc_type = CV_PROC_IA32_PIII;
-
-                if( strstr( buffer, "emm" ))
-                    proc_type = CV_PROC_IA32_P4;
-            }
-        }
+    case CV_CPU_SSE2:
+        return "sse2";
+    case CV_CPU_SSE4_1:
+        return "sse4.1";
+    case CV_CPU_AVX2:
+        return "avx2";
     }
-#endif
 
-    return proc_type;
+    return "generic";
 }
 
 
-static CvProcessorType
-icvPreviousProcessor( const char* proc_type )
+/*
+   converts a processor type name given to cvLoadPrimitives into the set of
+   instruction set levels allowed.  Each level includes the ones below it.
+*/
+static int
+icvParseProcessorType( const char* proc_type )
 {
     char signature[100];
     int i;
 
     if( strlen( proc_type ) >= sizeof(signature))
-        return CV_PROC_GENERIC;
+        return CV_CPU_NONE;
 
     for( i = 0; proc_type[i]; i++ )
         signature[i] = (char)tolower( proc_type[i] );
 
-    signature[i++] = '\0';
+    signature[i] = '\0';
 
-    if( !strcmp( signature, CV_PROC_IA32_P4 ))
-        proc_type = CV_PROC_IA32_PIII;
-    else if( !strcmp( signature, CV_PROC_IA32_PIII ))
-        proc_type = CV_PROC_IA32_PII;
-    else
-        proc_type = CV_PROC_GENERIC;
+    if( !strcmp( signature, "avx2" ))
+        return CV_CPU_SSE2 | CV_CPU_SSE4_1 | CV_CPU_AVX2;
+    if( !strcmp( signature, "sse4.1" ) || !strcmp( signature, "sse41" ))
+        return CV_CPU_SSE2 | CV_CPU_SSE4_1;
+    if( !strcmp( signature, "sse2" ))
+        return CV_CPU_SSE2;
 
-    return proc_type;
+    return CV_CPU_NONE;
 }
 
 
@@ -222,28 +194,6 @@ static void icvResetPointers()
 #include "_ipcv.h"
 }
 
-/*
-   determine processor type, load appropriate dll and
-   initialize all function pointers
-*/
-#ifdef WIN32
-#define DLL_PREFIX ""
-#define DLL_SUFFIX ".dll"
-#else
-#define DLL_PREFIX "lib"
-#define DLL_SUFFIX ".so"
-#define LoadLibrary(name) dlopen(name, RTLD_LAZY)
-#define FreeLibrary(name) dlclose(name)
-#define GetProcAddress dlsym
-typedef void* HMODULE;
-#endif
-
-#if 0 /*def _DEBUG*/
-#define DLL_DEBUG_FLAG "d"
-#else
-#define DLL_DEBUG_FLAG ""
-#endif
-
 //#define VERBOSE_LOADING
 
 #ifdef VERBOSE_LOADING
@@ -252,128 +202,55 @@ typedef void* HMODULE;
 #define ICV_PRINTF(args)
 #endif
 
-typedef struct CvModuleInfo
-{
-    const char* basename;
-    HMODULE handle;
-    char name[100];
-}
-CvModuleInfo;
-
-static CvModuleInfo modules[] =
-{
-    {"ippcv", 0, "" },
-    {"optcv", 0, "" },
-    { 0, 0, "" }
-};
-
-static const char* prefices[] = { "ippi", "ippcv", 0 };
+/* CV_CPU_xxx levels of the variants currently installed */
+static int loaded_levels = CV_CPU_NONE;
 
+/*
+   Reset all primitives to the generic code, then install the in-tree SIMD
+   variants the processor supports.  proc_type == NULL selects the best
+   the processor can run; otherwise it names the highest level to use
+   ("" or "generic", "sse2", "sse4.1", "avx2"), which is how the
+   variants are compared against each other.
+*/
 CV_IMPL int
-cvLoadPrimitives( const char* processor_type )
+cvLoadPrimitives( const char* proc_type )
 {
-    int i, loaded_modules = 0, loaded_functions = 0;
-    CvProcessorType proc_type = CvProcessorType(processor_type);
-    
+    int i, j, loaded_functions = 0;
+    int features = icvGetCpuFeatures();
+
     icvResetPointers();
+    loaded_levels = CV_CPU_NONE;
 
-    if( !proc_type || strcmp(proc_type, CV_PROC_GENERIC) != 0 )
-        proc_type = icvGetProcessorType();
+    if( proc_type )
+        features &= icvParseProcessorType( proc_type );
 
-    // try to load optimized dlls
-    for( i = 0; modules[i].basename; i++ )
+    for( i = 0; icvSimdFuncTab[i].name != 0; i++ )
     {
-        CvProcessorType proc = proc_type;
+        const CvSimdFuncDesc* simd = icvSimdFuncTab + i;
 
-        // unload previously loaded optimized modules
-        if( modules[i].handle )
-        {
-            FreeLibrary( modules[i].handle );
-            modules[i].handle = 0;
-        }
-        
-        while( strcmp( proc, CV_PROC_GENERIC ) != 0 )
-        {
-            sprintf( modules[i].name, DLL_PREFIX "%s%s" DLL_DEBUG_FLAG DLL_SUFFIX,
-                     modules[i].basename, (const char*)proc );
-            
-            modules[i].handle = LoadLibrary( modules[i].name );
-            if( modules[i].handle != 0 )
-            {
-                ICV_PRINTF(("%s loaded\n", modules[i].name )); 
-                loaded_modules++;
+        if( (simd->cpu & features) == 0 )
+            continue;
+
+        for( j = 0; ipp_func_desc[j].name != 0; j++ )
+            if( !strcmp( ipp_func_desc[j].name, simd->name ))
                 break;
-            }
-            
-            proc = icvPreviousProcessor( proc );
-        }
-    }
 
-    if( loaded_modules > 0 )
-    {
-        for( i = 0; ipp_func_desc[i].name != 0; i++ )
-        {
-        #if _MSC_VER >= 1200
-            #pragma warning( disable: 4054 4055 )   /* converting pointers to code<->data */
-        #endif
-            char name[100];
-            uchar* addr = 0;
-            int j = 0, k = 0;
-
-            if( ipp_func_desc[i].loaded )
-                continue;
-
-            for( j = 0; prefices[j] != 0; j++ )
-            {
-                strcpy( name, prefices[j] );
-                strcat( name, ipp_func_desc[i].name + 3 );
-
-                for( k = 0; modules[k].basename != 0; k++ )
-                    if( modules[k].handle )
-                    {
-                        addr = (uchar*)GetProcAddress( modules[k].handle, name );
-                        if( addr )
-                            break;
-                    }
-
-                if( addr )
-                    break;
-            }
-
-            if( addr )
-            {
-            #ifdef WIN32            
-                while( *addr == 0xE9 )
-                    addr += 5 + *((int*)(addr + 1));
-            #endif
-                *ipp_func_desc[i].addr = (ipp_func_addr)addr;
-                ipp_func_desc[i].loaded = k+1; // store incremented index of the module
-                                               // that contain the loaded function
-                loaded_functions++;
-                ICV_PRINTF(("%s:  \t%s\n", ipp_func_desc[i].name, modules[k].name ));
-            }
-
-            #if _MSC_VER >= 1200
-                #pragma warning( default: 4054 4055 )
-            #endif
-        }
-    }
-    
-#ifdef VERBOSE_LOADING
-    {
-    int not_loaded = 0;
-    ICV_PRINTF(("\nTotal loaded: %d\n\n", loaded_functions ));
-    printf( "***************************************************\nNot loaded ...\n\n" );
-    for( i = 0; ipp_func_desc[i].name != 0; i++ )
-        if( !ipp_func_desc[i].loaded )
+        if( ipp_func_desc[j].name == 0 )
         {
-            ICV_PRINTF(( "%s\n", ipp_func_desc[i].name ));
-            not_loaded++;
+            assert(0); /* icvSimdFuncTab names a primitive that is not in _ipcv.h */
+            continue;
         }
 
-    ICV_PRINTF(("\nTotal: %d\n", not_loaded ));
+        /* later entries are for higher levels, so they override earlier ones */
+        if( !ipp_func_desc[j].loaded )
+            loaded_functions++;
+        *ipp_func_desc[j].addr = (ipp_func_addr)simd->addr;
+        ipp_func_desc[j].loaded = simd->cpu;
+        loaded_levels |= simd->cpu;
+        ICV_PRINTF(("%s:  \t%s\n", simd->name, icvGetCpuLevelName( simd->cpu )));
     }
-#endif
+
+    ICV_PRINTF(("\nTotal loaded: %d\n\n", loaded_functions ));
 
     return loaded_functions;
 }
@@ -386,7 +263,7 @@ void
 cvGetLibraryInfo( const char **_version, int *_loaded, const char **_dll_name )
 {
     static const char* version = __DATE__;
-    static char loaded_modules[1000] = "";
+    static char loaded_modules[100];
 
     if( _version )
         *_version = version;
@@ -396,19 +273,14 @@ cvGetLibraryInfo( const char **_version, int *_loaded, const char **_dll_name )
     
     if( _dll_name )
     {
-        int i;
-        static int init_loaded_modules = 0;
-        
-        if( !init_loaded_modules )
-        {
-            init_loaded_modules = 1;
-            for( i = 0; modules[i].basename; i++ )
-                if( modules[i].handle != 0 )
-                {
-                    sprintf( loaded_modules + strlen(loaded_modules),
-                             ", %s", modules[i].name );
-                }
-        }
+        int cpu;
+
+        /* the instruction set levels in use, e.g. "sse2, sse4.1, avx2" */
+        loaded_modules[0] = '\0';
+        for( cpu = CV_CPU_SSE2; cpu <= CV_CPU_AVX2; cpu <<= 1 )
+            if( loaded_levels & cpu )
+                sprintf( loaded_modules + strlen(loaded_modules),
+                         ", %s", icvGetCpuLevelName( cpu ));
 
         *_dll_name = strlen(loaded_modules) == 0 ? "none" :
                      (const char*)(loaded_modules + 2); // skip ", "
@@ -416,6 +288,19 @@ cvGetLibraryInfo( const char **_version, int *_loaded, const char **_dll_name )
 }
 
 
+CV_IMPL const char*
+cvGetPrimitiveVariant( const char* name )
+{
+    int i;
+
+    for( i = 0; ipp_func_desc[i].name != 0; i++ )
+        if( !strcmp( ipp_func_desc[i].name, name ))
+            return icvGetCpuLevelName( ipp_func_desc[i].loaded );
+
+    return 0;
+}
+
+
 CV_IMPL int
 cvFillInternalFuncsTable(void* tbl)
 {
@@ -1990,6 +1990,7 @@ cvMatchTemplate( const void* arr, const void* templarr, void* resultarr,
     static int inittab = 0;
 
     void* buffer = 0;
+    CvMatchTemplateState* state = 0;
     CV_FUNCNAME( "cvMatchTemplate" );
 
     __BEGIN__;
@@ -2059,6 +2060,14 @@ cvMatchTemplate( const void* arr, const void* templarr, void* resultarr,
     imgSize = icvGetMatSize( img );
     templSize = icvGetMatSize( templ );
 
+    /* large templates are correlated in the frequency domain (cvtemplmatchdft.cpp) */
+    if( icvMatchTemplateUseDFT( imgSize, templSize ))
+    {
+        CV_CALL( state = cvCreateMatchTemplateState( templ ));
+        CV_CALL( cvMatchTemplateWithState( img, result, imethod, state ));
+        EXIT;
+    }
+
     bufSizeFunc = (CvMatchBufSizeFunc)(bufSizeFuncs[imethod]);
     IPPI_CALL( bufSizeFunc( imgSize, templSize, dataType, &bufferSize ));
 
@@ -2089,6 +2098,8 @@ cvMatchTemplate( const void* arr, const void* templarr, void* resultarr,
     __END__;
 
     cvFree( &buffer );
+    if( state )
+        cvReleaseMatchTemplateState( &state );
 }
 
 /* End of file. */
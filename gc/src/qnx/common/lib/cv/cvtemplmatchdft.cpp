@@ -0,0 +1,484 @@
+/*
+//
+//  cvtemplmatchdft.cpp  -- template matching in the frequency domain
+//
+//  The spatial cvMatchTemplate() does one full template-sized cross
+//  correlation per output pixel, so its cost is image area times template
+//  area.  Here the cross correlation is done with cvDFT instead, by tiled
+//  overlap-save: the image is cut into overlapping power-of-2 tiles, each
+//  tile is transformed, multiplied by the conjugate of the template
+//  spectrum and transformed back, and the part of the result that did not
+//  wrap around is kept.  The window sums needed by the other methods come
+//  from integral images, so every method costs about the same.
+//
+//  A CvMatchTemplateState holds a copy of the template and its spectrum,
+//  so matching the same template against a sequence of frames only pays
+//  for transforming the image.  cvMatchTemplate() itself comes here, with
+//  a temporary state, when the cost estimate says the frequency domain is
+//  cheaper; small templates stay in the spatial domain.
+//
+//  The correlation is computed in float, so for 8-bit images it is not
+//  exact, as the spatial version is.  For the normalized methods the
+//  difference is well below anything that matters for locating a match.
+//
+//  Team Overbot
+//  October, 2026
+//
+*/
+
+#include "_cv.h"
+
+/* templates smaller than this always stay in the spatial domain; about
+   where the two cost the same for 8u images from 160x120 to 640x480 */
+#define ICV_DFT_MIN_TEMPL_AREA  100
+
+/* relative cost of one point of a forward plus inverse transform, per
+   log2(tile area), against one multiply-add of the spatial correlation */
+#define ICV_DFT_POINT_COST      1.5
+
+struct CvMatchTemplateState
+{
+    CvMat* templ;           /* copy of the template, original type */
+    double templ_sum;       /* sum and sum of squares of the template */
+    double templ_sqsum;
+    CvSize img_size;        /* image size the tiles were chosen for */
+    CvSize dft_size;        /* tile size, powers of 2 */
+    CvMat* templ_spect;     /* CCS spectrum of the template, zero padded to a tile */
+    CvMat* tile;            /* image tile, its spectrum, then the correlation */
+    double* sum;            /* integral images of the image and of its square */
+    double* sqsum;
+};
+
+
+/* power of 2 >= n, and at least 2 so that the transforms are always 2D */
+static int
+icvDFTPow2( int n )
+{
+    int p = 2;
+
+    while( p < n )
+        p *= 2;
+    return p;
+}
+
+
+static int
+icvLog2( int n )
+{
+    int m = 0;
+
+    while( (1 << m) < n )
+        m++;
+    return m;
+}
+
+
+/* chooses the tile size which minimizes the estimated cost of the
+   correlation, and returns that cost */
+static double
+icvMatchTemplateTileCost( CvSize img_size, CvSize templ_size, CvSize* dft_size )
+{
+    CvSize res_size = cvSize( img_size.width - templ_size.width + 1,
+                              img_size.height - templ_size.height + 1 );
+    double best = -1;
+    int dw, dh;
+
+    *dft_size = cvSize( 0, 0 );
+
+    for( dh = icvDFTPow2( templ_size.height ); dh < 2*icvDFTPow2( img_size.height ); dh *= 2 )
+    {
+        for( dw = icvDFTPow2( templ_size.width ); dw < 2*icvDFTPow2( img_size.width ); dw *= 2 )
+        {
+            int stepx = dw - templ_size.width + 1, stepy = dh - templ_size.height + 1;
+            double tiles = (double)((res_size.width + stepx - 1)/stepx)*
+                           ((res_size.height + stepy - 1)/stepy);
+            double cost = tiles*dw*dh*(ICV_DFT_POINT_COST*icvLog2( dw*dh ) + 1);
+
+            if( best < 0 || cost < best )
+            {
+                best = cost;
+                *dft_size = cvSize( dw, dh );
+            }
+        }
+    }
+
+    return best;
+}
+
+
+/* decides between the spatial and the frequency domain */
+int
+icvMatchTemplateUseDFT( CvSize img_size, CvSize templ_size )
+{
+    CvSize dft_size;
+    double spatial_cost;
+
+    if( templ_size.width*templ_size.height < ICV_DFT_MIN_TEMPL_AREA )
+        return 0;
+
+    spatial_cost = (double)(img_size.width - templ_size.width + 1)*
+                   (img_size.height - templ_size.height + 1)*
+                   templ_size.width*templ_size.height;
+
+    return icvMatchTemplateTileCost( img_size, templ_size, &dft_size ) < spatial_cost;
+}
+
+
+/* a = a*conj(b), for CCS packed spectra of real arrays with even numbers
+   of rows and columns.  Columns 0 and width-1 hold the spectra of the
+   first and middle columns of the row transforms, which are themselves
+   real, packed down the column; the other columns are pairs of real and
+   imaginary parts.  Steps are in floats. */
+static void
+icvMulCcsConj_32f( float* a, int astep, const float* b, int bstep, CvSize size )
+{
+    int i, j, k;
+
+    for( k = 0; k < 2; k++ )
+    {
+        int c = k == 0 ? 0 : size.width - 1;
+
+        a[c] *= b[c];
+        a[(size.height-1)*astep + c] *= b[(size.height-1)*bstep + c];
+
+        for( i = 1; i < size.height - 1; i += 2 )
+        {
+            float* pa = a + i*astep + c;
+            const float* pb = b + i*bstep + c;
+            double re = (double)pa[0]*pb[0] + (double)pa[astep]*pb[bstep];
+            double im = (double)pa[astep]*pb[0] - (double)pa[0]*pb[bstep];
+
+            pa[0] = (float)re;
+            pa[astep] = (float)im;
+        }
+    }
+
+    for( i = 0; i < size.height; i++, a += astep, b += bstep )
+    {
+        for( j = 1; j < size.width - 1; j += 2 )
+        {
+            double re = (double)a[j]*b[j] + (double)a[j+1]*b[j+1];
+            double im = (double)a[j+1]*b[j] - (double)a[j]*b[j+1];
+
+            a[j] = (float)re;
+            a[j+1] = (float)im;
+        }
+    }
+}
+
+
+/* integral images of the image and of its square, (width+1)*(height+1) */
+static void
+icvMatchTemplateIntegral( const CvMat* img, double* sum, double* sqsum )
+{
+    int x, y, width = img->cols, height = img->rows;
+    int sumstep = width + 1;
+    int depth = CV_MAT_DEPTH( img->type );
+
+    memset( sum, 0, sumstep*sizeof(sum[0]) );
+    memset( sqsum, 0, sumstep*sizeof(sqsum[0]) );
+
+    for( y = 0; y < height; y++ )
+    {
+        const uchar* src = img->data.ptr + y*img->step;
+        double* s = sum + (y + 1)*sumstep;
+        double* sq = sqsum + (y + 1)*sumstep;
+        double rowsum = 0, rowsqsum = 0;
+
+        s[0] = sq[0] = 0;
+
+        for( x = 0; x < width; x++ )
+        {
+            double v = depth == CV_8U ? (double)src[x] :
+                       depth == CV_8S ? (double)((const signed char*)src)[x] :
+                                        (double)((const float*)src)[x];
+            rowsum += v;
+            rowsqsum += v*v;
+            s[x+1] = s[x+1-sumstep] + rowsum;
+            sq[x+1] = sq[x+1-sumstep] + rowsqsum;
+        }
+    }
+}
+
+
+/* picks tiles for this image size, and transforms the template to match */
+static void
+icvMatchTemplateSetSize( CvMatchTemplateState* state, CvSize img_size )
+{
+    CV_FUNCNAME( "icvMatchTemplateSetSize" );
+
+    __BEGIN__;
+
+    CvSize templ_size = icvGetMatSize( state->templ );
+    CvSize dft_size;
+    CvMat sub;
+
+    icvMatchTemplateTileCost( img_size, templ_size, &dft_size );
+
+    if( dft_size.width != state->dft_size.width ||
+        dft_size.height != state->dft_size.height )
+    {
+        cvReleaseMat( &state->templ_spect );
+        cvReleaseMat( &state->tile );
+        state->dft_size = cvSize( 0, 0 );
+
+        CV_CALL( state->templ_spect = cvCreateMat( dft_size.height, dft_size.width, CV_32FC1 ));
+        CV_CALL( state->tile = cvCreateMat( dft_size.height, dft_size.width, CV_32FC1 ));
+
+        CV_CALL( cvZero( state->templ_spect ));
+        CV_CALL( cvGetSubRect( state->templ_spect, &sub,
+                               cvRect( 0, 0, templ_size.width, templ_size.height )));
+        CV_CALL( cvConvert( state->templ, &sub ));
+        CV_CALL( cvDFT( state->templ_spect, state->templ_spect, CV_DXT_FORWARD ));
+        state->dft_size = dft_size;
+    }
+
+    if( img_size.width != state->img_size.width ||
+        img_size.height != state->img_size.height )
+    {
+        int sumsize = (img_size.width + 1)*(img_size.height + 1)*sizeof(double);
+
+        cvFree( (void**)&state->sum );
+        cvFree( (void**)&state->sqsum );
+        state->img_size = cvSize( 0, 0 );
+
+        CV_CALL( state->sum = (double*)cvAlloc( sumsize ));
+        CV_CALL( state->sqsum = (double*)cvAlloc( sumsize ));
+        state->img_size = img_size;
+    }
+
+    __END__;
+}
+
+
+/* the frequency domain cvMatchTemplate */
+static void
+icvMatchTemplateDFT( const CvMat* img, CvMat* result, int method,
+                     CvMatchTemplateState* state )
+{
+    CV_FUNCNAME( "icvMatchTemplateDFT" );
+
+    __BEGIN__;
+
+    CvSize templ_size = icvGetMatSize( state->templ );
+    CvSize res_size = icvGetMatSize( result );
+    CvSize dft_size;
+    CvMat src_sub, tile_sub;
+    int sumstep, stepx, stepy, x0, y0, x, y;
+    double n = (double)templ_size.width*templ_size.height;
+    double templ_coeff = 1;
+
+    CV_CALL( icvMatchTemplateSetSize( state, icvGetMatSize( img )));
+
+    dft_size = state->dft_size;
+    stepx = dft_size.width - templ_size.width + 1;
+    stepy = dft_size.height - templ_size.height + 1;
+    sumstep = img->cols + 1;
+
+    if( method != CV_TM_CCORR )
+        icvMatchTemplateIntegral( img, state->sum, state->sqsum );
+
+    if( method == CV_TM_SQDIFF_NORMED || method == CV_TM_CCORR_NORMED )
+        templ_coeff = icvInvSqrt64d( fabs( state->templ_sqsum ) + FLT_EPSILON );
+    else if( method == CV_TM_CCOEFF_NORMED )
+        templ_coeff = icvInvSqrt64d( fabs( state->templ_sqsum -
+                      state->templ_sum*state->templ_sum/n ) + FLT_EPSILON );
+
+    for( y0 = 0; y0 < res_size.height; y0 += stepy )
+    {
+        for( x0 = 0; x0 < res_size.width; x0 += stepx )
+        {
+            int w = MIN( dft_size.width, img->cols - x0 );
+            int h = MIN( dft_size.height, img->rows - y0 );
+            int resw = MIN( stepx, res_size.width - x0 );
+            int resh = MIN( stepy, res_size.height - y0 );
+
+            /* load the tile, zero padded past the edge of the image */
+            if( w < dft_size.width || h < dft_size.height )
+                CV_CALL( cvZero( state->tile ));
+            CV_CALL( cvGetSubRect( img, &src_sub, cvRect( x0, y0, w, h )));
+            CV_CALL( cvGetSubRect( state->tile, &tile_sub, cvRect( 0, 0, w, h )));
+            CV_CALL( cvConvert( &src_sub, &tile_sub ));
+
+            /* correlate with the template */
+            CV_CALL( cvDFT( state->tile, state->tile, CV_DXT_FORWARD ));
+            icvMulCcsConj_32f( state->tile->data.fl, state->tile->step/sizeof(float),
+                               state->templ_spect->data.fl,
+                               state->templ_spect->step/sizeof(float), dft_size );
+            CV_CALL( cvDFT( state->tile, state->tile, CV_DXT_INV_SCALE ));
+
+            /* the first resw x resh correlations did not wrap around */
+            for( y = 0; y < resh; y++ )
+            {
+                const float* corr = (const float*)(state->tile->data.ptr + y*state->tile->step);
+                float* dst = (float*)(result->data.ptr + (y0 + y)*result->step) + x0;
+                const double* s = state->sum + (y0 + y)*sumstep + x0;
+                const double* sq = state->sqsum + (y0 + y)*sumstep + x0;
+                int bl = templ_size.height*sumstep, br = bl + templ_size.width;
+                int tr = templ_size.width;
+
+                for( x = 0; x < resw; x++ )
+                {
+                    double c = corr[x], r, wsum = 0, wsqsum = 0;
+
+                    if( method != CV_TM_CCORR )
+                    {
+                        wsum = s[x+br] - s[x+bl] - s[x+tr] + s[x];
+                        wsqsum = sq[x+br] - sq[x+bl] - sq[x+tr] + sq[x];
+                    }
+
+                    switch( method )
+                    {
+                    case CV_TM_SQDIFF:
+                        r = MAX( wsqsum - 2*c + state->templ_sqsum, 0 );
+                        break;
+                    case CV_TM_SQDIFF_NORMED:
+                        r = MAX( wsqsum - 2*c + state->templ_sqsum, 0 )*templ_coeff*
+                            icvInvSqrt64d( fabs( wsqsum ) + FLT_EPSILON );
+                        break;
+                    case CV_TM_CCORR:
+                        r = c;
+                        break;
+                    case CV_TM_CCORR_NORMED:
+                        r = c*templ_coeff*icvInvSqrt64d( fabs( wsqsum ) + FLT_EPSILON );
+                        break;
+                    case CV_TM_CCOEFF:
+                        r = c - wsum*state->templ_sum/n;
+                        break;
+                    default:
+                        r = (c - wsum*state->templ_sum/n)*templ_coeff*
+                            icvInvSqrt64d( fabs( wsqsum - wsum*wsum/n ) + FLT_EPSILON );
+                        break;
+                    }
+
+                    dst[x] = (float)r;
+                }
+            }
+        }
+    }
+
+    __END__;
+}
+
+
+static void
+icvFreeMatchTemplateState( CvMatchTemplateState* state )
+{
+    if( !state )
+        return;
+
+    cvReleaseMat( &state->templ );
+    cvReleaseMat( &state->templ_spect );
+    cvReleaseMat( &state->tile );
+    cvFree( (void**)&state->sum );
+    cvFree( (void**)&state->sqsum );
+    cvFree( (void**)&state );
+}
+
+
+CV_IMPL CvMatchTemplateState*
+cvCreateMatchTemplateState( const CvArr* templarr )
+{
+    CvMatchTemplateState* state = 0;
+
+    CV_FUNCNAME( "cvCreateMatchTemplateState" );
+
+    __BEGIN__;
+
+    CvMat stub, *templ = (CvMat*)templarr;
+    CvScalar sum;
+    int coi = 0;
+
+    CV_CALL( templ = cvGetMat( templ, &stub, &coi ));
+
+    if( CV_MAT_CN( templ->type ) != 1 ||
+        (CV_MAT_DEPTH( templ->type ) != CV_8U &&
+        CV_MAT_DEPTH( templ->type ) != CV_8S &&
+        CV_MAT_DEPTH( templ->type ) != CV_32F) )
+        CV_ERROR( CV_StsUnsupportedFormat, "" );
+
+    CV_CALL( state = (CvMatchTemplateState*)cvAlloc( sizeof(*state) ));
+    memset( state, 0, sizeof(*state) );
+
+    CV_CALL( state->templ = cvCloneMat( templ ));
+    CV_CALL( sum = cvSum( templ ));
+    state->templ_sum = sum.val[0];
+    CV_CALL( state->templ_sqsum = cvDotProduct( templ, templ ));
+
+    __END__;
+
+    if( cvGetErrStatus() < 0 )
+    {
+        icvFreeMatchTemplateState( state );
+        state = 0;
+    }
+
+    return state;
+}
+
+
+CV_IMPL void
+cvReleaseMatchTemplateState( CvMatchTemplateState** state )
+{
+    CV_FUNCNAME( "cvReleaseMatchTemplateState" );
+
+    __BEGIN__;
+
+    if( !state )
+        CV_ERROR( CV_StsNullPtr, "" );
+
+    icvFreeMatchTemplateState( *state );
+    *state = 0;
+
+    __END__;
+}
+
+
+CV_IMPL void
+cvMatchTemplateWithState( const CvArr* arr, CvArr* resultarr, int method,
+                          CvMatchTemplateState* state )
+{
+    CV_FUNCNAME( "cvMatchTemplateWithState" );
+
+    __BEGIN__;
+
+    int coi = 0;
+    CvMat stub, *img = (CvMat*)arr;
+    CvMat resstub, *result = (CvMat*)resultarr;
+    CvSize img_size, templ_size;
+
+    if( !state )
+        CV_ERROR( CV_StsNullPtr, "" );
+
+    CV_CALL( img = cvGetMat( img, &stub, &coi ));
+    CV_CALL( result = cvGetMat( result, &resstub ));
+
+    img_size = icvGetMatSize( img );
+    templ_size = icvGetMatSize( state->templ );
+
+    /* small templates are cheaper in the spatial domain */
+    if( !icvMatchTemplateUseDFT( img_size, templ_size ))
+    {
+        CV_CALL( cvMatchTemplate( img, state->templ, result, method ));
+        EXIT;
+    }
+
+    if( !CV_ARE_TYPES_EQ( img, state->templ ))
+        CV_ERROR( CV_StsUnmatchedFormats, "" );
+
+    if( CV_MAT_TYPE( result->type ) != CV_32FC1 )
+        CV_ERROR( CV_StsUnsupportedFormat, "" );
+
+    if( result->width != img_size.width - templ_size.width + 1 ||
+        result->height != img_size.height - templ_size.height + 1 )
+        CV_ERROR( CV_StsUnmatchedSizes, "" );
+
+    if( method < CV_TM_SQDIFF || method > CV_TM_CCOEFF_NORMED )
+        CV_ERROR( CV_StsBadArg, "unknown comparison method" );
+
+    CV_CALL( icvMatchTemplateDFT( img, result, method, state ));
+
+    __END__;
+}
+
+/* End of file. */
@@ -646,3 +646,153 @@ cvCreateGLCMImage( CvGLCM* GLCM, int step )
     return dest;
 }
 
+
+
+/****************************************************************************************\
+
+      Texture descriptors of a grid of patches, from GLCM's kept up to date incrementally
+      as the patch slides along each row of the grid
+
+\****************************************************************************************/
+
+#define CV_MAX_NUM_GREY_LEVELS_PATCH  16
+
+CV_IMPL void
+cvCalcGLCMPatchDescriptors( const CvArr* srcarr, CvArr* dstarr, int levels,
+                            CvSize patchSize, CvSize patchStep, int dx, int dy )
+{
+    uchar* pairs = 0;
+    int* counts = 0;
+    double* nlogn = 0;
+
+    CV_FUNCNAME( "cvCalcGLCMPatchDescriptors" );
+
+    __BEGIN__;
+
+    CvMat srcstub, *src = (CvMat*)srcarr;
+    CvMat dststub, *dst = (CvMat*)dstarr;
+    uchar quant[CV_MAX_NUM_GREY_LEVELS_8U];
+    int   contrastTab[CV_MAX_NUM_GREY_LEVELS_PATCH*CV_MAX_NUM_GREY_LEVELS_PATCH];
+    float homogenityTab[CV_MAX_NUM_GREY_LEVELS_PATCH*CV_MAX_NUM_GREY_LEVELS_PATCH];
+    int   symTab[CV_MAX_NUM_GREY_LEVELS_PATCH*CV_MAX_NUM_GREY_LEVELS_PATCH];
+    int   symInc[CV_MAX_NUM_GREY_LEVELS_PATCH*CV_MAX_NUM_GREY_LEVELS_PATCH];
+    int   pairWidth, pairHeight, windowWidth, windowHeight, numPairs;
+    int   i, j, x, y;
+
+    CV_CALL( src = cvGetMat( src, &srcstub ));
+    CV_CALL( dst = cvGetMat( dst, &dststub ));
+
+    if( CV_MAT_TYPE( src->type ) != CV_8UC1 )
+        CV_ERROR( CV_StsUnsupportedFormat, "Source image must be 8uC1" );
+
+    if( CV_MAT_TYPE( dst->type ) != CV_32FC3 )
+        CV_ERROR( CV_StsUnsupportedFormat, "Descriptor array must be 32fC3" );
+
+    if( levels < 2 || levels > CV_MAX_NUM_GREY_LEVELS_PATCH )
+        CV_ERROR( CV_StsOutOfRange, "levels is not in 2 .. 16" );
+
+    if( patchSize.width <= abs(dx) || patchSize.height <= abs(dy) ||
+        patchStep.width <= 0 || patchStep.height <= 0 )
+        CV_ERROR( CV_StsBadSize, "Patch must be larger than the pixel offset" );
+
+    if( (dst->cols - 1)*patchStep.width + patchSize.width > src->cols ||
+        (dst->rows - 1)*patchStep.height + patchSize.height > src->rows )
+        CV_ERROR( CV_StsUnmatchedSizes, "Grid of patches does not fit in the image" );
+
+    // quantize, and pair each pixel with the one at (dx,dy), into a code a*levels + b
+    for( i = 0; i < CV_MAX_NUM_GREY_LEVELS_8U; i++ )
+        quant[i] = (uchar)((i*levels) >> 8);
+
+    pairWidth = src->cols - abs(dx);
+    pairHeight = src->rows - abs(dy);
+    CV_CALL( pairs = (uchar*)cvAlloc( pairWidth*pairHeight ));
+
+    for( y = 0; y < pairHeight; y++ )
+    {
+        const uchar* a = src->data.ptr + (y + MAX(-dy,0))*src->step + MAX(-dx,0);
+        const uchar* b = a + dy*src->step + dx;
+        uchar* p = pairs + y*pairWidth;
+
+        for( x = 0; x < pairWidth; x++ )
+            p[x] = (uchar)(quant[a[x]]*levels + quant[b[x]]);
+    }
+
+    // what each pair adds to the sums. The GLCM is made symmetric as in cvCreateGLCM:
+    // a pair adds 1 to both (a,b) and (b,a), which share one count, symTab[code], or
+    // 2 to (a,a). Its entropy term changes for both entries, or for the one
+    for( i = 0; i < levels; i++ )
+        for( j = 0; j < levels; j++ )
+        {
+            int code = i*levels + j;
+            contrastTab[code] = (i - j)*(i - j);
+            homogenityTab[code] = (float)(1./(1 + contrastTab[code]));
+            symTab[code] = MIN(i,j)*levels + MAX(i,j);
+            symInc[code] = i == j ? 2 : 1;
+        }
+
+    // a patch holds the pairs whose first pixel is in it and whose second pixel is too
+    windowWidth = patchSize.width - abs(dx);
+    windowHeight = patchSize.height - abs(dy);
+    numPairs = windowWidth*windowHeight;
+
+    // entropy is kept as the sum of m*log(m) over the symmetric counts m
+    CV_CALL( nlogn = (double*)cvAlloc( (2*numPairs + 1)*sizeof(nlogn[0]) ));
+    nlogn[0] = 0;
+    for( i = 1; i <= 2*numPairs; i++ )
+        nlogn[i] = i*log((double)i);
+
+    CV_CALL( counts = (int*)cvAlloc( levels*levels*sizeof(counts[0]) ));
+
+    for( i = 0; i < dst->rows; i++ )
+    {
+        const uchar* window = pairs + i*patchStep.height*pairWidth;
+        float* d = (float*)(dst->data.ptr + i*dst->step);
+        int contrastSum = 0;
+        double homogenitySum = 0, entropySum = 0;
+        int prevStart = 0, prevEnd = 0;
+
+        memset( counts, 0, levels*levels*sizeof(counts[0]) );
+
+        for( j = 0; j < dst->cols; j++, d += 3 )
+        {
+            int start = j*patchStep.width, end = start + windowWidth;
+
+            // columns of pairs the patch has left
+            for( x = prevStart; x < MIN(start, prevEnd); x++ )
+                for( y = 0; y < windowHeight; y++ )
+                {
+                    int code = window[y*pairWidth + x], s = symTab[code], m = counts[s];
+                    int inc = symInc[code];
+                    contrastSum -= contrastTab[code];
+                    homogenitySum -= homogenityTab[code];
+                    entropySum += (3 - inc)*(nlogn[m - inc] - nlogn[m]);
+                    counts[s] = m - inc;
+                }
+
+            // columns of pairs the patch has reached
+            for( x = MAX(start, prevEnd); x < end; x++ )
+                for( y = 0; y < windowHeight; y++ )
+                {
+                    int code = window[y*pairWidth + x], s = symTab[code], m = counts[s];
+                    int inc = symInc[code];
+                    contrastSum += contrastTab[code];
+                    homogenitySum += homogenityTab[code];
+                    entropySum += (3 - inc)*(nlogn[m + inc] - nlogn[m]);
+                    counts[s] = m + inc;
+                }
+
+            prevStart = start;
+            prevEnd = end;
+
+            d[CV_GLCMPATCH_CONTRAST] = (float)contrastSum/numPairs;
+            d[CV_GLCMPATCH_HOMOGENITY] = (float)(homogenitySum/numPairs);
+            d[CV_GLCMPATCH_ENTROPY] = (float)(log(2.*numPairs) - entropySum/(2*numPairs));
+        }
+    }
+
+    __END__;
+
+    cvFree( (void**)&counts );
+    cvFree( (void**)&nlogn );
+    cvFree( (void**)&pairs );
+}
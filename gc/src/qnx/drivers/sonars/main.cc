@@ -14,12 +14,26 @@
 #include <iostream>
 #include <getoptions.h>
 #include <srf08.h>
+#include "sonarsched.h"
 
 using namespace std;
 
 int verbose = 0;
 
 char * dev = "/dev/ser1";
+char * config = 0;
+float crosstalk_margin = 10;	//degrees of beam separation to allow
+
+//default array: six units evenly around the vehicle, about 55 degree beams,
+//range cut back to 6m with gain to suit
+static const sonar_unit default_units[] = {
+	{ SRF08_UNIT_0,   0, 55, 6000, 16 },
+	{ SRF08_UNIT_1,  60, 55, 6000, 16 },
+	{ SRF08_UNIT_2, 120, 55, 6000, 16 },
+	{ SRF08_UNIT_3, 180, 55, 6000, 16 },
+	{ SRF08_UNIT_4, 240, 55, 6000, 16 },
+	{ SRF08_UNIT_5, 300, 55, 6000, 16 },
+};
  
  static int
 version( void )
@@ -38,12 +52,30 @@ help( void )
 		"       -V | --version                  Display version\n"
 		"       -v | --verbose                  Verbose\n"
 		"       -d | --dev serial_dev           Serial device to use for SONAR server\n"
+		"       -c | --config file              Sonar geometry and crosstalk table\n"
 		"\n"
 	     << endl;
 
 	exit(-1);
 }
 
+/**
+ * publish one group of readings
+ */
+static void
+publish(const sonar_reading * readings, int count)
+{
+	printf("%.3f", readings[0].timestamp);
+	for (int i = 0; i < count; i++) {
+		if (readings[i].valid) {
+			printf(" %x:%d", readings[i].address, readings[i].dist);
+		}
+		else {
+			printf(" %x:INV", readings[i].address);
+		}
+	}
+	printf("\n");
+}
 
 int
 main(int argc, char ** argv)
@@ -53,6 +85,7 @@ main(int argc, char ** argv)
 			 "V|version&",          version,
 			 "v|verbose+",          &verbose,
 			 "d|dev=s",				&dev,
+			 "c|config=s",				&config,
 			 0
 		    );
 
@@ -60,29 +93,28 @@ main(int argc, char ** argv)
 //	srf08_select_unit(SRF08_UNIT_5);
 //	srf08_change_i2c_address(SRF08_UNIT_1);
 
-	//keep polling for data
-	
-	while (true) {
-		
-		int num_dists = 6;
-		unsigned int dists[num_dists];
-		
-		dists[0] = srf08_ping(SRF08_UNIT_0);
-		dists[1] = srf08_ping(SRF08_UNIT_1);
-		dists[2] = srf08_ping(SRF08_UNIT_2);
-		dists[3] = srf08_ping(SRF08_UNIT_3);
-		dists[4] = srf08_ping(SRF08_UNIT_4);
-		dists[5] = srf08_ping(SRF08_UNIT_5);
-
-		for (int i = 0; i < num_dists; i++) {
-			if (dists[i] < 1000) { //sanity check
-				printf(" %d ", dists[i]);
-			}
-			else {
-				printf(" INV ");
-			}
+	SonarScheduler sched;
+	if (config) {
+		if (sched.load(config) <= 0) {
+			cerr << "No sonars configured in " << config << endl;
+			exit(-1);
+		}
+	}
+	else {
+		for (unsigned int i = 0; i < sizeof(default_units)/sizeof(default_units[0]); i++) {
+			sched.add_unit(default_units[i]);
 		}
-		printf("\n");
+	}
+	sched.build_groups(crosstalk_margin);
+	sched.configure_units();
+	if (verbose) {
+		printf("%d sonars in %d groups\n", sched.unit_count(), sched.group_count());
+		sched.dump();
+	}
+
+	//keep polling for data, publishing each group as it completes
+	while (true) {
+		sched.run_cycle(publish);
 	}
 
 	//TODO
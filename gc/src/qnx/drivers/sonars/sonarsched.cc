@@ -0,0 +1,198 @@
+/* -*- indent-tabs-mode:T; c-basic-offset:8; tab-width:8; -*- vi: set ts=8:
+ *
+ * Team Overbot
+ * October 2026
+ *
+ * Interleaved firing of the SRF08 array
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <srf08.h>
+#include <timeutil.h>
+#include "sonarsched.h"
+
+SonarScheduler::SonarScheduler()
+{
+	memset(crosstalk, 0, sizeof(crosstalk));
+	memset(forced, -1, sizeof(forced));
+}
+
+int SonarScheduler::index_of(unsigned char address) const
+{
+	for (unsigned int i = 0; i < units.size(); i++) {
+		if (units[i].address == address) return i;
+	}
+	return -1;
+}
+
+void SonarScheduler::add_unit(const sonar_unit & unit)
+{
+	if (units.size() >= SONAR_MAX_UNITS) {
+		cerr << "sonarsched: too many units, ignoring 0x" << hex << int(unit.address) << dec << endl;
+		return;
+	}
+	units.push_back(unit);
+}
+
+/**
+ * force a pair of units to be (or not be) fired at different times,
+ * whatever the geometry says
+ */
+void SonarScheduler::set_crosstalk(unsigned char a, unsigned char b, bool interferes)
+{
+	int i = index_of(a);
+	int j = index_of(b);
+	if (i < 0 || j < 0) {
+		cerr << "sonarsched: crosstalk entry for unknown unit" << endl;
+		return;
+	}
+	forced[i][j] = forced[j][i] = interferes ? 1 : 0;
+}
+
+/* a crosstalk line of the config file */
+struct crosstalk_line {
+	unsigned int a, b;
+	bool interferes;
+};
+
+/**
+ * config file, one entry per line, # for comments:
+ *
+ *	unit <address> <bearing deg> <beamwidth deg> <range mm> <gain>
+ *	crosstalk <address> <address> yes|no
+ *
+ * addresses may be given in hex, e.g. 0xE0
+ * crosstalk lines may come before the units they name; they are
+ * applied once the whole file has been read
+ */
+int SonarScheduler::load(const char * filename)
+{
+	FILE * f = fopen(filename, "r");
+	if (!f) {
+		cerr << "sonarsched: can't open " << filename << endl;
+		return -1;
+	}
+	std::vector<crosstalk_line> overrides;	//applied after all units are known
+	char line[256];
+	int lineno = 0;
+	while (fgets(line, sizeof(line), f)) {
+		lineno++;
+		char * hash = strchr(line, '#');
+		if (hash) *hash = '\0';
+		char keyword[32], answer[32];
+		unsigned int a, b, range, gain;
+		float bearing, beamwidth;
+		if (sscanf(line, "%31s", keyword) != 1) continue;	//blank line
+		if (strcmp(keyword, "unit") == 0
+		    && sscanf(line, "%*s %i %f %f %u %u", &a, &bearing, &beamwidth, &range, &gain) == 5) {
+			sonar_unit unit;
+			unit.address = a;
+			unit.bearing = bearing;
+			unit.beamwidth = beamwidth;
+			unit.range = range;
+			unit.gain = gain;
+			add_unit(unit);
+		}
+		else if (strcmp(keyword, "crosstalk") == 0
+			 && sscanf(line, "%*s %i %i %31s", &a, &b, answer) == 3) {
+			crosstalk_line o = { a, b, strcmp(answer, "yes") == 0 };
+			overrides.push_back(o);
+		}
+		else {
+			cerr << "sonarsched: " << filename << " line " << lineno << " not understood" << endl;
+		}
+	}
+	fclose(f);
+	for (unsigned int i = 0; i < overrides.size(); i++) {
+		set_crosstalk(overrides[i].a, overrides[i].b, overrides[i].interferes);
+	}
+	return units.size();
+}
+
+/**
+ * two units interfere if their beams, widened by margin degrees, overlap;
+ * then assign units to groups greedily, so no two units in a group interfere
+ */
+void SonarScheduler::build_groups(float margin)
+{
+	const int n = units.size();
+	for (int i = 0; i < n; i++) {
+		for (int j = 0; j < n; j++) {
+			float sep = fabs(fmod(units[i].bearing - units[j].bearing, 360.0f));
+			if (sep > 180) sep = 360 - sep;
+			bool overlap = (i != j) && sep < (units[i].beamwidth + units[j].beamwidth) * 0.5f + margin;
+			if (forced[i][j] >= 0) overlap = forced[i][j];
+			crosstalk[i][j] = overlap;
+		}
+	}
+	groups.clear();
+	group_wait.clear();
+	for (int i = 0; i < n; i++) {
+		unsigned int g;
+		for (g = 0; g < groups.size(); g++) {
+			bool ok = true;
+			for (unsigned int k = 0; k < groups[g].size(); k++) {
+				if (crosstalk[i][groups[g][k]]) { ok = false; break; }
+			}
+			if (ok) break;
+		}
+		if (g == groups.size()) {
+			groups.push_back(std::vector<int>());
+			group_wait.push_back(0);
+		}
+		groups[g].push_back(i);
+		//a group is only as fast as its longest range unit
+		unsigned int ms = srf08_echo_ms(units[i].range);
+		if (ms > group_wait[g]) group_wait[g] = ms;
+	}
+}
+
+void SonarScheduler::configure_units()
+{
+	for (unsigned int i = 0; i < units.size(); i++) {
+		srf08_select_unit(units[i].address);
+		srf08_set_range(units[i].range);
+		srf08_set_gain(units[i].gain);
+	}
+}
+
+/**
+ * fire each group in turn
+ * every unit in the group is pinged, then we wait until the last one
+ * pinged has had its echo time, read them all back, and publish
+ */
+void SonarScheduler::run_cycle(sonar_publish_fn publish)
+{
+	sonar_reading readings[SONAR_MAX_UNITS];
+	for (unsigned int g = 0; g < groups.size(); g++) {
+		const std::vector<int> & group = groups[g];
+		for (unsigned int k = 0; k < group.size(); k++) {
+			srf08_ping_send(units[group[k]].address);
+		}
+		//the serial bridge is slow, so the earlier units are done
+		//sooner; only the last one sent needs the full echo time
+		double sent = gettimenow();
+		wait(group_wait[g]);
+		for (unsigned int k = 0; k < group.size(); k++) {
+			sonar_reading & r = readings[k];
+			r.address = units[group[k]].address;
+			r.dist = srf08_ping_recv(r.address);
+			r.valid = r.dist < 1000;	//sanity check
+			r.timestamp = sent;
+		}
+		publish(readings, group.size());
+	}
+}
+
+void SonarScheduler::dump() const
+{
+	for (unsigned int g = 0; g < groups.size(); g++) {
+		printf("group %d (%d ms):", g, group_wait[g]);
+		for (unsigned int k = 0; k < groups[g].size(); k++) {
+			printf(" 0x%x", units[groups[g][k]].address);
+		}
+		printf("\n");
+	}
+}
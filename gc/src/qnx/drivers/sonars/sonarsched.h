@@ -0,0 +1,63 @@
+/* -*- indent-tabs-mode:T; c-basic-offset:8; tab-width:8; -*- vi: set ts=8:
+ *
+ * Team Overbot
+ * October 2026
+ *
+ * Interleaved firing of the SRF08 array
+ *
+ * Sonars whose beams cannot hear each other are fired together, and the
+ * whole group is read back as soon as the longest echo time in the group
+ * has passed, instead of pinging one unit at a time with a fixed 65ms wait.
+ * Which units interfere comes from the mounting geometry, with overrides
+ * from the configuration file.
+ */
+
+#ifndef SONARSCHED_H
+#define SONARSCHED_H
+
+#include <vector>
+
+#define SONAR_MAX_UNITS		16
+
+/* one sonar, as mounted */
+struct sonar_unit {
+	unsigned char address;		/* SRF08_UNIT_n */
+	float bearing;			/* degrees, clockwise from straight ahead */
+	float beamwidth;		/* full beam angle, degrees */
+	unsigned int range;		/* max range, mm */
+	unsigned char gain;		/* SRF08_MIN_GAIN..SRF08_MAX_GAIN */
+};
+
+/* one reading */
+struct sonar_reading {
+	unsigned char address;
+	unsigned int dist;		/* cm */
+	bool valid;
+	double timestamp;		/* when the group was fired, seconds */
+};
+
+/* called with the readings of each group as it completes */
+typedef void (*sonar_publish_fn)(const sonar_reading * readings, int count);
+
+class SonarScheduler {
+public:
+	SonarScheduler();
+	int load(const char * filename);			/* read config file, returns unit count or -1 */
+	void add_unit(const sonar_unit & unit);
+	void set_crosstalk(unsigned char a, unsigned char b, bool interferes);
+	void build_groups(float margin);			/* crosstalk from geometry, then group */
+	void configure_units();				/* send range and gain to each unit */
+	void run_cycle(sonar_publish_fn publish);		/* fire every group once */
+	int unit_count() const { return units.size(); }
+	int group_count() const { return groups.size(); }
+	void dump() const;
+private:
+	int index_of(unsigned char address) const;
+	std::vector<sonar_unit> units;
+	bool crosstalk[SONAR_MAX_UNITS][SONAR_MAX_UNITS];	/* from geometry */
+	signed char forced[SONAR_MAX_UNITS][SONAR_MAX_UNITS];	/* -1 none, 0 no, 1 yes */
+	std::vector< std::vector<int> > groups;		/* unit indices fired together */
+	std::vector<unsigned int> group_wait;		/* ms to wait for each group */
+};
+
+#endif //SONARSCHED_H
@@ -17,29 +17,51 @@ void srf08_init(char * dev)
 }
 
 
-//can be modified slightly to use
-/*
+/**
+ * sets the analogue gain of the selected unit (see srf08_select_unit)
+ * lower gain with shorter range, or echoes from the previous ping are picked up
+ */
 void srf08_set_gain(unsigned char gain)
 {
-	if (gain > 31) gain = 31;
-	I2C_START_TX(address);
+	if (gain > SRF08_MAX_GAIN) gain = SRF08_MAX_GAIN;
+	i2c_start();
+	i2c_transmit(address);
 	i2c_transmit(SRF08_GAIN);
 	i2c_transmit(gain);
 	i2c_stop();
-	
 }
 
+/**
+ * sets the maximum range of the selected unit
+ * the unit stops listening after (register+1)*43mm, so a shorter range
+ * means the result can be read back sooner than the default 65ms
+ */
 void srf08_set_range(unsigned int millimeters)
 {
-    millimeters= (millimeters/43);
-    if(millimeters > 0xff ) { millimeters=0xff; }
-    I2C_START_TX(address);
-    i2c_transmit(2);
-    i2c_transmit(millimeters);
-    i2c_stop();
+	if (millimeters > SRF08_MAX_RANGE) millimeters = SRF08_MAX_RANGE;
+	unsigned int reg = (millimeters + 42) / 43;	//round up
+	if (reg > 0) reg--;
+	if (reg > 0xff) reg = 0xff;
+	i2c_start();
+	i2c_transmit(address);
+	i2c_transmit(SRF08_RANGE);
+	i2c_transmit(reg);
+	i2c_stop();
+}
 
+/**
+ * time in ms from srf08_ping_send until the result can be read,
+ * for a unit set to the given range
+ * sound takes about 5.8us per mm for the round trip; allow a little
+ * extra for the unit to finish up
+ */
+unsigned int srf08_echo_ms(unsigned int millimeters)
+{
+	if (millimeters > SRF08_MAX_RANGE) millimeters = SRF08_MAX_RANGE;
+	unsigned int ms = (millimeters * 2) / 343 + 5;
+	if (ms > 65) ms = 65;
+	return ms;
 }
-*/
 
 //for reference, might come in useful
 /*
@@ -40,6 +40,7 @@ using namespace std;
 #define SRF08_COMMAND         0
 #define SRF08_LIGHT           1
 #define SRF08_GAIN            1
+#define SRF08_RANGE           2      /* write only; reads as SRF08_ECHO_1 */
 #define SRF08_ECHO_1          2
 #define SRF08_ECHO_2          4
 #define SRF08_ECHO_3          6
@@ -67,6 +68,7 @@ extern void          srf08_init(char * dev);
 
 extern void          srf08_set_gain(unsigned char gain);
 extern void          srf08_set_range(unsigned int millimeters);
+extern unsigned int  srf08_echo_ms(unsigned int millimeters);
 
 extern void			 srf08_ping_send(unsigned char address);
 extern unsigned int  srf08_ping_recv(unsigned char address);
@@ -17,7 +17,8 @@
 #include <math.h>
 #include "Vector.h"
 #include "logprint.h"
-#include "tuneable.h"
+#include "tuneable.h"
+
 
 //
 //	Constants
@@ -37,6 +38,9 @@ const double k_min_odometer_delta = 0.0001;						// Minimum movement, meters tha
 const double k_min_odometer_cal_delta = 0.0166;						// Minimum movement for odometer calibration
 
 FusedNav::FusedNav(char* fusednavLog,  Kalman_Filter * pKF,  AHRS * pAHRS, GPS * pGPS) :
+	mVOForward(0.0),
+	mVOLeft(0.0),
+	mVOVariance(0.0),
         mAbs(0,0,0),
         mDRPosition(0,0,0),
         mDRUnc(0,0,0),
@@ -93,6 +97,22 @@ FusedNav::fuseAHRS()
 
 } // end of FusedNav::fuseAHRS()
 
+/* Called by the server thread when the road follower sends the motion between two
+   camera frames. Totals are kept until the next dead reckoning update uses them.
+*/
+void
+FusedNav::fuseVisualOdometry(const GPSINSVisualOdometry& vo)
+{
+	if (vo.dt <= 0 || vo.unc <= 0)
+	{
+		return;					// not a usable measurement
+	}
+	ost::MutexLock lok(m_volock);
+	mVOForward += vo.forward;
+	mVOLeft += vo.left;
+	mVOVariance += vo.unc * vo.unc;
+} // end of FusedNav::fuseVisualOdometry()
+
 
 /*******************************************************************************************
  *	fuseGPS:
@@ -194,6 +214,7 @@ FusedNav::fuseGPS()
 			mOdometerValueCurrent = mTravelData.odometer;
 			mOdometerValuePrevious = mOdometerValueCurrent; // Zero the odometer history
 			mOdometerDistThisGPSCycle = 0.0;
+			discardVisualOdometry();			// camera motion from before now is of no use
 			mRel = mZeroVector;
 			mDRPosition = mAbs;
 			mFusedPosition = mAbs;
@@ -245,20 +266,25 @@ FusedNav::updateDRPosition()
 	
 	mTravelData = mOdoSpeedometer.getTravelData();	// read odomoter
 	mOdometerValueCurrent = mTravelData.odometer;
-	mOdometerDistThisGPSCycle = mOdometerValueCurrent - mOdometerValuePrevious;
+	mOdometerDistThisGPSCycle = (mOdometerValueCurrent - mOdometerValuePrevious) * mOdometerCalibration;
 	mOdometerValuePrevious = mOdometerValueCurrent;
-	if(abs(mOdometerDistThisGPSCycle) > k_min_odometer_delta)
+	double dist = mOdometerDistThisGPSCycle;			// distance moved forward
+	double distsd = abs(dist) * k_odometer_error_per_meter;		// and its uncertainty
+	double left = 0.0;						// sideways motion, only the camera sees it
+	blendVisualOdometry(dist, distsd, left);			// combine with road camera motion, if any
+	if(abs(dist) > k_min_odometer_delta)
 	{
 		mMoving = true;
-		mOdometerDistThisGPSCycle = mOdometerDistThisGPSCycle * mOdometerCalibration;
-		mRelPiece[0] =  mOdometerDistThisGPSCycle * cos(mRPY[2]*M_PI/180);  // north, note: heading(yaw) in deg
-		mRelPiece[1] =  mOdometerDistThisGPSCycle * sin(mRPY[2]*M_PI/180);  // east, note: heading(yaw) in deg
-		mRelPiece[2] = -mOdometerDistThisGPSCycle * sin(mRPY[1]*M_PI/180);  // down, note: pitch in deg, '-' sign is due to down is positive
-		mRel += mRelPiece;				// based on odometer(encoder), and AHRS yaw (heading)
+		const double yaw = mRPY[2]*M_PI/180;			// heading(yaw) in deg
+		mRelPiece[0] =  dist * cos(yaw) + left * sin(yaw);	// north; left is west when heading north
+		mRelPiece[1] =  dist * sin(yaw) - left * cos(yaw);	// east
+		mRelPiece[2] = -dist * sin(mRPY[1]*M_PI/180);  // down, note: pitch in deg, '-' sign is due to down is positive
+		mRel += mRelPiece;				// based on odometer(encoder) and camera, and AHRS yaw (heading)
 		mDRPosition = mDRBase + mRel;
+		const double errorpermeter = distsd / abs(dist);	// k_odometer_error_per_meter, unless camera helped
 		for (int i=0;i<3;i++)
 		{
-			mDRUnc[i] += abs( mRelPiece[i] ) * k_odometer_error_per_meter;
+			mDRUnc[i] += abs( mRelPiece[i] ) * errorpermeter;
 		}		
 	}
 	else
@@ -266,6 +292,46 @@ FusedNav::updateDRPosition()
 		mMoving = false;
 	}
 }
+
+/* Combine the road camera's motion since the last dead reckoning update with the odometer's.
+   The forward distances are weighted by their variances. If the odometer is not answering,
+   the camera's distance is used alone. Sideways motion, such as a skid, comes only from the camera.
+*/
+void
+FusedNav::blendVisualOdometry(double& dist, double& distsd, double& left)
+{
+	ost::MutexLock lok(m_volock);
+	if (mVOVariance <= 0)
+	{
+		return;					// nothing from the camera since last time
+	}
+	if (!finite(dist))
+	{
+		dist = mVOForward;
+		distsd = sqrt(mVOVariance);
+	}
+	else
+	{
+		const double odovar = distsd * distsd;
+		dist = (dist * mVOVariance + mVOForward * odovar) / (odovar + mVOVariance);
+		distsd = sqrt(odovar * mVOVariance / (odovar + mVOVariance));
+	}
+	left = mVOLeft;
+	mVOForward = 0.0;
+	mVOLeft = 0.0;
+	mVOVariance = 0.0;
+}
+
+/* Throw away the road camera's motion totals, as when dead reckoning restarts from a GPS fix.
+*/
+void
+FusedNav::discardVisualOdometry()
+{
+	ost::MutexLock lok(m_volock);
+	mVOForward = 0.0;
+	mVOLeft = 0.0;
+	mVOVariance = 0.0;
+}
 	     
         
 void
@@ -54,6 +54,7 @@ public:
 	
 	void fuseAHRS();   // fuse the latest AHRS sample result into fusednav
 	void fuseGPS();    // fuse the latest GPS sample result into fusednav	
+	void fuseVisualOdometry(const GPSINSVisualOdometry& vo);	// add motion seen by the road camera
 private:
 	double getOdometerCalibration();
 	void discontinuityCheck();
@@ -62,9 +63,15 @@ private:
 	void clearFilterBuffer();
 	void updatePosition();
 	void updateDRPosition();
+	void blendVisualOdometry(double& dist, double& distsd, double& left);
+	void discardVisualOdometry();
 	void updateFusedPosition();
 	double calcCircUncertainty( Vector<3> unc);
 	ost::Mutex m_lock;			// lock during updates
+	ost::Mutex m_volock;			// lock for visual odometry totals, added to by the server thread
+	double		mVOForward;		// camera motion since last DR update, forward (m)
+	double		mVOLeft;		// and to the left (m)
+	double		mVOVariance;		// and its variance (m^2), zero if none
 public:
 
 	Kalman_Filter * mKF;
@@ -51,6 +51,15 @@ static void handle_getbasepoint(int rcvid, const GPSINSGetBasepoint& msg, Kalman
 	MsgReply(rcvid, reply);
 }
 
+//
+//	handle_visualodometry -- motion measured by the road camera
+//
+static void handle_visualodometry(int rcvid, const GPSINSVisualOdometry& msg, Kalman_Filter* kf)
+{
+	MsgError(rcvid, EOK);							// reply first, so the camera is not held up
+	kf->mFusedNav->fuseVisualOdometry(msg);				// used in dead reckoning
+}
+
 //TODO
 //we really would need a lock on the data structs
 void *
@@ -107,6 +116,10 @@ server_thread(void * args_v)
 			case GPSINSGetBasepoint::k_msgtype:									// get basepoint
 				handle_getbasepoint(rcvid, msgin.m_getbasepoint,kf);	// just retrieves current basepoint
 				break;
+
+			case GPSINSVisualOdometry::k_msgtype:								// motion from road camera
+				handle_visualodometry(rcvid, msgin.m_visualodometry, kf);
+				break;
 				
 			default:
 				MsgError(rcvid, EINVAL);													// some invalid request
@@ -66,7 +66,6 @@ const float k_scannerheight = 2.04;										// scanner height from ground
 const vec3 k_scannertiltaxis(0,1,0);										// tilt axis of scanner
 const size_t k_lidar_queue_size  = 25;									// max number of scan lines to queue before processing
 
-inline bool nonrangevalue(uint16_t range) { return(range > 8182); }				// true if special value from SICK unit
 //
 //	dump  -- debug support
 //
@@ -103,6 +102,7 @@ LMSmapUpdater::LMSmapUpdater(MapServer& owner, const vec3& scanneroffset)
 	m_gazecontrol(*this, k_tiltserver, k_frontlook, k_rearlook),	// gaze initialization
 	m_scanneroffset(scanneroffset), 
 	m_prevvalid(false),
+	m_prevscanline(NULL),
 	m_tiltcorrector(*this)
 {
 	m_scanneroffsetransform = translation3D(m_scanneroffset);	// construct matrix for scanner offset from GPS pos
@@ -176,20 +176,19 @@ void LMSmapUpdater::LMShandlePosedLidarData(const LidarScanLine& inlp, const mat
 {
 	//	Stamp the scan line
 	uint32_t cyclestamp = m_owner.getMap().incrementcyclestamp();	// increment scan line serial number
-	float avgrange;																// average range
-	bool goodavgrange = LMScalcAverageRange(inlp, avgrange);			// calc average range
-	LidarScanLine lp;  // scan line data with corrected tilt
+	LMSpreprocess(inlp, m_tiltcorrector.nextLine());					// convert straight into tilt corrector window
+	LMSrangeLine* lp;  																// scan line data with corrected tilt
 	mat4 vehpose=invehpose; 
-	bool good = m_tiltcorrector.correctTilt(inlp,goodavgrange, avgrange, vehpose, cyclestamp, lp);	// correct tilt
+	bool good = m_tiltcorrector.correctTilt(vehpose, cyclestamp, lp);	// correct tilt
 	if (!good)																		// trouble
 	{	m_prevvalid = false;													// no good scan line pair
 		return;																		// reject
 	}
-	float tilt = lp.m_header.m_tilt;										// get corrected tilt
+	float tilt = lp->m_header.m_tilt;										// get corrected tilt
 	//	tilt angle, 0 is down, pi/2 is forward
 	//	Tilt correction based on average range to target for area near center of scan
 
-	good = LMSgazeCheck(tilt, avgrange, goodavgrange);			// check gaze direction, dazzle, tilt, etc.
+	good = LMSgazeCheck(tilt, lp->m_avgrange, lp->m_goodavgrange);	// check gaze direction, dazzle, tilt, etc.
 	if (!good)																		// trouble
 	{	m_prevvalid = false;													// no good scan line pair
 		return;																		// reject
@@ -198,10 +197,10 @@ void LMSmapUpdater::LMShandlePosedLidarData(const LidarScanLine& inlp, const mat
 	const mat4 scannerpose(vehpose*LMStiltPose(tilt));	// get the scanner transform in world space
     if (m_prevvalid)															// if previous line is valid
 	{	 //	Process the pair of scan lines
-    	LMSupdateScanlinePair(m_prevscanline, m_prevscannerpose, lp, scannerpose, cyclestamp);
+    	LMSupdateScanlinePair(*m_prevscanline, m_prevscannerpose, *lp, scannerpose, cyclestamp);
     }
     m_prevscannerpose = scannerpose;							// save for next pair of scan lines
-    m_prevscanline = lp;
+    m_prevscanline = lp;														// stays in tilt corrector window for the next line
     m_prevvalid = true;
 }
 //
@@ -252,39 +251,13 @@ public:
 };
 const LMSLidarScanVectors k_scan_table(181);				// build table
 //
-//	LMSrangeConvert  --  convert range from LIDAR value to meters
+//	LMSpreprocess  -- convert one scan line to meters, and get its average range
 //
-//	Returns zero for invalid values.
+//	The average is over the narrow scan range used for gaze management.
 //
-inline float LMSrangeConvert(uint16_t range)
-{	if (nonrangevalue(range)) return(0.0);							// handle special value
-	return(range*0.01);														// convert to meters
-}
-//
-//	LMScalcAverageRange  -- check scan data for average range of center section of scan
-//
-//	Returns true if narrow range is all good
-//
-bool 	LMSmapUpdater::LMScalcAverageRange(const LidarScanLine& lp, float& avgrange)
-{	const int center = k_scan_table.size()/2;							// index of center point
-	const int k_max_bad_points = 4;										// more than this stops scan
-	const float k_default_avgrange = 999;								// huge bogus average range value
-	//	Scan for gaze management purposes. Narrow scan range only.
-	//	If we can't see all the pixels in the narrow scan range, we have to tilt the scanner down
-	{	uint32_t rangetotal = 0;												// total of ranges examined
-		int rangecount = 0;														// count
-		int badpoints = 0;															// bad points seen
-		for (int i= -k_maxgazeangle; i<= k_maxgazeangle; i++)
-		{	uint16_t range = lp.m_range[center+i];					// get a range point
-			if (!nonrangevalue(range))										// if valid
-			{	rangetotal += range;	rangecount ++;}				// total
-			else																			// bad values
-			{	badpoints++;														// trouble
-			}
-		}
-		avgrange = rangecount ? (rangetotal*0.01/rangecount) : k_default_avgrange;			// range seen, avoid divide by 0
-		return(badpoints <= k_max_bad_points);						// valid if no bad points
-	}
+void LMSmapUpdater::LMSpreprocess(const LidarScanLine& lp, LMSrangeLine& out)
+{	assert(k_scan_table.size() == int(LMS_MAX_DATA_POINTS));		// same center point
+	LMSpreprocessLine(lp, k_maxgazeangle, out);
 }
 //
 //	LMSgazeCheck  -- check scan data for gaze adjustment
@@ -303,8 +276,8 @@ bool 	LMSmapUpdater::LMSgazeCheck(float tilt, float avgrange, bool gooddata)
 //
 //	This is where all the real work gets done.
 //
-void LMSmapUpdater::LMSupdateScanlinePair(const LidarScanLine& lp1, const mat4& scannerpose1,
-					const LidarScanLine& lp2, const mat4& scannerpose2, uint32_t cyclestamp, bool playback)
+void LMSmapUpdater::LMSupdateScanlinePair(const LMSrangeLine& lp1, const mat4& scannerpose1,
+					const LMSrangeLine& lp2, const mat4& scannerpose2, uint32_t cyclestamp, bool playback)
 {
 	ost::MutexLock lok(m_owner.getMapLock());					// lock map during update; others are reading it
 	bool lp1odd = (lp1.m_header.m_valueCount & 1);		// an "odd" line contains 181 entries, degrees -180,-179....179..180
@@ -342,12 +315,12 @@ void LMSmapUpdater::LMSupdateScanlinePair(const LidarScanLine& lp1, const mat4&
 	//	Scan across the two scan lines, updating triangles of three scan points.
 	for (int i = -k_maxangle; i<= k_maxangle; i++)			// scan across the line
 	{	
-		//	Get relevant ranges and convert to meters.
-		//	Invalid values become zero.
-		float r1a = LMSrangeConvert(lp1.m_range[center+i-1]);
-		float r1b = LMSrangeConvert(lp1.m_range[center+i]);
-		float r2a = LMSrangeConvert(lp2.m_range[center+i-1]);
-		float r2b = LMSrangeConvert(lp2.m_range[center+i]);
+		//	Get relevant ranges, already in meters.
+		//	Invalid values are zero.
+		float r1a = lp1.m_range[center+i-1];
+		float r1b = lp1.m_range[center+i];
+		float r2a = lp2.m_range[center+i-1];
+		float r2b = lp2.m_range[center+i];
 		//	Calculate minimum range for each triangle.  This is used only so that near updates override far ones.
 		float minrange1 = std::min(std::min(r1a,r1b),r2a);
 		float minrange2 = std::min(std::min(r1b,r2a),r2b);
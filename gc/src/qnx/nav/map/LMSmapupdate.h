@@ -33,6 +33,7 @@
 #include "algebra3.h"
 #include "lidarserver.h"
 #include "gazecontrol.h"
+#include "LMSpreprocess.h"
 #include "LMStiltcorrect.h"
 //
 class MapServer;																	// forward
@@ -50,7 +51,7 @@ private:
 	std::queue<LidarScanLine*> m_emptyqueue;					// empty line buffers
 	//	Previous item, for line pair
 	bool m_prevvalid;																// previous info valid
-	LidarScanLine m_prevscanline;										// previous scan line
+	const LMSrangeLine* m_prevscanline;								// previous scan line, still in tilt corrector window
 	mat4	m_prevscannerpose;												// previous scanner pose
 	//	Tilt correction history
 	LMStiltCorrector m_tiltcorrector;										// the tilt corrector
@@ -58,8 +59,8 @@ public:
 	LMSmapUpdater(MapServer& owner, const vec3& scanneroffset);	// position relative to GPS
 	void LMShandleLidarData(const LidarScanLine& lp);
 	int getVerboseLevel() const;												// 3 or more for this 
-	void LMSupdateScanlinePair(const LidarScanLine& lp1, const mat4& scannerpose1,
-					const LidarScanLine& lp2, const mat4& scannerpose2, uint32_t cyclestamp, bool playback = false);
+	void LMSupdateScanlinePair(const LMSrangeLine& lp1, const mat4& scannerpose1,
+					const LMSrangeLine& lp2, const mat4& scannerpose2, uint32_t cyclestamp, bool playback = false);
 	mat4 LMStiltPose(float tilt);
 	bool LMSvalid() const { return(m_prevvalid);	}				// getting valid scan lines? ***TEMP***
 	void resetAncientStamp();												// reset ancient stamp so new data overrides old
@@ -68,7 +69,8 @@ public:
 	bool gazeistracking();														// true if up and in tracking mode
 	bool gazeissweeping();													// true if up and in sweeping  mode 
 	LMStiltCorrector& getLMStiltCorrector() {return(m_tiltcorrector);}
-	bool LMScalcAverageRange(const LidarScanLine& lp, float& avgrange);
+	const vec3& getScannerOffset() const { return(m_scanneroffset); }	// scanner position relative to GPS
+	void LMSpreprocess(const LidarScanLine& lp, LMSrangeLine& out);		// convert line to meters, get average range
 
 private:
 	void LMShandlePosedLidarData(const LidarScanLine& lp, const mat4& vehpose);
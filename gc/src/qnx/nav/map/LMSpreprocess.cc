@@ -0,0 +1,68 @@
+//
+//	LMSpreprocess.cc  --  once-per-line preprocessing of SICK LMS scan lines
+//
+//	Team Overbot
+//	October, 2026
+//
+#include <math.h>
+#include <algorithm>
+#include "LMSpreprocess.h"
+#include "tuneable.h"
+//
+//	Configurable constants
+//
+//	Despeckling replaces a sample which differs from both its neighbors, by more than
+//	this, with the median of the three. Off by default; a post or a wire at range is
+//	only one sample wide, and we don't want to lose those.
+//
+const Tuneable k_lms_despeckle("LMSDESPECKLE", 0.0, 10.0, 0.0, "Despeckle threshold, 0 for none (m)");
+const int k_max_bad_points = 4;											// more bad points in center than this is bad
+const float k_default_avgrange = 999;									// huge bogus average range value
+//
+//	median3  -- median of three values
+//
+inline float median3(float a, float b, float c)
+{	return(std::max(std::min(a,b), std::min(std::max(a,b),c)));	}
+//
+//	LMSpreprocessLine  -- convert one raw scan line
+//
+//	gazehalfwidth is the number of samples each side of center used for the average range.
+//	The conversion loop is kept free of branches, so it is cheap on any CPU.
+//
+void LMSpreprocessLine(const LidarScanLine& in, int gazehalfwidth, LMSrangeLine& out)
+{	out.m_header = in.m_header;
+	const int count = std::min(int(in.m_header.m_valueCount), int(LMS_MAX_DATA_POINTS));
+	//	Convert to meters, masking the special values
+	for (int i=0; i<count; i++)
+	{	const uint16_t range = in.m_range[i];
+		out.m_range[i] = nonrangevalue(range) ? 0.0f : float(range*0.01);
+	}
+	for (int i=count; i<int(LMS_MAX_DATA_POINTS); i++) out.m_range[i] = 0.0;	// unused entries
+	//	Average range of the center of the scan, for tilt correction and gaze management.
+	//	If we can't see all the pixels in the narrow scan range, we have to tilt the scanner down.
+	//	Uses the raw values, before any despeckling, so gaze sees what the scanner saw.
+	const int center = LMS_MAX_DATA_POINTS/2;							// index of center point
+	uint32_t rangetotal = 0;													// total of ranges examined
+	int rangecount = 0;															// count
+	for (int i = -gazehalfwidth; i <= gazehalfwidth; i++)
+	{	const uint16_t range = in.m_range[center+i];
+		const bool good = !nonrangevalue(range);
+		rangetotal += good ? range : 0;
+		rangecount += good;
+	}
+	const int badpoints = 2*gazehalfwidth + 1 - rangecount;
+	out.m_avgrange = rangecount ? (rangetotal*0.01/rangecount) : k_default_avgrange;	// avoid divide by 0
+	out.m_goodavgrange = badpoints <= k_max_bad_points;				// valid if few bad points
+	//	Despeckle, if enabled
+	const float threshold = k_lms_despeckle;
+	if (threshold <= 0 || count < 3) return;
+	float prev = out.m_range[0];												// original value of previous sample
+	for (int i=1; i<count-1; i++)
+	{	const float range = out.m_range[i];
+		const float next = out.m_range[i+1];
+		const float median = median3(prev, range, next);
+		if (prev > 0 && next > 0 && fabs(range - median) > threshold)	// isolated outlier or dropout
+		{	out.m_range[i] = median;	}
+		prev = range;																// compare against originals only
+	}
+}
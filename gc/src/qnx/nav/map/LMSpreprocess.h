@@ -0,0 +1,44 @@
+//
+//	LMSpreprocess.h  --  once-per-line preprocessing of SICK LMS scan lines
+//
+//	Each scan line is converted, once, from the raw LMS values to ranges in meters,
+//	with the special values (dazzle, no return) masked to zero. Optionally, single-sample
+//	speckles are removed. The average range over the center of the scan, used by the
+//	tilt corrector and gaze control, is computed in the same pass.
+//
+//	The converted lines live in the tilt corrector's window, and are handed from there
+//	to the map updater by pointer, so a line is never copied after conversion.
+//
+//	Team Overbot
+//	October, 2026
+//
+#ifndef LMSPREPROCESS_H
+#define LMSPREPROCESS_H
+
+#include <inttypes.h>
+#include "lidarserver.h"
+//
+//	LMSrangeLine  -- one preprocessed scan line
+//
+struct LMSrangeLine {
+	LidarScanLineHeader m_header;										// header of the raw line
+	bool m_goodavgrange;													// center of scan all good
+	float m_avgrange;															// average range of center of scan, m
+	float m_range[LMS_MAX_DATA_POINTS];								// range, m, 0 if no return
+};
+//
+//	Raw range values above this are status codes from the scanner, not ranges
+//
+inline bool nonrangevalue(uint16_t range) { return(range > 8182); }
+//
+//	LMSrangeConvert  --  convert range from LIDAR value to meters
+//
+//	Returns zero for invalid values.
+//
+inline float LMSrangeConvert(uint16_t range)
+{	if (nonrangevalue(range)) return(0.0);							// handle special value
+	return(range*0.01);														// convert to meters
+}
+
+void LMSpreprocessLine(const LidarScanLine& in, int gazehalfwidth, LMSrangeLine& out);	// convert one scan line
+#endif // LMSPREPROCESS_H
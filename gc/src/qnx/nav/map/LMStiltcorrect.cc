@@ -1,5 +1,5 @@
 //
-//   LMStiltcorrect.cch  --  corrector for tilt of LIDAR scanner
+//   LMStiltcorrect.cc  --  corrector for tilt of LIDAR scanner
 //
 //   Corrects for LIDAR tilt vibration based on average range reported.
 //
@@ -34,7 +34,7 @@ const Tuneable k_range_outlier_threshold("RANGEOUTLIERTHRESHOLD", 0.00, 2.0, 0.0
 //
 //-----------------------------------------------------------------
 LMStiltCorrector::LMStiltCorrector(LMSmapUpdater& owner)
-        :m_owner(owner)
+        :m_owner(owner), m_incoming(NULL)
 {
    windowSize(k_defaultHammingWindowSize);               // size weights vector of filter
 }
@@ -43,40 +43,48 @@ LMStiltCorrector::LMStiltCorrector(LMSmapUpdater& owner)
 //
 LMStiltCorrector::~LMStiltCorrector()
 {
-    ScanLineData *pData;
-
-    // clean up
+    freeLines();
+}
+//
+//   freeLines  -- release all the scan line data
+//
+void LMStiltCorrector::freeLines()
+{
     while (!m_dataQueue.empty())
     {
-        pData = m_dataQueue.front();
+        delete m_dataQueue.front();
         m_dataQueue.pop_front();
-        delete pData;
     }
 
     while (!m_emptyQueue.empty())
     {
-        pData = m_emptyQueue.front();
+        delete m_emptyQueue.front();
         m_emptyQueue.pop();
-        delete pData;
     }
+    delete m_incoming;
+    m_incoming = NULL;
 }
 //
 //   correctTilt -- correct tilt for one scan line
 //
 //   Actually does the tilt correction.
 //
-//   Note that vehPose is the pose for the incoming line on input, and for the outgoing line on output.
-//   However, the incoming line comes in as lp, and the outgoing line goes out as outlp.
+//   The incoming line has already been preprocessed into nextLine(). vehPose and cycleStamp
+//   are for the incoming line on input, and for the outgoing line on output. The outgoing
+//   line, the one in the middle of the window, is returned as outline.
 //
-bool LMStiltCorrector::correctTilt(const LidarScanLine& lp,bool& goodAvgRange,float& avgRange,mat4& vehPose,uint32_t& cycleStamp,LidarScanLine& outlp)
+bool LMStiltCorrector::correctTilt(mat4& vehPose, uint32_t& cycleStamp, LMSrangeLine*& outline)
 {
-    ScanLineData *pData=NULL,       // store the current input data to end of queue
+    ScanLineData *pData=m_incoming,  // the current input data, goes on end of queue
                         *pMiddle=NULL;// point to the middle item in queue
 
     bool  res = true;          // result to be returned
 
     const size_t msize = m_weights.size();               // filter size
 
+    pData->vehPose = vehPose;
+    pData->cycleStamp = cycleStamp;
+
     if (m_dataQueue.size() == msize-1)
     {
         // has enough lines; m_size-1 scan lines in m_queue, one is the current input
@@ -88,34 +96,35 @@ bool LMStiltCorrector::correctTilt(const LidarScanLine& lp,bool& goodAvgRange,fl
         float filteredAvgRange = 0.0;
         for (size_t i=0; i<msize-1; i++)
         {
-            filteredAvgRange += m_weights[i]*m_dataQueue[i]->avgRange;
+            filteredAvgRange += m_weights[i]*m_dataQueue[i]->line.m_avgrange;
         }
 
-        filteredAvgRange += m_weights[msize-1]*avgRange;
+        filteredAvgRange += m_weights[msize-1]*pData->line.m_avgrange;
 
         // get the pointer to the middle item of queue,
         // for return scan line data to caller
         pMiddle = m_dataQueue[m_middle-1];
 
         // compute the filtered tilt.
-        float newTilt =  pMiddle->linePoints.m_header.m_tilt;				// incoming tilt							
-        float avgRatio = pMiddle->avgRange / filteredAvgRange;		// ratio of this range to average
+        LidarScanLineHeader& header = pMiddle->line.m_header;
+        float newTilt =  header.m_tilt;									// incoming tilt							
+        float avgRatio = pMiddle->line.m_avgrange / filteredAvgRange;	// ratio of this range to average
         if (finite(avgRatio) && (fabs(avgRatio - 1.0) < k_range_outlier_threshold))		// if not outlier
-		{	float cot = cos(pMiddle->linePoints.m_header.m_tilt);			// OK to change tilt
+		{	float cot = cos(header.m_tilt);									// OK to change tilt
 			newTilt = acos(cot*avgRatio);												// calculate adjusted tilt
 		}
         if (getVerboseLevel() >= 2)                                       // if moderately verbose
         {   
-           double oldtiltdeg = radians2deg(pMiddle->linePoints.m_header.m_tilt);
+           double oldtiltdeg = radians2deg(header.m_tilt);
            double newtiltdeg = radians2deg(newTilt);
            double tiltcorrdeg = newtiltdeg - oldtiltdeg;
            logprintf("Tilt correction %1.2f deg + %1.2f deg -> %1.2f deg.  Avg range %1.2f m.\n", oldtiltdeg, tiltcorrdeg, newtiltdeg,
                filteredAvgRange); 
         }
 
-        pMiddle->linePoints.m_header.m_tilt = newTilt;
-        // remove 1st scan line data from queue
-        pData=m_dataQueue.front();
+        header.m_tilt = newTilt;
+        // remove 1st scan line data from queue; it takes the next line
+        m_incoming=m_dataQueue.front();
         m_dataQueue.pop_front();
 
     }
@@ -123,30 +132,22 @@ bool LMStiltCorrector::correctTilt(const LidarScanLine& lp,bool& goodAvgRange,fl
     {
         // no enough data, couldn't run low pass filer
 
-        // get empty scan line data from empty queue for depositing scan line
+        // get empty scan line data from empty queue for the next line
         if (m_emptyQueue.empty()) throw ("Tilt empty queue allocation error");
-        pData = m_emptyQueue.front();
+        m_incoming = m_emptyQueue.front();
         m_emptyQueue.pop();
-        // only need to allocate m_size-1 times
         res = false;
     }
 
-    // deposit scan line related data to the queue for processing later
-    pData->goodAvgRange = goodAvgRange ;
-    pData->avgRange = avgRange ;
-    pData->vehPose = vehPose;
-    pData->cycleStamp = cycleStamp;
-    pData->linePoints = lp;
+    // the current input goes on the queue for processing later
     m_dataQueue.push_back(pData);
 
     if (pMiddle)
     {
         // setup the data to return back to the caller
-        goodAvgRange = pMiddle->goodAvgRange;
-        avgRange = pMiddle->avgRange;
         vehPose=pMiddle->vehPose;
         cycleStamp = pMiddle->cycleStamp;
-        outlp = pMiddle->linePoints;
+        outline = &pMiddle->line;
     }
 
     return res;
@@ -170,28 +171,13 @@ bool LMStiltCorrector::windowSize(const size_t size)
     m_middle = (m_weights.size())/2 + 1;                        // index of middle value. 
     ComputeHammingCoefficient();
 
-    // empty the data queue & recycle memory blocks
-    while (!m_dataQueue.empty())
-    {
-        ScanLineData* blank = m_dataQueue.front();
-        m_dataQueue.pop_front();
-        m_emptyQueue.push(blank);
-    }
-    //	Clear empty queue too
-   	while (!m_emptyQueue.empty())
-    {
-        ScanLineData* blank = m_emptyQueue.front();
-        delete(blank);
-        m_dataQueue.pop_front();
-        m_emptyQueue.push(blank);
-    }
-
-    //	Allocate proper number of scan lines for empty queue
+    // discard the window, and allocate one line for each place in it
+    freeLines();
     for (size_t i=0;  i < m_weights.size()-1; i++)
     {   
-		ScanLineData* blank = new ScanLineData;            // get a blank scan line data
-		m_emptyQueue.push(blank);            // fill queue with empty scan line data
+		m_emptyQueue.push(new ScanLineData);            // fill queue with empty scan line data
     }
+    m_incoming = new ScanLineData;                          // and one for the line coming in
 
     return true;
 }
@@ -200,8 +186,8 @@ bool LMStiltCorrector::windowSize(const size_t size)
 
 inline bool LMStiltCorrector::isValidWindowSize(const size_t size) const
 {
-    // size must be odd number for low-pass filter
-    return (size - 2*(size/2))==1;
+    // size must be odd number for low-pass filter, and have something either side of the middle
+    return (size - 2*(size/2))==1 && size >= 3;
 }
 
 inline void LMStiltCorrector::ComputeHammingCoefficient()
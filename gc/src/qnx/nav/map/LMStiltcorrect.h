@@ -16,8 +16,11 @@
 //
 #include <stdint.h>
 #include <vector>
+#include <deque>
+#include <queue>
 #include "algebra3.h"
 #include "lidarserver.h"
+#include "LMSpreprocess.h"
 //
 class LMSmapUpdater;                                          // forward
 
@@ -35,6 +38,9 @@ class LMSmapUpdater;                                          // forward
 //   2. The first m_size/2 lines and last m_size/2 lines will be lost
 //   3. There will be (m_size/2) lines delay. For window size 7, it
 //      would be 3
+//   4. Lines are preprocessed straight into the window, with
+//      nextLine(), and returned by pointer. A returned line stays
+//      valid until m_size/2 more lines have gone through.
 // -----------------------------------------------------------------
 class LMStiltCorrector
 {
@@ -43,11 +49,9 @@ private:
 
     struct ScanLineData
     {
-        bool            goodAvgRange;
-        float           avgRange;
         mat4            vehPose;
         uint32_t        cycleStamp;
-        LidarScanLine   linePoints;
+        LMSrangeLine    line;
     };
  
     LMSmapUpdater&             m_owner;         // parent
@@ -55,12 +59,17 @@ private:
     size_t                     m_middle;        // middle item in the queue
     std::deque<ScanLineData*>  m_dataQueue;     // store scan line related data
     std::queue<ScanLineData*>  m_emptyQueue;    // empty scan line data queue
+    ScanLineData*              m_incoming;      // next line goes here
 
 
 public:
     LMStiltCorrector(LMSmapUpdater& owner);
     ~LMStiltCorrector();
-    bool correctTilt(const LidarScanLine& lp,bool& goodAvgRange,float& avgRange,mat4& vehPose,uint32_t& cycleStamp,LidarScanLine& outlp);
+    LMSrangeLine& nextLine()                    // preprocess next line into this
+    {
+        return m_incoming->line;
+    }
+    bool correctTilt(mat4& vehPose, uint32_t& cycleStamp, LMSrangeLine*& outline);
     size_t  windowSize() const
     {
         return m_weights.size();            // filter size
@@ -71,6 +80,7 @@ public:
 private:
     bool isValidWindowSize(const size_t size) const;
     void ComputeHammingCoefficient();
+    void freeLines();
 };
 
 #if ENABLE_BACKWARD_FILTER
@@ -0,0 +1,136 @@
+//
+//	ROADmapupdate.cc  --  map updating based on sensor data
+//
+//	Functions specific to the road follower's camera
+//
+//	Team Overbot
+//	October, 2026
+//
+#include <time.h>
+#include <math.h>
+#include <algorithm>
+#include "mapserver.h"
+#include "logprint.h"
+#include "algebra3.h"
+#include "roadserver.h"
+#include "ROADmapupdate.h"
+//
+//	Configurable constants
+//
+const size_t k_road_queue_size = 10;									// a few frames' worth of messages
+//
+//	Constructor
+//
+ROADmapUpdater::ROADmapUpdater(MapServer& owner, const vec3& cameraoffset)
+	: m_owner(owner), m_offset(cameraoffset)
+{
+	//	Allocate queue items for queue. Use "new" only at startup.
+	for (size_t i=0;  i < k_road_queue_size; i++)
+	{	RoadServerMsgRDGR* blank = new RoadServerMsgRDGR;	// get a blank message
+		m_emptyqueue.push(blank);										// fill queue with empty messages
+	}
+}
+//
+//	handleRoadData  -- handle one message from the road server
+//
+//	GPS/INS synchronization requires a queue of messages and of GPS poses,
+//	which have to be matched and interpolated.
+//
+void ROADmapUpdater::handleRoadData(const RoadServerMsgRDGR& msg)
+{	ost::MutexLock lok(m_owner.getMapLock());						// lock map during update
+	//	Put new message on queue
+	if (m_emptyqueue.empty())												// if no available buffers
+	{	logprintf("Road grid queue stuck. Flushing.\n");				// should not happen
+		while (!m_msgqueue.empty())										// flush queue
+		{	RoadServerMsgRDGR* p =  m_msgqueue.front();		// get first entry
+			m_msgqueue.pop();													// pop from message queue
+			assert(p);																	// must be nonempty
+			m_emptyqueue.push(p);											// push on empty queue, ignoring
+		}
+	}
+	assert(!m_emptyqueue.empty());										// must have a working buffer
+	RoadServerMsgRDGR* work = m_emptyqueue.front();		// get a working buffer
+	m_emptyqueue.pop();														// remove it from the queue
+	assert(work);
+	*work = msg;																	// save new message
+	m_msgqueue.push(work);													// push onto work queue
+	//	Process the queue, in order
+	while (!m_msgqueue.empty())											// while messages to process
+	{	RoadServerMsgRDGR* first = m_msgqueue.front();		// get first item
+		assert(first);																// must get it
+		VehiclePose vehpose;													// get vehicle pose
+		bool toolate;
+		//	Try to get a relevant vehicle pose from interpolation
+		bool good = m_owner.getPoses().getposeattime(vehpose, first->m_timestamp, toolate);	// get pose at time of timestamp
+		if ((!good) && (!toolate))												// if not ready to process the first message
+		{
+			break;																		// try again later
+		}
+		//	We will use up this message
+		if (good)																		// we have GPS data
+		{	handlePosedData(*first, vehpose.m_vehpose);		// process message with vehicle position
+		} else {
+			logprintf("No valid, current GPS data. Road grid ignored.\n");
+		}
+		m_msgqueue.pop();														// remove from work queue
+		m_emptyqueue.push(first);										// move to empty queue
+	}
+}
+//
+//	handlePosedData -- handle a grid for which we have a pose
+//
+//	Each map cell under the grid looks up the grid cell its center falls in. The grid's
+//	axes are found in world coordinates from the pose, and each map cell center is
+//	solved back into grid coordinates, so every cell under the grid is updated once.
+//	Map is locked.
+//
+void ROADmapUpdater::handlePosedData(const RoadServerMsgRDGR& msg, const mat4& vehpose)
+{	TerrainMap& map(m_owner.getMap());
+	const double cs = msg.m_cellsize;											// grid cell size, m
+	if (!(cs > 0)) return;																// bad message
+	//	Grid origin and axes, on the ground, in world coordinates
+	const vec3 o(vehpose*vec3(m_offset[0], m_offset[1], 0));			// camera, on the ground
+	const vec3 px(vehpose*vec3(m_offset[0]+1, m_offset[1], 0));	// one meter ahead of it
+	const vec3 py(vehpose*vec3(m_offset[0], m_offset[1]+1, 0));	// one meter left of it
+	const double exx = px[0]-o[0], exy = px[1]-o[1];						// forward axis
+	const double eyx = py[0]-o[0], eyy = py[1]-o[1];						// left axis
+	const double det = exx*eyy - eyx*exy;
+	if (fabs(det) < 0.1) return;														// vehicle nearly on its side
+	//	Grid extent, in grid coordinates
+	const double gx0 = msg.m_nearx;
+	const double gx1 = gx0 + RoadServerMsgRDGR::k_rows*cs;
+	const double gy0 = -(RoadServerMsgRDGR::k_cols/2)*cs;
+	const double gy1 = gy0 + RoadServerMsgRDGR::k_cols*cs;
+	//	Bounding box of the grid in the map
+	double xmin = 1e30, xmax = -1e30, ymin = 1e30, ymax = -1e30;
+	for (int i=0; i<4; i++)
+	{	const double gx = (i & 1) ? gx1 : gx0;
+		const double gy = (i & 2) ? gy1 : gy0;
+		const double wx = o[0] + gx*exx + gy*eyx;
+		const double wy = o[1] + gx*exy + gy*eyy;
+		xmin = std::min(xmin, wx); xmax = std::max(xmax, wx);
+		ymin = std::min(ymin, wy); ymax = std::max(ymax, wy);
+	}
+	const int ixmin = std::max(map.coordtocell(xmin), map.getminix());
+	const int ixmax = std::min(map.coordtocell(xmax), map.getmaxix());
+	const int iymin = std::max(map.coordtocell(ymin), map.getminiy());
+	const int iymax = std::min(map.coordtocell(ymax), map.getmaxiy());
+	int updated = 0;
+	for (int iy = iymin; iy <= iymax; iy++)
+	{	const double dy = map.celltocoord(iy) - o[1];
+		for (int ix = ixmin; ix <= ixmax; ix++)
+		{	const double dx = map.celltocoord(ix) - o[0];
+			const double gx = (dx*eyy - dy*eyx)/det;						// cell center in grid coordinates
+			const double gy = (exx*dy - exy*dx)/det;
+			const int row = int(floor((gx - gx0)/cs));
+			const int col = int(floor((gy - gy0)/cs));
+			if (row < 0 || row >= RoadServerMsgRDGR::k_rows || col < 0 || col >= RoadServerMsgRDGR::k_cols) continue;
+			const uint8_t likelihood = msg.m_cells[row][col];
+			if (likelihood == RoadServerMsgRDGR::k_nodata) continue;	// camera didn't see it
+			map.updateroad(ix, iy, likelihood);
+			updated++;
+		}
+	}
+	if (m_owner.getVerboseLevel() >= 3)								// very verbose
+	{	logprintf("Road grid: %d cells updated, camera at (%1.2f, %1.2f)\n", updated, o[0], o[1]);	}
+}
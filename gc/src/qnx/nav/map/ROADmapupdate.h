@@ -0,0 +1,35 @@
+//
+//	ROADmapupdate.h  --  map updating based on sensor data
+//
+//	Functions specific to the road follower's camera
+//
+//	The road server sends, for each frame, a grid of how road-like the ground ahead
+//	looked, in vehicle axes. Each map cell under the grid takes the likelihood of the
+//	grid cell it falls in, into the road layer. Like the stereo data, messages are
+//	queued until there is a vehicle pose for the time the frame was taken.
+//
+//	Team Overbot
+//	October, 2026
+//
+#ifndef ROADMAPUPDATE_H
+#define ROADMAPUPDATE_H
+//
+class MapServer;																	// forward
+struct RoadServerMsgRDGR;													// forward
+//
+//	class ROADmapUpdater  --  updater for the road follower's camera
+//
+class ROADmapUpdater {
+private:
+	MapServer& m_owner;														// owning map server
+	vec3 m_offset;																	// position of camera relative to GPS antenna
+public:
+	ROADmapUpdater(MapServer& owner, const vec3& cameraoffset);
+	//	Queue of messages waiting for a useful GPS update
+	std::queue< RoadServerMsgRDGR*> m_msgqueue;					// messages waiting to be processed
+	std::queue< RoadServerMsgRDGR*> m_emptyqueue;				// empty message buffers
+	void handleRoadData(const RoadServerMsgRDGR& msg);
+private:
+	void handlePosedData(const RoadServerMsgRDGR& msg, const mat4& vehpose);
+};
+#endif //  ROADMAPUPDATE_H
@@ -0,0 +1,115 @@
+//
+//	STEREOmapupdate.cc  --  map updating based on sensor data
+//
+//	Functions specific to stereo vision
+//
+//	Team Overbot
+//	October, 2026
+//
+#include <time.h>
+#include <algorithm>
+#include "mapserver.h"
+#include "logprint.h"
+#include "tuneable.h"
+#include "algebra3.h"
+#include "stereoserver.h"
+#include "timeutil.h"
+#include "STEREOmapupdate.h"
+//
+//	Configurable constants
+//
+const size_t k_stereo_queue_size = 25;								// a few frames' worth of messages
+//
+//	Constructor
+//
+STEREOmapUpdater::STEREOmapUpdater(MapServer& owner, const vec3& cameraoffset)
+	: m_owner(owner), m_offset(cameraoffset)
+{
+	//	Allocate queue items for queue. Use "new" only at startup.
+	for (size_t i=0;  i < k_stereo_queue_size; i++)
+	{	StereoServerMsgSTEL* blank = new StereoServerMsgSTEL;	// get a blank message
+		m_emptyqueue.push(blank);										// fill queue with empty messages
+	}
+}
+//
+//	handleStereoData  -- handle one message from the stereo server
+//
+//	GPS/INS synchronization requires a queue of messages and of GPS poses,
+//	which have to be matched and interpolated.
+//
+void STEREOmapUpdater::handleStereoData(const StereoServerMsgSTEL& msg)
+{	if (msg.m_samplecount == 0) return;									// nothing to do
+	ost::MutexLock lok(m_owner.getMapLock());						// lock map during update
+	//	Put new message on queue
+	if (m_emptyqueue.empty())												// if no available buffers
+	{	logprintf("Stereo queue stuck. Flushing.\n");					// should not happen
+		while (!m_msgqueue.empty())										// flush queue
+		{	StereoServerMsgSTEL* p =  m_msgqueue.front();		// get first entry
+			m_msgqueue.pop();													// pop from message queue
+			assert(p);																	// must be nonempty
+			m_emptyqueue.push(p);											// push on empty queue, ignoring
+		}
+	}
+	assert(!m_emptyqueue.empty());										// must have a working buffer
+	StereoServerMsgSTEL* work = m_emptyqueue.front();		// get a working buffer
+	m_emptyqueue.pop();														// remove it from the queue
+	assert(work);
+	*work = msg;																	// save new message
+	m_msgqueue.push(work);													// push onto work queue
+	//	Process the queue, in order
+	while (!m_msgqueue.empty())											// while messages to process
+	{	StereoServerMsgSTEL* first = m_msgqueue.front();		// get first item
+		assert(first);																// must get it
+		VehiclePose vehpose;													// get vehicle pose
+		bool toolate;
+		//	Try to get a relevant vehicle pose from interpolation
+		bool good = m_owner.getPoses().getposeattime(vehpose, first->m_timestamp, toolate);	// get pose at time of timestamp
+		if ((!good) && (!toolate))												// if not ready to process the first message
+		{
+			break;																		// try again later
+		}
+		//	We will use up this message
+		if (good)																		// we have GPS data
+		{	handlePosedData(*first, vehpose.m_vehpose);		// process message with vehicle position
+		} else {
+			logprintf("No valid, current GPS data. Stereo data ignored.\n");
+		}
+		m_msgqueue.pop();														// remove from work queue
+		m_emptyqueue.push(first);										// move to empty queue
+	}
+}
+//
+//	handlePosedData -- handle data for which we have a pose
+//
+void STEREOmapUpdater::handlePosedData(const StereoServerMsgSTEL& msg, const mat4& vehpose)
+{	uint32_t cyclestamp = m_owner.getMap().getcyclestamp();	// get map update cycle serial number
+	const int count = std::min(int(msg.m_samplecount), int(StereoServerMsgSTEL::k_maxsamples));
+	for (int i=0; i<count; i++)												// for each sample
+	{	handleStereoSample(msg.m_samples[i], vehpose, cyclestamp);	}	// handle
+}
+//
+//	handleStereoSample  -- handle one patch of ground seen by the cameras
+//
+//	The patch is rated by its elevation range, as for a LIDAR triangle.
+//	Map is locked.
+//
+void STEREOmapUpdater::handleStereoSample(const StereoElevSample& sample, const mat4& vehpose, uint32_t cyclestamp)
+{
+	vec3 low(sample.m_x, sample.m_y, sample.m_minz);			// lowest point, relative to camera
+	vec3 high(sample.m_x, sample.m_y, sample.m_maxz);			// highest point
+	vec3 plow = vehpose*(low + m_offset);								// relative to world
+	vec3 phigh = vehpose*(high + m_offset);
+	const double zrange = fabs(phigh[2] - plow[2]);				// elevation range
+	const float elev = (phigh[2] + plow[2])*0.5;					// elevation average
+	const uint8_t roughness = uint8_t(std::min(zrange*100.0, 255.0));	// roughness in cm, for the map
+	CellData::CellType newtype = CellData::NOGO;					// assume bad area
+	if (zrange < MapServer::getClearCellRoughnessLimit())		// if very flat
+	{	newtype = CellData::CLEAR;	}										// good (green) area
+	else if (zrange < MapServer::getNogoCellRoughnessLimit())	// if not totally hopeless
+	{	newtype = CellData::POSSIBLE; }									// questionable (yellow) area to be evaluated later
+	vec3 pt = (plow + phigh)*0.5;											// center of patch, world
+	if (m_owner.getVerboseLevel() >= 3)								// very verbose
+	{	logprintf("Stereo patch at (%1.2f, %1.2f) ->  (%1.2f %1.2f %1.2f) roughness %d\n",
+			sample.m_x, sample.m_y, pt[0], pt[1], pt[2], roughness);	}
+	m_owner.updateCell(pt, newtype, false, sample.m_range, roughness, elev, cyclestamp);	// update one cell
+}
@@ -0,0 +1,37 @@
+//
+//	STEREOmapupdate.h  --  map updating based on sensor data
+//
+//	Functions specific to stereo vision
+//
+//	The stereo server sends, for each frame, the elevation range it saw in small
+//	patches of ground ahead. Each patch becomes one cell update, rated by roughness
+//	the same way as a LIDAR triangle. Like the VORAD data, messages are queued until
+//	there is a vehicle pose for the time the frame was taken.
+//
+//	Team Overbot
+//	October, 2026
+//
+#ifndef STEREOMAPUPDATE_H
+#define STEREOMAPUPDATE_H
+//
+class MapServer;																	// forward
+struct StereoServerMsgSTEL;													// forward
+struct StereoElevSample;														// forward
+//
+//	class STEREOmapUpdater  --  updater for one stereo camera pair
+//
+class STEREOmapUpdater {
+private:
+	MapServer& m_owner;														// owning map server
+	vec3 m_offset;																	// position of left camera relative to GPS antenna
+public:
+	STEREOmapUpdater(MapServer& owner, const vec3& cameraoffset);
+	//	Queue of messages waiting for a useful GPS update
+	std::queue< StereoServerMsgSTEL*> m_msgqueue;					// messages waiting to be processed
+	std::queue< StereoServerMsgSTEL*> m_emptyqueue;				// empty message buffers
+	void handleStereoData(const StereoServerMsgSTEL& msg);
+private:
+	void handlePosedData(const StereoServerMsgSTEL& msg, const mat4& vehpose);
+	void handleStereoSample(const StereoElevSample& sample, const mat4& vehpose, uint32_t cyclestamp);
+};
+#endif //  STEREOMAPUPDATE_H
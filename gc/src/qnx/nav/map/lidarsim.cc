@@ -0,0 +1,458 @@
+//
+//	lidarsim.cc  --  synthetic LIDAR and GPS/INS data from a simulated scene
+//
+//	Team Overbot
+//	October, 2026
+//
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include "lidarsim.h"
+#include "geocoords.h"
+#include "logprint.h"
+#include "timeutil.h"
+//
+//	Constants
+//
+const double k_scan_rate = 75.0;											// LMS scan lines per second
+const uint64_t k_sim_epoch = 1128124800ULL*1000000000ULL;	// timestamp of first line, 2005-10-01, ns
+const uint16_t k_no_return_value = 8193;								// range value for no return
+const uint16_t k_max_range_value = 8182;								// highest real range value, cm
+const float k_default_tilt = 80.0;											// degrees from down, about 12m ahead
+const float k_wheelbase = 2.0;												// for pitch from terrain
+const float k_track = 1.6;														// for roll from terrain
+const double k_meters_per_degree = 111320.0;							// latitude, near enough
+//
+//	SimScene constructor
+//
+SimScene::SimScene()
+:	m_xmin(0), m_ymin(0), m_cellsize(1), m_nx(0), m_ny(0),
+	m_minheight(0), m_maxheight(0)
+{}
+//
+//	setterrain  -- set the area covered, flat at height 0
+//
+void SimScene::setterrain(double xmin, double ymin, double xmax, double ymax, double cellsize)
+{	m_xmin = xmin;
+	m_ymin = ymin;
+	m_cellsize = cellsize;
+	m_nx = std::max(1, int(ceil((xmax-xmin)/cellsize)));
+	m_ny = std::max(1, int(ceil((ymax-ymin)/cellsize)));
+	m_height.assign(m_nx*m_ny, 0.0f);
+}
+//
+//	addslope  -- tilt the ground
+//
+void SimScene::addslope(float dzdx, float dzdy)
+{	for (int iy=0; iy<m_ny; iy++)
+		for (int ix=0; ix<m_nx; ix++)
+			cell(ix,iy) += dzdx*(ix+0.5)*m_cellsize + dzdy*(iy+0.5)*m_cellsize;
+}
+//
+//	addbumps  -- rolling ground
+//
+//	Two crossed waves at different scales, so the ground isn't periodic along the path.
+//
+void SimScene::addbumps(float amplitude, float wavelength)
+{	const double k = 2*M_PI/wavelength;
+	for (int iy=0; iy<m_ny; iy++)
+	{	const double y = m_ymin + (iy+0.5)*m_cellsize;
+		for (int ix=0; ix<m_nx; ix++)
+		{	const double x = m_xmin + (ix+0.5)*m_cellsize;
+			cell(ix,iy) += amplitude*(0.7*sin(k*x)*sin(0.6*k*y) + 0.3*cos(2.3*k*x + 1.7*k*y));
+		}
+	}
+}
+//
+//	addbox  -- raise a rectangle above the ground
+//
+void SimScene::addbox(double x0, double y0, double x1, double y1, float height)
+{	for (int iy=0; iy<m_ny; iy++)
+	{	const double y = m_ymin + (iy+0.5)*m_cellsize;
+		if (y < std::min(y0,y1) || y > std::max(y0,y1)) continue;
+		for (int ix=0; ix<m_nx; ix++)
+		{	const double x = m_xmin + (ix+0.5)*m_cellsize;
+			if (x < std::min(x0,x1) || x > std::max(x0,x1)) continue;
+			cell(ix,iy) += height;
+		}
+	}
+}
+//
+//	addpost  -- raise a disc above the ground
+//
+void SimScene::addpost(double x, double y, double radius, float height)
+{	for (int iy=0; iy<m_ny; iy++)
+	{	const double dy = m_ymin + (iy+0.5)*m_cellsize - y;
+		for (int ix=0; ix<m_nx; ix++)
+		{	const double dx = m_xmin + (ix+0.5)*m_cellsize - x;
+			if (dx*dx + dy*dy <= radius*radius) cell(ix,iy) += height;
+		}
+	}
+}
+//
+//	finish  -- compute tile maxima and height range
+//
+void SimScene::finish()
+{	for (int level = 0; level < k_tile_levels; level++)
+	{	const int size = k_tile_cells << (3*level);								// cells on a side
+		m_tilesx[level] = (m_nx + size - 1) / size;
+		m_tilemax[level].assign(m_tilesx[level]*((m_ny + size - 1) / size), -1e30f);
+	}
+	m_minheight = 1e30f;
+	m_maxheight = -1e30f;
+	for (int iy=0; iy<m_ny; iy++)
+		for (int ix=0; ix<m_nx; ix++)
+		{	const float h = cell(ix,iy);
+			for (int level = 0; level < k_tile_levels; level++)
+			{	const int size = k_tile_cells << (3*level);
+				float& tmax = m_tilemax[level][(iy/size)*m_tilesx[level] + ix/size];
+				tmax = std::max(tmax, h);
+			}
+			m_minheight = std::min(m_minheight, h);
+			m_maxheight = std::max(m_maxheight, h);
+		}
+}
+//
+//	cellat  -- cell containing a point
+//
+bool SimScene::cellat(double x, double y, int& ix, int& iy) const
+{	ix = int(floor((x - m_xmin)/m_cellsize));
+	iy = int(floor((y - m_ymin)/m_cellsize));
+	return(ix >= 0 && iy >= 0 && ix < m_nx && iy < m_ny);
+}
+//
+//	heightat  -- height of the cell containing a point
+//
+float SimScene::heightat(double x, double y) const
+{	int ix, iy;
+	if (!cellat(x, y, ix, iy)) return(0);
+	return(cell(ix,iy));
+}
+//
+//	raycast  -- distance along a ray to the first cell it hits
+//
+//	dir must be a unit vector. Cells are flat-topped columns, so a ray can hit the top
+//	of a cell or the side of one. Returns false if nothing is hit within maxrange.
+//
+//	This is a cell-by-cell walk along the ray's ground track (Amanatides and Woo),
+//	except that on entering a tile whose highest cell is below the lowest point of
+//	the ray over that tile, we jump straight to where the ray leaves the tile.
+//	Tiles come in two sizes, so long nearly level rays skip ahead quickly.
+//
+bool SimScene::raycast(const vec3& org, const vec3& dir, float maxrange, float& range) const
+{	if (!valid()) return(false);
+	const double ox = org[0], oy = org[1], oz = org[2];
+	const double dx = dir[0], dy = dir[1], dz = dir[2];
+	//	Limit the ray to the scene's extent, horizontally and vertically
+	double tstart = 0, tend = maxrange;
+	const double xmax = m_xmin + m_nx*m_cellsize;
+	const double ymax = m_ymin + m_ny*m_cellsize;
+	if (fabs(dx) < 1e-12) { if (ox < m_xmin || ox >= xmax) return(false); }
+	else
+	{	double t0 = (m_xmin - ox)/dx, t1 = (xmax - ox)/dx;
+		if (t0 > t1) std::swap(t0, t1);
+		tstart = std::max(tstart, t0); tend = std::min(tend, t1);
+	}
+	if (fabs(dy) < 1e-12) { if (oy < m_ymin || oy >= ymax) return(false); }
+	else
+	{	double t0 = (m_ymin - oy)/dy, t1 = (ymax - oy)/dy;
+		if (t0 > t1) std::swap(t0, t1);
+		tstart = std::max(tstart, t0); tend = std::min(tend, t1);
+	}
+	if (dz >= 0)																		// level or rising
+	{	if (oz + dz*tstart > m_maxheight) return(false);			// above everything, can't hit
+	} else {
+		tstart = std::max(tstart, (oz - m_maxheight)/-dz);	// nothing to hit until down to the highest point
+		tend = std::min(tend, (oz - m_minheight)/-dz + m_cellsize);	// hit something by the lowest
+	}
+	if (tstart >= tend) return(false);
+	const int stepx = (dx > 0) ? 1 : -1;
+	const int stepy = (dy > 0) ? 1 : -1;
+	const double tdeltax = (fabs(dx) < 1e-12) ? 1e30 : m_cellsize/fabs(dx);
+	const double tdeltay = (fabs(dy) < 1e-12) ? 1e30 : m_cellsize/fabs(dy);
+	double t = tstart;
+	int ix = 0, iy = 0;
+	double tnextx = 0, tnexty = 0;
+	int checkedtile = -1;															// tile known not to be skippable
+	bool restart = true;
+	while (t < tend)
+	{	if (restart)																		// find the cell at t, and the next crossings
+		{	const double tin = t + 1e-6;											// just inside, off the boundary
+			ix = std::max(0, std::min(m_nx-1, int(floor((ox + dx*tin - m_xmin)/m_cellsize))));
+			iy = std::max(0, std::min(m_ny-1, int(floor((oy + dy*tin - m_ymin)/m_cellsize))));
+			tnextx = (fabs(dx) < 1e-12) ? 1e30 : (m_xmin + (ix + (dx > 0 ? 1 : 0))*m_cellsize - ox)/dx;
+			tnexty = (fabs(dy) < 1e-12) ? 1e30 : (m_ymin + (iy + (dy > 0 ? 1 : 0))*m_cellsize - oy)/dy;
+			restart = false;
+		}
+		//	Whole tile below the ray? Try the biggest tiles first.
+		const int tile = (iy / k_tile_cells)*m_tilesx[0] + ix / k_tile_cells;
+		if (tile != checkedtile)
+		{	for (int level = k_tile_levels-1; level >= 0; level--)
+			{	const int size = k_tile_cells << (3*level);						// cells on a side
+				const int tx = ix / size, ty = iy / size;
+				const double bx = m_xmin + (tx*size + (dx > 0 ? size : 0))*m_cellsize;
+				const double by = m_ymin + (ty*size + (dy > 0 ? size : 0))*m_cellsize;
+				const double texit = std::min(std::min((fabs(dx) < 1e-12) ? 1e30 : (bx - ox)/dx,
+					(fabs(dy) < 1e-12) ? 1e30 : (by - oy)/dy), tend);
+				const double zlow = oz + dz*((dz < 0) ? texit : t);	// lowest point of ray over tile
+				if (zlow > m_tilemax[level][ty*m_tilesx[level] + tx])	// can't hit anything in this tile
+				{	t = texit;
+					restart = true;
+					break;
+				}
+			}
+			if (restart) continue;
+			checkedtile = tile;
+		}
+		//	Check this cell
+		const double tcellexit = std::min(std::min(tnextx, tnexty), tend);
+		const float h = cell(ix, iy);
+		const double zin = oz + dz*t;
+		if (zin <= h)																	// hit the side, or started inside
+		{	range = t; return(true);	}
+		if (oz + dz*tcellexit <= h)												// comes down onto the top
+		{	range = (oz - h)/-dz; return(true);	}
+		//	Next cell
+		if (tnextx < tnexty)
+		{	ix += stepx; t = tnextx; tnextx += tdeltax;	}
+		else
+		{	iy += stepy; t = tnexty; tnexty += tdeltay;	}
+		if (ix < 0 || iy < 0 || ix >= m_nx || iy >= m_ny) break;	// off the scene
+	}
+	return(false);
+}
+//
+//	LidarSimulator constructor
+//
+LidarSimulator::LidarSimulator(const vec3& scanneroffset)
+:	m_scanneroffset(scanneroffset), m_duration(-1), m_maxrange(40), m_rangenoise(0), m_fixrate(20),
+	m_baselat(0), m_baselong(0), m_noiseseed(12345)
+{}
+//
+//	load  -- read a scene file
+//
+//	Obstacles are added after the ground is shaped, wherever they appear in the file.
+//
+bool LidarSimulator::load(const char* filename)
+{	FILE* f = fopen(filename, "r");
+	if (!f)
+	{	logprintf("Unable to open scene file \"%s\".\n", filename);
+		return(false);
+	}
+	struct Obstacle { bool m_post; double m_v[5]; };
+	std::vector<Obstacle> obstacles;
+	bool haveterrain = false;
+	bool good = true;
+	char line[256];
+	int lineno = 0;
+	while (fgets(line, sizeof(line), f))
+	{	lineno++;
+		char* hash = strchr(line, '#');
+		if (hash) *hash = '\0';
+		char keyword[32];
+		if (sscanf(line, "%31s", keyword) != 1) continue;						// blank line
+		double v[5];
+		int n = sscanf(line, "%*s %lf %lf %lf %lf %lf", &v[0], &v[1], &v[2], &v[3], &v[4]);
+		if (strcmp(keyword, "terrain") == 0 && n == 5)
+		{	m_scene.setterrain(v[0], v[1], v[2], v[3], v[4]); haveterrain = true;	}
+		else if (strcmp(keyword, "slope") == 0 && n == 2 && haveterrain)
+		{	m_scene.addslope(v[0], v[1]);	}
+		else if (strcmp(keyword, "bumps") == 0 && n == 2 && haveterrain && v[1] > 0)
+		{	m_scene.addbumps(v[0], v[1]);	}
+		else if ((strcmp(keyword, "box") == 0 && n == 5) || (strcmp(keyword, "post") == 0 && n == 4))
+		{	Obstacle obs;
+			obs.m_post = (keyword[0] == 'p');
+			memcpy(obs.m_v, v, sizeof(v));
+			obstacles.push_back(obs);
+		}
+		else if (strcmp(keyword, "waypoint") == 0 && n == 3)
+		{	SimWaypoint wp;
+			wp.m_x = v[0]; wp.m_y = v[1]; wp.m_speed = v[2]; wp.m_starttime = 0;
+			m_path.push_back(wp);
+		}
+		else if (strcmp(keyword, "gaze") == 0 && n == 2)
+		{	m_gaze.push_back(std::pair<float,float>(v[0], deg2radians(v[1])));	}
+		else if (strcmp(keyword, "duration") == 0 && n == 1) m_duration = v[0];
+		else if (strcmp(keyword, "maxrange") == 0 && n == 1) m_maxrange = std::min(v[0], k_max_range_value*0.01);
+		else if (strcmp(keyword, "rangenoise") == 0 && n == 1) m_rangenoise = v[0];
+		else if (strcmp(keyword, "fixrate") == 0 && n == 1 && v[0] > 0) m_fixrate = v[0];
+		else if (strcmp(keyword, "basepoint") == 0 && n == 2) { m_baselat = v[0]; m_baselong = v[1]; }
+		else
+		{	logprintf("Scene file \"%s\" line %d not understood: %s", filename, lineno, line);
+			good = false;
+		}
+	}
+	fclose(f);
+	if (!haveterrain)
+	{	logprintf("Scene file \"%s\" has no terrain line.\n", filename);
+		return(false);
+	}
+	for (size_t i=0; i<obstacles.size(); i++)
+	{	const double* v = obstacles[i].m_v;
+		if (obstacles[i].m_post) m_scene.addpost(v[0], v[1], v[2], v[3]);
+		else m_scene.addbox(v[0], v[1], v[2], v[3], v[4]);
+	}
+	m_scene.finish();
+	//	Arrival time at each waypoint. A zero speed stops the vehicle there.
+	double t = 0;
+	for (size_t i=0; i<m_path.size(); i++)
+	{	m_path[i].m_starttime = t;
+		if (i+1 < m_path.size())
+		{	const double len = hypot(m_path[i+1].m_x - m_path[i].m_x, m_path[i+1].m_y - m_path[i].m_y);
+			t = (m_path[i].m_speed > 0) ? t + len/m_path[i].m_speed : 1e30;
+		}
+	}
+	if (m_duration < 0)
+	{	m_duration = ((t < 1e30) ? t : 0) + 2.0;	}
+	if (m_gaze.empty()) m_gaze.push_back(std::pair<float,float>(0, deg2radians(k_default_tilt)));
+	return(good);
+}
+//
+//	vehicleat  -- vehicle position, heading, and speed at time t
+//
+//	The vehicle drives straight between waypoints and turns in place at them.
+//	Heading is radians counterclockwise from East.
+//
+void LidarSimulator::vehicleat(double t, double& x, double& y, float& heading, float& speed) const
+{	x = y = 0; heading = 0; speed = 0;
+	if (m_path.empty()) return;
+	size_t i = 0;
+	while (i+1 < m_path.size() && m_path[i+1].m_starttime <= t) i++;
+	const SimWaypoint& wp = m_path[i];
+	x = wp.m_x; y = wp.m_y;
+	if (i+1 < m_path.size())														// on a leg
+	{	const SimWaypoint& next = m_path[i+1];
+		heading = atan2(next.m_y - wp.m_y, next.m_x - wp.m_x);
+		speed = wp.m_speed;
+		x += cos(heading)*speed*(t - wp.m_starttime);
+		y += sin(heading)*speed*(t - wp.m_starttime);
+	} else if (i > 0)																	// stopped at end, facing along last leg
+	{	heading = atan2(wp.m_y - m_path[i-1].m_y, wp.m_x - m_path[i-1].m_x);	}
+}
+//
+//	tiltat  -- scanner tilt at time t, from the gaze schedule
+//
+float LidarSimulator::tiltat(double t) const
+{	if (m_gaze.size() == 1) return(m_gaze[0].second);
+	const double period = m_gaze.back().first;
+	if (period > 0) t = fmod(t, period);
+	for (size_t i=1; i<m_gaze.size(); i++)
+	{	if (t <= m_gaze[i].first)
+		{	const double span = m_gaze[i].first - m_gaze[i-1].first;
+			const double fract = (span > 0) ? std::max(0.0, (t - m_gaze[i-1].first)/span) : 1.0;
+			return(m_gaze[i-1].second + fract*(m_gaze[i].second - m_gaze[i-1].second));
+		}
+	}
+	return(m_gaze.back().second);
+}
+//
+//	noise  -- unit normal random number, Box-Muller
+//
+float LidarSimulator::noise()
+{	m_noiseseed = m_noiseseed*1103515245 + 12345;
+	const double u1 = ((m_noiseseed >> 8) + 1.0)/16777217.0;
+	m_noiseseed = m_noiseseed*1103515245 + 12345;
+	const double u2 = (m_noiseseed >> 8)/16777216.0;
+	return(sqrt(-2.0*log(u1))*cos(2*M_PI*u2));
+}
+//
+//	fixattime  -- GPS/INS fix for the vehicle at time t
+//
+//	Pitch and roll come from the ground under the wheels.
+//
+void LidarSimulator::fixattime(double t, uint64_t timestamp, GPSINSMsgRep& fix) const
+{	double x, y;
+	float heading, speed;
+	vehicleat(t, x, y, heading, speed);
+	const double fx = cos(heading), fy = sin(heading);					// forward
+	const double lx = -fy, ly = fx;												// left
+	const float z = m_scene.heightat(x, y);
+	const float pitch = atan2(m_scene.heightat(x + fx*k_wheelbase*0.5, y + fy*k_wheelbase*0.5)
+		- m_scene.heightat(x - fx*k_wheelbase*0.5, y - fy*k_wheelbase*0.5), k_wheelbase);	// nose up is positive
+	const float roll = atan2(m_scene.heightat(x + lx*k_track*0.5, y + ly*k_track*0.5)
+		- m_scene.heightat(x - lx*k_track*0.5, y - ly*k_track*0.5), k_track);	// right side down is positive
+	memset(&fix, 0, sizeof(fix));
+	fix.timestamp = timestamp;
+	fix.err = GPSINS_MSG::OK;
+	fix.posStat = GPSINS_MSG::SOL_COMPUTED;
+	fix.posType = GPSINS_MSG::OMNISTAR_HP;
+	fix.pos[0] = y;																	// North, East, Down
+	fix.pos[1] = x;
+	fix.pos[2] = -z;
+	fix.llh[0] = m_baselat + y/k_meters_per_degree;
+	fix.llh[1] = m_baselong + x/(k_meters_per_degree*cos(deg2radians(m_baselat)));
+	fix.llh[2] = z;
+	fix.unc[0] = fix.unc[1] = fix.unc[2] = 0.1;
+	fix.vel[0] = speed*fy;
+	fix.vel[1] = speed*fx;
+	fix.rpy[0] = radians2deg(roll);
+	fix.rpy[1] = radians2deg(pitch);
+	float yaw = 90 - radians2deg(heading);									// zero north, clockwise
+	if (yaw < 0) yaw += 360;
+	fix.rpy[2] = yaw;
+}
+//
+//	scanline  -- simulate one scan line at time t
+//
+//	Odd lines have 181 ranges at whole degrees, even lines 180 at half degrees,
+//	as the LMS interlaces them, and in the order LMSmapUpdater expects.
+//
+void LidarSimulator::scanline(double t, uint64_t timestamp, uint8_t index, LidarScanLine& line)
+{	const float tilt = tiltat(t);
+	line.m_header.m_timestamp = timestamp;
+	line.m_header.m_tilt = tilt;
+	line.m_header.m_sensorid = 0;
+	line.m_header.m_statusByte = 0;
+	line.m_header.m_scanIndex = index;
+	line.m_header.m_unused1 = 0;
+	line.m_header.m_unused2 = 0;
+	const bool odd = (index & 1);
+	line.m_header.m_valueCount = odd ? 181 : 180;
+	//	Scanner pose, computed the way the map server will compute it
+	GPSINSMsgRep fix;
+	fixattime(t, timestamp, fix);
+	mat4 vehpose;
+	posefromfix(fix, vehpose);
+	const float tiltdeg = tilt*(-180/M_PI) + 90;								// 0 is horizontal, down is +
+	const mat4 scannerpose(vehpose*translation3D(m_scanneroffset)*rotation3D(vec3(0,1,0), tiltdeg));
+	const vec3 org(scannerpose*vec3(0,0,0));
+	const double firstangle = odd ? -90.0 : -89.5;
+	for (int i=0; i<line.m_header.m_valueCount; i++)
+	{	const double angle = deg2radians(firstangle + i);				// left is positive
+		vec3 dir(scannerpose*vec3(cos(angle), sin(angle), 0) - org);
+		dir.normalize();
+		float range;
+		if (!m_scene.raycast(org, dir, m_maxrange, range))
+		{	line.m_range[i] = k_no_return_value; continue;	}
+		if (m_rangenoise > 0) range = std::max(0.0f, range + m_rangenoise*noise());
+		line.m_range[i] = std::min(uint16_t(range*100 + 0.5), k_max_range_value);
+	}
+}
+//
+//	generate  -- write the whole run
+//
+//	Fixes start one fix before the first scan line and end one after the last,
+//	so every line can be posed by interpolation.
+//
+bool LidarSimulator::generate(FILE* lidarout, FILE* gpsout)
+{	if (!m_scene.valid()) return(false);
+	const double starttime = gettimenow();
+	const int fixes = int(m_duration*m_fixrate) + 3;
+	for (int i=0; i<fixes; i++)
+	{	const double t = (i-1)/m_fixrate;
+		GPSINSMsgRep fix;
+		fixattime(t, k_sim_epoch + int64_t(t*1e9), fix);
+		if (fwrite(&fix, sizeof(fix), 1, gpsout) != 1) return(false);
+	}
+	const int lines = int(m_duration*k_scan_rate);
+	LidarScanLine line;
+	for (int i=0; i<lines; i++)
+	{	const double t = i/k_scan_rate;
+		scanline(t, k_sim_epoch + uint64_t(t*1e9), uint8_t(i), line);
+		if (fwrite(&line, sizeof(line), 1, lidarout) != 1) return(false);
+	}
+	const double elapsed = std::max(gettimenow() - starttime, 1e-6);
+	logprintf("Simulated %1.1f secs of data (%d scan lines, %d fixes) in %1.2f secs, %1.0fx real time.\n",
+		m_duration, lines, fixes, elapsed, m_duration/elapsed);
+	return(true);
+}
@@ -0,0 +1,106 @@
+//
+//	lidarsim.h  --  synthetic LIDAR and GPS/INS data from a simulated scene
+//
+//	Generates the same scan line and GPS/INS fix records the map server logs and
+//	plays back, by ray-casting the SICK LMS beams against a heightfield while the
+//	vehicle follows a path. The output files can be fed to "map -s ... -g ...",
+//	so the map updater and the steering code can be exercised, and timed, at
+//	any scale without the vehicle.
+//
+//	Scene file format, one item per line, # for comments, distances in meters:
+//
+//		terrain <xmin> <ymin> <xmax> <ymax> <cellsize>		area covered, required
+//		slope <dz/dx> <dz/dy>										tilted ground plane
+//		bumps <amplitude> <wavelength>							rolling ground
+//		box <x0> <y0> <x1> <y1> <height>						obstacle, height above ground
+//		post <x> <y> <radius> <height>							round obstacle
+//		waypoint <x> <y> <speed m/s>							path, followed in order
+//		gaze <time s> <tilt deg>									tilt schedule, 0 is down, 90 is ahead. Repeats.
+//		duration <secs>												default is time to drive the path, plus 2 secs
+//		maxrange <m>													scanner range limit, default 40
+//		rangenoise <m>													std. deviation of range error, default 0
+//		fixrate <hz>														GPS/INS fixes per second, default 20
+//		basepoint <lat> <long>										for the LLH in the fixes
+//
+//	X is East, Y is North, Z is up, as in the map.
+//
+//	Team Overbot
+//	October, 2026
+//
+#ifndef LIDARSIM_H
+#define LIDARSIM_H
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <vector>
+#include "algebra3.h"
+#include "lidarserver.h"
+#include "gpsins_messaging.h"
+//
+const int k_tile_cells = 8;													// small tile is this many cells on a side
+const int k_tile_levels = 2;													// tiles are 8 and 64 cells on a side
+//
+//	class SimScene  -- heightfield, with obstacles rasterized in
+//
+//	Ray casting walks the cells along the ray's ground track, but first checks
+//	a coarse grid of tile maximum heights, so the long stretches where the beam
+//	is well above the ground are crossed a tile at a time.
+//
+class SimScene {
+private:
+	double m_xmin, m_ymin;														// corner of cell (0,0)
+	double m_cellsize;																// meters per cell
+	int m_nx, m_ny;																	// size in cells
+	std::vector<float> m_height;												// cell heights, row major
+	int m_tilesx[k_tile_levels];													// row length in tiles, each size
+	std::vector<float> m_tilemax[k_tile_levels];							// highest cell in each tile, each size
+	float m_minheight, m_maxheight;										// over the whole scene
+public:
+	SimScene();
+	void setterrain(double xmin, double ymin, double xmax, double ymax, double cellsize);	// clear to flat ground at 0
+	void addslope(float dzdx, float dzdy);									// tilt the ground
+	void addbumps(float amplitude, float wavelength);					// rolling ground
+	void addbox(double x0, double y0, double x1, double y1, float height);		// raise a rectangle
+	void addpost(double x, double y, double radius, float height);		// raise a disc
+	void finish();																		// build tile maxima; call after all the above
+	bool valid() const { return(m_nx > 0 && m_ny > 0); }
+	float heightat(double x, double y) const;								// height of cell containing point, 0 off scene
+	bool raycast(const vec3& org, const vec3& dir, float maxrange, float& range) const;	// distance to first hit
+private:
+	bool cellat(double x, double y, int& ix, int& iy) const;			// cell containing point
+	float& cell(int ix, int iy) { return(m_height[iy*m_nx + ix]); }
+	float cell(int ix, int iy) const { return(m_height[iy*m_nx + ix]); }
+};
+//
+//	class LidarSimulator  -- vehicle, scanner, and scene
+//
+class LidarSimulator {
+private:
+	struct SimWaypoint {
+		double m_x, m_y;																// position
+		float m_speed;																	// speed on the leg starting here
+		double m_starttime;															// when we get here, secs from start
+	};
+	SimScene m_scene;																// what we see
+	std::vector<SimWaypoint> m_path;										// where we drive
+	std::vector<std::pair<float,float> > m_gaze;						// (time, tilt radians)
+	vec3 m_scanneroffset;															// scanner position relative to GPS antenna
+	float m_duration;																// secs of data to make
+	float m_maxrange;																// meters
+	float m_rangenoise;															// meters, std. deviation
+	float m_fixrate;																	// fixes per second
+	double m_baselat, m_baselong;											// LLH of the origin
+	uint32_t m_noiseseed;															// for range noise
+public:
+	LidarSimulator(const vec3& scanneroffset);
+	bool load(const char* filename);												// read scene file
+	bool generate(FILE* lidarout, FILE* gpsout);							// write scan lines and fixes
+	void fixattime(double t, uint64_t timestamp, GPSINSMsgRep& fix) const;	// vehicle state at time t
+	void scanline(double t, uint64_t timestamp, uint8_t index, LidarScanLine& line);	// simulate one scan line
+	const SimScene& getScene() const { return(m_scene); }
+private:
+	void vehicleat(double t, double& x, double& y, float& heading, float& speed) const;
+	float tiltat(double t) const;
+	float noise();
+};
+#endif // LIDARSIM_H
@@ -29,6 +29,7 @@
 //	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 //
 #include <exception>
+#include <stdlib.h>
 #include "mapserver.h"
 
 //
@@ -37,7 +38,12 @@
 static void
 usage()
 {
-    printf("usage: map  [-v] [-s scannerlogfilein] [-g gpslogfilein] [-w waypointfile] [-d logdir]\n");
+    printf("usage: map  [-v] [-s scannerlogfilein] [-g gpslogfilein] [-w waypointfile] [-d logdir] [-r recorddir]\n");
+    printf("       map  [-v] -S scenefile -s scannerlogfileout -g gpslogfileout [-w waypointfile] [-d logdir]\n");
+    printf("       map  [-v] -B benchdir -w waypointfile [-G goldenfile] [-n runs]\n");
+    printf("  -S simulates a run through the scene into the scanner and GPS files, then plays them back.\n");
+    printf("  -r recorddir keeps map snapshots and steering inputs while driving, for -B.\n");
+    printf("  -B times the steering code over a recording, checking results against the golden file if it exists.\n");
     exit(1);
 }
 //
@@ -50,6 +56,11 @@ int main(int argc, const char* argv[])
 	const char* dummygpsin = 0;									// dummy GPSINS file for input
 	const char* logdir = 0;												// log dir, if desired
 	const char* waypointin = 0;										// input waypoint file
+	const char* scenein = 0;												// simulated scene, if desired
+	const char* recorddir = 0;											// steering benchmark recording, if desired
+	const char* benchdir = 0;											// steering benchmark input, if desired
+	const char* goldenfile = 0;											// steering benchmark results to check against
+	int benchruns = 1;														// times to run steering benchmark
 	int verboselevel = 0;												// no verbose level yet
     // parse command line arguments
     for (int i=1; i < argc; i++) {
@@ -85,6 +96,37 @@ int main(int argc, const char* argv[])
 			waypointin = argv[i];										// -w filename
 			break;
 			
+		case 'S':																// simulated scene file
+			i++;
+			if (i >= argc) usage();										// must have another arg
+			scenein = argv[i];												// -S filename
+			break;
+			
+		case 'r':																// record for steering benchmark
+			i++;
+			if (i >= argc) usage();										// must have another arg
+			recorddir = argv[i];											// -r dirname
+			break;
+			
+		case 'B':																// steering benchmark
+			i++;
+			if (i >= argc) usage();										// must have another arg
+			benchdir = argv[i];											// -B dirname
+			break;
+			
+		case 'G':																// golden results for steering benchmark
+			i++;
+			if (i >= argc) usage();										// must have another arg
+			goldenfile = argv[i];											// -G filename
+			break;
+			
+		case 'n':																// steering benchmark runs
+			i++;
+			if (i >= argc) usage();										// must have another arg
+			benchruns = atoi(argv[i]);									// -n count
+			if (benchruns < 1) usage();
+			break;
+			
 
 	    default:																	// unknown flag
 			usage();
@@ -94,7 +136,17 @@ int main(int argc, const char* argv[])
         } 
         usage();
     }
+    if (scenein && !(dummylidarin && dummygpsin)) usage();	// simulation needs both output files
+    if ((goldenfile || benchruns > 1) && !benchdir) usage();	// only for the benchmark
     try {
+    	if (benchdir)																// steering benchmark, nothing else
+    	{	return(ms.steerBenchmark(benchdir, waypointin, goldenfile, benchruns) ? 0 : 1);	}
+    	if (recorddir && !ms.recordSteerFrames(recorddir))		// keep benchmark data while driving
+    	{	throw("Unable to record steering frames.");	}
+    	if (scenein)
+    	{	if (!ms.simulateTest(scenein, dummylidarin, dummygpsin))	// make the dummy data files
+    		{	throw("Unable to simulate scene.");	}
+    	}
 	    if (!dummylidarin)
 	    {	// start collecting messages forever
 	    	//	***NEEDS WORK for real operation***
@@ -84,6 +84,7 @@ public:
 	bool passable() const { return(m_valid && (m_type == CLEAR)); }
 	bool possible() const { return(m_valid && (m_type == POSSIBLE)); }
 	bool unknown() const { return((!m_valid) || (m_type == UNKNOWN)); }
+	CellType gettype() const { return(m_valid ? m_type : UNKNOWN); }	// type, UNKNOWN if no data
 	uint8_t roughness() const { return(m_roughness); }
 	float avgelev() const { return((m_minelev + m_maxelev) * 0.5); }	// average elevation
 	bool update(CellType newtype, bool sweeping, uint16_t newrange, uint8_t roughness, float elev, uint32_t cyclestamp, 
@@ -34,5 +34,11 @@
 
 const double k_vehwidth = 2.0;					// vehicle width in meters
 const double k_vehlength = 3.0;					// vehicle length in meters
+const double k_inflation_shoulder = 0.5;		// shoulder ring of inflated-obstacle layer, meters
+const int k_summary_tile_cells = 8;				// finest summary tile is this many cells on a side
+const int k_summary_levels = 2;					// summary tiles are 8 and 64 cells on a side
+const double k_roadclearahead = 20.0;			// look this far ahead for CLEAR ground to show the road follower, meters
+const uint8_t k_road_nodata = 255;				// road layer value for a cell the camera has not seen
+const double k_clearance_limit = 10.0;			// clearance layer reports distances up to this, meters
 
 #endif // MAPCONFIG_H
@@ -48,6 +48,8 @@ const size_t k_mapdimension = k_mapsizeincells;		// map size in cells, as an int
 //
 const vec3 k_scanneroffset(1.65,0,2.08);						// offset between GPS antenna and LMS scanner, meters
 const vec3 k_voradoffset(2.80,0,0.40);							// offset between GPS antenna and VORAD radar, meters
+const vec3 k_stereooffset(1.20,0.15,2.20);						// offset between GPS antenna and left stereo camera, meters
+const vec3 k_roadcameraoffset(1.20,0,2.00);					// offset between GPS antenna and road follower camera, meters
 //
 // Class member functions
 //
@@ -59,7 +61,10 @@ MapServer::MapServer()
 	m_map(*this, k_mapdimension, k_cellspermeter),		// the map
 	m_lmsupdater(*this, k_scanneroffset)	,					// main SICK LMS support
 	m_voradupdater(*this, k_voradoffset),						// VORAD support
-	m_driver(*this)															// the driving thread
+	m_stereoupdater(*this, k_stereooffset),						// stereo vision support
+	m_roadupdater(*this, k_roadcameraoffset),					// road camera support
+	m_driver(*this),															// the driving thread
+	m_snapshot(*this)														// map snapshot thread
 {
 }
 
@@ -154,6 +159,16 @@ void MapServer::handleMessage(int rcvid, MapServerMsg& msg)
 		handleSonar(msg.m_un.m_sonar);						// handle a sonar event
 		MsgError(rcvid, EOK);											// no data is returned
 		return;
+		
+	case StereoServerMsgSTEL::k_msgtype:					// incoming stereo elevation data
+		handleStereo(msg.m_un.m_stereodata);				// handle stereo message
+		MsgError(rcvid, EOK);											// no data is returned
+		return;
+		
+	case RoadServerMsgRDGR::k_msgtype:						// incoming road likelihood grid
+		handleRoad(msg.m_un.m_roaddata);						// handle road grid message
+		MsgError(rcvid, EOK);											// no data is returned
+		return;
 		    
     default:																		// bad message type
 	   	logprintf("MapServer::handleMessage - unknown message type: 0x%8x\n", msg.m_un.m_header.m_msgtype);
@@ -195,6 +210,24 @@ void MapServer::handleVorad(const VoradServerMsgVDTG& msg)
 	m_voradupdater.handleRadarData(msg);					// handled by VORAD updater
 }
 //
+//	handleStereo  -- incoming elevation samples from stereo vision
+//
+//	Caller handles reply.
+//
+void MapServer::handleStereo(const StereoServerMsgSTEL& msg)
+{
+	m_stereoupdater.handleStereoData(msg);					// handled by stereo updater
+}
+//
+//	handleRoad  -- incoming road likelihood grid from the road follower's camera
+//
+//	Caller handles reply.
+//
+void MapServer::handleRoad(const RoadServerMsgRDGR& msg)
+{
+	m_roadupdater.handleRoadData(msg);						// handled by road updater
+}
+//
 //	handleSonar -- incoming data from sonars
 //
 //	Caller handles reply.
@@ -40,12 +40,17 @@
 #include "terrainmap.h"
 #include "LMSmapupdate.h"															// SICK LMS support
 #include "VORADmapupdate.h"													// VORAD update
+#include "STEREOmapupdate.h"													// stereo vision update
+#include "ROADmapupdate.h"														// road camera update
 #include "moveservermsg.h"
 #include "waypoints.h"
 #include "maplog.h"
 #include "vehicledriver.h"
 #include "vehicleposes.h"
 #include "roadfollow.h"
+#include "mapsnapshot.h"
+#include "obstacleblobs.h"
+#include "obstacledistance.h"
 
 class MapLog;																					// forward
 //
@@ -63,10 +68,15 @@ private:
     ost::Mutex 	m_maplock;																// lock that protects the map
 	LMSmapUpdater	m_lmsupdater;													// SICK LMS support
 	VORADmapUpdater	m_voradupdater;											// VORAD support
+	STEREOmapUpdater	m_stereoupdater;										// stereo vision support
+	ROADmapUpdater	m_roadupdater;											// road camera support
 	RoadFollow	m_roadfollower;														// road follower support
 	VehicleDriver	m_driver;																// driving level
 	VehiclePoses	m_poses;																// pose info
 	MapLog		m_log;																		// associated log
+	MapSnapshot	m_snapshot;																// saved copies of map, for restarts
+	ObstacleBlobs	m_obstacles;															// NOGO cells grouped into obstacles
+	ObstacleDistance	m_clearance;														// distance to nearest NOGO cell
 	double			m_steertimestamp;													// last steering cycle start
 public:
     MapServer();			// constructor
@@ -75,6 +85,9 @@ public:
     void messageThread();		// main thread to receive messages
 	//	Dummy test mode
     void playbackTest(const char* dummylidarin, const char* dummygpsinsin, const char* waypointin, const char* logdirout);	// playback from test files
+    bool simulateTest(const char* scenein, const char* dummylidarout, const char* dummygpsinsout);	// make test files from a scene
+    bool recordSteerFrames(const char* dir);										// keep steering benchmark data in dir
+    bool steerBenchmark(const char* benchdir, const char* waypointin, const char* goldenfile, int reps);	// time steering over recorded data
 	//	Real mode
 	bool executeMission(const char* waypointin, const char* logdirout);	// does the actual work
 	void SetFault(Fault::Faultcode newfault);										// set and report a fault	
@@ -88,6 +101,9 @@ public:
     RoadFollow& getRoadFollow() { return(m_roadfollower); }			// access
     MapLog& getLog() { return(m_log); }											// return log
     VehiclePoses& getPoses() { return(m_poses); }							// access
+    MapSnapshot& getSnapshot() { return(m_snapshot); }					// access
+    ObstacleBlobs& getObstacles() { return(m_obstacles); }				// access, map must be locked
+    ObstacleDistance& getClearance() { return(m_clearance); }			// access, map must be locked
 public:
 	//	Portable update functions
 	void updateMapRectangle(const vec3& p1, const vec3& p2, const vec3& p3, const vec3& p4, float minrange, uint32_t cyclestamp, bool forceallgreen);	
@@ -108,6 +124,8 @@ private:
 	void handleStop(const MsgSpeedStop& msg);
 	void handleVorad(const VoradServerMsgVDTG& msg);
 	void handleSonar(const SonarObstacleMsgReq& msg);
+	void handleStereo(const StereoServerMsgSTEL& msg);
+	void handleRoad(const RoadServerMsgRDGR& msg);
 	void handleQuery(int rcvid);
 };
 
@@ -0,0 +1,213 @@
+//
+//	mapsnapshot.cc  --  periodic snapshots of the terrain map, for warm restarts
+//
+//	Team Overbot
+//	October, 2026
+//
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <math.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "mapsnapshot.h"
+#include "mapserver.h"
+#include "logprint.h"
+#include "timeutil.h"
+//
+//	Constants
+//
+//	The snapshot lives in shared memory, which survives a restart of the map server
+//	but not a reboot. After a reboot, the vehicle has probably been moved anyway.
+//
+const char* k_snapshot_file = "/dev/shmem/mapsnapshot";		// where the snapshot goes
+const char* k_snapshot_tempfile = "/dev/shmem/mapsnapshot.new";	// written here, then renamed
+const char* k_snapshot_archive_prefix = "mapsnap-";					// archived snapshot names, in archive dir
+const uint32_t k_snapshot_magic = 0x534d424f;						// "OBMS"
+const uint32_t k_snapshot_version = 1;
+const double k_snapshot_period = 5.0;									// secs between snapshots
+const int k_snapshot_priority = 8;											// well below driving
+const int k_snapshot_band = 32;											// rows copied per map lock
+const double k_snapshot_max_age = 300.0;								// older than this is not used, secs
+const double k_snapshot_origin_tolerance = 1e-7;					// degrees, about 1cm
+//
+//	Constructor
+//
+MapSnapshot::MapSnapshot(MapServer& owner)
+:	TimedLoop(k_snapshot_period, k_snapshot_priority),
+	m_owner(owner), m_lastcyclestamp(0), m_running(false)
+{}
+//
+//	Destructor
+//
+MapSnapshot::~MapSnapshot()
+{	stop();	}
+//
+//	start  -- start taking snapshots
+//
+void MapSnapshot::start()
+{	if (m_running) return;
+	m_running = true;
+	Start();
+}
+//
+//	stop  -- stop taking snapshots
+//
+void MapSnapshot::stop()
+{	if (!m_running) return;
+	Stop();
+	m_running = false;
+}
+//
+//	code  -- take one snapshot. Called periodically from our own thread.
+//
+void MapSnapshot::code()
+{	MapSnapshotHeader header;
+	if (!copymap(header)) return;												// nothing new, or map moved
+	if (!write(header, k_snapshot_file, k_snapshot_tempfile)) return;
+	m_lastcyclestamp = header.m_cyclestamp;
+	if (!m_archivedir.empty())														// if keeping them all for the benchmark
+	{	char filename[512], tempfile[520];
+		snprintf(filename, sizeof(filename), "%s/%s%08u", m_archivedir.c_str(), k_snapshot_archive_prefix, header.m_cyclestamp);
+		snprintf(tempfile, sizeof(tempfile), "%s.new", filename);
+		write(header, filename, tempfile);
+	}
+	if (m_owner.getVerboseLevel() >= 2)
+	{	logprintf("Map snapshot taken at cycle %d, center (%d, %d).\n", header.m_cyclestamp, header.m_ix, header.m_iy);	}
+}
+//
+//	Identity conversion, for copying cells out with getraster
+//
+struct CellCopy {
+	const CellData& operator()(const CellData& cell) const { return(cell); }
+};
+//
+//	copymap  -- copy the map into m_cells
+//
+//	The map is locked only while each band of rows is copied. If the map scrolls
+//	during the copy, this snapshot is abandoned; the next one will probably work.
+//	Bands taken a few milliseconds apart can differ by a scan line or two, which
+//	doesn't matter for a warm start.
+//
+bool MapSnapshot::copymap(MapSnapshotHeader& header)
+{	TerrainMap& map = m_owner.getMap();
+	int dim, ix, iy;
+	{	ost::MutexLock lok(m_owner.getMapLock());
+		if (map.getlastchangestamp() < m_lastcyclestamp) return(false);	// nothing changed since last time
+		dim = map.getdimincells();
+		ix = map.getix();
+		iy = map.getiy();
+		memset(&header, 0, sizeof(header));
+		header.m_magic = k_snapshot_magic;
+		header.m_version = k_snapshot_version;
+		header.m_cellsize = sizeof(CellData);
+		header.m_dimincells = dim;
+		header.m_cellspermeter = map.getcellspermeter();
+		header.m_ix = ix;
+		header.m_iy = iy;
+		header.m_cyclestamp = map.getcyclestamp();
+		header.m_timestamp = gettimenowns();
+		const Vector<3> origin(m_owner.getAllWaypoints().getOrigin());
+		header.m_origin[0] = origin[0];
+		header.m_origin[1] = origin[1];
+	}
+	m_cells.resize(dim*dim);														// allocates only the first time
+	CellData offmap;
+	offmap.clear();
+	for (int y = 0; y < dim; y += k_snapshot_band)
+	{	ost::MutexLock lok(m_owner.getMapLock());
+		if (map.getix() != ix || map.getiy() != iy || map.getdimincells() != dim) return(false);	// map moved
+		const int rows = std::min(k_snapshot_band, dim - y);
+		map.getraster(ix - dim/2, iy - dim/2 + y, dim, rows, &m_cells[y*dim], dim, offmap, CellCopy());
+	}
+	return(true);
+}
+//
+//	archivePrefix  -- start of archived snapshot file names
+//
+const char* MapSnapshot::archivePrefix()
+{	return(k_snapshot_archive_prefix);	}
+//
+//	write  -- write m_cells to a snapshot file
+//
+//	Written to a temporary file and renamed, so a crash while writing never
+//	leaves a damaged snapshot behind.
+//
+bool MapSnapshot::write(const MapSnapshotHeader& header, const char* filename, const char* tempfile)
+{	int fd = open(tempfile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+	{	logprintf("Unable to create map snapshot \"%s\": %s\n", tempfile, strerror(errno));
+		return(false);
+	}
+	const size_t cellbytes = m_cells.size()*sizeof(CellData);
+	bool good = ::write(fd, &header, sizeof(header)) == ssize_t(sizeof(header))
+		&& ::write(fd, &m_cells[0], cellbytes) == ssize_t(cellbytes);
+	if (close(fd) < 0) good = false;
+	if (good && rename(tempfile, filename) < 0) good = false;
+	if (!good)
+	{	logprintf("Unable to write map snapshot \"%s\": %s\n", filename, strerror(errno));
+		unlink(tempfile);
+	}
+	return(good);
+}
+//
+//	usable  -- is this snapshot for this map, and recent?
+//
+//	The age check is skipped when replaying archived snapshots.
+//
+bool MapSnapshot::usable(const MapSnapshotHeader& header, size_t filesize, bool checkage)
+{	const TerrainMap& map = m_owner.getMap();
+	if (header.m_magic != k_snapshot_magic || header.m_version != k_snapshot_version
+		|| header.m_cellsize != sizeof(CellData))
+	{	logprintf("Map snapshot is not in the current format. Not used.\n"); return(false);	}
+	if (header.m_dimincells != map.getdimincells() || header.m_cellspermeter != map.getcellspermeter()
+		|| filesize != sizeof(header) + size_t(header.m_dimincells)*header.m_dimincells*sizeof(CellData))
+	{	logprintf("Map snapshot is for a different map size. Not used.\n"); return(false);	}
+	const double age = (double(gettimenowns()) - double(header.m_timestamp))*0.000000001;
+	if (checkage && (age < 0 || age > k_snapshot_max_age))
+	{	logprintf("Map snapshot is %1.0f secs old. Not used.\n", age); return(false);	}
+	const Vector<3> origin(m_owner.getAllWaypoints().getOrigin());
+	if (fabs(origin[0] - header.m_origin[0]) > k_snapshot_origin_tolerance
+		|| fabs(origin[1] - header.m_origin[1]) > k_snapshot_origin_tolerance)
+	{	logprintf("Map snapshot was taken with different waypoints. Not used.\n"); return(false);	}
+	return(true);
+}
+//
+//	restore  -- load the last snapshot into the map, if it's usable
+//
+//	Called at startup, after the waypoints are loaded. Returns true if the map was loaded.
+//
+bool MapSnapshot::restore()
+{	return(restore(k_snapshot_file, true));	}
+//
+//	restore  -- load a snapshot file into the map, if it's usable
+//
+bool MapSnapshot::restore(const char* filename, bool checkage)
+{	int fd = open(filename, O_RDONLY);
+	if (fd < 0) return(false);														// no snapshot, normal cold start
+	struct stat fileinfo;
+	if (fstat(fd, &fileinfo) < 0 || size_t(fileinfo.st_size) < sizeof(MapSnapshotHeader))
+	{	close(fd); return(false);	}
+	const size_t filesize = fileinfo.st_size;
+	void* p = mmap(0, filesize, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);																				// mapping stays valid
+	if (p == MAP_FAILED)
+	{	logprintf("Unable to map snapshot \"%s\": %s\n", filename, strerror(errno));
+		return(false);
+	}
+	const MapSnapshotHeader& header = *(const MapSnapshotHeader*)p;
+	bool good = usable(header, filesize, checkage);
+	if (good)
+	{	ost::MutexLock lok(m_owner.getMapLock());
+		TerrainMap& map = m_owner.getMap();
+		map.restoremap(header.m_ix, header.m_iy, (const CellData*)((const char*)p + sizeof(header)));
+		map.setcyclestamp(std::max(map.getcyclestamp(), header.m_cyclestamp));	// restored cells aren't in the future
+		m_lastcyclestamp = map.getcyclestamp();								// don't write it straight back
+		if (checkage || m_owner.getVerboseLevel() >= 1)
+		{	logprintf("Map restored from snapshot, cycle %d, center (%d, %d).\n", header.m_cyclestamp, header.m_ix, header.m_iy);	}
+	}
+	munmap(p, filesize);
+	return(good);
+}
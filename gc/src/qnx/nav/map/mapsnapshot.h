@@ -0,0 +1,76 @@
+//
+//	mapsnapshot.h  --  periodic snapshots of the terrain map, for warm restarts
+//
+//	When the map server restarts, the map starts out empty, and the vehicle has to
+//	stop and sweep before it can move. So, while driving, we save the map every few
+//	seconds, and on startup we load the last snapshot back, at the world position
+//	it was taken. The normal recentering then scrolls it to where the vehicle is now,
+//	discarding whatever is no longer on the map.
+//
+//	The snapshot file is a fixed header followed by the cells, row by row, in
+//	absolute order from the map's lower left corner, so it can be mapped into
+//	memory and copied straight into the map. It is only loaded back into a map of
+//	the same size and cell size, laid out over the same waypoint origin, and only
+//	if it is recent.
+//
+//	Taking a snapshot runs in its own low-priority thread. The map is copied
+//	a band of rows at a time, locking the map only while each band is copied,
+//	and the file is written with the map unlocked, so steering never waits on the disk.
+//
+//	For the steering benchmark, each snapshot can also be kept in an archive directory,
+//	named by its cycle stamp. That's about 20MB every 5 seconds, so it's only for test runs.
+//
+//	Team Overbot
+//	October, 2026
+//
+#ifndef MAPSNAPSHOT_H
+#define MAPSNAPSHOT_H
+
+#include <inttypes.h>
+#include <vector>
+#include <string>
+#include "timedloop.h"
+#include "mapcell.h"
+
+class MapServer;																		// forward
+//
+//	MapSnapshotHeader  -- start of a snapshot file
+//
+struct MapSnapshotHeader {
+	uint32_t	m_magic;																	// k_snapshot_magic
+	uint32_t	m_version;																// k_snapshot_version
+	uint32_t	m_cellsize;																// sizeof(CellData)
+	int32_t	m_dimincells;															// map is this many cells square
+	double	m_cellspermeter;														// cell size
+	int32_t	m_ix, m_iy;																// map center, in cells
+	uint32_t	m_cyclestamp;															// map cycle stamp when taken
+	uint32_t	m_unused;																// (fill to 8 bytes)
+	uint64_t	m_timestamp;															// CLOCK_REALTIME when taken, ns
+	double	m_origin[2];																// latitude, longitude of waypoint origin
+};
+//
+//	class MapSnapshot  -- takes and restores snapshots
+//
+class MapSnapshot: private TimedLoop {
+private:
+	MapServer& m_owner;															// owning map server
+	std::vector<CellData> m_cells;												// copy of map, being written
+	uint32_t m_lastcyclestamp;													// cycle stamp of last snapshot taken
+	bool m_running;																	// snapshots being taken
+	std::string m_archivedir;														// keep all snapshots here, if nonempty
+public:
+	MapSnapshot(MapServer& owner);
+	virtual ~MapSnapshot();
+	void start();																			// start taking snapshots
+	void stop();																			// stop taking snapshots
+	bool restore();																		// load last snapshot into map, if usable
+	bool restore(const char* filename, bool checkage);						// load given snapshot into map, if usable
+	void setArchiveDir(const char* dir) { m_archivedir = dir ? dir : ""; }	// also keep every snapshot here
+	static const char* archivePrefix();											// archived snapshot name is prefix + cycle stamp
+private:
+	void code();																			// take one snapshot
+	bool copymap(MapSnapshotHeader& header);								// copy map into m_cells
+	bool write(const MapSnapshotHeader& header, const char* filename, const char* tempfile);	// write m_cells to file
+	bool usable(const MapSnapshotHeader& header, size_t filesize, bool checkage);	// check snapshot against current map
+};
+#endif // MAPSNAPSHOT_H
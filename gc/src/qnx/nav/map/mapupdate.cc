@@ -230,11 +230,16 @@ void MapServer::updateCell(int ix, int iy, CellData::CellType newtype, bool swee
 	}
 	const uint32_t ancientstamp = getMap().getancientstamp();		// override if newer than this.
 	CellData& cell = m_map.at(ix,iy);							// the relevant cell
+	const CellData::CellType oldtype = cell.gettype();		// for the summary levels
 	bool updated = cell.update(newtype, sweeping, minrange, roughness, elev, cyclestamp,
 		 k_clear_cell_roughness_limit, k_nogo_cell_roughness_limit, ancientstamp);
+	m_map.updatesummary(ix, iy, oldtype, cell);				// roughness may change even if type doesn't
+	if (cell.gettype() != oldtype) m_map.updateplanes(ix, iy, cell.gettype());	// keep classification planes current
 
 	if (updated)
 	{	m_log.logMapChange(cell,ix,iy);						// log change to cell
+		m_map.notechange(ix, iy);									// for consumers which want only what changed
+		m_map.updateinflation(ix, iy, cell.gettype() == CellData::NOGO);	// keep inflated-obstacle layer current
 	}
 	if (getVerboseLevel() >= 3)
 	{	////printf("Updated [%d,%d] to %d %s\n",ix,iy,newtype, updated ? "(CHANGED)":"");	//	very verbose ***TEMP***
@@ -0,0 +1,203 @@
+//
+//	arcfootprint.cpp  -- precomputed cell footprints of constant-curvature arcs
+//
+//	Team Overbot
+//	October, 2026
+//
+#include <math.h>
+#include <algorithm>
+#include "arcfootprint.h"
+#include "terrainmap.h"
+#include "logprint.h"
+//
+const int k_octant_headings = k_footprint_headings/8;			// heading buckets per octant
+//
+//	Constructor
+//
+ArcFootprintLibrary::ArcFootprintLibrary()
+:	m_boxsteps(0), m_cellspermeter(0), m_maxcurvature(0), m_halfwidth(0), m_length(0)
+{}
+//
+//	build  -- build all templates
+//
+//	Templates cover headings from 0 to 45 degrees inclusive, for each curvature bucket.
+//	Takes a fraction of a second, so done once, when the vehicle or map parameters change.
+//
+void ArcFootprintLibrary::build(double cellspermeter, float maxcurvature, float halfwidth, float length)
+{	m_cellspermeter = cellspermeter;
+	m_maxcurvature = maxcurvature;
+	m_halfwidth = halfwidth;
+	m_length = length;
+	m_cells.clear();
+	m_start.clear();
+	m_boxes.clear();
+	m_boxsteps = std::max(1, int(ceil(length/k_footprint_box_step)));
+	//	Widening needed to cover quantization. Half a bucket of curvature error gives a
+	//	sideways error of dist^2*curverr/2; heading error gives dist*headingerr.
+	const float curverr = (k_footprint_curvatures > 1) ? maxcurvature/(k_footprint_curvatures-1) : 0;
+	const float maxwidth = halfwidth + 1.0/cellspermeter + length*M_PI/k_footprint_headings
+		+ length*length*curverr*0.5;									// widest point of any footprint
+	const int gridradius = int((length + maxwidth)*cellspermeter) + 2;	// all footprints fit in this
+	std::vector<float> grid;												// distance to each cell, work area
+	for (int h = 0; h <= k_octant_headings; h++)
+	{	const double heading = h*(2*M_PI/k_footprint_headings);
+		for (int c = 0; c < k_footprint_curvatures; c++)
+		{	const double curvature = (k_footprint_curvatures > 1) ?
+				-maxcurvature + c*(2.0*maxcurvature/(k_footprint_curvatures-1)) : 0;
+			m_start.push_back(m_cells.size());
+			buildtemplate(heading, curvature, curverr, grid, gridradius);
+		}
+	}
+	m_start.push_back(m_cells.size());								// end of last template
+	logprintf("Arc footprint library: %d templates, %d cells, %1.1f KB.\n",
+		int(m_start.size()-1), int(m_cells.size()),
+		(m_cells.size()*sizeof(FootprintCell) + m_boxes.size()*sizeof(FootprintBox))/1024.0);
+}
+//
+//	widthmargin  -- most a footprint is widened, on each side, out to length
+//
+//	The widening in buildtemplate, half a cell diagonal for marking every cell a
+//	sample point falls in, and half a cell diagonal and the quantization error again
+//	for the true arc not starting or running exactly where the template's does.
+//
+float ArcFootprintLibrary::widthmargin(double cellspermeter, float maxcurvature, float length)
+{	const float curverr = (k_footprint_curvatures > 1) ? maxcurvature/(k_footprint_curvatures-1) : 0;
+	return(3*0.71/cellspermeter + 2*(length*M_PI/k_footprint_headings + length*length*curverr*0.5));
+}
+//
+//	Comparison for sorting footprint cells by distance
+//
+struct FootprintOrder {
+	template <class CELL> bool operator()(const CELL& a, const CELL& b) const
+	{	return(a.m_dist < b.m_dist);	}
+};
+//
+//	buildtemplate  -- build one template and append it to m_cells
+//
+//	The arc starts at the center of cell (0,0). Positive curvature is to the right.
+//	Each cell gets the shortest distance along the arc at which the widened vehicle covers it,
+//	less the most the vehicle's position within its start cell could move that forward.
+//
+void ArcFootprintLibrary::buildtemplate(double heading, double curvature, float curverr, std::vector<float>& grid, int gridradius)
+{	const int griddim = 2*gridradius+1;
+	grid.assign(griddim*griddim, -1.0f);								// -1 means not covered
+	const double step = 0.25/m_cellspermeter;						// quarter-cell sampling
+	const double cellmargin = 0.71/m_cellspermeter;				// vehicle can be anywhere in its start cell
+	for (double s = -cellmargin; s <= m_length + step*0.5; s += step)	// start a bit behind, for the same reason
+	{	const double theta = heading - curvature*s;					// heading at s, clockwise for positive curvature
+		double px, py;
+		if (fabs(curvature) < 1e-6)										// straight line
+		{	px = s*cos(heading);
+			py = s*sin(heading);
+		} else {
+			px = (sin(heading) - sin(theta))/curvature;
+			py = (cos(theta) - cos(heading))/curvature;
+		}
+		const double rx = sin(theta);										// unit vector to the right
+		const double ry = -cos(theta);
+		const double q = std::max(s, 0.0);								// distance for quantization error
+		const double hw = m_halfwidth + cellmargin + q*(M_PI/k_footprint_headings) + q*q*curverr*0.5;
+		for (double l = -hw; l <= hw + step*0.5; l += step)
+		{	const int ix = int(floor((px + l*rx)*m_cellspermeter + 0.5));
+			const int iy = int(floor((py + l*ry)*m_cellspermeter + 0.5));
+			if (abs(ix) > gridradius || abs(iy) > gridradius) continue;	// can't happen
+			float& d = grid[(iy+gridradius)*griddim + (ix+gridradius)];
+			if (d < 0) d = std::max(0.0, s - cellmargin - step);	// first time along path is closest, less start offset and sampling
+		}
+	}
+	const size_t start = m_cells.size();
+	for (int iy = -gridradius; iy <= gridradius; iy++)
+	{	for (int ix = -gridradius; ix <= gridradius; ix++)
+		{	const float d = grid[(iy+gridradius)*griddim + (ix+gridradius)];
+			if (d < 0) continue;
+			FootprintCell cell;
+			cell.m_dx = ix;
+			cell.m_dy = iy;
+			cell.m_dist = uint16_t(std::min(d*100.0f, 65535.0f));
+			m_cells.push_back(cell);
+		}
+	}
+	std::sort(m_cells.begin()+start, m_cells.end(), FootprintOrder());	// nearest cells first
+	//	Bounding boxes, out to each box step, for the quick check against the map summary
+	const uint16_t stepcm = uint16_t(k_footprint_box_step*100);
+	FootprintBox box = { 0, 0, 0, 0 };									// start cell is always in it
+	size_t i = start;
+	for (int b = 0; b < m_boxsteps; b++)
+	{	const bool last = (b == m_boxsteps-1);							// last box has everything
+		for (; i < m_cells.size() && (last || m_cells[i].m_dist <= (b+1)*stepcm); i++)
+		{	const FootprintCell& cell = m_cells[i];
+			box.m_xmin = std::min(box.m_xmin, cell.m_dx);
+			box.m_xmax = std::max(box.m_xmax, cell.m_dx);
+			box.m_ymin = std::min(box.m_ymin, cell.m_dy);
+			box.m_ymax = std::max(box.m_ymax, cell.m_dy);
+		}
+		m_boxes.push_back(box);
+	}
+}
+//
+//	orient  -- take an offset in a first-octant template to the actual heading
+//
+static inline void orient(int& dx, int& dy, bool mirror, int quadrant)
+{	if (mirror) std::swap(dx, dy);										// reflect across diagonal
+	switch (quadrant) {														// rotate counterclockwise
+	case 1: { const int tmp = dx; dx = -dy; dy = tmp; break; }
+	case 2: dx = -dx; dy = -dy; break;
+	case 3: { const int tmp = dx; dx = dy; dy = -tmp; break; }
+	default: break;
+	}
+}
+//
+//	clearDistance  -- distance along an arc clear of NOGO cells
+//
+//	Returns the distance along the arc from pos, heading forward, with the given curvature,
+//	at which the vehicle first covers a NOGO or off-map cell, or length if none within length.
+//	Curvatures outside the turning range have no template, and return length.
+//
+float ArcFootprintLibrary::clearDistance(const TerrainMap& map, const vec2& pos, const vec2& forward,
+		float curvature, float length) const
+{	if (m_start.size() == 0) return(length);							// not built
+	if (fabs(curvature) > m_maxcurvature) return(length);		// no template
+	length = std::min(length, m_length);
+	//	Pick heading bucket, then reduce to the first octant
+	double angle = atan2(forward[1], forward[0]);
+	if (angle < 0) angle += 2*M_PI;
+	const int bucket = int(angle*(k_footprint_headings/(2*M_PI)) + 0.5) % k_footprint_headings;
+	const int quadrant = bucket / (2*k_octant_headings);			// quarter turns to rotate by
+	int h = bucket % (2*k_octant_headings);							// heading within quadrant
+	const bool mirror = (h > k_octant_headings);					// second octant - reflect across diagonal
+	if (mirror)
+	{	h = 2*k_octant_headings - h;
+		curvature = -curvature;												// reflection reverses turn direction
+	}
+	const int c = (k_footprint_curvatures > 1) ?
+		int(floor((curvature + m_maxcurvature)*((k_footprint_curvatures-1)/(2.0*m_maxcurvature)) + 0.5)) : 0;
+	const int t = h*k_footprint_curvatures + std::max(0, std::min(c, k_footprint_curvatures-1));
+	const int ix0 = map.coordtocell(pos[0]);
+	const int iy0 = map.coordtocell(pos[1]);
+	//	Quick check. If the map summary says there's no NOGO cell anywhere in the
+	//	template's bounding box, and the box is all on the map, the arc is clear.
+	{	const int b = std::min(m_boxsteps-1, std::max(0, int(ceil(length/k_footprint_box_step))-1));
+		const FootprintBox& box = m_boxes[t*m_boxsteps + b];
+		int x0 = box.m_xmin, y0 = box.m_ymin, x1 = box.m_xmax, y1 = box.m_ymax;
+		orient(x0, y0, mirror, quadrant);								// opposite corners stay opposite
+		orient(x1, y1, mirror, quadrant);
+		const int ixmin = ix0 + std::min(x0,x1), ixmax = ix0 + std::max(x0,x1);
+		const int iymin = iy0 + std::min(y0,y1), iymax = iy0 + std::max(y0,y1);
+		if (map.cellonmap(ixmin, iymin) && map.cellonmap(ixmax, iymax)
+			&& !map.typeInRect(ixmin, iymin, ixmax, iymax, CellData::NOGO)) return(length);
+	}
+	//	Walk the template, nearest cells first
+	const uint16_t maxdist = uint16_t(std::min(length*100.0f, 65535.0f));
+	for (size_t i = m_start[t]; i < m_start[t+1]; i++)
+	{	const FootprintCell& cell = m_cells[i];
+		if (cell.m_dist > maxdist) break;									// past end of interest
+		int dx = cell.m_dx;
+		int dy = cell.m_dy;
+		orient(dx, dy, mirror, quadrant);
+		const int ix = ix0 + dx;
+		const int iy = iy0 + dy;
+		if (!map.cellonmap(ix, iy) || map.at(ix, iy).gettype() == CellData::NOGO)
+			return(cell.m_dist*0.01f);										// blocked here
+	}
+	return(length);
+}
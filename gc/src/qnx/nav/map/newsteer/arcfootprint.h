@@ -0,0 +1,77 @@
+//
+//	arcfootprint.h  -- precomputed cell footprints of constant-curvature arcs
+//
+//	Team Overbot
+//	October, 2026
+//
+//	For a fixed cell size, the cells swept by the vehicle along an arc of a given
+//	curvature, starting at a given heading, are the same every cycle, up to a
+//	translation by whole cells. So we precompute them once, as lists of cell offsets
+//	sorted by distance along the arc, and testing an arc becomes a table-driven walk
+//	over map cells, with no trigonometry or allocation.
+//
+//	Headings are quantized to k_footprint_headings around the circle. Only the first
+//	octant is stored; the other seven are obtained by swapping and negating offsets,
+//	which is exact on a square grid. Curvatures are quantized to k_footprint_curvatures
+//	buckets across the vehicle's turning range. Each footprint is widened by enough
+//	to cover both quantization errors and the vehicle's position within its cell,
+//	so the footprint contains the cells the true arc would sweep, and reaches each
+//	of them no later than the true arc does (to within a few centimeters).
+//
+//	The widening makes a footprint contain cells the vehicle does not cover. To use
+//	the library to reject arcs, build it with the vehicle halfwidth less widthmargin,
+//	so every cell in a footprint really is under the vehicle, and allow distancemargin
+//	for a cell being reached before it really is.
+//
+//	The library grows with the square of its length. For rejecting arcs blocked
+//	within half a vehicle length, it is about a megabyte and builds in well under 0.1 second.
+//
+#ifndef ARCFOOTPRINT_H
+#define ARCFOOTPRINT_H
+
+#include <vector>
+#include <inttypes.h>
+#include "algebra3.h"
+
+class TerrainMap;
+//
+const int k_footprint_headings = 256;						// heading buckets around the circle (multiple of 8)
+const int k_footprint_curvatures = 65;						// curvature buckets, odd so zero is exact
+const float k_footprint_box_step = 1.0;						// bounding boxes kept for each this many meters
+//
+//	class ArcFootprintLibrary  -- the footprint templates for one vehicle and cell size
+//
+class ArcFootprintLibrary
+{
+private:
+	struct FootprintCell {
+		int16_t m_dx, m_dy;													// offset from start cell
+		uint16_t m_dist;														// distance along arc, cm
+	};
+	struct FootprintBox {
+		int16_t m_xmin, m_ymin, m_xmax, m_ymax;					// bounds of cells, relative to start cell
+	};
+	std::vector<FootprintCell> m_cells;								// all templates, end to end
+	std::vector<size_t> m_start;										// start of each template in m_cells
+	std::vector<FootprintBox> m_boxes;								// bounds of each template, out to each box step
+	int m_boxsteps;															// boxes per template
+	double m_cellspermeter;												// parameters templates were built for
+	float m_maxcurvature;
+	float m_halfwidth;
+	float m_length;
+public:
+	ArcFootprintLibrary();
+	bool valid(double cellspermeter, float maxcurvature, float halfwidth, float length) const
+	{	return(m_start.size() > 0 && m_cellspermeter == cellspermeter && m_maxcurvature == maxcurvature
+			&& m_halfwidth == halfwidth && m_length == length);
+	}
+	void build(double cellspermeter, float maxcurvature, float halfwidth, float length);	// build all templates
+	static float widthmargin(double cellspermeter, float maxcurvature, float length);	// most footprints are widened, each side
+	static float distancemargin(double cellspermeter)				// most a cell's distance is understated
+	{	return((3*0.71 + 0.25)/cellspermeter);	}
+	float clearDistance(const TerrainMap& map, const vec2& pos, const vec2& forward,
+		float curvature, float length) const;						// distance along arc clear of NOGO cells
+private:
+	void buildtemplate(double heading, double curvature, float curverr, std::vector<float>& grid, int gridradius);
+};
+#endif // ARCFOOTPRINT_H
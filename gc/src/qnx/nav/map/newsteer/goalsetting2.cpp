@@ -56,6 +56,9 @@ const Tuneable k_safety_margin("SAFETYMARGIN",0.20, 2.0, 0.40, "Minimum clearanc
 //
 const Tuneable k_road_follower_bias("ROADFOLLOWERBIAS",0.0, 1.0, 0.25, "Road follower scale factor (0 to 1)");
 const Tuneable k_road_follower_max("ROADFOLLOWERMAX",0, 4.0, 0, "Road follower max path increase value (m)");
+const Tuneable k_road_layer_max("ROADLAYERMAX",0, 4.0, 0, "Path increase for a path all on road seen by camera (m)");
+const Tuneable k_road_layer_dist("ROADLAYERDIST",5, 60, 30, "Look this far along a path for road seen by camera (m)");
+const float k_road_layer_step = 1.0;									// sample road layer this often along path (m)
 //
 //	getBaseWidth  -- get base width for path.
 //
@@ -204,8 +207,12 @@ float NewSteer::getSteeringLookaheadDistance() const
 //
 //	Provide a slight preference for a path on the road
 //
+//	Two sources: the road follower's suggested curvature, and the road layer of the map,
+//	where the camera's road likelihood has been projected, out past LIDAR range.
+//
 float	NewSteer::adjustMetricForRoad(const TerrainMap& map, float curv, float metric)
 {
+	metric += roadLayerBias(map, curv);												// road seen along this arc
 	const RoadFollowInfo& roadinfo =  map.getroadfollowinfo();			// get road info
 	if (roadinfo.m_confidence <= 0) return(metric);								// ignore if low confidence
 	float curvdiff = fabs(curv - roadinfo.m_curvature) / m_maxcurvature;	// difference from ideal curvature, range 0 to 1
@@ -214,6 +221,31 @@ float	NewSteer::adjustMetricForRoad(const TerrainMap& map, float curv, float met
 	extrametric = std::min(extrametric, float(k_road_follower_max));				// maximum metric increase 
 	return(metric + extrametric);															// return adjusted path
 }
+//
+//	roadLayerBias  -- metric increase for an arc that stays on road seen by the camera
+//
+//	Average road likelihood of the cells along the arc that the camera has seen.
+//	Cells it has not seen don't count either way.
+//
+float NewSteer::roadLayerBias(const TerrainMap& map, float curv)
+{
+	if (k_road_layer_max <= 0) return(0);												// turned off
+	float sum = 0;
+	int seen = 0;
+	for (float dist = k_road_layer_step; dist <= k_road_layer_dist; dist += k_road_layer_step)
+	{	vec2 fwd;
+		const vec2 pt(pointalongarc(m_inposition, m_inforward, curv, dist, fwd));	// point on arc
+		const int ix = map.coordtocell(pt[0]);
+		const int iy = map.coordtocell(pt[1]);
+		if (!map.cellonmap(ix,iy)) break;													// off map, done
+		const uint8_t road = map.roadat(ix,iy);
+		if (road == k_road_nodata) continue;											// camera has not seen it
+		sum += road;
+		seen++;
+	}
+	if (seen == 0) return(0);																// no road info
+	return((sum/(seen*254.0f))*k_road_layer_max);							// all road gets the max
+}
 
 //
 //	constructPathFromCurvature  -- given a desired test curvature and length, construct a path to go there.
@@ -311,12 +343,50 @@ bool NewSteer::constructPathFromCurvature(const WaypointTriple& wp, const Terrai
 			////path.dump("Path to test");																				// ***TEMP***	
 		}
 	}
+	//	If the path is still the plain arc, a table lookup can show it is blocked too soon to be any use.
+	//	The templates are narrowed so that every cell in one really is under the vehicle.
+	const ArcFootprintLibrary* footprints = needdirconstraint ? 0 : getArcFootprints(map);
+	if (footprints && footprints->clearDistance(map, m_inposition, m_inforward, curv, getArcPrescreenDistance())
+		+ ArcFootprintLibrary::distancemargin(map.getcellspermeter()) < getArcPrescreenDistance())
+	{	if (m_stats) m_stats->m_prescreened++;
+		return(false);
+	}
+	//	Cheap check first. A hit on the inflated-obstacle layer this close would be a center obstacle
+	//	for testPath too, and testPath would reject the path for being too short.
+	if (inflatedPathClearDistance(map, path, path.getlength()*0.99) < m_vehicledim[1]*0.5)
+	{	if (m_stats) m_stats->m_prescreened++;
+		return(false);
+	}
 	//	Finally do the real impingement test.
 	//	This path should not have boundary impingements if at all possible.
 	float pathlenout;
 	return(testPath(wp, map, false, k_planning_safety_margin, path, path.getlength()*0.99, pathlenout, impingements));
 }
 //
+//	inflatedPathClearDistance  -- how far along a path is the centerline clear of inflated obstacles?
+//
+//	The map's inflated-obstacle layer marks every cell within half a vehicle width of a NOGO cell,
+//	so a centerline test there is a test of the whole vehicle body. The path is walked in short chords.
+//	The walk starts half a vehicle width along, so NOGO cells behind the vehicle, which the path scan
+//	never sees, don't count.
+//
+float NewSteer::inflatedPathClearDistance(const TerrainMap& map, const CurvedPath& path, float pathlen)
+{
+	const float k_chord_length = 0.5;														// sagitta about 1cm at tightest turn
+	float dist = std::min(float(m_vehicledim[0]*0.5), pathlen);							// start here
+	vec2 p0, p1, fwd;
+	if (!path.pointalongpath(dist, p0, fwd)) return(0);								// bogus path, treat as blocked
+	while (dist < pathlen)
+	{	const float next = std::min(dist + k_chord_length, pathlen);
+		if (!path.pointalongpath(next, p1, fwd)) return(dist);
+		const float clear = map.inflatedClearDistance(p0[0], p0[1], p1[0], p1[1], false);
+		if (clear < (p1-p0).length()) return(dist + clear);						// hit within this chord
+		p0 = p1;
+		dist = next;
+	}
+	return(pathlen);
+}
+//
 //	tryPathCurvature -- try a path with a specific curvature, and evaluate its metric
 //
 bool NewSteer::tryPathCurvature(const WaypointTriple& wp, const TerrainMap& map, const float testcurv,
@@ -408,6 +478,7 @@ bool NewSteer::searchPathRange(const WaypointTriple& wp, const TerrainMap& map,
 	const vec2& ingoalpt,																// we want to get here
 	CurvedPath& path)																	// path output path
 {
+	NewSteerPhaseTimer timer(m_stats, NewSteerStats::phase_searchpathrange);	// if benchmarking
 	float bestcurv = 0;																	// best curvature found
 	float bestmetric = -1;																// metric used to select winning curve
 	float curvescale = testinsidebounds ? (getmaxcurv() - getmincurv()) : m_maxcurvature*2;	// range to test
@@ -422,9 +493,11 @@ bool NewSteer::searchPathRange(const WaypointTriple& wp, const TerrainMap& map,
 		bool isinsidebounds = (testcurv >= getmincurv() && testcurv <= getmaxcurv());	// inside current curvature limits?
 		if (good && isinsidebounds)													// if possible curve
 		{	//	Test this one, the ideal curve.
+			if (m_stats) m_stats->m_candidates++;
 			bool good = tryPathCurvature(wp, map, testcurv, ingoalpt, path, metric);
 			if (good)
 			{	bestcurv = testcurv;														// initial test curvature
+				if (m_stats) m_stats->m_accepted++;
 				bestmetric = metric*1.1;												// slight bias in favor of ideal path
 		   		logPathEndpoint(path);													// create item for debug
 			}
@@ -436,12 +509,14 @@ bool NewSteer::searchPathRange(const WaypointTriple& wp, const TerrainMap& map,
 		bool isinsidebounds = (testcurv >= getmincurv() && testcurv <= getmaxcurv());	// inside current curvature limits?
 		if (testinsidebounds != isinsidebounds) continue;				// test only appropriate range
 		if (testcurv > m_maxcurvature || testcurv < -m_maxcurvature) continue;	 // avoid totally hopeless
+		if (m_stats) m_stats->m_candidates++;
 		//	Construct path which goes to a point on an arc from the vehicle position, but is a general path.
 		//	The generated path may be an S-curve if necessary.
 		float metric;
 		bool good = tryPathCurvature(wp, map, testcurv, ingoalpt, path, metric);
 		if (good)
 		{	//	Found a usable point, but not necessarily the best one.
+			if (m_stats) m_stats->m_accepted++;
 		    if (metric > bestmetric)												// if new winner
 		    {	bestcurv = testcurv;
 			   	bestmetric = metric;
@@ -728,4 +803,42 @@ const std::vector<float>& NewSteer::getCurveTestSchedule()
 	logprintf("Curvature schedule has %d curves to try.\n", m_curvatureschedule.size());	
 	return(m_curvatureschedule);
 }
-	
\ No newline at end of file
+//
+//	getArcPrescreenDistance  -- arcs blocked closer than this are rejected without a path scan
+//
+//	testPath rejects a path with a center obstacle closer than half a vehicle length.
+//
+float NewSteer::getArcPrescreenDistance() const
+{	return(m_vehicledim[1]*0.5);	}
+//
+//	getArcFootprintHalfwidth  -- halfwidth to build arc templates with
+//
+//	Vehicle halfwidth, less the templates' own widening, so that every cell in a
+//	template is under the vehicle. Not positive if the cells are too coarse for that.
+//
+float NewSteer::getArcFootprintHalfwidth(double cellspermeter) const
+{	return(m_vehicledim[0]*0.5 - ArcFootprintLibrary::widthmargin(cellspermeter, m_maxcurvature, getArcPrescreenDistance()));	}
+//
+//	buildArcFootprints  -- precompute swept-cell templates for arcs, for this vehicle and map
+//
+//	Called when the vehicle model is set, not while steering, since it takes a while.
+//
+void NewSteer::buildArcFootprints(const TerrainMap& map)
+{	const double cellspermeter = map.getcellspermeter();
+	const float halfwidth = getArcFootprintHalfwidth(cellspermeter);
+	if (halfwidth <= 0)
+	{	logprintf("Map cells too coarse for arc footprint prescreen.\n");
+		return;
+	}
+	if (!m_arcfootprints.valid(cellspermeter, m_maxcurvature, halfwidth, getArcPrescreenDistance()))
+	{	m_arcfootprints.build(cellspermeter, m_maxcurvature, halfwidth, getArcPrescreenDistance());	}
+}
+//
+//	getArcFootprints  -- get swept-cell templates for arcs, if built for this vehicle and map
+//
+const ArcFootprintLibrary* NewSteer::getArcFootprints(const TerrainMap& map) const
+{	const double cellspermeter = map.getcellspermeter();
+	if (!m_arcfootprints.valid(cellspermeter, m_maxcurvature, getArcFootprintHalfwidth(cellspermeter), getArcPrescreenDistance()))
+	{	return(0);	}																		// not built, no prescreen
+	return(&m_arcfootprints);
+}
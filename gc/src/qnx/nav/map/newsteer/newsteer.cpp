@@ -64,7 +64,7 @@ const Tuneable k_initial_offcourse_tolerance("INITIALOFFCOURSETOLERANCE", 0.0, 2
 //
 NewSteer::NewSteer()
         : m_outpathendpos(vec2(k_NaN,k_NaN)),										// used for hysteresys
-        m_verboselevel(0)
+        m_verboselevel(0), m_stats(0)
 {
 	init();																									// clear state
 }
@@ -118,6 +118,7 @@ bool NewSteer::steer (const vec3& startPos, const vec2& startForward,	// start p
         // output: desired speed
         float& recommendedSpeed)
 {
+	NewSteerPhaseTimer timer(m_stats, NewSteerStats::phase_steer);	// if benchmarking
     //	Update system state
     updatestate(startPos, startForward, startSpeed, startCurvature, elapsedTime, startPitch, startRoll, startDir);
     //	Do the driving
@@ -393,6 +394,7 @@ bool NewSteer::checkOnCourse(WaypointTriple& wp, bool& offcourserecovery)
 bool NewSteer::calcSafeLimits(const WaypointTriple& wp,
                               double distin, float inspeed, bool inturn, double curvature, float& distance, float& speed)
 {
+	NewSteerPhaseTimer timer(m_stats, NewSteerStats::phase_calcsafelimits);	// if benchmarking
 	distance = distin;																		// proposed distance to move
     if (distance < k_min_move)														// if move too short
     {	setFault(Fault::obstacle, "Move too small");							// stop BEFORE hitting obstacle. Allows useful rescan.
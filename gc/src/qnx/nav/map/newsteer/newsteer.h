@@ -36,6 +36,8 @@
 #include "splinepath.h"
 #include "scurvepath.h"
 #include "nan.h"
+#include "arcfootprint.h"
+#include "timeutil.h"
 //
 //	Forward declarations
 //
@@ -59,6 +61,46 @@ struct PathEndpoint {
 	uint8_t	m_color;															// 3-bit RGB
 };
 //
+//	struct NewSteerStats  -- where the time goes, for benchmarking
+//
+//	Only collected when a stats block has been attached with setStats.
+//	Phase times are inclusive; testPath is called from within the others.
+//
+struct NewSteerStats {
+	enum Phase { phase_steer, phase_searchpathrange, phase_improvepath, phase_testpath, phase_calcsafelimits, phase_count };
+	uint64_t m_cycles[phase_count];											// CPU cycles spent in each phase
+	uint32_t m_calls[phase_count];												// times each phase was entered
+	uint32_t m_candidates;															// curvatures tried in searchPathRange
+	uint32_t m_prescreened;														// rejected by a prescreen, arc footprints or inflated layer
+	uint32_t m_accepted;															// candidates which produced a usable path
+	NewSteerStats() { clear(); }
+	void clear()
+	{	for (int i=0; i<phase_count; i++) { m_cycles[i] = 0; m_calls[i] = 0; }
+		m_candidates = m_prescreened = m_accepted = 0;
+	}
+	static const char* phasename(int phase)
+	{	static const char* names[phase_count] = { "steer", "searchPathRange", "improvePath", "testPath", "calcSafeLimits" };
+		return(names[phase]);
+	}
+};
+//
+//	class NewSteerPhaseTimer  -- times one phase, from construction to destruction
+//
+class NewSteerPhaseTimer {
+	NewSteerStats* m_stats;															// null if not collecting
+	NewSteerStats::Phase m_phase;
+	uint64_t m_start;
+public:
+	NewSteerPhaseTimer(NewSteerStats* stats, NewSteerStats::Phase phase)
+	: m_stats(stats), m_phase(phase), m_start(stats ? getcyclecount() : 0)
+	{}
+	~NewSteerPhaseTimer()
+	{	if (!m_stats) return;
+		m_stats->m_cycles[m_phase] += getcyclecount() - m_start;
+		m_stats->m_calls[m_phase]++;
+	}
+};
+//
 //	class NewSteer  -- one steering controller
 //
 //
@@ -99,8 +141,10 @@ private:
     int		m_outwaypoint;				// waypoint number we are currently in, for debug
     //	Precaulculate data
    	std::vector<float>	m_curvatureschedule;	// list of curvatures to try, relative to current position
+   	ArcFootprintLibrary m_arcfootprints;		// swept cells of arcs, for fast obstacle prescreen
    	//	Debug support
    	int m_verboselevel;					// 0=quiet, 1=per-cycle messages, 2=within-cycle messages
+   	NewSteerStats* m_stats;				// timing and counts, if benchmarking
 public:
 
     NewSteer();								// constructor
@@ -116,6 +160,7 @@ public:
 
 	void setVerboseLevel(int lev) {	m_verboselevel = lev; }		// message control
 	int getVerboseLevel() const { return(m_verboselevel); }
+	void setStats(NewSteerStats* stats) { m_stats = stats; }		// collect timing into this, or stop if null
     void init ();							// reinitialize any cached state
 
 	//	Vehicle properties needed to make steering decisions
@@ -126,6 +171,7 @@ public:
         m_maxcurvature = invturnradius;		// how tight can we turn?
         m_steeringrate = 2.0*m_maxcurvature / locktolocksecs;	// how fast can we turn
     }
+	void buildArcFootprints(const TerrainMap& map);				// precompute arc templates for this vehicle and map
     
     // Execute one STEER update: given current vehicle state (global
     // position, heading, speed), elapsed time since last steer update,
@@ -224,6 +270,7 @@ private:
 	float getSteeringLookaheadDistance() const;
 	bool testPath(const WaypointTriple& wp, const TerrainMap& map, bool safemode, float shoulderwidth, const CurvedPath& path, 
 		const float pathlenin, float& pathlenout, ImpingementGroup& impingements);
+	float inflatedPathClearDistance(const TerrainMap& map, const CurvedPath& path, float pathlen);
 	bool constructPathFromCurvature(const WaypointTriple& wp, const TerrainMap& map, float curv, float pathlen, CurvedPath& path, 
 			ImpingementGroup& impingements);
 	bool tryPathCurvature(const WaypointTriple& wp, const TerrainMap& map, const float testcurv,  
@@ -233,8 +280,12 @@ private:
 	bool searchPathRange(const WaypointTriple& wp, const TerrainMap& map,  bool testinsidebounds, const vec2& ingoal, CurvedPath& path);														// path to work on, will be changed
 	void improvePath(const WaypointTriple& wp, const TerrainMap& map, CurvedPath& path, float shoulderwidth, bool& tightspot);
 	const std::vector<float>& getCurveTestSchedule();
+	float getArcPrescreenDistance() const;
+	float getArcFootprintHalfwidth(double cellspermeter) const;
+	const ArcFootprintLibrary* getArcFootprints(const TerrainMap& map) const;
 	void logPathEndpoint(const CurvedPath& path, uint8_t color = 4);
 	float adjustMetricForRoad(const TerrainMap& map, float curv, float metric);
+	float roadLayerBias(const TerrainMap& map, float curv);
     bool steerToGoalPoint(const vec2& goalpt, float& curvature);
 	bool steerToPath(const CurvedPath& path, float& curvature);	// steer to follow this path
 	bool calcSafeLimits(const WaypointTriple& wp,
@@ -117,6 +117,7 @@ bool NewSteer::calcTiltPenalty(const ImpingementGroup& impingements, float& tilt
 bool NewSteer::testPath(const WaypointTriple& wp, const TerrainMap& map, bool safemode, float shoulderwidth, const CurvedPath& path, 
 	const float pathlenin, float& pathlenout, ImpingementGroup& impingements)
 {
+	NewSteerPhaseTimer timer(m_stats, NewSteerStats::phase_testpath);	// if benchmarking, includes rasterization
 #ifdef OBSOLETE //	may need to check this in paths.
 	//	Trim back arclen to keep turn under a half circle. The boundary tests break for arcs bigger than that.
 	if (fabs(curvature) > 0.0001)														// if not straight
@@ -301,7 +302,8 @@ static void calcImprovementMetric(const CurvedPath& path, float basewidth, float
 //	perpendicular to the direction at its end for the best clearance.
 //
 void NewSteer::improvePath(const WaypointTriple& wp, const TerrainMap& map, CurvedPath& path, float shoulderwidth, bool& tightspot)
-{	tightspot = false;																	// not in tight spot yet
+{	NewSteerPhaseTimer timer(m_stats, NewSteerStats::phase_improvepath);	// if benchmarking
+	tightspot = false;																	// not in tight spot yet
 	//	Save properties of input path, independent of its form
 	const vec2 inendpos = path.getendpos();										// point at end of path
 	const vec2 inendforward = path.getendforward();							// direction at end of path
@@ -302,17 +302,15 @@ void CurvedPathObstacleScanner::scan_point(int x, int y)
 //
 //	scan_hline0  -- scan one line in the rasterizer
 //
-//	This is where all the time goes.
+//	This is where all the time goes. The map's classification planes let us skip
+//	over passable cells 64 at a time, and only look at the cells which aren't.
 //
 void CurvedPathObstacleScanner::scan_hline0(int x, int y, int len)
 {
 	const TerrainMap& map = m_map;													// convenient abbreviation
-    for(int i=0;i<len;i++,x++)
-    {
-        if(map.passableCell(x,y))																// if no problem
-            continue;																					// continue
-        collision_point(x, y, map.unknownCell(x,y));									// otherwise handle error or problem
-    }
+	const int xend = x + len;
+    for (x = map.nextimpassable(x, xend, y); x < xend; x = map.nextimpassable(x+1, xend, y))	// for each problem cell
+    {	collision_point(x, y, map.unknownCell(x,y));	}								// handle error or problem
 }
 
 void CurvedPathObstacleScanner::scan_hline(int x1, int x2, int y)
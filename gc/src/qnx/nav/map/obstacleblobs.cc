@@ -0,0 +1,262 @@
+//
+//	obstacleblobs.cc  --  connected groups of NOGO cells in the terrain map
+//
+//	Labeling is the classic two-pass union-find. The first pass gives each NOGO cell of
+//	the region a provisional label, the same as an already-labeled neighbor's when it has
+//	one, and notes when two provisional labels turn out to be the same blob. The second
+//	pass resolves each cell's label to its blob and gathers the blob's statistics.
+//	The region is scanned tile by tile, so a cell's neighbors in other tiles may be
+//	visited before or after it; all eight are checked.
+//
+//	The region relabeled each update is a set of summary tiles: the tiles changed since
+//	the last update, plus all the tiles of every blob found in or bordering one of them,
+//	repeated until no more blobs turn up. A blob touching the region is thus always
+//	relabeled whole, and cells outside the region keep their labels.
+//
+//	Team Overbot
+//	October, 2026
+//
+#include <algorithm>
+#include "obstacleblobs.h"
+
+const int k_tile_cells = TerrainMap::summarytilecells(0);					// region is made of finest summary tiles
+//
+//	Constructor
+//
+ObstacleBlobs::ObstacleBlobs()
+: m_dim(0), m_tiledim(0), m_serial(0), m_sincestamp(0), m_nextid(1), m_relabeled(0)
+{}
+//
+//	reset  -- forget everything, for a new map size
+//
+//	Tiles of the region are marked in a wraparound array too. A map row of dim cells
+//	spans at most dim/cells+2 tiles, so that many tiles on a side never collide.
+//
+void ObstacleBlobs::reset(const TerrainMap& map)
+{	m_dim = map.getdimincells();
+	m_tiledim = m_dim/k_tile_cells + 2;
+	m_labels.assign(m_dim*m_dim, 0);
+	m_tilemark.assign(m_tiledim*m_tiledim, 0);
+	m_blobs.clear();
+	m_serial = 0;
+	m_sincestamp = 0;																		// everything is new
+}
+//
+//	tilecells  -- cells of tile (tx,ty) which are on the map
+//
+CellRect ObstacleBlobs::tilecells(const TerrainMap& map, int tx, int ty) const
+{	CellRect rect;
+	rect.m_ixmin = std::max(tx*k_tile_cells, map.getminix());
+	rect.m_ixmax = std::min(tx*k_tile_cells + k_tile_cells - 1, map.getmaxix());
+	rect.m_iymin = std::max(ty*k_tile_cells, map.getminiy());
+	rect.m_iymax = std::min(ty*k_tile_cells + k_tile_cells - 1, map.getmaxiy());
+	return(rect);
+}
+//
+//	addtile  -- add tile (tx,ty) to the region, unless off the map or already in it
+//
+void ObstacleBlobs::addtile(const TerrainMap& map, int tx, int ty)
+{	const CellRect rect(tilecells(map, tx, ty));
+	if (rect.m_ixmin > rect.m_ixmax || rect.m_iymin > rect.m_iymax) return;	// off the map
+	uint32_t& mark = m_tilemark[TerrainMap::mod(ty,m_tiledim)*m_tiledim + TerrainMap::mod(tx,m_tiledim)];
+	if (mark == m_serial) return;														// already in region
+	mark = m_serial;
+	m_regiontiles.push_back(tx);
+	m_regiontiles.push_back(ty);
+}
+//
+//	addblob  -- add all the tiles of a blob's bounds to the region
+//
+void ObstacleBlobs::addblob(const TerrainMap& map, const ObstacleBlob& blob)
+{	for (int ty = TerrainMap::tileof(blob.m_bounds.m_iymin, k_tile_cells); ty <= TerrainMap::tileof(blob.m_bounds.m_iymax, k_tile_cells); ty++)
+	{	for (int tx = TerrainMap::tileof(blob.m_bounds.m_ixmin, k_tile_cells); tx <= TerrainMap::tileof(blob.m_bounds.m_ixmax, k_tile_cells); tx++)
+		{	addtile(map, tx, ty);	}
+	}
+}
+//
+//	findaffected  -- blobs with a cell in the tile, or next to it, are relabeled
+//
+//	The ring of cells around the tile catches blobs that a new NOGO cell in the tile
+//	might join. Labels here may be stale, left from cells that scrolled off, so ids of
+//	blobs no longer around are ignored.
+//
+void ObstacleBlobs::findaffected(const TerrainMap& map, int tx, int ty)
+{	const CellRect rect(tilecells(map, tx, ty));
+	const int ixmin = std::max(rect.m_ixmin-1, map.getminix());
+	const int ixmax = std::min(rect.m_ixmax+1, map.getmaxix());
+	const int iymin = std::max(rect.m_iymin-1, map.getminiy());
+	const int iymax = std::min(rect.m_iymax+1, map.getmaxiy());
+	for (int iy = iymin; iy <= iymax; iy++)
+	{	for (int ix = ixmin; ix <= ixmax; ix++)
+		{	const int id = labelat(map, ix, iy);
+			if (id <= 0) continue;															// not in a blob
+			BlobMap::iterator p = m_blobs.find(id);
+			if (p == m_blobs.end()) continue;											// stale
+			addblob(map, p->second);													// whole blob gets relabeled
+			m_affected.insert(*p);
+			m_blobs.erase(p);
+		}
+	}
+}
+//
+//	findroot  -- union-find root of a provisional label, with path halving
+//
+int ObstacleBlobs::findroot(int label)
+{	while (m_parent[label] != label)
+	{	m_parent[label] = m_parent[m_parent[label]];
+		label = m_parent[label];
+	}
+	return(label);
+}
+//
+//	relabel  -- label the NOGO cells of the region from scratch
+//
+//	Provisional labels are stored negated, as -(index+1), so they can't be mistaken for
+//	blob ids. A new blob takes over the id of the first old blob among its cells not
+//	already taken, so a blob keeps its id as it grows, shrinks, or scrolls. When blobs
+//	merge, the merged one keeps one of the ids; when one splits, one part keeps it.
+//
+void ObstacleBlobs::relabel(const TerrainMap& map)
+{	m_parent.clear();
+	m_oldid.clear();
+	//	Pass 1: provisional labels, and which ones are the same blob
+	for (size_t t = 0; t < m_regiontiles.size(); t += 2)
+	{	const CellRect rect(tilecells(map, m_regiontiles[t], m_regiontiles[t+1]));
+		for (int iy = rect.m_iymin; iy <= rect.m_iymax; iy++)
+		{	for (int ix = rect.m_ixmin; ix <= rect.m_ixmax; ix++)
+			{	int& label = labelat(map, ix, iy);
+				if (!map.inplane(plane_nogo, ix, iy))
+				{	label = 0;	continue;	}
+				const int provisional = m_parent.size();							// new label for this cell
+				m_parent.push_back(provisional);
+				m_oldid.push_back(label > 0 ? label : 0);
+				//	Unite with neighbors already labeled in this pass. Neighbors outside the
+				//	region are never NOGO with a different blob, or that blob would be in it.
+				const int nx[8] = { ix-1, ix-1, ix, ix+1, ix+1, ix+1, ix, ix-1 };
+				const int ny[8] = { iy, iy-1, iy-1, iy-1, iy, iy+1, iy+1, iy+1 };
+				for (int n = 0; n < 8; n++)
+				{	if (!map.cellonmap(nx[n], ny[n])) continue;
+					const int neighbor = labelat(map, nx[n], ny[n]);
+					if (neighbor >= 0) continue;											// not labeled this pass
+					const int a = findroot(-neighbor-1);
+					const int b = findroot(provisional);
+					if (a < b) m_parent[b] = a;											// lower label is the root
+					else if (b < a) m_parent[a] = b;
+				}
+				label = -provisional-1;
+			}
+		}
+	}
+	//	Pass 2: each root becomes a blob
+	m_component.assign(m_parent.size(), -1);
+	m_newblobs.clear();
+	m_sums.clear();
+	int provisional = 0;
+	for (size_t t = 0; t < m_regiontiles.size(); t += 2)
+	{	const CellRect rect(tilecells(map, m_regiontiles[t], m_regiontiles[t+1]));
+		for (int iy = rect.m_iymin; iy <= rect.m_iymax; iy++)
+		{	for (int ix = rect.m_ixmin; ix <= rect.m_ixmax; ix++)
+			{	int& label = labelat(map, ix, iy);
+				if (label >= 0) continue;													// not NOGO
+				assert(label == -provisional-1);										// same order as pass 1
+				const int root = findroot(provisional);
+				int& index = m_component[root];
+				if (index < 0)																	// first cell of new blob
+				{	index = m_newblobs.size();
+					ObstacleBlob blob;
+					blob.m_id = 0;
+					blob.m_bounds.m_ixmin = blob.m_bounds.m_ixmax = ix;
+					blob.m_bounds.m_iymin = blob.m_bounds.m_iymax = iy;
+					blob.m_cells = 0;
+					blob.m_firstseen = map.getcyclestamp();
+					blob.m_lastseen = 0;
+					m_newblobs.push_back(blob);
+					m_sums.push_back(0.0);
+					m_sums.push_back(0.0);
+				}
+				ObstacleBlob& blob = m_newblobs[index];
+				const int oldid = m_oldid[provisional];
+				if (blob.m_id == 0 && oldid > 0)										// inherit old blob's id if not taken
+				{	BlobMap::iterator p = m_affected.find(oldid);
+					if (p != m_affected.end())
+					{	blob.m_id = oldid;
+						blob.m_firstseen = p->second.m_firstseen;
+						m_affected.erase(p);
+					}
+				}
+				blob.m_bounds.m_ixmin = std::min(blob.m_bounds.m_ixmin, ix);
+				blob.m_bounds.m_ixmax = std::max(blob.m_bounds.m_ixmax, ix);
+				blob.m_bounds.m_iymin = std::min(blob.m_bounds.m_iymin, iy);
+				blob.m_bounds.m_iymax = std::max(blob.m_bounds.m_iymax, iy);
+				blob.m_cells++;
+				blob.m_lastseen = std::max(blob.m_lastseen, map.at(ix,iy).m_cyclestamp);
+				m_sums[index*2] += ix;
+				m_sums[index*2+1] += iy;
+				provisional++;
+			}
+		}
+	}
+	//	Finish the blobs, and give new ones ids
+	for (size_t i = 0; i < m_newblobs.size(); i++)
+	{	ObstacleBlob& blob = m_newblobs[i];
+		if (blob.m_id == 0) blob.m_id = m_nextid++;
+		blob.m_centerx = m_sums[i*2]/blob.m_cells*map.getCellDimensions();		// mean of cell centers; cell n is centered at n*celldim
+		blob.m_centery = m_sums[i*2+1]/blob.m_cells*map.getCellDimensions();
+		blob.m_extentx = (blob.m_bounds.m_ixmax - blob.m_bounds.m_ixmin + 1)*map.getCellDimensions();
+		blob.m_extenty = (blob.m_bounds.m_iymax - blob.m_bounds.m_iymin + 1)*map.getCellDimensions();
+		m_blobs[blob.m_id] = blob;
+	}
+	//	Pass 3: final ids into the labels
+	provisional = 0;
+	for (size_t t = 0; t < m_regiontiles.size(); t += 2)
+	{	const CellRect rect(tilecells(map, m_regiontiles[t], m_regiontiles[t+1]));
+		for (int iy = rect.m_iymin; iy <= rect.m_iymax; iy++)
+		{	for (int ix = rect.m_ixmin; ix <= rect.m_ixmax; ix++)
+			{	int& label = labelat(map, ix, iy);
+				if (label >= 0) continue;
+				label = m_newblobs[m_component[findroot(provisional)]].m_id;
+				provisional++;
+			}
+		}
+	}
+	m_affected.clear();																		// any left are gone
+}
+//
+//	update  -- bring the labeling up to date with changes to the map
+//
+//	Call once per cycle, with the map locked. Tiles changed in the current cycle are
+//	looked at again next time, since the map may change further within the cycle.
+//
+void ObstacleBlobs::update(const TerrainMap& map)
+{	if (map.getdimincells() != m_dim) reset(map);									// map size changed, start over
+	m_changed.clear();
+	map.changedtiles(m_sincestamp, m_changed);
+	m_sincestamp = map.getcyclestamp();
+	m_relabeled = 0;
+	if (m_changed.empty()) return;															// nothing to do
+	m_serial++;																						// new region
+	if (m_serial == 0)																			// wrapped, clear old marks
+	{	std::fill(m_tilemark.begin(), m_tilemark.end(), 0);
+		m_serial = 1;
+	}
+	m_regiontiles.clear();
+	for (size_t i = 0; i < m_changed.size(); i++)
+	{	addtile(map, TerrainMap::tileof(m_changed[i].m_ixmin, k_tile_cells), TerrainMap::tileof(m_changed[i].m_iymin, k_tile_cells));	}
+	for (size_t t = 0; t < m_regiontiles.size(); t += 2)								// grows as blobs are found
+	{	findaffected(map, m_regiontiles[t], m_regiontiles[t+1]);	}
+	relabel(map);
+	m_relabeled = m_regiontiles.size()/2;
+}
+//
+//	blobat  -- blob containing cell (ix,iy), or NULL
+//
+const ObstacleBlob* ObstacleBlobs::blobat(const TerrainMap& map, int ix, int iy) const
+{	if (!map.cellonmap(ix,iy) || map.getdimincells() != m_dim) return(NULL);
+	const int id = m_labels[TerrainMap::mod(iy,m_dim)*m_dim + TerrainMap::mod(ix,m_dim)];
+	if (id <= 0) return(NULL);
+	BlobMap::const_iterator p = m_blobs.find(id);
+	if (p == m_blobs.end()) return(NULL);
+	const CellRect& b = p->second.m_bounds;
+	if (ix < b.m_ixmin || ix > b.m_ixmax || iy < b.m_iymin || iy > b.m_iymax) return(NULL);	// stale label, cell scrolled on since
+	return(&p->second);
+}
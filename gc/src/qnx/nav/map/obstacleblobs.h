@@ -0,0 +1,79 @@
+//
+//	obstacleblobs.h  --  connected groups of NOGO cells in the terrain map
+//
+//	Steering and the logs see the map a cell at a time, and the map has hundreds of
+//	thousands of cells. Grouped into blobs of 8-connected NOGO cells, it has tens of
+//	obstacles, each with its extent and when it was last seen. The labeling is kept
+//	up to date from the map's change tracking: each update relabels only the tiles
+//	changed since the last one, plus the tiles of any blob in or next to them, so a
+//	blob is always labeled as a whole. A blob keeps its id from update to update for
+//	as long as it lasts, so obstacles can be followed over time.
+//
+//	Team Overbot
+//	October, 2026
+//
+#ifndef OBSTACLEBLOBS_H
+#define OBSTACLEBLOBS_H
+
+#include <inttypes.h>
+#include <vector>
+#include <map>
+#include "terrainmap.h"
+//
+//	struct ObstacleBlob  -- one group of connected NOGO cells
+//
+struct ObstacleBlob {
+	int m_id;																		// label, kept while blob lasts
+	CellRect m_bounds;															// bounding box, cells
+	int m_cells;																	// NOGO cells in blob
+	float m_centerx, m_centery;											// centroid, meters
+	float m_extentx, m_extenty;											// size of bounding box, meters
+	uint32_t m_firstseen;														// cycle stamp when first labeled
+	uint32_t m_lastseen;														// latest cycle stamp of its cells
+};
+//
+//	class ObstacleBlobs  -- labeling of the NOGO cells of a TerrainMap into blobs
+//
+//	Map must be locked during update and lookups.
+//
+class ObstacleBlobs {
+public:
+	typedef std::map<int, ObstacleBlob> BlobMap;
+private:
+	BlobMap m_blobs;																// current blobs, by id
+	BlobMap m_affected;															// blobs being relabeled, by old id
+	std::vector<int> m_labels;													// blob id of each cell, 0 if none, map's wraparound layout
+	std::vector<uint32_t> m_tilemark;										// update serial when tile joined region, wraparound
+	std::vector<int> m_regiontiles;											// tiles being relabeled, as tx,ty pairs
+	std::vector<CellRect> m_changed;										// tiles changed since last update
+	std::vector<int> m_parent;													// union-find over provisional labels
+	std::vector<int> m_oldid;													// blob id a provisional label's cell had before
+	std::vector<int> m_component;											// index in m_newblobs of each root, or -1
+	std::vector<ObstacleBlob> m_newblobs;								// blobs found by relabeling
+	std::vector<double> m_sums;												// sums of ix, iy of cells of each new blob
+	int m_dim;																		// map size this was set up for
+	int m_tiledim;																	// tiles on a side of m_tilemark
+	uint32_t m_serial;															// update serial, for m_tilemark
+	uint32_t m_sincestamp;													// next update looks at changes at or after this
+	int m_nextid;																	// next new blob id
+	int m_relabeled;																// tiles relabeled by last update
+public:
+	ObstacleBlobs();
+	void update(const TerrainMap& map);								// bring up to date with map changes
+	const BlobMap& getblobs() const { return(m_blobs); }			// all blobs, by id
+	const ObstacleBlob* blobat(const TerrainMap& map, int ix, int iy) const;	// blob containing cell, or NULL
+	int getrelabeled() const { return(m_relabeled); }				// work done by last update, in tiles
+private:
+	void reset(const TerrainMap& map);									// forget everything, for new map size
+	int& labelat(const TerrainMap& map, int ix, int iy)				// label of cell (ix,iy), which must be on map
+	{	assert(map.cellonmap(ix,iy));
+		return(m_labels[TerrainMap::mod(iy,m_dim)*m_dim + TerrainMap::mod(ix,m_dim)]);
+	}
+	void addtile(const TerrainMap& map, int tx, int ty);			// add tile to region, if on map and not in already
+	void addblob(const TerrainMap& map, const ObstacleBlob& blob);	// add tiles of blob's bounds to region
+	void findaffected(const TerrainMap& map, int tx, int ty);	// blobs in or next to tile join region
+	void relabel(const TerrainMap& map);								// label region from scratch
+	CellRect tilecells(const TerrainMap& map, int tx, int ty) const;	// cells of tile on map
+	int findroot(int label);														// union-find root
+};
+#endif // OBSTACLEBLOBS_H
@@ -0,0 +1,146 @@
+//
+//	obstacledistance.cc  --  distance from each cell of the terrain map to the nearest NOGO cell
+//
+//	The layer keeps its own mask of NOGO cells, refreshed from the classification plane
+//	for the tiles that changed, and its distances, both in the map's wraparound layout.
+//	A changed cell can change distances up to the limit away from it, so each changed
+//	tile marks the tiles within the limit for recomputing. The marked tiles are grouped
+//	into rectangles, runs of tiles along a row joined with the same runs in the rows
+//	below, and each rectangle is one call of the transform. After a scroll, that is one
+//	strip along each edge that moved, rather than the whole map. The cells that scrolled
+//	off are not in any changed tile, so the strip within the limit of the edge they
+//	left by is marked too.
+//
+//	Team Overbot
+//	October, 2026
+//
+#include <math.h>
+#include <algorithm>
+#include "obstacledistance.h"
+
+const int k_tile_cells = TerrainMap::summarytilecells(0);					// changes are tracked in finest summary tiles
+//
+//	Constructor
+//
+ObstacleDistance::ObstacleDistance(double limit)
+: m_state(NULL), m_limit(limit), m_dim(0), m_minix(0), m_miniy(0), m_sincestamp(0), m_updated(0)
+{}
+//
+//	Destructor
+//
+ObstacleDistance::~ObstacleDistance()
+{	if (m_state) cvReleaseDistTransformState(&m_state);	}
+//
+//	reset  -- forget everything, for a new map size
+//
+void ObstacleDistance::reset(const TerrainMap& map)
+{	m_dim = map.getdimincells();
+	const float limitcells = m_limit / map.getCellDimensions();
+	m_mask.assign(m_dim*m_dim, 255);
+	m_distance.assign(m_dim*m_dim, limitcells);
+	cvInitMatHeader(&m_maskmat, m_dim, m_dim, CV_8UC1, &m_mask[0]);
+	cvInitMatHeader(&m_distancemat, m_dim, m_dim, CV_32FC1, &m_distance[0]);
+	if (m_state) cvReleaseDistTransformState(&m_state);
+	m_state = cvCreateDistTransformState(cvSize(m_dim, m_dim), limitcells);
+	m_sincestamp = 0;																		// everything is new
+}
+//
+//	recompute  -- recompute distances for a block of tiles, numbered from the map's corner tile
+//
+void ObstacleDistance::recompute(const TerrainMap& map, int txmin, int txmax, int tymin, int tymax)
+{	const int tx0 = TerrainMap::tileof(map.getminix(), k_tile_cells);
+	const int ty0 = TerrainMap::tileof(map.getminiy(), k_tile_cells);
+	const int ixmin = std::max((tx0+txmin)*k_tile_cells, map.getminix());	// cells of block on map
+	const int ixmax = std::min((tx0+txmax)*k_tile_cells + k_tile_cells - 1, map.getmaxix());
+	const int iymin = std::max((ty0+tymin)*k_tile_cells, map.getminiy());
+	const int iymax = std::min((ty0+tymax)*k_tile_cells + k_tile_cells - 1, map.getmaxiy());
+	//	The transform sees the map as an image with the map's corner cell at (0,0)
+	const CvRect rect = cvRect(ixmin - map.getminix(), iymin - map.getminiy(), ixmax - ixmin + 1, iymax - iymin + 1);
+	const CvPoint origin = cvPoint(TerrainMap::mod(map.getminix(), m_dim), TerrainMap::mod(map.getminiy(), m_dim));
+	cvDistTransformWithState(&m_maskmat, &m_distancemat, m_state, rect, origin);
+	m_updated += rect.width*rect.height;
+}
+//
+//	update  -- bring the layer up to date with changes to the map
+//
+//	Call once per cycle, with the map locked. Tiles changed in the current cycle are
+//	looked at again next time, since the map may change further within the cycle.
+//
+void ObstacleDistance::update(const TerrainMap& map)
+{	if (map.getdimincells() != m_dim) reset(map);									// map size changed, start over
+	m_changed.clear();
+	map.changedtiles(m_sincestamp, m_changed);
+	m_sincestamp = map.getcyclestamp();
+	m_updated = 0;
+	if (m_changed.empty() || !m_state) return;											// nothing to do
+	//	Refresh the mask for the changed tiles
+	for (size_t i = 0; i < m_changed.size(); i++)
+	{	const CellRect& rect = m_changed[i];
+		for (int iy = rect.m_iymin; iy <= rect.m_iymax; iy++)
+		{	uint8_t* row = &m_mask[TerrainMap::mod(iy,m_dim)*m_dim];
+			for (int ix = rect.m_ixmin; ix <= rect.m_ixmax; ix++)
+			{	row[TerrainMap::mod(ix,m_dim)] = map.inplane(plane_nogo, ix, iy) ? 0 : 255;	}
+		}
+	}
+	//	Mark the tiles within the limit of a changed tile
+	const int tx0 = TerrainMap::tileof(map.getminix(), k_tile_cells);
+	const int ty0 = TerrainMap::tileof(map.getminiy(), k_tile_cells);
+	const int ntx = TerrainMap::tileof(map.getmaxix(), k_tile_cells) - tx0 + 1;
+	const int nty = TerrainMap::tileof(map.getmaxiy(), k_tile_cells) - ty0 + 1;
+	const int reach = int(ceil(m_limit / map.getCellDimensions() / k_tile_cells));	// limit, in tiles
+	m_dirty.assign(ntx*nty, 0);
+	for (size_t i = 0; i < m_changed.size(); i++)
+	{	const int tx = TerrainMap::tileof(m_changed[i].m_ixmin, k_tile_cells) - tx0;
+		const int ty = TerrainMap::tileof(m_changed[i].m_iymin, k_tile_cells) - ty0;
+		for (int y = std::max(ty-reach, 0); y <= std::min(ty+reach, nty-1); y++)
+		{	std::fill(&m_dirty[y*ntx + std::max(tx-reach, 0)], &m_dirty[y*ntx + std::min(tx+reach, ntx-1)] + 1, 1);	}
+	}
+	//	Mark the tiles within the limit of an edge cells scrolled off by
+	const int dx = map.getminix() - m_minix;
+	const int dy = map.getminiy() - m_miniy;
+	m_minix = map.getminix();
+	m_miniy = map.getminiy();
+	for (int ty = 0; ty < nty; ty++)
+	{	for (int tx = 0; tx < ntx; tx++)
+		{	if ((dx > 0 && tx <= reach) || (dx < 0 && tx >= ntx-1-reach)
+				|| (dy > 0 && ty <= reach) || (dy < 0 && ty >= nty-1-reach))
+			{	m_dirty[ty*ntx + tx] = 1;	}
+		}
+	}
+	//	Recompute rectangles of marked tiles. A run in a row continues a rectangle
+	//	from the row above if it spans the same tiles.
+	m_runs.clear();
+	for (int ty = 0; ty <= nty; ty++)															// one past the end, to finish
+	{	m_nextruns.clear();
+		for (int tx = 0; ty < nty && tx < ntx; tx++)
+		{	if (!m_dirty[ty*ntx + tx]) continue;
+			const int start = tx;
+			while (tx+1 < ntx && m_dirty[ty*ntx + tx+1]) tx++;
+			int firstrow = ty;
+			for (size_t r = 0; r < m_runs.size(); r += 3)
+			{	if (m_runs[r] == start && m_runs[r+1] == tx)								// same run as above, continue it
+				{	firstrow = m_runs[r+2];
+					m_runs[r] = -1;																	// taken
+					break;
+				}
+			}
+			m_nextruns.push_back(start);
+			m_nextruns.push_back(tx);
+			m_nextruns.push_back(firstrow);
+		}
+		for (size_t r = 0; r < m_runs.size(); r += 3)											// rectangles ending above this row
+		{	if (m_runs[r] >= 0) recompute(map, m_runs[r], m_runs[r+1], m_runs[r+2], ty-1);	}
+		m_runs.swap(m_nextruns);
+	}
+}
+//
+//	clearanceat  -- distance from cell (ix,iy) to the nearest NOGO cell, in meters
+//
+//	Distances past the limit are reported as the limit. NOGO cells beyond the edge
+//	of the map are not known, so near the edge the clearance may be too large.
+//
+float ObstacleDistance::clearanceat(const TerrainMap& map, int ix, int iy) const
+{	assert(map.cellonmap(ix,iy));
+	if (map.getdimincells() != m_dim) return(0);										// not set up yet, assume the worst
+	return(m_distance[TerrainMap::mod(iy,m_dim)*m_dim + TerrainMap::mod(ix,m_dim)] * map.getCellDimensions());
+}
@@ -0,0 +1,52 @@
+//
+//	obstacledistance.h  --  distance from each cell of the terrain map to the nearest NOGO cell
+//
+//	The inflated-obstacle layer answers yes or no for one vehicle width. This layer
+//	holds the actual clearance, exact Euclidean distance in meters up to
+//	k_clearance_limit, so steering can prefer paths with more room. It is kept up to
+//	date from the map's change tracking: each update recomputes only the cells within
+//	the limit of a tile changed since the last one, with the OpenCV exact distance
+//	transform working directly on arrays in the map's wraparound layout.
+//
+//	Team Overbot
+//	October, 2026
+//
+#ifndef OBSTACLEDISTANCE_H
+#define OBSTACLEDISTANCE_H
+
+#include <inttypes.h>
+#include <vector>
+#include <cv.h>
+#include "terrainmap.h"
+//
+//	class ObstacleDistance  -- clearance layer of a TerrainMap
+//
+//	Map must be locked during update and lookups.
+//
+class ObstacleDistance {
+private:
+	std::vector<uint8_t> m_mask;												// 0 for NOGO cells, map's wraparound layout
+	std::vector<float> m_distance;												// cells to nearest NOGO cell, same layout
+	CvMat m_maskmat;																// headers for the above
+	CvMat m_distancemat;
+	CvDistTransformState* m_state;											// transform buffers, for this map size
+	std::vector<CellRect> m_changed;										// tiles changed since last update
+	std::vector<uint8_t> m_dirty;												// tiles to recompute, relative to map corner
+	std::vector<int> m_runs;														// runs of dirty tiles in previous tile row, as start,end,firstrow
+	std::vector<int> m_nextruns;												// and in this one
+	double m_limit;																	// report distances up to this, meters
+	int m_dim;																		// map size this was set up for
+	int m_minix, m_miniy;														// map corner at last update
+	uint32_t m_sincestamp;													// next update looks at changes at or after this
+	int m_updated;																	// cells recomputed by last update
+public:
+	ObstacleDistance(double limit = k_clearance_limit);
+	~ObstacleDistance();
+	void update(const TerrainMap& map);								// bring up to date with map changes
+	float clearanceat(const TerrainMap& map, int ix, int iy) const;	// meters to nearest NOGO cell, up to limit
+	int getupdated() const { return(m_updated); }					// work done by last update, in cells
+private:
+	void reset(const TerrainMap& map);									// forget everything, for new map size
+	void recompute(const TerrainMap& map, int txmin, int txmax, int tymin, int tymax);	// recompute block of tiles
+};
+#endif // OBSTACLEDISTANCE_H
@@ -39,6 +39,7 @@
 #include "waypoints.h"
 #include "geocoords.h"
 #include "interpolatelib.h"
+#include "lidarsim.h"
 
 //
 const float k_min_tilt = (M_PI/180)*40;						// must have at least 40 degrees of tilt from straight down to be useful.
@@ -237,17 +238,18 @@ void MapServer::playbackTest(const char* dummylidarin, const char* dummygpsinsin
 	mat4 vehpose(identity3D());									// vehicle pose is at origin looking east.
 	mat4 scannerpose1;												// scanner pose of line 1
 	mat4 scannerpose2;												// scanner pose of line 2
-	LidarScanLine line1, line2;									// our two scan lines
+	LidarScanLine rawline;											// scan line as read
+	LMSrangeLine line1, line2;									// our two scan lines
 	ActiveWaypoints activewaypoints;						// active waypoint set
 	int rejects = 0;														// rejected messages
 	bool first = true;
 	uint64_t lasttimestamp = 0;									// last time stamp
 	for (uint32_t cyclestamp = 0; ;cyclestamp++)
-	{	int stat = fread(&line2, sizeof(line2), 1, lidarin);	// get scan line
+	{	int stat = fread(&rawline, sizeof(rawline), 1, lidarin);	// get scan line
 		if (stat <= 0) break;											// EOF
-		lasttimestamp = line2.m_header.m_timestamp;	// last timestamp read
+		lasttimestamp = rawline.m_header.m_timestamp;	// last timestamp read
 		if (first)
-		{		dumptimestamp("First LIDAR line timestamp: ", line2.m_header.m_timestamp);
+		{		dumptimestamp("First LIDAR line timestamp: ", rawline.m_header.m_timestamp);
 		}
 		//	Update "ancient stamp". Data older than this is overridden by new, even if better
 		const int k_scanspersec = 75;											// normal scan rate
@@ -256,19 +258,23 @@ void MapServer::playbackTest(const char* dummylidarin, const char* dummygpsinsin
 		{	m_map.setancientstamp(cyclestamp - ancientdiff);	}	// older than this is ancient
 		double latitude, longitude;											// from last GPS fix, uninterpolated
 		float speed;
-		bool good = getposebytime(fixes, line2.m_header.m_timestamp, vehpose, latitude, longitude, speed);	// get vehicle pose
+		bool good = getposebytime(fixes, rawline.m_header.m_timestamp, vehpose, latitude, longitude, speed);	// get vehicle pose
 		if (!good)
 		{	if (rejects++ > 10) continue;								// give up after 10 rejects
 			logprintf("Unable to get vehicle pose from GPS data for scan line #%d.\n", cyclestamp);
-			dumptimestamp("LIDAR line timestamp: ", line2.m_header.m_timestamp);
+			dumptimestamp("LIDAR line timestamp: ", rawline.m_header.m_timestamp);
 			continue;														// otherwise continue
 		}
-		float avgrange;
-		bool goodavgrange = getLMSupdater().LMScalcAverageRange(line2, avgrange);
-		float intilt = line2.m_header.m_tilt;
+		LMStiltCorrector& tiltcorrector = getLMSupdater().getLMStiltCorrector();
+		LMSrangeLine& inputline = tiltcorrector.nextLine();			// preprocess into tilt corrector window
+		getLMSupdater().LMSpreprocess(rawline, inputline);
+		float intilt = rawline.m_header.m_tilt;
 		float tilt;	
 		uint32_t  originalCycleStamp = cyclestamp;
-		bool goodtilt =  getLMSupdater().getLMStiltCorrector().correctTilt(line2,goodavgrange, avgrange, vehpose, cyclestamp, line2);	// correct tilt
+		LMSrangeLine* outline;
+		bool goodtilt =  tiltcorrector.correctTilt(vehpose, cyclestamp, outline);	// correct tilt
+		line2 = goodtilt ? *outline : inputline;						// copy, since we keep line1 around
+		bool goodavgrange = line2.m_goodavgrange;
       if (!goodavgrange || !goodtilt) {
           tilt = intilt;
       } else {
@@ -314,3 +320,25 @@ void MapServer::playbackTest(const char* dummylidarin, const char* dummygpsinsin
 	dumptimestamp("Last LIDAR line timestamp: ", lasttimestamp);	// final timestamp for debug
 	fclose(lidarin);
 }
+//
+//	simulateTest  -- make test data files from a simulated scene
+//
+//	Writes files in the form playbackTest reads. See lidarsim.h for the scene file format.
+//
+bool MapServer::simulateTest(const char* scenein, const char* dummylidarout, const char* dummygpsinsout)
+{	LidarSimulator sim(getLMSupdater().getScannerOffset());	// scanner mounted as on the vehicle
+	if (!sim.load(scenein)) return(false);							// read the scene
+	FILE* lidarout = fopen(dummylidarout,"w");
+	FILE* gpsout = fopen(dummygpsinsout,"w");
+	if (!lidarout || !gpsout)
+	{	logprintf("Unable to create simulated data files \"%s\" and \"%s\".\n", dummylidarout, dummygpsinsout);
+		if (lidarout) fclose(lidarout);
+		if (gpsout) fclose(gpsout);
+		return(false);
+	}
+	bool good = sim.generate(lidarout, gpsout);				// simulate the whole run
+	fclose(lidarout);
+	fclose(gpsout);
+	if (!good) logprintf("Unable to write simulated data files.\n");
+	return(good);
+}
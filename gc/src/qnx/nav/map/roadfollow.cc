@@ -45,7 +45,7 @@ const float k_good_confidence = 0;										// > 0 is good
 //	Constructor
 //
 RoadFollow::RoadFollow()
-: m_roadport(k_roadserver_name, k_roadserver_timeout)								
+: m_roadport(k_roadserver_name, k_roadserver_timeout), m_clearahead(0)
 {
 	m_lastinfo.m_confidence = k_no_confidence;		// not valid yet
 	m_lastinfo.m_curvature = 0;
@@ -61,6 +61,9 @@ void* RoadFollow::roadThread()
 		roadquery.pavement = RoadServerMsgRDDR::RoadUnknown;			// pavement type unknown
 		roadquery.upvector[0] = roadquery.upvector[1] = 0.0;
 		roadquery.upvector[2] = 1.0;								// assume straight up
+		{	ost::MutexLock lok(m_lock);								// lock
+			roadquery.m_cleardist = m_clearahead;				// road ahead known from the map
+		}
 		RoadServerMsgReply roadreply;							// reply area
 		int stat = m_roadport.MsgSend(roadquery, roadreply);	// query road follower
 		if (stat < 0) 
@@ -101,8 +104,13 @@ void RoadFollow::getRoadSteeringHint(RoadFollowInfo& info)
 {	ost::MutexLock lok(m_lock);												// lock	
 	info = m_lastinfo;																// return most recent
 }
-
-
-
-
-
+//
+//	setClearAhead  -- how far ahead of the vehicle the map has the ground CLEAR
+//
+//	Sent to the road follower with the next query, so it can learn what the road looks
+//	like from that part of the image. Zero if nothing ahead is known to be CLEAR.
+//
+void RoadFollow::setClearAhead(float dist)
+{	ost::MutexLock lok(m_lock);												// lock	
+	m_clearahead = dist;
+}
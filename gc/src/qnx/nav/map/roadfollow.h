@@ -52,6 +52,7 @@ class RoadFollow {
 private:
 	MsgClientPort	m_roadport;												// connection to road server port
 	RoadFollowInfo m_lastinfo;												// last set of info
+	float m_clearahead;															// CLEAR ground ahead, m, for next query
 	ost::Mutex m_lock;																// lock on data
 private:
 	void* roadThread();															// roadThread -- local thread to manage tiliting.
@@ -63,5 +64,6 @@ public:
 	void init();																			// start road follower interface
 	bool getRoadSteeringHint(float& curv);							// get steering hint from road follower, non blocking
 	void getRoadSteeringHint(RoadFollowInfo& info);				// get steering hint from road follower, non blocking
+	void setClearAhead(float dist);											// tell road follower how far ahead is CLEAR
 };
 #endif // ROADFOLLOW_H
\ No newline at end of file
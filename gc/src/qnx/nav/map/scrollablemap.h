@@ -32,6 +32,7 @@
 #define SCROLLABLEMAP_H
 #include <stddef.h>
 #include <vector>
+#include <algorithm>
 #include <assert.h>
 
 //
@@ -76,6 +77,11 @@ public:
 	void setmapcenter(double x, double y);										// set the center of the map, by coords
 	void setmapcentercell(int ix, int iy);												// set the center of the map, by cell index
 	void clearmap();																			// clear entire map
+	void restoremap(int xcenter, int ycenter, const CELL* cells);				// load entire map, saved with getraster
+	//	Raster access, for operations on a whole window of the map (such as
+	//	inflating obstacles by dilating cell types with cvDilate)
+	template <class PIXEL, class CONVERT> void getraster(int ixmin, int iymin, int width, int height,
+		PIXEL* raster, int rowstep, PIXEL offmap, CONVERT convert) const;
 	//	Compatibility with NewSteer
 	void setCellDimensions(double sizeinm)										// cell dimensions
 	{	resize(m_dimincells, 1.0/sizeinm);	 }											// resize
@@ -264,6 +270,54 @@ template<class CELL, class PARENT> inline void ScrollableMap<CELL,PARENT>::clear
 	fillmap(getminix(), getmaxix(), getminiy(), getmaxiy());		// refilll after scrolling
 }
 //
+//	restoremap  -- load the entire map, centered at the indicated cell
+//
+//	cells holds the whole map, row by row, from the lower left corner, as
+//	getraster would have copied it out when the map was centered there.
+//
+template<class CELL, class PARENT> inline void ScrollableMap<CELL,PARENT>::restoremap(int xcenter, int ycenter, const CELL* cells)
+{	m_xcenter = xcenter;
+	m_ycenter = ycenter;
+	for (int y=0; y<m_dimincells; y++, cells += m_dimincells)
+	{	CELL* row = &m_map[mod(getminiy()+y,m_dimincells)*m_dimincells];	// this row in the array
+		int mx = mod(getminix(),m_dimincells);											// position within the row
+		for (int x=0; x<m_dimincells; x++)
+		{	row[mx] = cells[x];
+			if (++mx == m_dimincells) mx = 0;											// wrap around
+		}
+	}
+	fillmap(getminix(), getmaxix(), getminiy(), getmaxiy());					// rebuild anything derived from the cells
+}
+//
+//	getraster  -- copy a window of the map into a raster
+//
+//	The window starts at absolute cell (ixmin, iymin), and row y of the raster
+//	(rowstep PIXELs apart) is map row iymin+y.  Each cell is converted with
+//	convert(cell); cells off the map become offmap.  The array wraps around,
+//	so the position within each row is wrapped as we walk along it.
+//
+template<class CELL, class PARENT> template <class PIXEL, class CONVERT>
+inline void ScrollableMap<CELL,PARENT>::getraster(int ixmin, int iymin, int width, int height,
+		PIXEL* raster, int rowstep, PIXEL offmap, CONVERT convert) const
+{	const int onminix = std::max(ixmin, getminix());									// part of each row on the map
+	const int onmaxix = std::min(ixmin+width-1, getmaxix());
+	for (int y=0; y<height; y++, raster += rowstep)
+	{	const int iy = iymin + y;
+		if (iy < getminiy() || iy > getmaxiy() || onminix > onmaxix)		// whole row off map
+		{	for (int x=0; x<width; x++) raster[x] = offmap;
+			continue;
+		}
+		for (int ix=ixmin; ix<onminix; ix++) raster[ix-ixmin] = offmap;	// left of map
+		for (int ix=onmaxix+1; ix<ixmin+width; ix++) raster[ix-ixmin] = offmap;	// right of map
+		const CELL* row = &m_map[mod(iy,m_dimincells)*m_dimincells];		// start of this row in the array
+		int mx = mod(onminix,m_dimincells);												// position within the row
+		for (int ix=onminix; ix<=onmaxix; ix++)
+		{	raster[ix-ixmin] = convert(row[mx]);
+			if (++mx == m_dimincells) mx = 0;											// wrap around
+		}
+	}
+}
+//
 //	passableMove  -- complex terrain evaluation
 //
 //	Subclass must implement if anything useful is to happen
@@ -0,0 +1,287 @@
+//
+//	steerbench.cc  --  steering benchmark, over recorded map snapshots and vehicle states
+//
+//	Runs NewSteer, by itself, over the steering cycles of a recorded run, and reports
+//	where the time goes. The results can be saved as a "golden" file, and later runs
+//	checked against it, so a change to the steering code can be timed and checked
+//	for changes in behavior at the same time.
+//
+//	A recording is made by running the map server with "-r dir". That keeps every
+//	map snapshot in "dir", and writes the inputs to every steering cycle to
+//	"dir/steerframes.txt". Each cycle is replayed on the most recent snapshot taken
+//	before it, with the map scrolled to the vehicle position, as in the live system.
+//	The snapshots are taken every few seconds, so the map is not quite the one the
+//	vehicle saw, but it's the same map on every benchmark run.
+//
+//	Non real time code.
+//
+//	Team Overbot
+//	October, 2026
+//
+#include <stdio.h>
+#include <string.h>
+#include <dirent.h>
+#include <math.h>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include "mapserver.h"
+#include "logprint.h"
+#include "timeutil.h"
+//
+//	Constants
+//
+const float k_golden_tolerance = 0.0001;											// outputs must match this closely
+const int k_max_mismatch_msgs = 10;													// report this many mismatches in detail
+//
+//	struct SteerFrame  -- inputs to one steering cycle
+//
+struct SteerFrame {
+	uint32_t m_cyclestamp;																	// map cycle stamp when recorded
+	vec3	m_pos;																					// vehicle position
+	vec2	m_forward;																			// vehicle direction
+	float	m_speed, m_curvature, m_pitch, m_roll;									// vehicle state
+	int	m_dir;																					// 1=fwd, -1=reverse
+	float	m_elapsed;																			// time since last cycle
+	int	m_snapshot;																			// index of snapshot to use, or -1
+};
+//
+//	struct SteerResult  -- outputs from one steering cycle
+//
+struct SteerResult {
+	int	m_good;																					// steer returned true
+	int	m_fault;																				// fault code if not
+	float	m_movedist, m_curvature, m_speed;											// steering command
+	bool matches(const SteerResult& other) const
+	{	return(m_good == other.m_good && m_fault == other.m_fault
+			&& fabs(m_movedist - other.m_movedist) <= k_golden_tolerance
+			&& fabs(m_curvature - other.m_curvature) <= k_golden_tolerance
+			&& fabs(m_speed - other.m_speed) <= k_golden_tolerance);
+	}
+};
+//
+//	SnapshotStampLess  -- order snapshots by cycle stamp
+//
+struct SnapshotStampLess {
+	bool operator()(uint32_t stamp, const std::pair<uint32_t, std::string>& snapshot) const
+	{	return(stamp < snapshot.first);	}
+};
+//
+//	readsnapshotnames  -- find the archived snapshots in the directory, in cycle stamp order
+//
+static bool readsnapshotnames(const char* dir, std::vector<std::pair<uint32_t, std::string> >& snapshots)
+{	DIR* d = opendir(dir);
+	if (!d)
+	{	logprintf("Unable to read benchmark directory \"%s\".\n", dir);
+		return(false);
+	}
+	const char* prefix = MapSnapshot::archivePrefix();
+	const size_t prefixlen = strlen(prefix);
+	while (const dirent* ent = readdir(d))
+	{	unsigned int stamp;
+		char extra;
+		if (strncmp(ent->d_name, prefix, prefixlen) != 0) continue;			// not a snapshot
+		if (sscanf(ent->d_name + prefixlen, "%u%c", &stamp, &extra) != 1) continue;	// partly written, or something else
+		snapshots.push_back(std::make_pair(uint32_t(stamp), std::string(dir) + "/" + ent->d_name));
+	}
+	closedir(d);
+	std::sort(snapshots.begin(), snapshots.end());
+	return(true);
+}
+//
+//	readframes  -- read the recorded steering inputs
+//
+static bool readframes(const char* filename, std::vector<SteerFrame>& frames)
+{	FILE* f = fopen(filename, "r");
+	if (!f)
+	{	logprintf("Unable to open steering frame file \"%s\".\n", filename);
+		return(false);
+	}
+	char line[512];
+	int lineno = 0;
+	while (fgets(line, sizeof(line), f))
+	{	lineno++;
+		SteerFrame frame;
+		double x, y, z, fx, fy;
+		if (sscanf(line, "frame %u %lf %lf %lf %lf %lf %f %f %f %f %d %f", &frame.m_cyclestamp, &x, &y, &z, &fx, &fy,
+			&frame.m_speed, &frame.m_curvature, &frame.m_pitch, &frame.m_roll, &frame.m_dir, &frame.m_elapsed) != 12)
+		{	logprintf("Steering frame file \"%s\", line %d not understood.\n", filename, lineno);
+			fclose(f);
+			return(false);
+		}
+		frame.m_pos = vec3(x, y, z);
+		frame.m_forward = vec2(fx, fy);
+		frame.m_snapshot = -1;
+		frames.push_back(frame);
+	}
+	fclose(f);
+	return(true);
+}
+//
+//	readgolden  -- read results of an earlier run. False if no file.
+//
+static bool readgolden(const char* filename, std::vector<SteerResult>& results)
+{	FILE* f = fopen(filename, "r");
+	if (!f) return(false);
+	char line[256];
+	while (fgets(line, sizeof(line), f))
+	{	SteerResult result;
+		int frameix;
+		if (sscanf(line, "result %d %d %d %f %f %f", &frameix, &result.m_good, &result.m_fault,
+			&result.m_movedist, &result.m_curvature, &result.m_speed) != 6) continue;
+		if (frameix != int(results.size())) break;											// out of sequence, stop
+		results.push_back(result);
+	}
+	fclose(f);
+	return(true);
+}
+//
+//	writegolden  -- save results as the golden run
+//
+static bool writegolden(const char* filename, const std::vector<SteerResult>& results)
+{	FILE* f = fopen(filename, "w");
+	if (!f)
+	{	logprintf("Unable to create golden steering results file \"%s\".\n", filename);
+		return(false);
+	}
+	for (size_t i=0; i<results.size(); i++)
+	{	const SteerResult& r = results[i];
+		fprintf(f, "result %d %d %d %.9g %.9g %.9g\n", int(i), r.m_good, r.m_fault, r.m_movedist, r.m_curvature, r.m_speed);
+	}
+	return(fclose(f) == 0);
+}
+//
+//	recordSteerFrames  -- record map snapshots and steering inputs into dir, for steerBenchmark
+//
+bool MapServer::recordSteerFrames(const char* dir)
+{	m_snapshot.setArchiveDir(dir);														// keep every snapshot
+	return(m_driver.setFrameLog(dir));													// and the steering inputs
+}
+//
+//	steerBenchmark  -- run NewSteer over a recording, and report timing
+//
+//	If "goldenfile" exists, the results must match it. If not, it is created.
+//	Returns false on any mismatch.
+//
+bool MapServer::steerBenchmark(const char* benchdir, const char* waypointin, const char* goldenfile, int reps)
+{	//	Load everything
+	m_allwaypoints.setVerbose(getVerbose());
+	if (!waypointin || m_allwaypoints.readWaypoints(waypointin) < 0)
+	{	logprintf("Steering benchmark needs the waypoint file used for the recording.\n");
+		return(false);
+	}
+	std::vector<std::pair<uint32_t, std::string> > snapshots;
+	if (!readsnapshotnames(benchdir, snapshots)) return(false);
+	std::vector<SteerFrame> frames;
+	const std::string framefile(std::string(benchdir) + "/" + VehicleDriver::frameLogName());
+	if (!readframes(framefile.c_str(), frames)) return(false);
+	//	Each frame is run on the latest snapshot taken before it.
+	int usableframes = 0;
+	for (size_t i=0; i<frames.size(); i++)
+	{	std::vector<std::pair<uint32_t, std::string> >::const_iterator p =
+			std::upper_bound(snapshots.begin(), snapshots.end(), frames[i].m_cyclestamp, SnapshotStampLess());
+		if (p == snapshots.begin()) continue;												// before first snapshot, not used
+		frames[i].m_snapshot = (p - snapshots.begin()) - 1;
+		usableframes++;
+	}
+	if (usableframes == 0)
+	{	logprintf("No steering frames in \"%s\" have a map snapshot.\n", benchdir);
+		return(false);
+	}
+	//	Run the frames, in order, reps times. Each run starts with a new steering controller,
+	//	so every run sees exactly the same inputs.
+	NewSteerStats stats;
+	uint64_t worstcycles = 0;																// slowest single cycle
+	size_t worstframe = 0;
+	int nondeterministic = 0;																// reps which differ from the first
+	std::vector<SteerResult> results;
+	for (int rep = 0; rep < reps; rep++)
+	{	ReactiveDriver steer;
+		{	ost::MutexLock lok(m_maplock);
+			VehicleDriver::setVehicleModel(steer, m_map);
+		}
+		steer.init();
+		steer.setVerboseLevel(getVerboseLevel() >= 2 ? getVerboseLevel() - 1 : 0);	// -v -v for steering messages
+		int loaded = -1;																			// snapshot now in map
+		size_t resultix = 0;
+		bool samerep = true;
+		for (size_t i=0; i<frames.size(); i++)
+		{	const SteerFrame& frame = frames[i];
+			if (frame.m_snapshot < 0) continue;
+			if (frame.m_snapshot != loaded)
+			{	if (!m_snapshot.restore(snapshots[frame.m_snapshot].second.c_str(), false))
+				{	logprintf("Unable to use map snapshot \"%s\".\n", snapshots[frame.m_snapshot].second.c_str());
+					return(false);
+				}
+				loaded = frame.m_snapshot;
+			}
+			SteerResult result;
+			{	ost::MutexLock lok(m_maplock);												// as in the live system
+				m_map.setmapcenter(frame.m_pos[0], frame.m_pos[1]);				// scroll to vehicle, not timed
+				const uint64_t startcycles = stats.m_cycles[NewSteerStats::phase_steer];
+				steer.setStats(&stats);
+				result.m_good = steer.steer(frame.m_pos, frame.m_forward, frame.m_speed, frame.m_curvature,
+					frame.m_pitch, frame.m_roll, frame.m_dir, frame.m_elapsed, m_map, m_map.getActiveWaypoints(),
+					result.m_movedist, result.m_curvature, result.m_speed);
+				steer.setStats(0);
+				const uint64_t cycles = stats.m_cycles[NewSteerStats::phase_steer] - startcycles;
+				if (cycles > worstcycles) { worstcycles = cycles; worstframe = i; }
+			}
+			result.m_fault = result.m_good ? 0 : int(steer.getFault());
+			if (rep == 0)
+			{	results.push_back(result);	}
+			else if (!results[resultix].matches(result))
+			{	samerep = false;	}
+			resultix++;
+		}
+		if (!samerep) nondeterministic++;
+	}
+	//	Report
+	const double perframe = 1.0 / (double(usableframes)*reps);
+	const double steertime = cyclestosecs(stats.m_cycles[NewSteerStats::phase_steer]);
+	printf("Steering benchmark: %d frames (%d without a map skipped), %d snapshots, %d runs.\n",
+		usableframes, int(frames.size()) - usableframes, int(snapshots.size()), reps);
+	printf("%-18s %12s %12s %8s\n", "phase", "calls/frame", "ms/frame", "% steer");
+	for (int phase = 0; phase < NewSteerStats::phase_count; phase++)
+	{	const double secs = cyclestosecs(stats.m_cycles[phase]);
+		printf("%-18s %12.2f %12.4f %8.1f\n", NewSteerStats::phasename(phase),
+			stats.m_calls[phase]*perframe, secs*perframe*1000.0, steertime > 0 ? 100.0*secs/steertime : 0.0);
+	}
+	printf("Candidates per frame: %1.2f tried, %1.2f prescreened out, %1.2f usable.\n",
+		stats.m_candidates*perframe, stats.m_prescreened*perframe, stats.m_accepted*perframe);
+	printf("Slowest frame: #%d, %1.4f ms.\n", int(worstframe), cyclestosecs(worstcycles)*1000.0);
+	bool good = true;
+	if (nondeterministic > 0)
+	{	printf("NONDETERMINISTIC: %d of %d runs differ from the first.\n", nondeterministic, reps - 1);
+		good = false;
+	}
+	//	Golden check
+	if (!goldenfile) return(good);
+	std::vector<SteerResult> golden;
+	if (!readgolden(goldenfile, golden))
+	{	if (!writegolden(goldenfile, results)) return(false);
+		printf("Golden results written to \"%s\".\n", goldenfile);
+		return(good);
+	}
+	if (golden.size() != results.size())
+	{	printf("MISMATCH: golden file \"%s\" has %d results, this run has %d.\n", goldenfile, int(golden.size()), int(results.size()));
+		return(false);
+	}
+	int mismatches = 0;
+	for (size_t i=0; i<results.size(); i++)
+	{	if (results[i].matches(golden[i])) continue;
+		if (mismatches++ < k_max_mismatch_msgs)
+		{	const SteerResult& r = results[i];
+			const SteerResult& g = golden[i];
+			printf("MISMATCH at result %d: got %d/%d %1.4f m %1.5f 1/r %1.2f m/s, golden %d/%d %1.4f m %1.5f 1/r %1.2f m/s\n",
+				int(i), r.m_good, r.m_fault, r.m_movedist, r.m_curvature, r.m_speed,
+				g.m_good, g.m_fault, g.m_movedist, g.m_curvature, g.m_speed);
+		}
+	}
+	if (mismatches > 0)
+	{	printf("MISMATCH: %d of %d results differ from golden file \"%s\".\n", mismatches, int(results.size()), goldenfile);
+		return(false);
+	}
+	printf("All %d results match golden file \"%s\".\n", int(results.size()), goldenfile);
+	return(good);
+}
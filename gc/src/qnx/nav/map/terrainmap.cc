@@ -1,7 +1,8 @@
 //
 //	terrainmap.cc  -- terrain map implementation
 //
-//	Handles updates of waypoint boundaries in the map as it scrolls.
+//	Handles updates of waypoint boundaries in the map as it scrolls,
+//	and maintains the inflated-obstacle layer.
 //
 //	John Nagle
 //	Team Overbot
@@ -26,6 +27,8 @@
 //	along with this program; if not, write to the Free Software
 //	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 //
+#include <math.h>
+#include <string.h>
 #include <terrainmap.h>
 #include "logprint.h"
 #include "vehicledriver.h"
@@ -41,6 +44,10 @@ void TerrainMap::fillmapx(int ix, int iymin, int iymax)
 {
 	////logprintf("Need to fill terrain map column %d from %d to %d\n", ix, iymin, iymax);	// ***TEMP***
 	ost::MutexLock lok(m_owner.getMapLock());							// protect map during update
+	scrollinflationx(ix, iymin, iymax);										// move inflation layer along with map
+	scrollsummary(ix, ix, iymin, iymax, (ix == getmaxix()) ? -getdimincells() : getdimincells(), 0);	// and summary levels
+	scrollplanes(ix, ix, iymin, iymax);											// and classification planes
+	scrollroad(ix, ix, iymin, iymax);												// and road layer
 	updateactivewaypoints();														// update active waypoint list
 }
 //
@@ -53,6 +60,10 @@ void TerrainMap::fillmapy(int ixmin, int ixmax, int iy)
 {
 	////logprintf("Need to fill terrain map row %d from %d to %d\n", iy, ixmin, ixmax);	// ***TEMP***
 	ost::MutexLock lok(m_owner.getMapLock());							// protect map during update
+	scrollinflationy(ixmin, ixmax, iy);										// move inflation layer along with map
+	scrollsummary(ixmin, ixmax, iy, iy, 0, (iy == getmaxiy()) ? -getdimincells() : getdimincells());	// and summary levels
+	scrollplanes(ixmin, ixmax, iy, iy);											// and classification planes
+	scrollroad(ixmin, ixmax, iy, iy);												// and road layer
 	updateactivewaypoints();
 }
 //
@@ -64,6 +75,10 @@ void TerrainMap::fillmap(int ixmin, int ixmax, int iymin, int iymax)
 {	
 	////logprintf("Need to fill entire map\n");									// ***TEMP***
 	ost::MutexLock lok(m_owner.getMapLock());							// protect map during update
+	rebuildinflation();																// map may also have been resized
+	rebuildsummary();
+	rebuildplanes();
+	rebuildroad();
 	updateactivewaypoints();
 }
 //
@@ -84,9 +99,482 @@ void TerrainMap::updateactivewaypoints()
 //
 //	updateroadfollowinfo  -- update the road follower info, once per steering cycle
 //
-void TerrainMap::updateroadfollowinfo()
+//	Also tells the road follower how far ahead the map knows the ground is CLEAR,
+//	so it can learn what the road looks like from that stretch of the image.
+//
+void TerrainMap::updateroadfollowinfo(double x, double y, double fwdx, double fwdy)
 {
 	ost::MutexLock lok(m_owner.getMapLock());							// protect map during update
 	m_owner.getRoadFollow().getRoadSteeringHint(m_roadfollowinfo);	
+	const float clear = knownClearDistance(x, y, x + fwdx*k_roadclearahead, y + fwdy*k_roadclearahead, k_vehwidth*0.5);
+	m_owner.getRoadFollow().setClearAhead(clear);						// sent with the next query
 }
 
+//
+//	Inflated-obstacle layer
+//
+//	For each cell, we keep a count of the NOGO cells within half a vehicle width of it,
+//	and within half a vehicle width plus a shoulder. A cell with a nonzero count is one
+//	where the vehicle's centerline cannot go without the vehicle (or its shoulder) hitting
+//	an obstacle, so a path can be checked along its centerline alone.
+//
+//	The layer is updated incrementally: when a cell becomes, or stops being, NOGO,
+//	only the counts within the shoulder radius of it change. When the map scrolls,
+//	the NOGO cells scrolling off are subtracted and the new edge is recounted.
+//
+//
+//	setinflationwidths  -- set inflation radii, in meters, and rebuild the layer
+//
+void TerrainMap::setinflationwidths(double halfwidth, double shoulder)
+{	m_inflationhalfwidth = halfwidth;
+	m_inflationshoulder = shoulder;
+	rebuildinflation();
+}
+//
+//	rebuildinflation  -- recompute entire layer from the map
+//
+//	Only needed at startup, on a resize, or when the radii change.
+//
+void TerrainMap::rebuildinflation()
+{	const double cellspermeter = getcellspermeter();
+	const double rcore = m_inflationhalfwidth*cellspermeter;			// radii in cells
+	const double rshoulder = (m_inflationhalfwidth + m_inflationshoulder)*cellspermeter;
+	const int r = int(rshoulder);
+	assert(2*r < getdimincells());												// disc must fit well within the map
+	m_inflationdisc.clear();
+	for (int dy = -r; dy <= r; dy++)
+	{	for (int dx = -r; dx <= r; dx++)
+		{	const double d2 = dx*dx + dy*dy;
+			if (d2 > rshoulder*rshoulder) continue;							// outside disc
+			InflationOffset offset = { dx, dy, d2 <= rcore*rcore };
+			m_inflationdisc.push_back(offset);
+		}
+	}
+	const InflationCell empty = { 0, 0, false };
+	m_inflation.assign(getdimincells()*getdimincells(), empty);		// clear the layer
+	for (int iy = getminiy(); iy <= getmaxiy(); iy++)					// count every NOGO cell on the map
+	{	for (int ix = getminix(); ix <= getmaxix(); ix++)
+		{	if (at(ix,iy).gettype() == CellData::NOGO) updateinflation(ix, iy, true);	}
+	}
+}
+//
+//	updateinflation  -- cell at (ix,iy) became, or stopped being, NOGO
+//
+//	Called from MapServer::updateCell whenever a cell changes.
+//
+void TerrainMap::updateinflation(int ix, int iy, bool nogo)
+{	InflationCell& cell = inflationat(ix,iy);
+	if (cell.m_nogo == nogo) return;												// no change
+	cell.m_nogo = nogo;
+	addinflationinrect(ix, iy, nogo ? 1 : -1, getminix(), getmaxix(), getminiy(), getmaxiy());
+}
+//
+//	addinflationinrect  -- add delta to counts around NOGO cell at (ix,iy)
+//
+//	Only cells within the rectangle, which must be on the map, are changed.
+//	(ix,iy) itself need not be on the map.
+//
+void TerrainMap::addinflationinrect(int ix, int iy, int delta, int ixmin, int ixmax, int iymin, int iymax)
+{	const int dim = getdimincells();
+	for (size_t i=0; i<m_inflationdisc.size(); i++)
+	{	const InflationOffset& offset = m_inflationdisc[i];
+		const int tx = ix + offset.m_dx;
+		const int ty = iy + offset.m_dy;
+		if (tx < ixmin || tx > ixmax || ty < iymin || ty > iymax) continue;	// outside rectangle
+		InflationCell& cell = m_inflation[mod(ty,dim)*dim + mod(tx,dim)];
+		cell.m_shoulder += delta;
+		if (offset.m_core) cell.m_core += delta;
+	}
+}
+//
+//	scrollinflationx  -- update layer for a column which just scrolled on
+//
+//	The new column occupies the same storage as the column which just scrolled off.
+//	Counts from NOGO cells in the old column are removed from the cells still on the
+//	map, then the new column is counted from the NOGO cells near it.
+//
+void TerrainMap::scrollinflationx(int ix, int iymin, int iymax)
+{	const int dim = getdimincells();
+	const int oldix = (ix == getmaxix()) ? ix - dim : ix + dim;			// column that scrolled off
+	const int r = int((m_inflationhalfwidth + m_inflationshoulder)*getcellspermeter());
+	for (int iy = iymin; iy <= iymax; iy++)
+	{	InflationCell& cell = inflationat(ix,iy);
+		if (cell.m_nogo) addinflationinrect(oldix, iy, -1, getminix(), getmaxix(), iymin, iymax);
+		cell.m_core = cell.m_shoulder = 0;
+		cell.m_nogo = false;															// new cells are empty
+	}
+	const int sxmin = std::max(ix-r, getminix());								// columns which can reach new one
+	const int sxmax = std::min(ix+r, getmaxix());
+	for (int sx = sxmin; sx <= sxmax; sx++)
+	{	for (int sy = iymin; sy <= iymax; sy++)
+		{	if (inflationat(sx,sy).m_nogo) addinflationinrect(sx, sy, 1, ix, ix, iymin, iymax);	}
+	}
+}
+//
+//	scrollinflationy  -- update layer for a row which just scrolled on
+//
+void TerrainMap::scrollinflationy(int ixmin, int ixmax, int iy)
+{	const int dim = getdimincells();
+	const int oldiy = (iy == getmaxiy()) ? iy - dim : iy + dim;			// row that scrolled off
+	const int r = int((m_inflationhalfwidth + m_inflationshoulder)*getcellspermeter());
+	for (int ix = ixmin; ix <= ixmax; ix++)
+	{	InflationCell& cell = inflationat(ix,iy);
+		if (cell.m_nogo) addinflationinrect(ix, oldiy, -1, ixmin, ixmax, getminiy(), getmaxiy());
+		cell.m_core = cell.m_shoulder = 0;
+		cell.m_nogo = false;
+	}
+	const int symin = std::max(iy-r, getminiy());								// rows which can reach new one
+	const int symax = std::min(iy+r, getmaxiy());
+	for (int sy = symin; sy <= symax; sy++)
+	{	for (int sx = ixmin; sx <= ixmax; sx++)
+		{	if (inflationat(sx,sy).m_nogo) addinflationinrect(sx, sy, 1, ixmin, ixmax, iy, iy);	}
+	}
+}
+//
+//	inflatedClearDistance  -- how far along a centerline is clear of inflated obstacles?
+//
+//	Returns the distance from (x0,y0) towards (x1,y1) to the first cell where the
+//	vehicle (with its shoulders, if withshoulder) would hit a NOGO cell, or the
+//	full length if none. Leaving the map counts as a hit.
+//
+float TerrainMap::inflatedClearDistance(double x0, double y0, double x1, double y1, bool withshoulder) const
+{	const double len = hypot(x1-x0, y1-y0);
+	const int steps = int(len*getcellspermeter()*2) + 1;				// half-cell steps
+	for (int i=0; i<=steps; i++)
+	{	const double t = double(i)/steps;
+		const int ix = coordtocell(x0 + (x1-x0)*t);
+		const int iy = coordtocell(y0 + (y1-y0)*t);
+		if (!cellonmap(ix,iy)) return(t*len);									// off map, stop here
+		const InflationCell& cell = inflationat(ix,iy);
+		if (withshoulder ? cell.m_shoulder : cell.m_core) return(t*len);	// hit
+	}
+	return(len);
+}
+//
+//	knownClearDistance  -- how far along a strip is every cell known to be CLEAR?
+//
+//	Returns the distance from (x0,y0) towards (x1,y1) to the first cross section of
+//	the strip, halfwidth to either side of the centerline, with a cell that is not
+//	CLEAR. UNKNOWN cells and leaving the map both end the strip.
+//
+float TerrainMap::knownClearDistance(double x0, double y0, double x1, double y1, double halfwidth) const
+{	const double len = hypot(x1-x0, y1-y0);
+	if (len <= 0) return(0);
+	const double sx = -(y1-y0)/len, sy = (x1-x0)/len;							// unit vector across the strip
+	const int steps = int(len*getcellspermeter()*2) + 1;				// half-cell steps along
+	const int across = int(halfwidth*getcellspermeter()*2);			// half-cell steps to each side
+	for (int i=0; i<=steps; i++)
+	{	const double t = double(i)/steps;
+		const double cx = x0 + (x1-x0)*t;
+		const double cy = y0 + (y1-y0)*t;
+		for (int j=-across; j<=across; j++)
+		{	const double d = j/(getcellspermeter()*2);
+			const int ix = coordtocell(cx + sx*d);
+			const int iy = coordtocell(cy + sy*d);
+			if (!cellonmap(ix,iy)) return(t*len);								// off map, stop here
+			if (at(ix,iy).gettype() != CellData::CLEAR) return(t*len);	// not known clear
+		}
+	}
+	return(len);
+}
+//
+//	Summary levels
+//
+//	Each level divides the map into square tiles, k_summary_tile_cells times larger
+//	on a side than the level below, the lowest level being tiles of cells. For each
+//	tile, we keep counts of the cells of each type, so a planner looking far ahead
+//	can check a large area a tile at a time, and only look at cells in tiles that
+//	have something in them.
+//
+//	Tiles are at fixed positions in the world, not relative to the map, and are
+//	stored with the same wraparound as the map. Tiles on the edges of the map are
+//	only partly on it, and count only the cells that are. The levels are updated
+//	along with each cell, and tiles along the edge are recomputed as the map scrolls.
+//	A recomputed tile counts as changed, since its cells are new.
+//
+//
+//	rebuildsummary  -- recompute all levels from the map
+//
+void TerrainMap::rebuildsummary()
+{	const int dim = getdimincells();
+	for (int level = 0; level < k_summary_levels; level++)
+	{	const int cells = summarytilecells(level);
+		m_summarydim[level] = dim/cells + 2;										// enough that tiles on the map never overlap
+		m_summary[level].resize(m_summarydim[level]*m_summarydim[level]);
+		recomputesummary(level, tileof(getminix(),cells), tileof(getmaxix(),cells), tileof(getminiy(),cells), tileof(getmaxiy(),cells));
+	}
+}
+//
+//	recomputesummary  -- recompute a block of tiles at one level, from the level below
+//
+//	Tiles entirely off the map are skipped; their storage belongs to a tile on the map.
+//
+void TerrainMap::recomputesummary(int level, int txmin, int txmax, int tymin, int tymax)
+{	const int cells = summarytilecells(level);
+	const int subcells = cells / k_summary_tile_cells;							// size of the units being summed
+	m_lastchangestamp = m_cyclestamp;												// cells came or went
+	for (int ty = tymin; ty <= tymax; ty++)
+	{	for (int tx = txmin; tx <= txmax; tx++)
+		{	//	Part of this tile on the map, in cells
+			const int ixmin = std::max(tx*cells, getminix());
+			const int ixmax = std::min(tx*cells + cells - 1, getmaxix());
+			const int iymin = std::max(ty*cells, getminiy());
+			const int iymax = std::min(ty*cells + cells - 1, getmaxiy());
+			if (ixmin > ixmax || iymin > iymax) continue;							// off the map
+			SummaryTile& tile = summarytile(level, tx, ty);
+			memset(&tile, 0, sizeof(tile));
+			tile.m_changestamp = m_cyclestamp;
+			if (level == 0)																	// sum cells
+			{	for (int iy = iymin; iy <= iymax; iy++)
+				{	for (int ix = ixmin; ix <= ixmax; ix++)
+					{	const CellData& cell = at(ix,iy);
+						tile.m_count[cell.gettype()]++;
+						if (cell.m_valid) tile.m_maxroughness = std::max(tile.m_maxroughness, cell.roughness());
+					}
+				}
+			} else {																			// sum tiles of level below
+				for (int sy = tileof(iymin,subcells); sy <= tileof(iymax,subcells); sy++)
+				{	for (int sx = tileof(ixmin,subcells); sx <= tileof(ixmax,subcells); sx++)
+					{	const SummaryTile& sub = summarytile(level-1, sx, sy);
+						for (int t = 0; t <= CellData::NOGO; t++) tile.m_count[t] += sub.m_count[t];
+						tile.m_maxroughness = std::max(tile.m_maxroughness, sub.m_maxroughness);
+					}
+				}
+			}
+		}
+	}
+}
+//
+//	scrollsummary  -- recompute tiles for a row or column which just scrolled on
+//
+//	The cells scrolled on replace the ones (dx,dy) away, which scrolled off. Tiles
+//	containing either are recomputed, at every level.
+//
+void TerrainMap::scrollsummary(int ixmin, int ixmax, int iymin, int iymax, int dx, int dy)
+{	for (int level = 0; level < k_summary_levels; level++)
+	{	const int cells = summarytilecells(level);
+		recomputesummary(level, tileof(ixmin,cells), tileof(ixmax,cells), tileof(iymin,cells), tileof(iymax,cells));
+		recomputesummary(level, tileof(ixmin+dx,cells), tileof(ixmax+dx,cells), tileof(iymin+dy,cells), tileof(iymax+dy,cells));
+	}
+}
+//
+//	updatesummary  -- cell at (ix,iy), formerly of type oldtype, was updated
+//
+//	Called from MapServer::updateCell for every cell update, since roughness
+//	can change without the type changing.
+//
+void TerrainMap::updatesummary(int ix, int iy, CellData::CellType oldtype, const CellData& cell)
+{	const CellData::CellType newtype = cell.gettype();
+	for (int level = 0; level < k_summary_levels; level++)
+	{	const int cells = summarytilecells(level);
+		SummaryTile& tile = summarytile(level, tileof(ix,cells), tileof(iy,cells));
+		if (newtype != oldtype)
+		{	tile.m_count[oldtype]--;
+			tile.m_count[newtype]++;
+		}
+		if (cell.m_valid) tile.m_maxroughness = std::max(tile.m_maxroughness, cell.roughness());
+	}
+}
+//
+//	typeInRect  -- is any cell in the rectangle of the given type, or worse?
+//
+//	Starts with the coarsest tiles, and only looks at finer tiles, and finally cells,
+//	within tiles which have such a cell somewhere. The part of the rectangle
+//	off the map is ignored.
+//
+bool TerrainMap::typeInRect(int ixmin, int iymin, int ixmax, int iymax, CellData::CellType type) const
+{	ixmin = std::max(ixmin, getminix());												// clip to map
+	ixmax = std::min(ixmax, getmaxix());
+	iymin = std::max(iymin, getminiy());
+	iymax = std::min(iymax, getmaxiy());
+	if (ixmin > ixmax || iymin > iymax) return(false);							// nothing on map
+	return(typeintiles(k_summary_levels-1, ixmin, iymin, ixmax, iymax, type));
+}
+//
+//	typeintiles  -- typeInRect, at one level, for a rectangle on the map
+//
+bool TerrainMap::typeintiles(int level, int ixmin, int iymin, int ixmax, int iymax, CellData::CellType type) const
+{	if (level < 0)																			// down to cells
+	{	for (int iy = iymin; iy <= iymax; iy++)
+		{	for (int ix = ixmin; ix <= ixmax; ix++)
+			{	if (at(ix,iy).gettype() >= type) return(true);	}
+		}
+		return(false);
+	}
+	const int cells = summarytilecells(level);
+	for (int ty = tileof(iymin,cells); ty <= tileof(iymax,cells); ty++)
+	{	for (int tx = tileof(ixmin,cells); tx <= tileof(ixmax,cells); tx++)
+		{	if (!summarytile(level, tx, ty).hastype(type)) continue;				// nothing here
+			const int txmin = std::max(tx*cells, ixmin);								// part of tile in rectangle
+			const int txmax = std::min(tx*cells + cells - 1, ixmax);
+			const int tymin = std::max(ty*cells, iymin);
+			const int tymax = std::min(ty*cells + cells - 1, iymax);
+			if (txmin == tx*cells && txmax == tx*cells + cells - 1
+				&& tymin == ty*cells && tymax == ty*cells + cells - 1) return(true);	// whole tile is in rectangle
+			if (typeintiles(level-1, txmin, tymin, txmax, tymax, type)) return(true);
+		}
+	}
+	return(false);
+}
+//
+//	Change tracking
+//
+//	Consumers which only want what changed - the logger, the viewer, derived layers -
+//	remember the cycle stamp when they last looked, and ask for the tiles changed since.
+//	Each summary tile carries the cycle stamp of its last change, so the search only
+//	descends into coarse tiles which have changed, and never looks at cells. A consumer
+//	called every cycle gets that cycle's changes by asking with the current stamp.
+//	Stamps, rather than dirty bits, let any number of consumers work independently.
+//
+//
+//	notechange  -- cell at (ix,iy) changed this cycle
+//
+//	Called from MapServer::updateCell when CellData::update reports a change.
+//
+void TerrainMap::notechange(int ix, int iy)
+{	for (int level = 0; level < k_summary_levels; level++)
+	{	const int cells = summarytilecells(level);
+		summarytile(level, tileof(ix,cells), tileof(iy,cells)).m_changestamp = m_cyclestamp;
+	}
+	m_lastchangestamp = m_cyclestamp;
+}
+//
+//	changedtiles  -- finest summary tiles which changed at or after sincestamp
+//
+//	Appends each tile, clipped to the map, to out.
+//
+void TerrainMap::changedtiles(uint32_t sincestamp, std::vector<CellRect>& out) const
+{	if (m_lastchangestamp < sincestamp) return;										// nothing at all
+	changedintiles(k_summary_levels-1, sincestamp, getminix(), getminiy(), getmaxix(), getmaxiy(), out);
+}
+//
+//	changedintiles  -- changedtiles, at one level, for a rectangle on the map
+//
+void TerrainMap::changedintiles(int level, uint32_t sincestamp, int ixmin, int iymin, int ixmax, int iymax, std::vector<CellRect>& out) const
+{	const int cells = summarytilecells(level);
+	for (int ty = tileof(iymin,cells); ty <= tileof(iymax,cells); ty++)
+	{	for (int tx = tileof(ixmin,cells); tx <= tileof(ixmax,cells); tx++)
+		{	if (summarytile(level, tx, ty).m_changestamp < sincestamp) continue;	// nothing new here
+			CellRect rect;																	// part of tile in rectangle
+			rect.m_ixmin = std::max(tx*cells, ixmin);
+			rect.m_ixmax = std::min(tx*cells + cells - 1, ixmax);
+			rect.m_iymin = std::max(ty*cells, iymin);
+			rect.m_iymax = std::min(ty*cells + cells - 1, iymax);
+			if (level == 0)
+			{	out.push_back(rect);	}
+			else
+			{	changedintiles(level-1, sincestamp, rect.m_ixmin, rect.m_iymin, rect.m_ixmax, rect.m_iymax, out);	}
+		}
+	}
+}
+//
+//	Classification planes
+//
+//	For each of UNKNOWN, POSSIBLE, and NOGO, one bit per cell, 64 cells to a word,
+//	with the same wraparound as the map. The scanners spend most of their time looking
+//	along rows of cells for anything not passable, and with the planes they can look
+//	at 64 cells at a time. Bits past the end of each row are always zero.
+//
+//
+//	rebuildplanes  -- recompute all planes from the map
+//
+void TerrainMap::rebuildplanes()
+{	m_planewords = (getdimincells() + 63) / 64;
+	for (int plane = 0; plane < k_plane_count; plane++)
+	{	m_planes[plane].assign(getdimincells()*m_planewords, 0);	}
+	scrollplanes(getminix(), getmaxix(), getminiy(), getmaxiy());
+}
+//
+//	scrollplanes  -- recompute the bits for a block of cells, usually a row or column just scrolled on
+//
+void TerrainMap::scrollplanes(int ixmin, int ixmax, int iymin, int iymax)
+{	for (int iy = iymin; iy <= iymax; iy++)
+	{	for (int ix = ixmin; ix <= ixmax; ix++)
+		{	updateplanes(ix, iy, at(ix,iy).gettype());	}
+	}
+}
+//
+//	updateplanes  -- cell at (ix,iy) is now of the given type
+//
+void TerrainMap::updateplanes(int ix, int iy, CellData::CellType type)
+{	assert(cellonmap(ix,iy));
+	const int col = mod(ix,getdimincells());
+	const size_t word = mod(iy,getdimincells())*m_planewords + col/64;
+	const uint64_t bit = uint64_t(1) << (col % 64);
+	const bool set[k_plane_count] = { type == CellData::UNKNOWN, type == CellData::POSSIBLE, type == CellData::NOGO };
+	for (int plane = 0; plane < k_plane_count; plane++)
+	{	if (set[plane]) m_planes[plane][word] |= bit;
+		else m_planes[plane][word] &= ~bit;
+	}
+}
+//
+//	Road layer
+//
+//	For each cell, how road-like the road follower's camera found it, 0-254, blended
+//	over the frames that saw it. Unlike the LIDAR, the camera reaches well beyond the
+//	range at which cells get classified, so steering can look for the road out there.
+//
+//
+//	rebuildroad  -- forget the whole road layer
+//
+void TerrainMap::rebuildroad()
+{	m_road.assign(getdimincells()*getdimincells(), k_road_nodata);	}
+//
+//	scrollroad  -- cells just scrolled on have not been seen
+//
+void TerrainMap::scrollroad(int ixmin, int ixmax, int iymin, int iymax)
+{	const int dim = getdimincells();
+	for (int iy = iymin; iy <= iymax; iy++)
+	{	for (int ix = ixmin; ix <= ixmax; ix++)
+		{	m_road[mod(iy,dim)*dim + mod(ix,dim)] = k_road_nodata;	}
+	}
+}
+//
+//	updateroad  -- camera saw cell (ix,iy) with this road likelihood
+//
+//	Blended with earlier sightings, so one bad frame does not wipe out the road.
+//
+void TerrainMap::updateroad(int ix, int iy, uint8_t likelihood)
+{	assert(cellonmap(ix,iy));
+	assert(likelihood != k_road_nodata);
+	const int dim = getdimincells();
+	uint8_t& cell = m_road[mod(iy,dim)*dim + mod(ix,dim)];
+	if (cell == k_road_nodata) cell = likelihood;							// first sighting
+	else cell = uint8_t((3*int(cell) + int(likelihood) + 2)/4);		// weight new sighting 1/4
+}
+//
+//	nextimpassable  -- first cell in [ix, ixend) of row iy which is not passable
+//
+//	Returns ixend if they're all passable. The whole span must be on the map. The span
+//	is in at most two pieces in the array, one on each side of the wraparound point.
+//
+int TerrainMap::nextimpassable(int ix, int ixend, int iy) const
+{	if (ix >= ixend) return(ixend);
+	assert(cellonmap(ix,iy) && cellonmap(ixend-1,iy));
+	const int dim = getdimincells();
+	const size_t rowstart = mod(iy,dim)*m_planewords;
+	const uint64_t* unknown = &m_planes[plane_unknown][rowstart];
+	const uint64_t* possible = &m_planes[plane_possible][rowstart];
+	const uint64_t* nogo = &m_planes[plane_nogo][rowstart];
+	int col = mod(ix,dim);																// position in row of array
+	int remaining = ixend - ix;														// cells left to look at
+	int skipped = 0;																		// cells looked at
+	while (remaining > 0)
+	{	const int colend = std::min(dim, col + remaining);						// end of this piece
+		int w = col / 64;
+		uint64_t bits = (unknown[w] | possible[w] | nogo[w]) & (~uint64_t(0) << (col % 64));	// ignore cells before start
+		for (;;)
+		{	if (bits)
+			{	const int hit = w*64 + __builtin_ctzll(bits);
+				if (hit < colend) return(ix + skipped + hit - col);
+				break;																			// past end of piece
+			}
+			if (++w*64 >= colend) break;
+			bits = unknown[w] | possible[w] | nogo[w];
+		}
+		skipped += colend - col;
+		remaining -= colend - col;
+		col = 0;																				// continue from start of row
+	}
+	return(ixend);
+}
@@ -45,6 +45,72 @@
 ////typedef ScrollableMap<CellData, AbstractTerrainMap> TerrainMap;
 class MapServer;															// forward
 //
+//	struct InflationCell  -- one cell of the inflated-obstacle ("configuration space") layer
+//
+//	Counts of NOGO cells within half a vehicle width, and within half a vehicle width
+//	plus a shoulder, of this cell. Counts, rather than flags, let a NOGO cell be removed
+//	again without rescanning its neighbors.
+//
+struct InflationCell {
+	uint16_t m_core;																	// NOGO cells within vehicle halfwidth
+	uint16_t m_shoulder;															// NOGO cells within halfwidth plus shoulder
+	bool m_nogo;																		// this cell itself counted as NOGO
+};
+//
+//	struct InflationOffset  -- one cell of the inflation disc, relative to its NOGO cell
+//
+struct InflationOffset {
+	int m_dx, m_dy;																		// offset in cells
+	bool m_core;																		// within vehicle halfwidth
+};
+//
+//	CellPlane  -- the classification bit planes
+//
+//	One bit per cell, set if the cell is of that type. A cell with none of the bits
+//	set is CLEAR, and so passable.
+//
+enum CellPlane {
+	plane_unknown,																		// UNKNOWN, or no data
+	plane_possible,																		// POSSIBLE
+	plane_nogo,																			// NOGO
+	k_plane_count
+};
+//
+//	struct SummaryTile  -- one tile of a coarse summary level
+//
+//	Counts of the cells of each type within the tile, for the part of the tile
+//	that is on the map, and an upper bound on their roughness. Counts let a
+//	cell's type change without rescanning the tile. The roughness bound only
+//	comes down when the tile is recomputed, as it scrolls.
+//
+//	The change stamp is the map cycle stamp when a cell in the tile last changed,
+//	or the tile was recomputed. Consumers use it to find what changed since they last looked.
+//
+struct SummaryTile {
+	uint16_t m_count[CellData::NOGO+1];										// cells of each type
+	uint8_t m_maxroughness;															// no cell rougher than this
+	uint32_t m_changestamp;															// cycle of last change within tile
+	int cells() const																		// cells of tile on map
+	{	return(m_count[CellData::UNKNOWN] + m_count[CellData::CLEAR] + m_count[CellData::POSSIBLE] + m_count[CellData::NOGO]);	}
+	CellData::CellType worsttype() const											// worst known type, UNKNOWN if nothing known
+	{	for (int t = CellData::NOGO; t > CellData::UNKNOWN; t--) { if (m_count[t]) return(CellData::CellType(t)); }
+		return(CellData::UNKNOWN);
+	}
+	bool hastype(CellData::CellType type) const								// any cell this bad or worse?
+	{	for (int t = CellData::NOGO; t >= type; t--) { if (m_count[t]) return(true); }
+		return(false);
+	}
+	float knownfraction() const														// fraction of cells with data
+	{	return(cells() ? 1.0f - float(m_count[CellData::UNKNOWN])/cells() : 0.0f);	}
+};
+//
+//	struct CellRect  -- a rectangle of cells, inclusive
+//
+struct CellRect {
+	int m_ixmin, m_iymin;
+	int m_ixmax, m_iymax;
+};
+//
 //	class TerrainMap  -- the big scrollable map of cells, and other info about the real world
 //
 //	ScrollableMap does most of the work, but we have to provide some functions to update
@@ -58,11 +124,27 @@ private:
 	RoadFollowInfo m_roadfollowinfo;																			// latest road follower info
 	uint32_t m_cyclestamp;																							// map update cycle serial number
 	uint32_t m_ancientstamp;																						// older than this, override
+	uint32_t m_lastchangestamp;																					// cycle of last change anywhere
+	//	Inflated-obstacle layer, parallel to the cells of the map
+	std::vector<InflationCell> m_inflation;																	// same wraparound layout as the map
+	std::vector<InflationOffset> m_inflationdisc;															// offsets within shoulder radius
+	double m_inflationhalfwidth;																				// vehicle halfwidth, meters
+	double m_inflationshoulder;																					// shoulder width, meters
+	//	Summary levels, coarser and coarser, for quick tests over large areas
+	std::vector<SummaryTile> m_summary[k_summary_levels];												// wraparound layout, in tiles
+	int m_summarydim[k_summary_levels];																		// tiles on a side, each level
+	//	Classification planes, one bit per cell, packed along each row
+	std::vector<uint64_t> m_planes[k_plane_count];															// same wraparound layout as the map
+	int m_planewords;																									// words in each row of a plane
+	//	Road layer, road likelihood seen by the road follower's camera
+	std::vector<uint8_t> m_road;																					// same wraparound layout as the map
 public:
 	TerrainMap(MapServer& owner, int dimincells, double cellspermeter)					// constructor
 	: ScrollableMap<CellData, AbstractTerrainMap>(dimincells, cellspermeter),			// initialize parent
-	m_owner(owner), m_cyclestamp(0), m_ancientstamp(0)										// link back to owner
-	{}
+	m_owner(owner), m_cyclestamp(0), m_ancientstamp(0), m_lastchangestamp(0),									// link back to owner
+	m_inflationhalfwidth(k_vehwidth*0.5), m_inflationshoulder(k_inflation_shoulder)
+	{	rebuildinflation(); rebuildsummary(); rebuildplanes(); rebuildroad();	}																// parent could not call our fillmap
+
 	virtual ~TerrainMap() {}
 	const ActiveWaypoints& getActiveWaypoints() const { return(m_activewaypoints); }
 protected:
@@ -74,10 +156,84 @@ public:
 	uint32_t incrementcyclestamp()								// access to cycle serial number
 	{	m_cyclestamp++;	 return(m_cyclestamp); }
 	uint32_t getcyclestamp() const { return(m_cyclestamp); }
+	void setcyclestamp(uint32_t val) { m_cyclestamp = val; }		// when restoring a saved map
 	void setancientstamp(uint32_t val) { m_ancientstamp = val; }
 	uint32_t getancientstamp() const { return(m_ancientstamp); }
-	void updateroadfollowinfo();
+	void updateroadfollowinfo(double x, double y, double fwdx, double fwdy);	// at vehicle position and heading
 	const RoadFollowInfo& getroadfollowinfo() const 
 	{	return(m_roadfollowinfo);	}									// access
+	//	Inflated-obstacle layer
+	void setinflationwidths(double halfwidth, double shoulder);	// set radii, and rebuild layer
+	void updateinflation(int ix, int iy, bool nogo);					// cell at (ix,iy) became, or stopped being, NOGO
+	bool inflatedCell(int ix, int iy) const								// would vehicle centered here hit a NOGO cell?
+	{	return(inflationat(ix,iy).m_core != 0);	}
+	bool shoulderCell(int ix, int iy) const								// would vehicle plus shoulders?
+	{	return(inflationat(ix,iy).m_shoulder != 0);	}
+	float inflatedClearDistance(double x0, double y0, double x1, double y1, bool withshoulder) const;	// test a centerline
+	float knownClearDistance(double x0, double y0, double x1, double y1, double halfwidth) const;	// test a strip for CLEAR
+	//	Summary levels
+	void updatesummary(int ix, int iy, CellData::CellType oldtype, const CellData& cell);	// cell at (ix,iy) was updated
+	const SummaryTile& summaryat(int level, int ix, int iy) const				// tile containing cell (ix,iy), which must be on map
+	{	assert(cellonmap(ix,iy));
+		const int cells = summarytilecells(level);
+		return(summarytile(level, tileof(ix,cells), tileof(iy,cells)));
+	}
+	bool typeInRect(int ixmin, int iymin, int ixmax, int iymax, CellData::CellType type) const;	// any cell this bad or worse?
+	//	Classification planes
+	void updateplanes(int ix, int iy, CellData::CellType type);						// cell at (ix,iy) is now of this type
+	int nextimpassable(int ix, int ixend, int iy) const;								// first cell in [ix,ixend) of row not passable, else ixend
+	bool inplane(CellPlane plane, int ix, int iy) const									// is cell (ix,iy) in this plane?
+	{	assert(cellonmap(ix,iy));
+		const int col = mod(ix,getdimincells());
+		return((m_planes[plane][mod(iy,getdimincells())*m_planewords + col/64] >> (col % 64)) & 1);
+	}
+	//	Road layer
+	void updateroad(int ix, int iy, uint8_t likelihood);												// camera saw cell (ix,iy) with this road likelihood
+	uint8_t roadat(int ix, int iy) const																	// road likelihood 0-254, or k_road_nodata
+	{	assert(cellonmap(ix,iy));
+		return(m_road[mod(iy,getdimincells())*getdimincells() + mod(ix,getdimincells())]);
+	}
+	//	Change tracking
+	void notechange(int ix, int iy);																	// cell at (ix,iy) changed this cycle
+	uint32_t getlastchangestamp() const { return(m_lastchangestamp); }				// cycle of last change anywhere on map
+	void changedtiles(uint32_t sincestamp, std::vector<CellRect>& out) const;		// finest tiles changed at or after stamp
+	static int summarytilecells(int level)											// cells on a side of a tile at this level
+	{	int cells = k_summary_tile_cells;
+		while (level-- > 0) cells *= k_summary_tile_cells;
+		return(cells);
+	}
+	static int tileof(int i, int cells)													// tile containing cell i, rounding down
+	{	return(i >= 0 ? i/cells : -((-i-1)/cells) - 1);	}
+private:
+	const InflationCell& inflationat(int ix, int iy) const			// inflation cell at (ix,iy), fatal if off map
+	{	assert(cellonmap(ix,iy));
+		return(m_inflation[mod(iy,getdimincells())*getdimincells() + mod(ix,getdimincells())]);
+	}
+	InflationCell& inflationat(int ix, int iy)
+	{	assert(cellonmap(ix,iy));
+		return(m_inflation[mod(iy,getdimincells())*getdimincells() + mod(ix,getdimincells())]);
+	}
+	void rebuildinflation();												// recompute entire layer from the map
+	void addinflation(int ix, int iy, int delta);						// add delta around NOGO cell at (ix,iy)
+	void addinflationinrect(int ix, int iy, int delta, int ixmin, int ixmax, int iymin, int iymax);
+	void scrollinflationx(int ix, int iymin, int iymax);				// column scrolled on
+	void scrollinflationy(int ixmin, int ixmax, int iy);				// row scrolled on
+	const SummaryTile& summarytile(int level, int tx, int ty) const			// tile (tx,ty) of level, unchecked
+	{	const int dim = m_summarydim[level];
+		return(m_summary[level][mod(ty,dim)*dim + mod(tx,dim)]);
+	}
+	SummaryTile& summarytile(int level, int tx, int ty)
+	{	const int dim = m_summarydim[level];
+		return(m_summary[level][mod(ty,dim)*dim + mod(tx,dim)]);
+	}
+	void rebuildsummary();													// recompute all levels from the map
+	void recomputesummary(int level, int txmin, int txmax, int tymin, int tymax);	// recompute block of tiles
+	void scrollsummary(int ixmin, int ixmax, int iymin, int iymax, int dx, int dy);	// cells scrolled on, replacing cells (dx,dy) away
+	void rebuildplanes();																	// recompute all planes from the map
+	void scrollplanes(int ixmin, int ixmax, int iymin, int iymax);					// recompute bits for cells scrolled on
+	void rebuildroad();																					// forget the whole road layer
+	void scrollroad(int ixmin, int ixmax, int iymin, int iymax);					// cells scrolled on have not been seen
+	bool typeintiles(int level, int ixmin, int iymin, int ixmax, int iymax, CellData::CellType type) const;
+	void changedintiles(int level, uint32_t sincestamp, int ixmin, int iymin, int ixmax, int iymax, std::vector<CellRect>& out) const;
 };
 #endif // TERRAINMAP_H
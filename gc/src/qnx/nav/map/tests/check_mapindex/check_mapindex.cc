@@ -0,0 +1,257 @@
+//
+//	check_mapindex.cc  -- check the terrain map's indexes against brute force
+//
+//	Drives a map server's terrain map with random cell updates and scrolling, and
+//	each cycle checks what the summary levels, classification planes, change tracking
+//	and clearance layer answer against a plain look at the cells:
+//
+//		typeInRect			any cell of a random rectangle that bad or worse
+//		nextimpassable		first cell of a random span of a row not CLEAR
+//		changedtiles			every cell changed or scrolled on since a stamp is in a reported tile
+//		clearanceat			distance to the nearest NOGO cell on the map, up to the limit
+//
+//	Usage: check_mapindex [cycles] [seed]
+//
+//	Team Overbot
+//	October, 2026
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+#include "mapserver.h"
+#include "mutexlock.h"
+
+MapServer mapServer;
+
+const int k_updates_per_cycle = 100;										// random cell updates each cycle
+const int k_scroll_every = 5;													// cycles between scrolls
+const int k_jump_at = 120;														// cycle at which the map jumps clear of itself
+const int k_look_every = 4;													// cycles between change snapshots
+const int k_rects_per_cycle = 20;												// typeInRect queries each cycle
+const int k_spans_per_cycle = 40;												// nextimpassable queries each cycle
+const int k_clearances_per_cycle = 200;									// clearanceat queries each cycle
+const double k_clearance_tolerance = 1e-4;									// meters
+//
+//	nextrandom  -- repeatable pseudo-random number in [0,n)
+//
+static unsigned s_seed = 54321;
+static int nextrandom(int n)
+{	s_seed = s_seed*1103515245 + 12345;
+	return(int((s_seed >> 8) % unsigned(n)));
+}
+//
+//	randomupdates  -- a cluster of cell updates, some of them along the map's edge
+//
+//	Half the updates are CLEAR, from short range so they usually override, so that
+//	rows have long passable stretches and obstacles come and go.
+//
+static void randomupdates(MapServer& server, uint32_t stamp)
+{	TerrainMap& map = server.getMap();
+	const int dim = map.getdimincells();
+	const int cx = map.getminix() + nextrandom(dim);						// cluster center
+	const int cy = map.getminiy() + nextrandom(dim);
+	for (int i=0; i<k_updates_per_cycle; i++)
+	{	int ix = cx + nextrandom(80) - 40;
+		int iy = cy + nextrandom(80) - 40;
+		if (i % 10 == 0) iy = (nextrandom(2) ? map.getminiy() : map.getmaxiy());	// along the edge
+		const int kind = nextrandom(6);
+		const CellData::CellType type = kind < 3 ? CellData::CLEAR : kind < 5 ? CellData::POSSIBLE : CellData::NOGO;
+		const uint16_t range = type == CellData::CLEAR ? 1 + nextrandom(50) : 500 + nextrandom(1500);
+		server.updateCell(ix, iy, type, false, range, nextrandom(4), 0.0, stamp);	// off the map is ignored
+	}
+	if (nextrandom(4) == 0)															// now and then a cleared strip
+	{	const int iy0 = cy + nextrandom(40) - 20;
+		for (int iy = iy0; iy < iy0 + 6; iy++)
+			for (int ix = cx - 150; ix <= cx + 150; ix++)
+				server.updateCell(ix, iy, CellData::CLEAR, false, 1, 0, 0.0, stamp);
+	}
+}
+//
+//	scrollmap  -- move the map center by a few cells, or far enough that nothing is left
+//
+static void scrollmap(TerrainMap& map, bool jump)
+{	const int dim = map.getdimincells();
+	const int cx = map.getminix() + dim/2;
+	const int cy = map.getminiy() + dim/2;
+	if (jump) map.setmapcentercell(cx - dim - dim/4, cy + dim);
+	else map.setmapcentercell(cx + nextrandom(61) - 30, cy + nextrandom(61) - 30);
+}
+//
+//	checkrects  -- typeInRect on random rectangles, some partly or wholly off the map
+//
+static int checkrects(const TerrainMap& map, int cycle)
+{	const int dim = map.getdimincells();
+	int errors = 0;
+	for (int i=0; i<k_rects_per_cycle; i++)
+	{	const int ixmin = map.getminix() - 50 + nextrandom(dim + 100);
+		const int iymin = map.getminiy() - 50 + nextrandom(dim + 100);
+		const int ixmax = ixmin + nextrandom(i % 4 == 0 ? 200 : 20);
+		const int iymax = iymin + nextrandom(i % 4 == 0 ? 200 : 20);
+		for (int type = CellData::UNKNOWN; type <= CellData::NOGO; type++)
+		{	bool expected = false;
+			for (int iy = std::max(iymin, map.getminiy()); iy <= std::min(iymax, map.getmaxiy()) && !expected; iy++)
+				for (int ix = std::max(ixmin, map.getminix()); ix <= std::min(ixmax, map.getmaxix()) && !expected; ix++)
+					expected = map.at(ix,iy).gettype() >= type;
+			if (map.typeInRect(ixmin, iymin, ixmax, iymax, CellData::CellType(type)) != expected)
+			{	printf("cycle %d: typeInRect [%d..%d, %d..%d] type %d is %d, should be %d\n",
+					cycle, ixmin, ixmax, iymin, iymax, type, !expected, expected);
+				errors++;
+			}
+		}
+	}
+	return(errors);
+}
+//
+//	checkspans  -- nextimpassable on random spans of rows, including across the wraparound point
+//
+static int checkspans(const TerrainMap& map, int cycle)
+{	const int dim = map.getdimincells();
+	int errors = 0;
+	for (int i=0; i<k_spans_per_cycle; i++)
+	{	const int iy = map.getminiy() + nextrandom(dim);
+		const int ix = map.getminix() + nextrandom(dim);
+		const int ixend = ix + nextrandom(std::min(400, map.getmaxix() + 1 - ix) + 1);	// may be empty
+		int expected = ix;
+		while (expected < ixend && map.passableCell(expected, iy)) expected++;
+		const int got = map.nextimpassable(ix, ixend, iy);
+		if (got != expected)
+		{	printf("cycle %d: nextimpassable(%d, %d, %d) is %d, should be %d\n", cycle, ix, ixend, iy, got, expected);
+			errors++;
+		}
+	}
+	return(errors);
+}
+//
+//	struct ChangeSnapshot  -- the cell types as a consumer last saw them
+//
+struct ChangeSnapshot {
+	std::vector<uint8_t> m_types;												// cell types, map's wraparound layout
+	CellRect m_bounds;																// cells on the map then
+	uint32_t m_stamp;																	// cycle stamp then
+};
+//
+//	takesnapshot  -- remember the map as it is now
+//
+static void takesnapshot(const TerrainMap& map, ChangeSnapshot& snap)
+{	const int dim = map.getdimincells();
+	snap.m_types.resize(dim*dim);
+	for (int iy = map.getminiy(); iy <= map.getmaxiy(); iy++)
+		for (int ix = map.getminix(); ix <= map.getmaxix(); ix++)
+			snap.m_types[TerrainMap::mod(iy,dim)*dim + TerrainMap::mod(ix,dim)] = map.at(ix,iy).gettype();
+	snap.m_bounds.m_ixmin = map.getminix();
+	snap.m_bounds.m_ixmax = map.getmaxix();
+	snap.m_bounds.m_iymin = map.getminiy();
+	snap.m_bounds.m_iymax = map.getmaxiy();
+	snap.m_stamp = map.getcyclestamp();
+}
+//
+//	checkchanges  -- changedtiles since the snapshot covers every cell changed or new since
+//
+//	Each tile reported must be on the map and within one finest summary tile.
+//
+static int checkchanges(const TerrainMap& map, const ChangeSnapshot& snap, int cycle)
+{	const int dim = map.getdimincells();
+	const int cells = TerrainMap::summarytilecells(0);
+	std::vector<CellRect> changed;
+	map.changedtiles(snap.m_stamp, changed);
+	std::vector<uint8_t> covered(dim*dim, 0);										// cell in a reported tile, wraparound layout
+	int errors = 0;
+	for (size_t i=0; i<changed.size(); i++)
+	{	const CellRect& r = changed[i];
+		if (r.m_ixmin > r.m_ixmax || r.m_iymin > r.m_iymax
+			|| !map.cellonmap(r.m_ixmin, r.m_iymin) || !map.cellonmap(r.m_ixmax, r.m_iymax)
+			|| TerrainMap::tileof(r.m_ixmin, cells) != TerrainMap::tileof(r.m_ixmax, cells)
+			|| TerrainMap::tileof(r.m_iymin, cells) != TerrainMap::tileof(r.m_iymax, cells))
+		{	printf("cycle %d: changed tile [%d..%d, %d..%d] is not one tile on the map\n",
+				cycle, r.m_ixmin, r.m_ixmax, r.m_iymin, r.m_iymax);
+			errors++;
+			continue;
+		}
+		for (int iy = r.m_iymin; iy <= r.m_iymax; iy++)
+			for (int ix = r.m_ixmin; ix <= r.m_ixmax; ix++)
+				covered[TerrainMap::mod(iy,dim)*dim + TerrainMap::mod(ix,dim)] = 1;
+	}
+	for (int iy = map.getminiy(); iy <= map.getmaxiy(); iy++)
+	{	for (int ix = map.getminix(); ix <= map.getmaxix(); ix++)
+		{	const int n = TerrainMap::mod(iy,dim)*dim + TerrainMap::mod(ix,dim);
+			if (covered[n]) continue;
+			const bool wason = ix >= snap.m_bounds.m_ixmin && ix <= snap.m_bounds.m_ixmax
+				&& iy >= snap.m_bounds.m_iymin && iy <= snap.m_bounds.m_iymax;
+			if (!wason || snap.m_types[n] != map.at(ix,iy).gettype())
+			{	printf("cycle %d: cell [%d,%d] %s since stamp %u, but not in a changed tile\n",
+					cycle, ix, iy, wason ? "changed" : "scrolled on", snap.m_stamp);
+				errors++;
+			}
+		}
+	}
+	return(errors);
+}
+//
+//	clearancebrute  -- distance from cell to the nearest NOGO cell on the map, up to limit
+//
+static double clearancebrute(const TerrainMap& map, int ix, int iy, double limit)
+{	const int reach = int(ceil(limit*map.getcellspermeter()));
+	double best = limit*map.getcellspermeter()*limit*map.getcellspermeter();
+	for (int y = std::max(iy - reach, map.getminiy()); y <= std::min(iy + reach, map.getmaxiy()); y++)
+		for (int x = std::max(ix - reach, map.getminix()); x <= std::min(ix + reach, map.getmaxix()); x++)
+			if (map.at(x,y).gettype() == CellData::NOGO)
+				best = std::min(best, double((x-ix)*(x-ix) + (y-iy)*(y-iy)));
+	return(sqrt(best)*map.getCellDimensions());
+}
+//
+//	checkclearance  -- clearanceat on random cells, half of them near the edge
+//
+static int checkclearance(const TerrainMap& map, const ObstacleDistance& clearance, int cycle)
+{	const int dim = map.getdimincells();
+	const int edge = int(ceil(k_clearance_limit*map.getcellspermeter()));	// cells within the limit of the edge
+	int errors = 0;
+	for (int i=0; i<k_clearances_per_cycle; i++)
+	{	int ix = map.getminix() + nextrandom(dim);
+		int iy = map.getminiy() + nextrandom(dim);
+		if (i % 2) ix = (nextrandom(2) ? map.getminix() + nextrandom(edge) : map.getmaxix() - nextrandom(edge));
+		const double expected = clearancebrute(map, ix, iy, k_clearance_limit);
+		const double got = clearance.clearanceat(map, ix, iy);
+		if (fabs(got - expected) > k_clearance_tolerance)
+		{	printf("cycle %d: clearance at [%d,%d] is %.4f, should be %.4f\n", cycle, ix, iy, got, expected);
+			errors++;
+		}
+	}
+	return(errors);
+}
+
+int main(int argc, char* argv[])
+{
+	int cycles = 200;
+	if (argc > 1) cycles = atoi(argv[1]);
+	if (argc > 2) s_seed = unsigned(atoi(argv[2]));
+	TerrainMap& map = mapServer.getMap();
+	ObstacleDistance& clearance = mapServer.getClearance();
+	ChangeSnapshot snap;
+	takesnapshot(map, snap);
+	int errors = 0;
+	int updated = 0;
+	for (int cycle = 0; cycle < cycles; cycle++)
+	{	const uint32_t stamp = map.incrementcyclestamp();
+		if (cycle == k_jump_at) scrollmap(map, true);
+		else if (cycle > 0 && cycle % k_scroll_every == 0) scrollmap(map, false);
+		randomupdates(mapServer, stamp);
+		ost::MutexLock lok(mapServer.getMapLock());							// as the steering thread would
+		clearance.update(map);
+		updated += clearance.getupdated();
+		errors += checkrects(map, cycle);
+		errors += checkspans(map, cycle);
+		errors += checkchanges(map, snap, cycle);
+		errors += checkclearance(map, clearance, cycle);
+		if (cycle % k_look_every == 0) takesnapshot(map, snap);			// a consumer which looks now and then
+		if (errors > 20) break;															// enough to go on
+	}
+	printf("%d cycles, %.0f clearance cells recomputed per cycle\n", cycles, double(updated)/cycles);
+	if (errors)
+	{	printf("FAILED: %d mismatches\n", errors);
+		return(1);
+	}
+	printf("OK\n");
+	return(0);
+}
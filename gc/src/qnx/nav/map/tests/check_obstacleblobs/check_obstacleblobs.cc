@@ -0,0 +1,188 @@
+//
+//	check_obstacleblobs.cc  -- check the obstacle blob labeling against a flood fill
+//
+//	Drives a map server's terrain map with random cell updates and scrolling, brings
+//	the obstacle blobs up to date each cycle, and compares them with a plain flood fill
+//	of the 8-connected NOGO cells of the whole map: the same partition of the cells,
+//	and for each blob the same cell count, bounds, and centroid.
+//
+//	Usage: check_obstacleblobs [cycles] [seed]
+//
+//	Team Overbot
+//	October, 2026
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+#include "mapserver.h"
+#include "mutexlock.h"
+
+MapServer mapServer;
+
+const int k_updates_per_cycle = 60;										// random cell updates each cycle
+const int k_scroll_every = 7;													// cycles between scrolls
+const int k_jump_at = 150;														// cycle at which the map jumps clear of itself
+const double k_centroid_tolerance = 0.01;									// meters
+//
+//	nextrandom  -- repeatable pseudo-random number in [0,n)
+//
+static unsigned s_seed = 12345;
+static int nextrandom(int n)
+{	s_seed = s_seed*1103515245 + 12345;
+	return(int((s_seed >> 8) % unsigned(n)));
+}
+//
+//	randomupdates  -- a cluster of cell updates, some of them along the map's edge
+//
+//	Blocked updates come from long range and cleared ones from short range, so
+//	that clears are usually accepted and blobs split as well as merge.
+//
+static void randomupdates(MapServer& server, uint32_t stamp)
+{	TerrainMap& map = server.getMap();
+	const int dim = map.getdimincells();
+	const int cx = map.getminix() + nextrandom(dim);						// cluster center
+	const int cy = map.getminiy() + nextrandom(dim);
+	for (int i=0; i<k_updates_per_cycle; i++)
+	{	int ix = cx + nextrandom(40) - 20;
+		int iy = cy + nextrandom(40) - 20;
+		if (i % 10 == 0) ix = (nextrandom(2) ? map.getminix() : map.getmaxix());	// along the edge
+		const int kind = nextrandom(3);
+		const CellData::CellType type = kind == 0 ? CellData::CLEAR : kind == 1 ? CellData::POSSIBLE : CellData::NOGO;
+		const uint16_t range = type == CellData::CLEAR ? 1 + nextrandom(50) : 500 + nextrandom(1500);
+		server.updateCell(ix, iy, type, false, range, 0, 0.0, stamp);	// off the map is ignored
+	}
+	if (nextrandom(10) == 0)															// now and then a long wall
+	{	const int iy = cy + nextrandom(40) - 20;
+		for (int ix = cx - 60; ix <= cx + 60; ix++)
+			server.updateCell(ix, iy, CellData::NOGO, false, 500, 0, 0.0, stamp);
+	}
+}
+//
+//	scrollmap  -- move the map center by a few cells, or far enough that nothing is left
+//
+static void scrollmap(TerrainMap& map, bool jump)
+{	const int dim = map.getdimincells();
+	const int cx = map.getminix() + dim/2;
+	const int cy = map.getminiy() + dim/2;
+	if (jump) map.setmapcentercell(cx + dim + dim/3, cy - dim);
+	else map.setmapcentercell(cx + nextrandom(41) - 20, cy + nextrandom(41) - 20);
+}
+//
+//	isnogo  -- NOGO cell on the map?
+//
+static bool isnogo(const TerrainMap& map, int ix, int iy)
+{	return(map.cellonmap(ix,iy) && map.at(ix,iy).gettype() == CellData::NOGO);	}
+//
+//	checkblobs  -- flood fill the whole map and compare with the labeling
+//
+//	Returns the number of mismatches found.
+//
+static int checkblobs(const TerrainMap& map, const ObstacleBlobs& blobs, int cycle)
+{	const int dim = map.getdimincells();
+	std::vector<int> seen(dim*dim, 0);												// cell filled yet, wraparound layout
+	std::vector<int> stack;																// cells to visit, as ix,iy pairs
+	size_t found = 0;
+	int errors = 0;
+	for (int iy = map.getminiy(); iy <= map.getmaxiy(); iy++)
+	{	for (int ix = map.getminix(); ix <= map.getmaxix(); ix++)
+		{	const ObstacleBlob* blob = blobs.blobat(map, ix, iy);
+			if (!isnogo(map, ix, iy))
+			{	if (blob)
+				{	printf("cycle %d: cell [%d,%d] is not NOGO but is in blob %d\n", cycle, ix, iy, blob->m_id);
+					errors++;
+				}
+				continue;
+			}
+			if (!blob)
+			{	printf("cycle %d: NOGO cell [%d,%d] is in no blob\n", cycle, ix, iy);
+				errors++;
+				continue;
+			}
+			if (seen[TerrainMap::mod(iy,dim)*dim + TerrainMap::mod(ix,dim)]) continue;
+			//	New component. Fill it, checking every cell has the same blob.
+			found++;
+			int cells = 0;
+			double sumx = 0, sumy = 0;
+			CellRect bounds = { ix, iy, ix, iy };
+			seen[TerrainMap::mod(iy,dim)*dim + TerrainMap::mod(ix,dim)] = 1;
+			stack.clear();
+			stack.push_back(ix);
+			stack.push_back(iy);
+			while (!stack.empty())
+			{	const int y = stack.back(); stack.pop_back();
+				const int x = stack.back(); stack.pop_back();
+				cells++;
+				sumx += x;
+				sumy += y;
+				bounds.m_ixmin = std::min(bounds.m_ixmin, x);
+				bounds.m_ixmax = std::max(bounds.m_ixmax, x);
+				bounds.m_iymin = std::min(bounds.m_iymin, y);
+				bounds.m_iymax = std::max(bounds.m_iymax, y);
+				if (blobs.blobat(map, x, y) != blob)
+				{	printf("cycle %d: cell [%d,%d] of blob %d is labeled otherwise\n", cycle, x, y, blob->m_id);
+					errors++;
+				}
+				for (int dy = -1; dy <= 1; dy++)
+				{	for (int dx = -1; dx <= 1; dx++)
+					{	if (!isnogo(map, x+dx, y+dy)) continue;
+						int& s = seen[TerrainMap::mod(y+dy,dim)*dim + TerrainMap::mod(x+dx,dim)];
+						if (s) continue;
+						s = 1;
+						stack.push_back(x+dx);
+						stack.push_back(y+dy);
+					}
+				}
+			}
+			const double centerx = sumx/cells*map.getCellDimensions();		// cell n is centered at n*celldim
+			const double centery = sumy/cells*map.getCellDimensions();
+			if (cells != blob->m_cells
+				|| bounds.m_ixmin != blob->m_bounds.m_ixmin || bounds.m_ixmax != blob->m_bounds.m_ixmax
+				|| bounds.m_iymin != blob->m_bounds.m_iymin || bounds.m_iymax != blob->m_bounds.m_iymax
+				|| fabs(centerx - blob->m_centerx) > k_centroid_tolerance
+				|| fabs(centery - blob->m_centery) > k_centroid_tolerance)
+			{	printf("cycle %d: blob %d has %d cells [%d..%d, %d..%d] at (%.2f,%.2f), flood fill found %d cells [%d..%d, %d..%d] at (%.2f,%.2f)\n",
+					cycle, blob->m_id, blob->m_cells, blob->m_bounds.m_ixmin, blob->m_bounds.m_ixmax,
+					blob->m_bounds.m_iymin, blob->m_bounds.m_iymax, blob->m_centerx, blob->m_centery,
+					cells, bounds.m_ixmin, bounds.m_ixmax, bounds.m_iymin, bounds.m_iymax, centerx, centery);
+				errors++;
+			}
+		}
+	}
+	if (found != blobs.getblobs().size())
+	{	printf("cycle %d: %d blobs, flood fill found %d\n", cycle, int(blobs.getblobs().size()), int(found));
+		errors++;
+	}
+	return(errors);
+}
+
+int main(int argc, char* argv[])
+{
+	int cycles = 300;
+	if (argc > 1) cycles = atoi(argv[1]);
+	if (argc > 2) s_seed = unsigned(atoi(argv[2]));
+	TerrainMap& map = mapServer.getMap();
+	ObstacleBlobs& blobs = mapServer.getObstacles();
+	int errors = 0;
+	int relabeled = 0;
+	for (int cycle = 0; cycle < cycles; cycle++)
+	{	const uint32_t stamp = map.incrementcyclestamp();
+		if (cycle == k_jump_at) scrollmap(map, true);
+		else if (cycle > 0 && cycle % k_scroll_every == 0) scrollmap(map, false);
+		randomupdates(mapServer, stamp);
+		ost::MutexLock lok(mapServer.getMapLock());							// as the steering thread would
+		blobs.update(map);
+		relabeled += blobs.getrelabeled();
+		errors += checkblobs(map, blobs, cycle);
+		if (errors > 20) break;															// enough to go on
+	}
+	printf("%d cycles, %d blobs at end, %.1f tiles relabeled per cycle\n",
+		cycles, int(blobs.getblobs().size()), double(relabeled)/cycles);
+	if (errors)
+	{	printf("FAILED: %d mismatches\n", errors);
+		return(1);
+	}
+	printf("OK\n");
+	return(0);
+}
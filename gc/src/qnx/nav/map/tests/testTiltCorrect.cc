@@ -12,6 +12,7 @@
 MapServer mapServer;
 vec3 scanneroffset;
 LMSmapUpdater mapUpdater(mapServer,scanneroffset);
+const int k_gazeHalfWidth = 20;                       // average range over center +-20 degrees
 void ShowUsage();
 
 class testTiltCorrect {
@@ -41,22 +42,9 @@ public:
 		if (m_lidar) fclose(m_lidar);
 	};
 	
-   float averageRange(const LidarScanLine& lp, const int startRangesIndex=69,const int endRangesIndex=110);
-
-   
    void run(void);
 };
 
-float testTiltCorrect::averageRange(const LidarScanLine& lp,int startRangesIndex,int endRangesIndex)
-{     
-    float totalRangeValue = 0;
-    for (int i=startRangesIndex; i < endRangesIndex; i++)
-      totalRangeValue += lp.m_range[i];
-      
-    return (totalRangeValue/(endRangesIndex-startRangesIndex));
-
-}
-
 void testTiltCorrect::run(void)
 {
    LidarScanLine line;
@@ -70,24 +58,23 @@ void testTiltCorrect::run(void)
 //         continue;
       
       cyclestamp++;
-      float avgRange = averageRange(line);
+      LMSpreprocessLine(line, k_gazeHalfWidth, m_tiltCorrector.nextLine());
       mat4 vehPose;
       uint32_t cStamp=cyclestamp;
-      LidarScanLine outlp;
-      bool goodAvg=true; 
-      if (m_tiltCorrector.correctTilt(line,goodAvg,avgRange,vehPose,cStamp,outlp)) {
+      LMSrangeLine* outlp;
+      if (m_tiltCorrector.correctTilt(vehPose,cStamp,outlp)) {
         cout << " cycleStamp1="<<cyclestamp;
         cout << " cycleStamp2="<< cStamp;
-        cout << " avg2="<<avgRange;
+        cout << " avg2="<<outlp->m_avgrange;
 		  timespec ts;														// as timespec
-	  	  nsec2timespec(&ts,outlp.m_header.m_timestamp);						// convert to seconds
+	  	  nsec2timespec(&ts,outlp->m_header.m_timestamp);						// convert to seconds
 		  tm localtm;
 		  localtime_r(&ts.tv_sec,&localtm);							// convert time
 		  char s[100];
 		  const char* format = "%F %T";							// yyyy-mm-dd hh:mm:ss 
 		  strftime(s,sizeof(s),format,&localtm);					// edit time
 	  	  cout << " time="<<s<<"."<<ts.tv_nsec;
-        cout << " tilt="<<outlp.m_header.m_tilt;
+        cout << " tilt="<<outlp->m_header.m_tilt;
         cout << endl;
       }
     }
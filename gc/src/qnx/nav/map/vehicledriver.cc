@@ -27,6 +27,8 @@
 //	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 //
 #include <exception>
+#include <errno.h>
+#include <string.h>
 #include "vehicledriver.h"
 #include "mapserver.h"
 #include "logprint.h"
@@ -52,9 +54,11 @@ const float k_invturnradius = sin(k_max_steering_angle) / k_wheelbase;				// max
 //	NOTE - duplicate from mapupdate
 const Tuneable k_nogo_cell_roughness_limit("NOGOCELLROUGHNESS",1,30,20,"Minimum roughness of no-go area, cm");
 const Tuneable k_veh_length("VEHLENGTH", 2, 4, 3, "Vehicle length, m");				// vehicle length
-const Tuneable k_veh_width("VEHLENGTH", 2, 4, 2, "Vehicle width, m");				// vehicle length
+const Tuneable k_veh_width("VEHWIDTH", 2, 4, 2, "Vehicle width, m");				// vehicle width
 const Tuneable k_steering_error_ratio("STEERINGERRORRATIO", 0.01, 1, 0.10, "Steering error, ratio");		// cross track error expected per unit move
 const Tuneable k_safe_fusednav_cep("SAFEFUSEDNAVCEP", 0.00, 3.0, 2.0, "Safe fusednav circular error, m");		// cross track error expected per unit move
+const Tuneable k_obstacle_blobs("OBSTACLEBLOBS", 0, 1, 0, "Label NOGO cells into obstacle blobs each cycle (0 or 1)");	// nothing uses them yet
+const Tuneable k_clearance_layer("CLEARANCELAYER", 0, 1, 0, "Keep distance to nearest NOGO cell each cycle (0 or 1)");	// nothing uses it yet
 //
 //	Compute timing control - maximum time that drive computation should take.
 //
@@ -63,6 +67,7 @@ const Tuneable k_safe_fusednav_cep("SAFEFUSEDNAVCEP", 0.00, 3.0, 2.0, "Safe fuse
 //	Must not exceed 100 ms minus the time required to issue a move command, which is short.
 //
 const uint64_t k_drive_step_compute_period = 70* (1000000);					// 70ms per cycle 
+const char* k_frame_log_name = "steerframes.txt";							// steering inputs, in the recording dir
 
 //
 //	Misc. support functions
@@ -97,7 +102,8 @@ VehicleDriver::VehicleDriver(MapServer& owner)	 // constructor
 	m_lastrecoverypos(0,0),										// last recovery was here
 	m_missioncompleted(false),									// mission completed
 	m_lastgpsinserrorstatus(GPSINS_MSG::INITIALIZATION),		// last error status from GPS/INS
-	m_timedloopoverruns(0)										// number of timed loop overruns
+	m_timedloopoverruns(0),										// number of timed loop overruns
+	m_framelog(0)														// not recording
 {
 	bzero(&m_lastmovereply, sizeof(m_lastmovereply));	// clear last move reply
 }
@@ -106,6 +112,42 @@ VehicleDriver::VehicleDriver(MapServer& owner)	 // constructor
 //
 VehicleDriver::~VehicleDriver()
 {
+	if (m_framelog) fclose(m_framelog);
+}
+//
+//	setVehicleModel  -- set vehicle properties in a steering controller and its map
+//
+//	Shared with the steering benchmark, so it steers the same vehicle.
+//	Map must be locked.
+//
+void VehicleDriver::setVehicleModel(ReactiveDriver& steer, TerrainMap& map)
+{
+  	steer.setVehicleTrackingError(k_steering_error_ratio);
+    steer.setVehicleProperties(k_veh_width, k_veh_length, k_invturnradius);
+    steer.buildArcFootprints(map);											// arc templates, for this vehicle and cell size
+    map.setinflationwidths(k_veh_width*0.5, k_inflation_shoulder);	// inflated-obstacle layer for this vehicle
+    steer.setTerrainRoughnessThreshold(k_nogo_cell_roughness_limit);
+}
+//
+//	frameLogName  -- name of the steering input file, within the recording dir
+//
+const char* VehicleDriver::frameLogName()
+{	return(k_frame_log_name);	}
+//
+//	setFrameLog  -- record the inputs to every steering cycle, for the steering benchmark
+//
+//	One line per cycle:
+//		frame <map cycle stamp> <x> <y> <z> <forward x> <forward y> <speed> <curvature> <pitch> <roll> <dir> <elapsed secs>
+//
+bool VehicleDriver::setFrameLog(const char* dir)
+{	char filename[512];
+	snprintf(filename, sizeof(filename), "%s/%s", dir, k_frame_log_name);
+	m_framelog = fopen(filename, "w");
+	if (!m_framelog)
+	{	logprintf("Unable to create steering frame log \"%s\": %s\n", filename, strerror(errno));
+		return(false);
+	}
+	return(true);
 }
 //
 //	initDriving -- initialize NewSteer
@@ -114,9 +156,7 @@ void VehicleDriver::initDriving()
 {
 	ost::MutexLock lok(getOwner().getMapLock());	// lock map during steering calc
 	//	Set vehicle parameters in steering level's vehicle model.
-  	m_VehicleDriver.setVehicleTrackingError(k_steering_error_ratio);
-    m_VehicleDriver.setVehicleProperties(k_veh_width, k_veh_length, k_invturnradius);
-    m_VehicleDriver.setTerrainRoughnessThreshold(k_nogo_cell_roughness_limit);
+	setVehicleModel(m_VehicleDriver, getOwner().getMap());					// vehicle properties for steering
 	m_steertimestamp = gettimenow();					// start the clock
 	m_VehicleDriver.init();										// initialize steering level
 	logprintf("Vehicle properties: %1.2fm long, %1.2fm wide, %1.3f 1/r (%1.3fm radius), %1.3f steering error ratio.\n",
@@ -154,7 +194,9 @@ void VehicleDriver::stopDriving()
 bool VehicleDriver::startDriving()
 {
 	getOwner().getMap().clearmap();						// NOTE - all map data is lost here.
+	getOwner().getSnapshot().restore();					// unless we were just restarted
 	initDriving();
+	getOwner().getSnapshot().start();						// save map periodically from now on
 	Start();
 	return(true);
 }
@@ -293,6 +335,9 @@ bool VehicleDriver::requestRunMode(bool& busy)
 		busy = true;																								// don't drive now
 		return(true);																								// will try again
 	}
+	//	driveStep will want a fresh position right after this. Ask for it now, so the
+	//	GPS/INS query is in flight while we talk to the move server.
+	requestPosition();
 	//	Start engine if necessary, and shift into gear.
 	Fault::Faultcode faultid;																					// fault id
 	//	***TEMP*** fix to get proper gear info and set it here.
@@ -303,7 +348,8 @@ bool VehicleDriver::requestRunMode(bool& busy)
 	}
 	bool good = commandMove(0, 0, 0, newgear, busy, faultid);			// command a zero move
 	if (!good)
-	{	good = handleDrivingFault(faultid);															// try to handle problem
+	{	cancelPosition();																			// fault handling may take a while, ask again after
+		good = handleDrivingFault(faultid);															// try to handle problem
 		if (!good) return(false);																				// failed
 	}
 	//	Check that sensors have initialized
@@ -433,7 +479,19 @@ bool VehicleDriver::driveStep()
 		}
 		getOwner().getLog().logWaypoints(getActiveWaypoints());						// log the waypoints
 		//	Update current info from road follower
-		map.updateroadfollowinfo();																		// bring up to date for this cycle
+		map.updateroadfollowinfo(startpos[0], startpos[1], startforward[0], startforward[1]);																		// bring up to date for this cycle
+		//	Update obstacle blobs from this cycle's map changes, if asked for
+		if (k_obstacle_blobs > 0.5)
+		{	getOwner().getObstacles().update(map);														// relabels only changed tiles
+			if (getVerboseLevel() >= 2)
+			{	logprintf("Obstacles: %d blobs, %d tiles relabeled.\n", int(getOwner().getObstacles().getblobs().size()), getOwner().getObstacles().getrelabeled());	}
+		}
+		//	Update clearance layer from this cycle's map changes, if asked for
+		if (k_clearance_layer > 0.5)
+		{	getOwner().getClearance().update(map);														// recomputes only near changed tiles
+			if (getVerboseLevel() >= 2)
+			{	logprintf("Clearance: %d cells recomputed.\n", getOwner().getClearance().getupdated());	}
+		}
 		//	Update fault recovery state
 		updateDrivingFault(startpos);																	// tell fault recovery where we are
 		//	Call NewSteer to get the next steering command
@@ -444,6 +502,11 @@ bool VehicleDriver::driveStep()
 		logprintf("Calling steer: %spos (%1.2f, %1.2f) headed (%1.3f, %1.3f) at %1.1f m/s 1/r %1.5f  %1.3f secs %d wpts\n",
 			(requesteddir < 0 ? "(REVERSE) " : ""),
 			startpos[0], startpos[1], startforward[0], startforward[1], m_lastspeed, m_lastcurvature, elapsedtime, getActiveWaypoints().size());	// ***TEMP***
+		if (m_framelog)																							// if recording for the benchmark
+		{	fprintf(m_framelog, "frame %u %.17g %.17g %.17g %.17g %.17g %.9g %.9g %.9g %.9g %d %.9g\n",
+				map.getcyclestamp(), startpos[0], startpos[1], startpos[2], startforward[0], startforward[1],
+				m_lastspeed, m_lastcurvature, pitch, roll, requesteddir, elapsedtime);
+		}
 		good = m_VehicleDriver.steer(startpos, startforward, m_lastspeed, m_lastcurvature, pitch, roll, requesteddir, elapsedtime,
 			map, getActiveWaypoints(),
 			commandedmovedistance, commandedcurvature, recommendedspeed);
@@ -505,14 +568,31 @@ bool VehicleDriver::driveStep()
 	return(true);																									// completed one step
 }
 //
+//	requestPosition  -- start a query to the GPS/INS server
+//
+//	The reply is collected by the next getPosition. Meanwhile, we can talk to other servers.
+//
+void VehicleDriver::requestPosition()
+{	m_gpsinsreq.m_msgtype = GPSINSMsgReq::k_msgtype;										// set type
+	int stat = m_gpsinsClientPort.MsgSendStart(m_gpsinsreq, m_gpsinsreply);		// send, don't wait
+	if (stat < 0)																									// if trouble, getPosition will try again
+	{	logprintf("Unable to start GPSINS query: %s\n", strerror(errno));	}
+}
+//
+//	cancelPosition  -- discard the reply to a query started by requestPosition
+//
+//	Otherwise the next getPosition would take it as current, however old it was by then.
+//
+void VehicleDriver::cancelPosition()
+{	if (m_gpsinsClientPort.MsgSendPending()) m_gpsinsClientPort.MsgSendWait();	}
+//
 //	getPosition -- get position from GPS/INS server
 //
 bool VehicleDriver::getPosition(vec3& startpos, vec2& startforward, double& startspeed, double &cep, float& roll, float& pitch)
 {	
-	GPSINSMsgReq msg;																						// message to send
-	msg.m_msgtype = GPSINSMsgReq::k_msgtype;												// set type
-	GPSINSMsgRep reply;																					// the reply
-	int stat = m_gpsinsClientPort.MsgSend(msg,reply);										// request position fix
+	if (!m_gpsinsClientPort.MsgSendPending()) requestPosition();						// unless already asked for, ask now
+	int stat = m_gpsinsClientPort.MsgSendWait();												// collect position fix
+	const GPSINSMsgRep& reply = m_gpsinsreply;												// the reply
 	if (stat < 0)																									// if trouble
 	{	logprintf("Error from GPSINS server: %s\n", strerror(errno));						// failed
 		return(false);																							// fails
@@ -33,6 +33,7 @@
 
 #include "mutexlock.h"
 #include "messaging.h"
+#include "asyncmessaging.h"
 #include "timedloop.h"
 #include "dummyopensteer.h"
 #include "terrainmap.h"
@@ -56,7 +57,9 @@ class VehicleDriver: private TimedLoop {
 private:
 	MapServer& m_owner;																	// the owner
     MsgClientPort 	m_moveClientPort;												// client port for sending out move commands
-    MsgClientPort 	m_gpsinsClientPort;												// client port for querying GPS/INS	    
+    MsgAsyncClientPort 	m_gpsinsClientPort;										// client port for querying GPS/INS, can have a query in flight
+	GPSINSMsgReq m_gpsinsreq;																// GPS/INS query, owned here while in flight
+	GPSINSMsgRep m_gpsinsreply;															// and its reply
 	ReactiveDriver	m_VehicleDriver;													// driving level
 	double			m_steertimestamp;													// last steering cycle start
 	float	m_lastspeed;																		// vehicle speed, last control cyccle
@@ -73,6 +76,7 @@ private:
 	//	GPS/Map resynchronization
 	GPSINS_MSG::Err m_lastgpsinserrorstatus;									// last error status from GPS/INS
 	uint64_t m_timedloopoverruns;														// tally times that timed loop overran
+	FILE*	m_framelog;																		// steering inputs, for the benchmark, if recording
 public:																								// called from OUTSIDE the thread
     VehicleDriver(MapServer& owner);												// constructor
     virtual ~VehicleDriver();																// destructor
@@ -82,6 +86,9 @@ public:																								// called from OUTSIDE the thread
     void getStatus(MapServerMsg::MsgMapQueryReply& status);		// return current move status
     float getCurvature();																		// get turning curvature (LIDAR needs this)
     void setVerboseLevel(int lev);														// set verbosity level
+    bool setFrameLog(const char* dir);												// record steering inputs into dir
+    static void setVehicleModel(ReactiveDriver& steer, TerrainMap& map);	// vehicle properties, for a steering controller
+    static const char* frameLogName();												// name of steering input file in dir
 private:																								// called from WITHIN the thread
 	void code();																					// the timed loop
 	bool driveStep();																			// one driving cycle
@@ -91,6 +98,8 @@ private:																								// called from WITHIN the thread
     int		getVerboseLevel();																// if verbose mode
 	bool requestRunMode(bool& busy);												// request to go to run mode
 	void initDriving();																			// initialize steering level
+	void requestPosition();																// start a GPS/INS query, collected by getPosition
+	void cancelPosition();																// discard a query started by requestPosition
 	bool 	getPosition(vec3& startpos, vec2& startforward, double& startspeed, double &cep, float& roll, float& pitch);		// get current vehicle situation
 	bool updateMoveStatus();															// update status by querying move server
 	void updateBlindSpot(const vec3& pos, const vec2& forward, bool fullfill);	// update "blind spot" under vehicle at startup
@@ -12,62 +12,226 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <strings.h>
+#include <string.h>
 #include <errno.h>
+#include <vector>
+#include <algorithm>
 #include <sys/iofunc.h>
 #include <sys/dispatch.h>
 #include <logprint.h>
 #include "messaging.h"
 #include "remotemessaging.h"
 #include "timeutil.h"
+#include "mutexlock.h"
+#include "threadobject.h"
 //
 //	Configuration constants
 //
 const size_t k_max_messsage_length = 640*480*3+100;	// longest allowed message
 const size_t k_max_reply_length =  k_max_messsage_length;	// longest allowed reply
 const double k_timeout = 1.0;								// once a second, cycle
+const size_t k_header_length = 4096;						// received directly; also the "small message" limit
+const int k_small_workers = 3;								// threads relaying small messages
+const int k_large_workers = 2;								// threads relaying large messages
+const unsigned int k_max_pending = 32;					// requests received but not yet replied to
 //
+//	Relaying
 //
-//	Incoming message, which may be a pulse we have to interpret.
-//	
-union  MsgData {
-    _pulse m_pulse;												// if it's a pulse
-   	char m_servermsg[k_max_messsage_length];	// if it's a message
+//	The receive thread takes in only the first k_header_length bytes of each message,
+//	then queues it. Small messages and large ones (such as camera frames) have separate
+//	queues and separate worker threads, so a big transfer never holds up a small
+//	control message behind it.
+//
+//	A worker reads any remainder of the message straight from the client into its own
+//	buffer, and sends header and remainder to the destination as two parts of one message.
+//	The reply goes into a buffer sized for what the client can accept, and goes back
+//	to the client from there. Nothing is copied through fixed-size staging buffers.
+//
+//	Each worker has its own connection to the destination, so sends don't serialize.
+//
+struct RelayRequest {
+	int m_rcvid;																	// client to reply to
+	size_t m_msglen;																// full length of client's message
+	size_t m_replylen;															// size of client's reply buffer
+	size_t m_headerlen;															// bytes in m_header
+	union {
+		_pulse m_pulse;															// if it's a pulse
+		char m_header[k_header_length];									// start of message
+	};
 };
-static char reply[k_max_reply_length];									// reply buffer
-static MsgData msg;																// dummy message
-
-
+typedef ost::BoundedBuffer<RelayRequest*, k_max_pending> RelayQueue;
+//
+//	class RelayWorker  -- one relay thread, with its own connection and buffers
+//
+template<class DEST> class RelayWorker: public ost::Pthread
+{
+private:
+	DEST* m_dest;																	// connection to destination
+	RelayQueue& m_work;															// queue we serve
+	RelayQueue& m_free;															// where finished requests go
+	std::vector<char> m_payload;												// rest of message, past header
+	std::vector<char> m_reply;													// reply from destination
+public:
+	RelayWorker(DEST* dest, RelayQueue& work, RelayQueue& free)
+	: m_dest(dest), m_work(work), m_free(free) {}
+	virtual ~RelayWorker() { delete m_dest; }
+protected:
+	void run();
+private:
+	void relay(RelayRequest& req);
+};
+//
+//	run  -- worker thread
+//
+template<class DEST> void RelayWorker<DEST>::run()
+{	for (;;)
+	{	RelayRequest* req;
+		m_work.get(req);																// wait for work
+		relay(*req);																	// forward it
+		m_free.put(req);																// recycle
+	}
+}
 //	
-//	handledatamsg  -- handle a test message
+//	relay  -- forward one message and its reply
 //
-static void handledatamsg(MsgClientPort& dest, int rcvid, const char* msg, size_t len)
-{	
-	int cnt = dest.MsgSend(msg, len, reply, sizeof(reply));// send to local server
+template<class DEST> void RelayWorker<DEST>::relay(RelayRequest& req)
+{	iov_t siov[2];																	// header, then remainder
+	int sparts = 1;
+	SETIOV(&siov[0], req.m_header, req.m_headerlen);
+	if (req.m_msglen > req.m_headerlen)									// need the rest of the message
+	{	const size_t rest = req.m_msglen - req.m_headerlen;
+		if (m_payload.size() < rest) m_payload.resize(rest);			// grows to largest message seen
+		int cnt = MsgRead(req.m_rcvid, &m_payload[0], rest, req.m_headerlen);	// straight from the client
+		if (cnt < 0)
+		{	perror("Remote msg read failed"); fflush(stderr);
+			MsgError(req.m_rcvid, errno);
+			return;
+		}
+		SETIOV(&siov[1], &m_payload[0], cnt);
+		sparts = 2;
+	}
+	const size_t replylen = std::min(req.m_replylen, k_max_reply_length);	// what the client can take
+	if (m_reply.size() < replylen) m_reply.resize(replylen);
+	iov_t riov;
+	SETIOV(&riov, replylen ? &m_reply[0] : 0, replylen);
+	int cnt = m_dest->MsgSendv(siov, sparts, &riov, 1);				// send to local server
 	if (cnt < 0)																	// if local failure
 	{	perror("Remote msg pass failed"); fflush(stderr);		// report
-		MsgError(rcvid,errno);												// return error code to remote
+		MsgError(req.m_rcvid,errno);										// return error code to remote
 		return;
 	}
 	if (cnt > int(k_max_reply_length))									// if oversize message
 	{	printf("Remote msg of %d bytes is too big.  Limit is %d.\n", cnt, k_max_reply_length); fflush(stdout); 
-		MsgError(rcvid, ENOMEM);										// return too big error
+		MsgError(req.m_rcvid, ENOMEM);									// return too big error
 		return;
 	}
 	//	Send reply. 
-	//	We can't actually tell how long the reply is, but we assume it is the value of "cnt", which is conventional
-	int stat = MsgReply(rcvid, cnt, reply, cnt);									// success, send reply
+	//	We can't actually tell how long the reply is, but we assume it is the value of "cnt", which is conventional.
+	//	Reply will be truncated to size of client's receive buffer.
+	int stat = MsgReply(req.m_rcvid, cnt, replylen ? &m_reply[0] : 0, std::min(size_t(cnt), replylen));
 	if (stat < 0)																	// if local failure
 	{	perror("Remote msg reply failed"); fflush(stderr);	}	// report
 }
 //
-//	The test server -- runs as a separate thread.
+//	Connections to destinations, one per worker
+//
+static MsgClientPort* newdest(MsgClientPort*, const char* node, const char* name)
+{	return(new MsgClientPort(name, k_timeout));	}
+static RemoteMsgClientPort* newdest(RemoteMsgClientPort*, const char* node, const char* name)
+{	return(new RemoteMsgClientPort(node, name, 0.0));	}
+//
+//	class Relay  -- the request pool, queues, and workers
+//
+template<class DEST> class Relay
+{
+private:
+	RelayRequest m_requests[k_max_pending];								// the request pool
+	RelayQueue m_free;															// unused requests
+	RelayQueue m_small;															// small messages waiting
+	RelayQueue m_large;															// large messages waiting
+	std::vector<RelayWorker<DEST>*> m_workers;
+public:
+	Relay(const char* node, const char* name);
+	RelayRequest* getrequest()													// get request to receive into (blocks)
+	{	RelayRequest* req; m_free.get(req); return(req);	}
+	void freerequest(RelayRequest* req)									// request not used
+	{	m_free.put(req);	}
+	void submit(RelayRequest* req, int rcvid, const _msg_info& info);	// queue for relay
+};
+//
+//	Constructor -- start the workers
+//
+template<class DEST> Relay<DEST>::Relay(const char* node, const char* name)
+{	for (unsigned int i=0; i<k_max_pending; i++) m_free.put(&m_requests[i]);
+	for (int i=0; i<k_small_workers + k_large_workers; i++)
+	{	RelayQueue& work = (i < k_small_workers) ? m_small : m_large;
+		RelayWorker<DEST>* worker = new RelayWorker<DEST>(newdest((DEST*)0, node, name), work, m_free);
+		int stat = worker->create();												// start thread
+		if (stat)
+		{	printf("Relay thread create failed: %s\n", strerror(stat)); exit(1);	}
+		m_workers.push_back(worker);
+	}
+}
+//
+//	submit  -- queue a received message for relay
+//
+template<class DEST> void Relay<DEST>::submit(RelayRequest* req, int rcvid, const _msg_info& info)
+{	req->m_rcvid = rcvid;
+	req->m_msglen = info.srcmsglen;											// what the client sent
+	req->m_replylen = info.dstmsglen;										// what the client can take back
+	req->m_headerlen = std::min(size_t(info.msglen), k_header_length);	// what we have so far
+	if (req->m_msglen > k_max_messsage_length)							// if oversize message
+	{	printf("Remote msg of %d bytes is too big.  Limit is %d.\n", int(req->m_msglen), k_max_messsage_length); fflush(stdout);
+		MsgError(rcvid, EMSGSIZE);
+		m_free.put(req);
+		return;
+	}
+	if (req->m_msglen > req->m_headerlen)
+	{	m_large.put(req);	}															// large, its own workers
+	else
+	{	m_small.put(req);	}															// small, never waits behind large
+}
+//
+//	handlepulse  -- handle a pulse
+//
+static void handlepulse(const _pulse& pulse)
+{
+	switch (pulse.code) {
+	case _PULSE_CODE_DISCONNECT:
+		/*
+		 * A client disconnected all its connections (called
+		 * name_close() for each name_open() of our name) or
+		 * terminated
+		 */
+		ConnectDetach(pulse.scoid);
+		break;
+		
+	case _PULSE_CODE_UNBLOCK:
+		/*
+		 * REPLY blocked client wants to unblock (was hit by
+		 * a signal or timed out).  It's up to you if you
+		 * reply now or later.
+		 */
+		break;
+		
+	default:
+		/*
+		 * A pulse sent by one of your processes or a
+		 * _PULSE_CODE_COIDDEATH or _PULSE_CODE_THREADDEATH 
+		 * from the kernel?
+		 */
+		 break;
+	}
+}
+//
+//	The test server
 //
 //	Only run for test operations.
 //
 //	Checks messages and forwards them to the real server.
 //
 static void testserver(const char* myname, const char* destname)
-{	MsgClientPort dest(destname, k_timeout);							// create a connection to the destination
+{	Relay<MsgClientPort> relay(0, destname);							// workers, each with a connection to the destination
 	name_attach_t* attach = name_attach(0,myname,0);		// create a path
 	if (!attach)
 	{	printf("Failed to name_attach to \"%s\"\n", myname);		// two copies are probably running
@@ -85,9 +249,11 @@ static void testserver(const char* myname, const char* destname)
 			}
 		}	
     	_msg_info info;													// additional message info
-        int rcvid = MsgReceive(attach->chid, &msg, sizeof(msg), &info);
+    	RelayRequest* req = relay.getrequest();					// receive into a free request
+        int rcvid = MsgReceive(attach->chid, req->m_header, sizeof(req->m_header), &info);
         if (rcvid < 0) 
         {	//	Trouble
+        	relay.freerequest(req);
         	if (errno == ETIMEDOUT)								// normal timeout
         	{	logprintf("\n");
         		lastwatchdog = now;
@@ -98,73 +264,19 @@ static void testserver(const char* myname, const char* destname)
         }
 
         if (rcvid == 0) {/* Pulse received */
-            switch (msg.m_pulse.code) {
-            case _PULSE_CODE_DISCONNECT:
-                /*
-                 * A client disconnected all its connections (called
-                 * name_close() for each name_open() of our name) or
-                 * terminated
-                 */
-                ConnectDetach(msg.m_pulse.scoid);
-                break;
-                
-            case _PULSE_CODE_UNBLOCK:
-                /*
-                 * REPLY blocked client wants to unblock (was hit by
-                 * a signal or timed out).  It's up to you if you
-                 * reply now or later.
-                 */
-                break;
-                
-            default:
-                /*
-                 * A pulse sent by one of your processes or a
-                 * _PULSE_CODE_COIDDEATH or _PULSE_CODE_THREADDEATH 
-                 * from the kernel?
-                 */
-                 break;
-            }
-            continue;
-        }
-#ifdef OBSOLETE
-        /* A QNX IO message received, reject */
-        if (msg.hdr.type >= _IO_BASE && msg.hdr.type <= _IO_MAX) {
-        	printf("QNX I/O msg type %d received.\n",msg.hdr.type);	
-            MsgError(rcvid, ENOSYS);
+            handlepulse(req->m_pulse);
+            relay.freerequest(req);
             continue;
         }
-#endif // OBSOLETE
-        /* A message (presumable ours) received, handle */
-        handledatamsg(dest, rcvid, msg.m_servermsg, info.msglen);								// do it
+        /* A message (presumable ours) received, queue it */
+        relay.submit(req, rcvid, info);
     }
 
     /* Remove the name from the space */
     name_detach(attach, 0);
 }
-//	
-//	handlereversedatamsg  -- handle a test message
-//
-static void handlereversedatamsg(RemoteMsgClientPort& dest, int rcvid, const char* msg, size_t len)
-{	
-	int cnt = dest.MsgSend(msg, len, reply, sizeof(reply));// send to local server
-	if (cnt < 0)																	// if local failure
-	{	perror("Remote msg pass failed"); fflush(stderr);		// report
-		MsgError(rcvid,errno);												// return error code to remote
-		return;
-	}
-	if (cnt > int(k_max_reply_length))									// if oversize message
-	{	printf("Remote msg of %d bytes is too big.  Limit is %d.\n", cnt, k_max_reply_length); fflush(stdout); 
-		MsgError(rcvid, ENOMEM);										// return too big error
-		return;
-	}
-	//	Send reply.  Reply will be truncated to size of receive buffer.
-	//	We can't actually tell how long the reply is, but we assume it is the value of "cnt"
-	int stat = MsgReply(rcvid, cnt, reply, cnt);						// success, send reply
-	if (stat < 0)																	// if local failure
-	{	perror("Remote msg reply failed"); fflush(stderr);	}	// report
-}
 //
-//	The reverse test server -- runs as a separate thread.
+//	The reverse test server
 //
 //	Only run for test operations.
 //
@@ -172,7 +284,7 @@ static void handlereversedatamsg(RemoteMsgClientPort& dest, int rcvid, const cha
 //
 static void reversetestserver(const char* destnode, const char* destname)
 {	MsgServerPort serverport(0.0);										// create our server port
-	RemoteMsgClientPort dest(destnode,destname,0.0);			// create our dest port
+	Relay<RemoteMsgClientPort> relay(destnode, destname);		// workers, each with a connection to the dest
 	//
 	logprintf("Reverse remote msg server: simulating \"%s\" by connecting to \"%s\" on \"%s\"\n",getenv("ID"),destname,destnode);		// server is ready
     // create a channel, tell watchdog
@@ -193,10 +305,12 @@ static void reversetestserver(const char* destnode, const char* destname)
 			}
 		}	
     	_msg_info info;													// additional message info
-        int rcvid = serverport.MsgReceive(&msg, sizeof(msg), &info);
+    	RelayRequest* req = relay.getrequest();					// receive into a free request
+        int rcvid = serverport.MsgReceive(req->m_header, sizeof(req->m_header), &info);
 
         if (rcvid < 0) 
         {	//	Trouble
+        	relay.freerequest(req);
         	if (errno == ETIMEDOUT)								// normal timeout
         	{	logprintf("\n");
         		lastwatchdog = now;
@@ -207,44 +321,12 @@ static void reversetestserver(const char* destnode, const char* destname)
         }
 
         if (rcvid == 0) {/* Pulse received */
-            switch (msg.m_pulse.code) {
-            case _PULSE_CODE_DISCONNECT:
-                /*
-                 * A client disconnected all its connections (called
-                 * name_close() for each name_open() of our name) or
-                 * terminated
-                 */
-                ConnectDetach(msg.m_pulse.scoid);
-                break;
-                
-            case _PULSE_CODE_UNBLOCK:
-                /*
-                 * REPLY blocked client wants to unblock (was hit by
-                 * a signal or timed out).  It's up to you if you
-                 * reply now or later.
-                 */
-                break;
-                
-            default:
-                /*
-                 * A pulse sent by one of your processes or a
-                 * _PULSE_CODE_COIDDEATH or _PULSE_CODE_THREADDEATH 
-                 * from the kernel?
-                 */
-                 break;
-            }
-            continue;
-        }
-#ifdef OBSOLETE
-        /* A QNX IO message received, reject */
-        if (msg.hdr.type >= _IO_BASE && msg.hdr.type <= _IO_MAX) {
-        	printf("QNX I/O msg type %d received.\n",msg.hdr.type);	
-            MsgError(rcvid, ENOSYS);
+            handlepulse(req->m_pulse);
+            relay.freerequest(req);
             continue;
         }
-#endif // OBSOLETE
-        /* A message (presumable ours) received, handle */
-        handlereversedatamsg(dest, rcvid, msg.m_servermsg, info.msglen);								// do it
+        /* A message (presumable ours) received, queue it */
+        relay.submit(req, rcvid, info);
     }
 }
 //
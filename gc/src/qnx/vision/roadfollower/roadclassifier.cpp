@@ -0,0 +1,174 @@
+#include "roadclassifier.h"
+#include "roadtrapezoid.h"
+
+/**
+ * Classifies the pixels of the road trapezoid as road or not, by their color.
+ *
+ * The classifier keeps a 3-D color histogram of the road.  Each frame in
+ * which the caller knows of a stretch of road ahead, from the LIDAR map, it
+ * is given that stretch as a training region, and the histogram of the
+ * region's pixels is blended into the road histogram with cvAccColorHist,
+ * so older frames are forgotten exponentially rather than the histogram
+ * being recomputed from a stored history.  Every frame, the histogram is
+ * back projected over the trapezoid with cvColorBackProject, scaled so
+ * that the most road-like color is 255.  Both work on the BGR pixels in
+ * place, through lookup tables built once.
+ */
+
+// weight of each new training frame in the road histogram
+#define DEFAULT_FORGETTING 0.05
+
+/**
+ * Constructor.  The images are allocated with the first frame, when the
+ * image size is known.
+ *
+ * @param  trap  The trapezoid to classify.
+ * @param  bins  Histogram bins along each color axis.
+ */
+RoadClassifier::RoadClassifier(const RoadTrapezoid *trap, int bins) :
+    m_hist(0), m_prob(0), m_trapmask(0), m_trainmask(0), m_trap(trap), m_train_count(0), m_train_used(0),
+    m_rect(cvRect(0, 0, 0, 0)), m_trap_version(-1), m_trained(0),
+    m_alpha(DEFAULT_FORGETTING), m_score(0.0)
+{
+    int sizes[3] = {bins, bins, bins};
+    m_hist = cvCreateHist(3, sizes, CV_HIST_ARRAY);
+    cvCalcColorHistLUT(m_hist, &m_lut);
+    for (int i=0; i<4; i++) {
+        m_train[i] = cvPoint(0, 0);
+    }
+}
+
+/**
+ * Destructor.
+ */
+RoadClassifier::~RoadClassifier() {
+    cvReleaseHist(&m_hist);
+    if (m_prob) {
+        cvReleaseImage(&m_prob);
+    }
+    if (m_trapmask) {
+        cvReleaseImage(&m_trapmask);
+    }
+    if (m_trainmask) {
+        cvReleaseImage(&m_trainmask);
+    }
+}
+
+/**
+ * Set how fast the road histogram forgets.
+ *
+ * @param  alpha  Weight of each new training frame, 0-1.  The histogram
+ *                mostly reflects the last 1/alpha training frames.
+ */
+void RoadClassifier::setForgetting(double alpha) {
+    m_alpha = alpha < 0.0 ? 0.0 : alpha > 1.0 ? 1.0 : alpha;
+}
+
+/**
+ * Set the region of the next frame known to be road.  Used for the next
+ * call to processFrame only.
+ *
+ * @param  pts  Corners of a convex quadrilateral, in image coords, or null.
+ * @param  count  Number of corners, 3 or 4, or 0 for no training region.
+ */
+void RoadClassifier::setTrainingRegion(const CvPoint *pts, int count) {
+    m_train_count = 0;
+    if (!pts || count < 3 || count > 4) {
+        return;
+    }
+    for (int i=0; i<count; i++) {
+        m_train[i] = pts[i];
+    }
+    m_train_count = count;
+}
+
+/**
+ * Learn from the training region, if any, and classify the trapezoid.
+ *
+ * @param  image  The input image, 3 channel BGR.
+ */
+void RoadClassifier::processFrame(IplImage *image) {
+    if (!image || image->nChannels != 3) {
+        return;
+    }
+    CvSize size = cvGetSize(image);
+
+    // (re)allocate for this image size
+    if (!m_prob || size.width != m_prob->width || size.height != m_prob->height) {
+        if (m_prob) {
+            cvReleaseImage(&m_prob);
+            cvReleaseImage(&m_trapmask);
+            cvReleaseImage(&m_trainmask);
+        }
+        m_prob = cvCreateImage(size, IPL_DEPTH_8U, 1);
+        m_trapmask = cvCreateImage(size, IPL_DEPTH_8U, 1);
+        m_trainmask = cvCreateImage(size, IPL_DEPTH_8U, 1);
+        m_prob->origin = m_trapmask->origin = m_trainmask->origin = image->origin;
+        cvZero(m_trainmask);
+        m_trap_version = -1;
+    }
+    if (m_trap_version != m_trap->getVersion()) {
+        cvZero(m_trapmask);
+        cvFillConvexPoly(m_trapmask, (CvPoint *)m_trap->getCorners(), 4, 255);
+        cvZero(m_prob);
+        m_rect = m_trap->getBoundingRect(size);
+        m_trap_version = m_trap->getVersion();
+    }
+
+    // blend the training region into the road histogram; the first frame replaces it
+    m_train_used = 0;
+    if (m_train_count > 0) {
+        CvRect rect = RoadTrapezoid::boundingRect(m_train, m_train_count, size);
+        if (rect.width > 0 && rect.height > 0) {
+            cvSetImageROI(m_trainmask, rect);
+            cvZero(m_trainmask);
+            cvResetImageROI(m_trainmask);
+            cvFillConvexPoly(m_trainmask, m_train, m_train_count, 255);
+            cvSetImageROI(image, rect);
+            cvSetImageROI(m_trainmask, rect);
+            cvAccColorHist(image, m_hist, &m_lut, m_trained ? m_alpha : 1.0, m_trainmask);
+            cvResetImageROI(image);
+            cvResetImageROI(m_trainmask);
+            m_trained++;
+            m_train_used = m_train_count;
+        }
+    }
+    m_train_count = 0;
+
+    // back project over the trapezoid, most road-like color at 255
+    m_score = 0.0;
+    if (!m_trained || m_rect.width <= 0 || m_rect.height <= 0) {
+        return;
+    }
+    float maxval = 0;
+    cvGetMinMaxHistValue(m_hist, 0, &maxval);
+    if (maxval <= 0) {
+        return;
+    }
+    cvSetImageROI(image, m_rect);
+    cvSetImageROI(m_prob, m_rect);
+    cvSetImageROI(m_trapmask, m_rect);
+    cvColorBackProject(image, m_prob, m_hist, &m_lut, 255.0/maxval, m_trapmask);
+    m_score = cvAvg(m_prob, m_trapmask).val[0]/255.0;
+    cvResetImageROI(image);
+    cvResetImageROI(m_prob);
+    cvResetImageROI(m_trapmask);
+}
+
+/**
+ * Outline the region learned from in the last frame, in green.
+ *
+ * @param  image  The image that was classified.
+ */
+void RoadClassifier::draw(IplImage *image) const {
+    if (m_train_used == 0) {
+        return;
+    }
+    CvPoint pts[4];
+    for (int i=0; i<m_train_used; i++) {
+        pts[i] = m_train[i];
+    }
+    CvPoint *contour = pts;
+    int count = m_train_used;
+    cvPolyLine(image, &contour, &count, 1, 1, CV_RGB(0, 255, 0), 1);
+}
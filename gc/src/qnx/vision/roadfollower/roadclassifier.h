@@ -0,0 +1,39 @@
+#ifndef _ROADCLASSIFIER
+#define _ROADCLASSIFIER
+
+#include <cv.h>
+
+class RoadTrapezoid;
+
+class RoadClassifier {
+    CvHistogram *m_hist; // road color histogram over B,G,R, sums to 1 once trained
+    CvColorHistLUT m_lut; // bin of each channel value, for m_hist
+    IplImage *m_prob; // road likeness of each pixel in the trapezoid, 0-255
+    IplImage *m_trapmask; // trapezoid mask
+    IplImage *m_trainmask; // training region mask
+    const RoadTrapezoid *m_trap; // region of the image to classify
+    CvPoint m_train[4]; // training region, a convex quadrilateral
+    int m_train_count; // corners in m_train, 0 if no training region for the next frame
+    int m_train_used; // corners in m_train learned from in the last frame, 0 if none
+    CvRect m_rect; // bounding rectangle of the trapezoid, clipped to the image
+    int m_trap_version; // version of m_trap the mask was made for, -1 if none
+    int m_trained; // frames learned from so far
+    double m_alpha; // weight of each new frame in the histogram
+    double m_score; // mean road likeness inside the trapezoid, 0-1
+
+public:
+    RoadClassifier(const RoadTrapezoid *trap, int bins = 16);
+    ~RoadClassifier();
+
+    void setForgetting(double alpha);
+    void setTrainingRegion(const CvPoint *pts, int count);
+
+    void processFrame(IplImage *image);
+    int isTrained() const {return m_trained > 0;}
+    double getScore() const {return m_score;}
+    const IplImage *getProbability() const {return m_prob;}
+    const IplImage *getMask() const {return m_trapmask;}
+    void draw(IplImage *image) const;
+};
+
+#endif
@@ -0,0 +1,198 @@
+#include "roadedges.h"
+#include "roadtrapezoid.h"
+#include <math.h>
+
+/**
+ * Finds the straight edges inside the road trapezoid, and from them the
+ * left and right edges of the road.
+ *
+ * The road followers look at intensity and homogeneity profiles of the
+ * sub-sampled image, and know nothing of where the road's edges actually are.
+ * This class finds the straight edges in the full-resolution image, inside
+ * the same trapezoid the ImageSampler uses, with cvFindEdgeLines: Canny edges
+ * found only inside the trapezoid, and lines from the probabilistic Hough
+ * transform, each followed from frame to frame.  Only the rows the trapezoid
+ * covers are converted to gray.  Of the lines found in a frame, the left road
+ * edge is the one nearest the middle of the trapezoid's lower side, on the
+ * left, that leans inwards going away from the vehicle; likewise the right.
+ */
+
+// most lines followed at once
+#define MAX_EDGE_LINES 16
+
+// lines closer than this to horizontal (|cos(theta)| below it) can't be road edges
+#define MIN_EDGE_STEEPNESS 0.3
+
+/**
+ * Constructor.  The buffers are allocated with the first frame, when the
+ * image size is known.
+ *
+ * @param  trap  The trapezoid to look in.
+ */
+RoadEdges::RoadEdges(const RoadTrapezoid *trap) :
+    m_state(0), m_gray(0), m_trap(trap), m_trap_version(-1), m_left(-1), m_right(-1)
+{
+}
+
+/**
+ * Destructor.
+ */
+RoadEdges::~RoadEdges() {
+    if (m_state) {
+        cvReleaseEdgeLineState(&m_state);
+    }
+    if (m_gray) {
+        cvReleaseImage(&m_gray);
+    }
+}
+
+/**
+ * Find the edge lines in a frame.
+ *
+ * @param  image  The input image, 3 channel BGR or gray.
+ * @return  The number of lines, including lines followed from earlier
+ *          frames that were not seen in this one.
+ */
+int RoadEdges::processFrame(IplImage *image) {
+    if (!image) {
+        return 0;
+    }
+    CvSize size = cvGetSize(image);
+
+    // (re)allocate for this image size
+    if (!m_state || size.width != m_state->imgSize.width || size.height != m_state->imgSize.height) {
+        if (m_state) {
+            cvReleaseEdgeLineState(&m_state);
+        }
+        if (m_gray) {
+            cvReleaseImage(&m_gray);
+        }
+        m_state = cvCreateEdgeLineState(size, MAX_EDGE_LINES);
+        m_gray = cvCreateImage(size, IPL_DEPTH_8U, 1);
+        m_trap_version = -1;
+    }
+    if (m_trap_version != m_trap->getVersion()) {
+        cvSetEdgeLineROI(m_state, m_trap->getCorners(), 4);
+        m_trap_version = m_trap->getVersion();
+    }
+
+    // convert only the rows the trapezoid covers, and one more above and below for the gradient
+    CvRect roi = m_state->roiRect;
+    if (roi.width > 0 && roi.height > 0) {
+        int top = roi.y > 0 ? roi.y - 1 : 0;
+        int bottom = roi.y + roi.height < size.height ? roi.y + roi.height + 1 : size.height;
+        CvRect rows = cvRect(0, top, size.width, bottom - top);
+        cvSetImageROI(image, rows);
+        cvSetImageROI(m_gray, rows);
+        if (image->nChannels == 1) {
+            cvCopy(image, m_gray);
+        }
+        else {
+            cvCvtColor(image, m_gray, CV_BGR2GRAY);
+        }
+        cvResetImageROI(image);
+        cvResetImageROI(m_gray);
+    }
+
+    cvFindEdgeLines(m_state, m_gray);
+    findRoadEdges();
+    return m_state->lineCount;
+}
+
+/**
+ * x-coord where a line crosses an image row.  The line must not be horizontal.
+ */
+double RoadEdges::lineX(const CvEdgeLine *line, double y) const {
+    return (line->rho - y*sin(line->theta))/cos(line->theta);
+}
+
+/**
+ * Pick the left and right road edges among the lines seen in this frame.
+ */
+void RoadEdges::findRoadEdges() {
+    m_left = m_right = -1;
+    const CvPoint *corners = m_trap->getCorners();
+    double lower = corners[0].y; // row of the lower side of the trapezoid
+    double upper = corners[3].y; // row of the upper side
+    double center = (corners[0].x + corners[1].x)/2.0;
+    double bestleft = 0;
+    double bestright = 0;
+
+    for (int i=0; i<m_state->lineCount; i++) {
+        const CvEdgeLine *line = &m_state->lines[i];
+        if (line->missed > 0 || fabs(cos(line->theta)) < MIN_EDGE_STEEPNESS) {
+            continue;
+        }
+        double xlower = lineX(line, lower);
+        double xupper = lineX(line, upper);
+        if (xlower < center && xupper > xlower) {
+            // left edge candidate, keep the innermost
+            if (m_left < 0 || xlower > bestleft) {
+                m_left = i;
+                bestleft = xlower;
+            }
+        }
+        else if (xlower > center && xupper < xlower) {
+            // right edge candidate, keep the innermost
+            if (m_right < 0 || xlower < bestright) {
+                m_right = i;
+                bestright = xlower;
+            }
+        }
+    }
+}
+
+/**
+ * Get the number of lines, including ones not seen in the last frame.
+ */
+int RoadEdges::getLineCount() const {
+    return m_state ? m_state->lineCount : 0;
+}
+
+/**
+ * Get a line.
+ *
+ * @param  i  Index of the line, 0 .. getLineCount()-1
+ */
+const CvEdgeLine *RoadEdges::getLine(int i) const {
+    if (!m_state || i < 0 || i >= m_state->lineCount) {
+        return 0;
+    }
+    return &m_state->lines[i];
+}
+
+/**
+ * Get the left edge of the road in the last frame, or null if none was found.
+ */
+const CvEdgeLine *RoadEdges::getLeftEdge() const {
+    return getLine(m_left);
+}
+
+/**
+ * Get the right edge of the road in the last frame, or null if none was found.
+ */
+const CvEdgeLine *RoadEdges::getRightEdge() const {
+    return getLine(m_right);
+}
+
+/**
+ * Draw the lines seen in the last frame into an image, the road edges in red.
+ *
+ * @param  image  The image the lines were found in.
+ */
+void RoadEdges::draw(IplImage *image) const {
+    for (int i=0; i<getLineCount(); i++) {
+        const CvEdgeLine *line = getLine(i);
+        if (line->missed > 0) {
+            continue;
+        }
+        CvPoint pt1 = cvPoint(cvRound(line->pt1.x), cvRound(line->pt1.y));
+        CvPoint pt2 = cvPoint(cvRound(line->pt2.x), cvRound(line->pt2.y));
+        if (i == m_left || i == m_right) {
+            cvLine(image, pt1, pt2, CV_RGB(255, 0, 0), 2);
+        }
+        else {
+            cvLine(image, pt1, pt2, CV_RGB(255, 255, 0), 1);
+        }
+    }
+}
@@ -0,0 +1,33 @@
+#ifndef _ROADEDGES
+#define _ROADEDGES
+
+#include <cv.h>
+
+class RoadTrapezoid;
+
+class RoadEdges {
+    CvEdgeLineState *m_state; // lines found and tracked, and the buffers for finding them
+    IplImage *m_gray; // gray copy of the rows the trapezoid covers
+    const RoadTrapezoid *m_trap; // region of the image to look in
+    int m_trap_version; // version of m_trap the state was set up for, -1 if none
+    int m_left; // index of the left road edge among the lines, -1 if none
+    int m_right; // index of the right road edge among the lines, -1 if none
+
+    // pick the left and right road edges from the lines found this frame
+    void findRoadEdges();
+    // x-coord where a line crosses image row y
+    double lineX(const CvEdgeLine *line, double y) const;
+
+public:
+    RoadEdges(const RoadTrapezoid *trap);
+    ~RoadEdges();
+
+    int processFrame(IplImage *image);
+    int getLineCount() const;
+    const CvEdgeLine *getLine(int i) const;
+    const CvEdgeLine *getLeftEdge() const;
+    const CvEdgeLine *getRightEdge() const;
+    void draw(IplImage *image) const;
+};
+
+#endif
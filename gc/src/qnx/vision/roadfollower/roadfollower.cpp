@@ -15,6 +15,10 @@
 #include "ralphfollower.h"
 #include "offroadfollower.h"
 #include "imagesampler.h"
+#include "roadtrapezoid.h"
+#include "roadedges.h"
+#include "roadclassifier.h"
+#include "roadtexture.h"
 
 
 const int k_textcolor = CV_RGB(0,0,255);										// text in blue, for visibility
@@ -26,12 +30,16 @@ const int k_textcolor = CV_RGB(0,0,255);										// text in blue, for visibilit
 RoadFollower::RoadFollower() :
     m_display_image(0), m_angle(0.0), m_score(0.0), m_offset(0.0),
     m_threshold(0.0)
-,m_debug(0), m_display(0),m_ralph(0), m_offroad(0), m_sampler(0), m_counter(0)
+,m_debug(0), m_display(0),m_ralph(0), m_offroad(0), m_sampler(0), m_trap(0), m_edges(0), m_classifier(0), m_texture(0), m_texture_enable(0), m_counter(0)
     
 {
     m_ralph = new RALPHFollower();
     m_offroad = new OffRoadFollower();
     m_sampler = new ImageSampler();
+    m_trap = new RoadTrapezoid();
+    m_edges = new RoadEdges(m_trap);
+    m_classifier = new RoadClassifier(m_trap);
+    m_texture = new RoadTexture(m_trap);
 }
 
 /**
@@ -41,6 +49,10 @@ RoadFollower::~RoadFollower() {
     delete m_ralph;
     delete m_offroad;
     delete m_sampler;
+    delete m_edges;
+    delete m_classifier;
+    delete m_texture;
+    delete m_trap;
     if (m_display_image) {
         cvReleaseImage(&m_display_image);
     }
@@ -134,6 +146,7 @@ double RoadFollower::getOffset() {
  */
 void RoadFollower::setUpperRight(int x, int y) {
     m_sampler->setUpperRight(x, y);
+    m_trap->setUpperRight(x, y);
 }
 
 /**
@@ -145,6 +158,7 @@ void RoadFollower::setUpperRight(int x, int y) {
  */
 void RoadFollower::setUpperLeft(int x, int y) {
     m_sampler->setUpperLeft(x, y);
+    m_trap->setUpperLeft(x, y);
 }
 
 /**
@@ -156,6 +170,7 @@ void RoadFollower::setUpperLeft(int x, int y) {
  */
 void RoadFollower::setLowerRight(int x, int y) {
     m_sampler->setLowerRight(x, y);
+    m_trap->setLowerRight(x, y);
 }
 
 /**
@@ -167,6 +182,7 @@ void RoadFollower::setLowerRight(int x, int y) {
  */
 void RoadFollower::setLowerLeft(int x, int y) {
     m_sampler->setLowerLeft(x, y);
+    m_trap->setLowerLeft(x, y);
 }
 
 /**
@@ -182,6 +198,18 @@ void RoadFollower::setThreshold(double t) {
     m_threshold = t;
 }
 
+/**
+ * Turn the texture stage on or off.  Nothing uses the texture descriptors
+ * yet, so it is off by default, and costs nothing unless turned on.
+ *
+ * 0 is off (default).
+ *
+ * @param  e  Nonzero to compute the texture descriptors each frame.
+ */
+void RoadFollower::setTextureEnable(int e) {
+    m_texture_enable = e;
+}
+
 /**
  * Process a frame in the image.
  *
@@ -207,6 +235,17 @@ void RoadFollower::processFrame(IplImage* image) {
 
     // make sure we've got something
 
+    // find the straight edges in the trapezoid, before anything is drawn on the image
+    m_edges->processFrame(image1);
+
+    // classify the trapezoid's pixels by color, learning from any stretch known to be road
+    m_classifier->processFrame(image1);
+
+    // texture of patches of the trapezoid, to tell smooth road from brush
+    if (m_texture_enable) {
+        m_texture->processFrame(image1);
+    }
+
     // sample the image, perform inverse perspective mapping, and reduce image to 32x30
     m_sampler->sample(image1);
 
@@ -364,6 +403,12 @@ void RoadFollower::processFrame(IplImage* image) {
         }
         //kmeans->getColorAssignments();
 
+        // show the edge lines, with the road edges in red
+        m_edges->draw(image);
+
+        // outline the region the road colors were learned from
+        m_classifier->draw(image);
+
         // this embeds the sampled image inside the original image in the lower right corner
 
         // rescale sampled image based on dimensions of original image to insert into
@@ -6,6 +6,10 @@
 class RALPHFollower;
 class OffRoadFollower;
 class ImageSampler;
+class RoadTrapezoid;
+class RoadEdges;
+class RoadClassifier;
+class RoadTexture;
 
 class RoadFollower {
     IplImage *m_display_image; // internal image buffer for display purposes
@@ -18,6 +22,11 @@ class RoadFollower {
     RALPHFollower *m_ralph; // an instance of a class to perform the RALPH road follower
     OffRoadFollower *m_offroad; // an instance of a class to perform the OVERBOT road follower
     ImageSampler *m_sampler; // an instance of a class to perform sub-sampling
+    RoadTrapezoid *m_trap; // the trapezoid the edge, classifier and texture stages look in
+    RoadEdges *m_edges; // straight edges in the trapezoid, and the road edges among them
+    RoadClassifier *m_classifier; // road color model, and road likeness of the trapezoid's pixels
+    RoadTexture *m_texture; // co-occurrence texture of patches of the trapezoid
+    int m_texture_enable; // flag to run the texture stage
     unsigned int m_counter; // a counter for the number of frames of video processed 
 
 public:
@@ -30,12 +39,16 @@ public:
     double getScore();
     double getOffset();
     unsigned int getCounter() {return m_counter;}
+    const RoadEdges *getEdges() {return m_edges;}
+    RoadClassifier *getClassifier() {return m_classifier;}
+    const RoadTexture *getTexture() {return m_texture;}
     void setUpperRight(int x, int y);
     void setUpperLeft(int x, int y);
     void setLowerRight(int x, int y);
     void setLowerLeft(int x, int y);
     void setDisplayResults(int d);
     void setThreshold(double t);
+    void setTextureEnable(int e);
 };
 
 #endif
@@ -0,0 +1,98 @@
+//
+//	roadgrid.cpp  --  road likelihood on a ground grid ahead of the camera
+//
+//	Team Overbot
+//	October, 2026
+//
+#include <math.h>
+#include "roadgrid.h"
+#include "visualodometry.h"
+//
+//	Constants
+//
+const int k_subsamples = 4;									// each pixel is projected at 4x4 points
+const int k_cells = RoadServerMsgRDGR::k_rows*RoadServerMsgRDGR::k_cols;
+//
+//	Constructor
+//
+RoadGrid::RoadGrid(float cellsize, float nearx)
+: m_step(0), m_cellsize(cellsize), m_nearx(nearx)
+{	m_size.width = m_size.height = 0;
+}
+//
+//	isbuilt  -- is the table for images of this size?
+//
+bool RoadGrid::isbuilt(const IplImage* image) const
+{	return(image->width == m_size.width && image->height == m_size.height && image->widthStep == m_step);	}
+//
+//	build  -- find which pixels see which cell
+//
+//	Only pixels set in the mask are used. Far from the camera a pixel covers several
+//	cells front to back, so each pixel is projected at several points within it, and
+//	is listed under every cell one of those points falls in.
+//
+void RoadGrid::build(const IplImage* mask, const VisualOdometry& camera)
+{	m_size = cvGetSize(mask);
+	m_step = mask->widthStep;
+	std::vector<int> pixelcell;								// (cell, pixel offset) pairs
+	int cells[k_subsamples*k_subsamples];			// cells seen by one pixel
+	for (int y=0; y<m_size.height; y++)
+	{	const unsigned char* row = (const unsigned char*)(mask->imageData + y*mask->widthStep);
+		for (int x=0; x<m_size.width; x++)
+		{	if (!row[x]) continue;									// not in the trapezoid
+			int count = 0;
+			for (int i=0; i<k_subsamples*k_subsamples; i++)
+			{	CvPoint2D32f pt, ground;
+				pt.x = x - 0.5f + (i % k_subsamples + 0.5f)/k_subsamples;
+				pt.y = y - 0.5f + (i / k_subsamples + 0.5f)/k_subsamples;
+				if (!camera.toGroundPlane(mask, pt, ground)) continue;	// above horizon
+				const int r = int(floor((ground.x - m_nearx)/m_cellsize));
+				const int c = int(floor(ground.y/m_cellsize)) + RoadServerMsgRDGR::k_cols/2;
+				if (r < 0 || r >= RoadServerMsgRDGR::k_rows || c < 0 || c >= RoadServerMsgRDGR::k_cols) continue;
+				const int cell = r*RoadServerMsgRDGR::k_cols + c;
+				int j = 0;
+				while (j < count && cells[j] != cell) j++;
+				if (j == count) cells[count++] = cell;		// new cell for this pixel
+			}
+			for (int j=0; j<count; j++)
+			{	pixelcell.push_back(cells[j]);
+				pixelcell.push_back(y*mask->widthStep + x);
+			}
+		}
+	}
+	//	Sort into a list of pixels for each cell
+	m_cellstart.assign(k_cells+1, 0);
+	for (size_t i=0; i<pixelcell.size(); i += 2)
+	{	m_cellstart[pixelcell[i]+1]++;	}
+	for (int i=0; i<k_cells; i++)
+	{	m_cellstart[i+1] += m_cellstart[i];	}
+	m_pixels.resize(pixelcell.size()/2);
+	std::vector<int> next(m_cellstart.begin(), m_cellstart.end()-1);
+	for (size_t i=0; i<pixelcell.size(); i += 2)
+	{	m_pixels[next[pixelcell[i]]++] = pixelcell[i+1];	}
+}
+//
+//	project  -- fill in the grid of a message from a road likelihood image
+//
+//	The image must be like the mask the table was built from. Each cell is the
+//	average over its pixels, or k_nodata if no pixel sees it.
+//
+void RoadGrid::project(const IplImage* likelihood, RoadServerMsgRDGR& msg) const
+{	const unsigned char* base = (const unsigned char*)likelihood->imageData;
+	unsigned char* out = &msg.m_cells[0][0];
+	for (int cell=0; cell<k_cells; cell++)
+	{	const int start = m_cellstart.empty() ? 0 : m_cellstart[cell];
+		const int end = m_cellstart.empty() ? 0 : m_cellstart[cell+1];
+		if (end == start)											// camera doesn't see this cell
+		{	out[cell] = RoadServerMsgRDGR::k_nodata;
+			continue;
+		}
+		int sum = 0;
+		for (int i=start; i<end; i++)
+		{	sum += base[m_pixels[i]];	}
+		const int avg = (sum + (end-start)/2)/(end-start);
+		out[cell] = (avg < RoadServerMsgRDGR::k_nodata) ? avg : RoadServerMsgRDGR::k_nodata-1;
+	}
+	msg.m_cellsize = m_cellsize;
+	msg.m_nearx = m_nearx;
+}
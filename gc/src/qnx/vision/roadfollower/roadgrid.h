@@ -0,0 +1,38 @@
+//
+//	roadgrid.h  --  road likelihood on a ground grid ahead of the camera
+//
+//	The road classifier rates each pixel of the trapezoid. Each cell of a grid on the
+//	ground, in vehicle axes, takes the average rating of the pixels that see it. Which
+//	pixels see which cell depends only on the camera geometry, so it is worked out
+//	once, as a list of pixels for each cell, and each frame is one gather pass over
+//	the lists.
+//
+//	Team Overbot
+//	October, 2026
+//
+#ifndef ROADGRID_H
+#define ROADGRID_H
+
+#include <vector>
+#include "../../common/include/cv/cv.h"
+#include "roadserver.h"
+class VisualOdometry;
+//
+//	class RoadGrid  --  pixel to ground cell table, and the gather through it
+//
+class RoadGrid {
+private:
+	std::vector<int> m_cellstart;							// start of each cell's pixels in m_pixels, plus one at end
+	std::vector<int> m_pixels;								// offsets of the pixels that see each cell
+	CvSize m_size;												// image size table was built for
+	int m_step;														// row step of that image
+	float m_cellsize;												// cell size, m
+	float m_nearx;													// near edge of grid, m ahead of camera
+public:
+	RoadGrid(float cellsize, float nearx);
+	void build(const IplImage* mask, const VisualOdometry& camera);	// which pixels of mask see which cell
+	bool isbuilt(const IplImage* image) const;			// built for images like this one?
+	void project(const IplImage* likelihood, RoadServerMsgRDGR& msg) const;	// fill in grid of msg
+};
+
+#endif // ROADGRID_H
@@ -12,9 +12,14 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <time.h>
+#include <math.h>
 #include "iplimagecameraread.h"
 #include "roadserver.h"
 #include "roadfollower.h"
+#include "roadclassifier.h"
+#include "visualodometry.h"
+#include "roadgrid.h"
+#include "gpsins_messaging.h"
 #include "avformat.h"
 #include "ffmpegwrite.h"
 #include "avconvertimage.h"
@@ -52,6 +57,17 @@ const Tuneable k_ulx("ULX", 0.0, 320.0, 110.0, "x-coord of upper left corner of
 const Tuneable k_uly("ULY", 0.0, 240.0, 160.0, "y-coord of upper  left corner of trapezoid");
 const Tuneable k_urx("URX", 0.0, 320.0, 230.0, "x-coord of upper  right corner of trapezoid");
 const Tuneable k_ury("URY", 0.0, 240.0, 160.0, "y-coord of upper  right corner of trapezoid");
+const Tuneable k_voenable("VOENABLE", 0, 1, 1, "Send visual odometry to GPS/INS server (0 or 1)");
+const double k_gpsinstimeout = 0.1;						// GPS/INS server timeout, seconds
+const Tuneable k_trainnear("ROADTRAINNEAR", 1.0, 20.0, 4.0, "Learn road colors from CLEAR ground starting this far ahead (m)");
+const Tuneable k_trainfar("ROADTRAINFAR", 2.0, 40.0, 12.0, "Learn road colors from CLEAR ground out to this far ahead (m)");
+const Tuneable k_trainmin("ROADTRAINMIN", 0.5, 20.0, 2.0, "Learn road colors only from a CLEAR stretch at least this long (m)");
+const Tuneable k_trainhalfwidth("ROADTRAINHALFWIDTH", 0.2, 3.0, 0.8, "Learn road colors from this far either side of the centerline (m)");
+const Tuneable k_gridenable("ROADGRIDENABLE", 0, 1, 1, "Send road likelihood grid to map server (0 or 1)");
+const double k_maptimeout = 0.1;							// map server timeout, seconds
+const float k_gridcellsize = 0.5;							// road grid cell size, m
+const float k_gridnearx = 3.0;								// road grid starts this far ahead of camera, m
+const Tuneable k_textureenable("ROADTEXTUREENABLE", 0, 1, 0, "Compute road texture descriptors each frame (0 or 1)");
 
 //
 static bool verbose = false;									// true if verbose mode
@@ -137,15 +153,24 @@ private:
 	int m_fd;														// file descriptor of camera
 	IplImage m_cvcamimage;								// CV image from camera
 	IplImage m_cvimage;									// CV image to work on (smaller)
+	IplImage* m_grayimage;								// camera image in gray, for visual odometry
 	RoadFollower m_roadfollower;						// the road follower
+	VisualOdometry m_odometry;							// motion over the ground from frame to frame
+	MsgClientPort m_gpsinsport;						// for sending visual odometry to GPS/INS server
+	RoadGrid m_roadgrid;										// road likelihood from image to ground grid
+	MsgClientPort m_mapport;								// for sending road grid to map server
 	MPEGwrite m_imagelog;								// output image log
 	MPEGframe m_imageframe;							// output image frame
 	int m_logfps;													// logging frame rate
 	uint64_t m_nextframetime;							// don't log until this time, for log throttling
+	float m_cleardist;											// CLEAR ground ahead per map, m, for next frame
 private:
 	void setroadtrapezoid();								// set up the road trapezoid
 	int processframe();										// process a frame
 	void logframe();											// log frame if needed	
+	void updateodometry(uint64_t frametime);		// visual odometry for this frame
+	void settrainingregion();								// where the road classifier learns from, this frame
+	void sendroadgrid(uint64_t frametime);		// road likelihood on the ground, to the map server
 public:
 	int reset();
 	void serverPC(int rcvid, RoadServerMsgRDPC& msg);
@@ -162,11 +187,14 @@ private:
 //	Constructor
 //
 CameraRoadFollower::CameraRoadFollower()
-: m_fd(-1), m_nextframetime(0)
+: m_fd(-1), m_gpsinsport("GPSINS", k_gpsinstimeout),
+	m_roadgrid(k_gridcellsize, k_gridnearx), m_mapport("MAP", k_maptimeout), m_nextframetime(0), m_cleardist(0)
 {	//	Create working openCV images
 	CvSize camimgsize = {camimgwidth, camimgheight };		// simple struct
 	cvInitImageHeader(&m_cvcamimage, camimgsize, imgdepth , imgchannels, IPL_ORIGIN_BL);
 	cvCreateImageData(&m_cvcamimage);					// ***CHECK STATUS***
+	m_grayimage = cvCreateImage(camimgsize, imgdepth, 1);
+	m_grayimage->origin = IPL_ORIGIN_BL;					// same row order as camera image
 	CvSize imgsize = {imgwidth, imgheight };				// simple struct
 	cvInitImageHeader(&m_cvimage, imgsize, imgdepth , imgchannels, IPL_ORIGIN_BL);
 	cvCreateImageData(&m_cvimage);							// ***CHECK STATUS***
@@ -174,6 +202,7 @@ CameraRoadFollower::CameraRoadFollower()
 	//	Intitialize road follower
 	setroadtrapezoid();
 	m_roadfollower.setThreshold(k_threshold);					// set minimum acceptable road quality
+	m_roadfollower.setTextureEnable(k_textureenable > 0.5);	// texture stage, off unless asked for
 }
 //	
 //	Destructor
@@ -182,6 +211,7 @@ CameraRoadFollower::~CameraRoadFollower()
 {	close();
 	cvReleaseImageData(&m_cvimage);				// release it
 	cvReleaseImageData(&m_cvcamimage);			// release it
+	cvReleaseImage(&m_grayimage);
 }
 //
 //	logframe -- log a frame of video
@@ -239,17 +269,101 @@ int CameraRoadFollower::openlog(const char* logdir, const char* logformat, int l
 	return(0);
 }
 //
+//	updateodometry  -- track the ground from the last frame, and report the motion
+//
+//	Goes to the GPS/INS server as a velocity measurement. Uses the full size image,
+//	since resolution on the ground ahead sets the accuracy.
+//
+void CameraRoadFollower::updateodometry(uint64_t frametime)
+{	if (k_voenable < 0.5) return;											// turned off
+	cvCvtColor(&m_cvcamimage, m_grayimage, CV_BGR2GRAY);	// tracking works on gray
+	VisualOdometry::Motion motion;
+	if (!m_odometry.processFrame(m_grayimage, frametime, motion)) return;	// no motion this frame
+	GPSINSVisualOdometry msg;
+	msg.m_msgtype = GPSINSVisualOdometry::k_msgtype;
+	msg.timestamp = frametime;
+	msg.dt = motion.m_dt;
+	msg.forward = motion.m_forward;
+	msg.left = motion.m_left;
+	msg.yaw = motion.m_yaw*(180/M_PI);									// message is in degrees
+	msg.unc = motion.m_unc;
+	msg.points = motion.m_points;
+	if (verbose)
+	{	logprintf("Visual odometry: %1.3f m forward, %1.3f m left, %1.2f deg in %1.3f s (%d points)\n",
+			msg.forward, msg.left, msg.yaw, msg.dt, msg.points);
+	}
+	int stat = m_gpsinsport.MsgSend(msg);								// send to GPS/INS server
+	if (stat < 0 && verbose)													// not fatal; GPS/INS may not be up
+	{	perror("Unable to send visual odometry to GPS/INS server");	}
+}
+//
+//	settrainingregion  -- tell the road classifier where the road is known to be
+//
+//	The map server sends, with each road direction query, how far straight ahead the
+//	LIDAR map has the ground CLEAR across the vehicle's width. A strip of that ground
+//	along the centerline, projected into the image, is where the classifier learns
+//	road colors from. Only good for the frame after the query.
+//
+void CameraRoadFollower::settrainingregion()
+{	RoadClassifier* classifier = m_roadfollower.getClassifier();
+	const double nearx = k_trainnear;
+	const double farx = (m_cleardist < k_trainfar) ? m_cleardist : double(k_trainfar);
+	m_cleardist = 0;																// used up
+	if (farx - nearx < k_trainmin)											// not enough known road
+	{	classifier->setTrainingRegion(0, 0);
+		return;
+	}
+	const double hw = k_trainhalfwidth;
+	const CvPoint2D32f ground[4] = { cvPoint2D32f(nearx, hw), cvPoint2D32f(nearx, -hw),
+		cvPoint2D32f(farx, -hw), cvPoint2D32f(farx, hw) };			// x ahead, y left
+	CvPoint corners[4];
+	for (int i=0; i<4; i++)
+	{	CvPoint2D32f pt;
+		if (!m_odometry.toImage(&m_cvimage, ground[i], pt))			// behind camera, can't use
+		{	classifier->setTrainingRegion(0, 0);
+			return;
+		}
+		corners[i] = cvPoint(cvRound(pt.x), cvRound(pt.y));
+	}
+	classifier->setTrainingRegion(corners, 4);
+}
+//
+//	sendroadgrid  -- send the classifier's road likelihood, on the ground, to the map server
+//
+//	Which pixels see which grid cell is fixed by the camera geometry, so the table is
+//	built once, from the trapezoid mask, and each frame is one pass through it.
+//
+void CameraRoadFollower::sendroadgrid(uint64_t frametime)
+{	if (k_gridenable < 0.5) return;											// turned off
+	const RoadClassifier* classifier = m_roadfollower.getClassifier();
+	if (!classifier->isTrained()) return;									// no road colors yet
+	const IplImage* prob = classifier->getProbability();
+	if (!m_roadgrid.isbuilt(prob))												// first frame
+	{	m_roadgrid.build(classifier->getMask(), m_odometry);	}
+	RoadServerMsgRDGR msg;
+	msg.m_msgtype = RoadServerMsgRDGR::k_msgtype;
+	msg.m_timestamp = frametime;
+	m_roadgrid.project(prob, msg);
+	int stat = m_mapport.MsgSend(msg);										// send to map server
+	if (stat < 0 && verbose)													// not fatal; map may not be up
+	{	perror("Unable to send road grid to map server");	}
+}
+//
 //	processframe  -- process a frame
 //
 int CameraRoadFollower::processframe()
 {
 	int stat = readframe(m_cvcamimage);							// read a frame
 	if (stat) return(stat);														// status
+	const uint64_t frametime = gettimens();								// frame was taken about now
+	updateodometry(frametime);
 	stat = halveimage(m_cvimage,m_cvcamimage);			// halve the image size
 	if (stat) return(stat);														// fails
 	//	***MORE*** need to set road trapezoid based on roll and pitch info
 	//	Process through road follower
+	settrainingregion();													// learn road colors, if map knows road ahead
 	m_roadfollower.processFrame(&m_cvimage);				// process the frame
+	sendroadgrid(frametime);												// road likelihood to map
 	//	Log the image
 	logframe();
 	return(0);																		// success
@@ -283,6 +397,7 @@ void CameraRoadFollower::serverPC(int rcvid, RoadServerMsgRDPC& msg)
 void CameraRoadFollower::serverDR(int rcvid, RoadServerMsgRDDR& msg)
 {
 	m_roadfollower.setDisplayResults(1);							// visible debug info
+	m_cleardist = msg.m_cleardist;											// road ahead according to the map
 	int stat = processframe();												// read a frame
 	if (stat) 																		// if camera failed
 	{	MsgError(rcvid,stat);													// reply with result code only
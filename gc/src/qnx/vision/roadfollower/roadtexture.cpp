@@ -0,0 +1,171 @@
+#include "roadtexture.h"
+#include "roadtrapezoid.h"
+
+/**
+ * Describes the texture of the road trapezoid, patch by patch.
+ *
+ * Graded dirt is smooth and brush is busy, even where their colors are
+ * alike.  The trapezoid's bounding rectangle is covered with a grid of
+ * overlapping square patches, and the gray level co-occurrence matrix of
+ * each patch, for horizontally adjacent pixels, gives its contrast,
+ * homogeneity and entropy.  cvCalcGLCMPatchDescriptors keeps the
+ * co-occurrence counts up to date as the patch slides along each row of
+ * the grid, rather than counting each patch from scratch, so the whole
+ * grid costs about as much as a few patches.
+ */
+
+// gray levels the image is quantized to
+#define TEXTURE_LEVELS 16
+
+// patch size, pixels
+#define TEXTURE_PATCH 16
+
+// patch spacing, pixels; patches overlap by half
+#define TEXTURE_STEP 8
+
+/**
+ * Constructor.  The buffers are allocated with the first frame, when the
+ * image size is known.
+ *
+ * @param  trap  The trapezoid to describe.
+ */
+RoadTexture::RoadTexture(const RoadTrapezoid *trap) :
+    m_gray(0), m_mask(0), m_desc(0), m_inside(0), m_trap(trap),
+    m_rect(cvRect(0, 0, 0, 0)), m_trap_version(-1), m_entropy(0.0)
+{
+}
+
+/**
+ * Destructor.
+ */
+RoadTexture::~RoadTexture() {
+    if (m_gray) {
+        cvReleaseImage(&m_gray);
+    }
+    if (m_mask) {
+        cvReleaseImage(&m_mask);
+    }
+    if (m_desc) {
+        cvReleaseMat(&m_desc);
+    }
+    if (m_inside) {
+        cvReleaseMat(&m_inside);
+    }
+}
+
+/**
+ * Lay out the grid of patches over the trapezoid's bounding rectangle, and
+ * find which patches have their centers inside the trapezoid.
+ */
+void RoadTexture::setupGrid(CvSize size) {
+    if (m_desc) {
+        cvReleaseMat(&m_desc);
+        cvReleaseMat(&m_inside);
+    }
+    cvZero(m_mask);
+    cvFillConvexPoly(m_mask, (CvPoint *)m_trap->getCorners(), 4, 255);
+
+    m_rect = m_trap->getBoundingRect(size);
+    if (m_rect.width < TEXTURE_PATCH || m_rect.height < TEXTURE_PATCH) {
+        m_rect = cvRect(0, 0, 0, 0); // too small for even one patch
+        return;
+    }
+
+    int cols = (m_rect.width - TEXTURE_PATCH)/TEXTURE_STEP + 1;
+    int rows = (m_rect.height - TEXTURE_PATCH)/TEXTURE_STEP + 1;
+    m_desc = cvCreateMat(rows, cols, CV_32FC3);
+    m_inside = cvCreateMat(rows, cols, CV_8UC1);
+    for (int i=0; i<rows; i++) {
+        for (int j=0; j<cols; j++) {
+            CvRect r = getPatchRect(i, j);
+            int x = r.x + r.width/2;
+            int y = r.y + r.height/2;
+            CV_MAT_ELEM(*m_inside, uchar, i, j) =
+                ((uchar *)(m_mask->imageData + y*m_mask->widthStep))[x];
+        }
+    }
+}
+
+/**
+ * Find the texture of each patch of the trapezoid.
+ *
+ * @param  image  The input image, 3 channel BGR or gray.
+ */
+void RoadTexture::processFrame(IplImage *image) {
+    if (!image) {
+        return;
+    }
+    CvSize size = cvGetSize(image);
+
+    // (re)allocate for this image size
+    if (!m_gray || size.width != m_gray->width || size.height != m_gray->height) {
+        if (m_gray) {
+            cvReleaseImage(&m_gray);
+            cvReleaseImage(&m_mask);
+        }
+        m_gray = cvCreateImage(size, IPL_DEPTH_8U, 1);
+        m_mask = cvCreateImage(size, IPL_DEPTH_8U, 1);
+        m_trap_version = -1;
+    }
+    if (m_trap_version != m_trap->getVersion()) {
+        setupGrid(size);
+        m_trap_version = m_trap->getVersion();
+    }
+    m_entropy = 0.0;
+    if (!m_desc) {
+        return;
+    }
+
+    // convert only the bounding rectangle
+    cvSetImageROI(image, m_rect);
+    cvSetImageROI(m_gray, m_rect);
+    if (image->nChannels == 1) {
+        cvCopy(image, m_gray);
+    }
+    else {
+        cvCvtColor(image, m_gray, CV_BGR2GRAY);
+    }
+    cvCalcGLCMPatchDescriptors(m_gray, m_desc, TEXTURE_LEVELS,
+        cvSize(TEXTURE_PATCH, TEXTURE_PATCH), cvSize(TEXTURE_STEP, TEXTURE_STEP), 1, 0);
+    cvResetImageROI(image);
+    cvResetImageROI(m_gray);
+
+    // mean entropy of the patches in the trapezoid
+    int count = 0;
+    for (int i=0; i<m_desc->rows; i++) {
+        const float *d = (const float *)(m_desc->data.ptr + i*m_desc->step);
+        for (int j=0; j<m_desc->cols; j++) {
+            if (isInside(i, j)) {
+                m_entropy += d[3*j + CV_GLCMPATCH_ENTROPY];
+                count++;
+            }
+        }
+    }
+    if (count > 0) {
+        m_entropy /= count;
+    }
+}
+
+/**
+ * Is a patch's center inside the trapezoid?
+ *
+ * @param  row  Row of the patch in the grid.
+ * @param  col  Column of the patch in the grid.
+ */
+int RoadTexture::isInside(int row, int col) const {
+    if (!m_inside || row < 0 || row >= m_inside->rows || col < 0 || col >= m_inside->cols) {
+        return 0;
+    }
+    return CV_MAT_ELEM(*m_inside, uchar, row, col) != 0;
+}
+
+/**
+ * Get the pixels a patch covers, in image coords.
+ *
+ * @param  row  Row of the patch in the grid.
+ * @param  col  Column of the patch in the grid.
+ */
+CvRect RoadTexture::getPatchRect(int row, int col) const {
+    return cvRect(m_rect.x + col*TEXTURE_STEP, m_rect.y + row*TEXTURE_STEP,
+        TEXTURE_PATCH, TEXTURE_PATCH);
+}
@@ -0,0 +1,33 @@
+#ifndef _ROADTEXTURE
+#define _ROADTEXTURE
+
+#include <cv.h>
+#include <cvaux.h>
+
+class RoadTrapezoid;
+
+class RoadTexture {
+    IplImage *m_gray; // gray copy of the trapezoid's bounding rectangle
+    IplImage *m_mask; // trapezoid mask
+    CvMat *m_desc; // contrast, homogeneity and entropy of each patch, 32FC3
+    CvMat *m_inside; // nonzero for each patch whose center is in the trapezoid
+    const RoadTrapezoid *m_trap; // region of the image to describe
+    CvRect m_rect; // bounding rectangle of the trapezoid, clipped to the image
+    int m_trap_version; // version of m_trap the grid was laid out for, -1 if none
+    double m_entropy; // mean entropy of the patches in the trapezoid
+
+    // lay out the grid of patches over the trapezoid
+    void setupGrid(CvSize size);
+
+public:
+    RoadTexture(const RoadTrapezoid *trap);
+    ~RoadTexture();
+
+    void processFrame(IplImage *image);
+    const CvMat *getDescriptors() const {return m_desc;}
+    int isInside(int row, int col) const;
+    CvRect getPatchRect(int row, int col) const;
+    double getMeanEntropy() const {return m_entropy;}
+};
+
+#endif
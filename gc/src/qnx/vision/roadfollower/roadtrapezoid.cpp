@@ -0,0 +1,91 @@
+#include "roadtrapezoid.h"
+
+/**
+ * The trapezoid of the image the road stages look at.
+ *
+ * RoadFollower owns one, and the stages that work inside it (edges,
+ * classifier, texture) keep a pointer to it.  Each stage remembers the
+ * version it set its buffers up for, and sets them up again when the
+ * version changes.
+ */
+
+/**
+ * Constructor.
+ */
+RoadTrapezoid::RoadTrapezoid() :
+    m_version(0)
+{
+    for (int i=0; i<4; i++) {
+        m_corners[i] = cvPoint(0, 0);
+    }
+}
+
+/**
+ * Set the upper right coordinates of the trapezoid
+ * @param  x  The x coord.
+ * @param  y  The y coord.
+ */
+void RoadTrapezoid::setUpperRight(int x, int y) {
+    m_corners[2] = cvPoint(x, y);
+    m_version++;
+}
+
+/**
+ * Set the upper left coordinates of the trapezoid
+ * @param  x  The x coord.
+ * @param  y  The y coord.
+ */
+void RoadTrapezoid::setUpperLeft(int x, int y) {
+    m_corners[3] = cvPoint(x, y);
+    m_version++;
+}
+
+/**
+ * Set the lower right coordinates of the trapezoid
+ * @param  x  The x coord.
+ * @param  y  The y coord.
+ */
+void RoadTrapezoid::setLowerRight(int x, int y) {
+    m_corners[1] = cvPoint(x, y);
+    m_version++;
+}
+
+/**
+ * Set the lower left coordinates of the trapezoid
+ * @param  x  The x coord.
+ * @param  y  The y coord.
+ */
+void RoadTrapezoid::setLowerLeft(int x, int y) {
+    m_corners[0] = cvPoint(x, y);
+    m_version++;
+}
+
+/**
+ * Bounding rectangle of the trapezoid, clipped to the image.
+ */
+CvRect RoadTrapezoid::getBoundingRect(CvSize size) const {
+    return boundingRect(m_corners, 4, size);
+}
+
+/**
+ * Bounding rectangle of a polygon, clipped to the image.  Empty if the
+ * polygon is entirely outside the image.
+ */
+CvRect RoadTrapezoid::boundingRect(const CvPoint *pts, int count, CvSize size) {
+    int xmin = pts[0].x, xmax = pts[0].x;
+    int ymin = pts[0].y, ymax = pts[0].y;
+    for (int i=1; i<count; i++) {
+        xmin = pts[i].x < xmin ? pts[i].x : xmin;
+        xmax = pts[i].x > xmax ? pts[i].x : xmax;
+        ymin = pts[i].y < ymin ? pts[i].y : ymin;
+        ymax = pts[i].y > ymax ? pts[i].y : ymax;
+    }
+    xmin = xmin < 0 ? 0 : xmin;
+    ymin = ymin < 0 ? 0 : ymin;
+    xmax = xmax >= size.width ? size.width - 1 : xmax;
+    ymax = ymax >= size.height ? size.height - 1 : ymax;
+    if (xmax < xmin || ymax < ymin) {
+        return cvRect(0, 0, 0, 0);
+    }
+    return cvRect(xmin, ymin, xmax - xmin + 1, ymax - ymin + 1);
+}
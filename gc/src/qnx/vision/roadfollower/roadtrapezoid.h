@@ -0,0 +1,25 @@
+#ifndef _ROADTRAPEZOID
+#define _ROADTRAPEZOID
+
+#include <cv.h>
+
+class RoadTrapezoid {
+    CvPoint m_corners[4]; // lower left, lower right, upper right, upper left
+    int m_version; // incremented each time a corner moves
+
+public:
+    RoadTrapezoid();
+
+    void setUpperRight(int x, int y);
+    void setUpperLeft(int x, int y);
+    void setLowerRight(int x, int y);
+    void setLowerLeft(int x, int y);
+
+    const CvPoint *getCorners() const {return m_corners;}
+    int getVersion() const {return m_version;}
+    CvRect getBoundingRect(CvSize size) const;
+
+    static CvRect boundingRect(const CvPoint *pts, int count, CvSize size);
+};
+
+#endif
@@ -0,0 +1,289 @@
+//
+//	visualodometry.cpp  --  vehicle motion from the road camera
+//
+//	The ground is taken to be flat, and the camera to be level side to side.
+//	Points that don't meet that, such as corners on other vehicles, fit the
+//	motion badly and are dropped by the residual test.
+//
+//	Team Overbot
+//	October, 2026
+//
+#include <math.h>
+#include <algorithm>
+#include "visualodometry.h"
+#include "tuneable.h"
+//
+//	Tuneable parameters
+//
+const Tuneable k_camheight("VOCAMHEIGHT", 0.5, 4.0, 2.0, "Road camera height above ground (m)");
+const Tuneable k_campitch("VOCAMPITCH", 0.0, 45.0, 12.0, "Road camera tilt down from level (deg)");
+const Tuneable k_camfov("VOCAMFOV", 20.0, 120.0, 50.0, "Road camera horizontal field of view (deg)");
+const Tuneable k_maxrange("VOMAXRANGE", 3.0, 40.0, 15.0, "Track ground points out to this distance (m)");
+const Tuneable k_maxfeatures("VOMAXFEATURES", 20, 1000, 300, "Corners to track");
+const Tuneable k_minpoints("VOMINPOINTS", 5, 200, 20, "Ground points needed for a motion fit");
+//
+//	Constants
+//
+const int k_lkwindow = 7;										// half size of LK window, pixels
+const int k_lklevels = 3;										// pyramid levels above full size
+const double k_featurequality = 0.01;						// for cvGoodFeaturesToTrack
+const double k_featurespacing = 10;						// min distance between corners, pixels
+const double k_minresidual = 0.05;							// residuals below this (m) are never outliers
+const double k_minunc = 0.02;								// floor on displacement uncertainty (m)
+const double k_coldstartrange = 8.0;						// with no motion to predict from, use only points this far out (m)
+//
+//	Constructor
+//
+VisualOdometry::VisualOdometry()
+: m_lkstate(0), m_eigimage(0), m_tempimage(0), m_havemotion(false), m_prevtime(0), m_horizonrow(0)
+{	m_size.width = m_size.height = 0;
+}
+//
+//	Destructor
+//
+VisualOdometry::~VisualOdometry()
+{	if (m_lkstate) cvReleasePyrLKState(&m_lkstate);
+	cvReleaseImage(&m_eigimage);
+	cvReleaseImage(&m_tempimage);
+}
+//
+//	reset  -- forget the previous frame
+//
+//	The next frame starts a new sequence, and gives no motion.
+//
+void VisualOdometry::reset()
+{	m_prevpts.clear();
+	m_havemotion = false;
+}
+//
+//	setup  -- allocate for a frame size
+//
+int VisualOdometry::setup(CvSize size)
+{	if (m_lkstate && size.width == m_size.width && size.height == m_size.height) return(0);	// already set
+	if (m_lkstate) cvReleasePyrLKState(&m_lkstate);
+	cvReleaseImage(&m_eigimage);
+	cvReleaseImage(&m_tempimage);
+	m_size = size;
+	m_lkstate = cvCreatePyrLKState(size, cvSize(k_lkwindow, k_lkwindow), k_lklevels);
+	m_eigimage = cvCreateImage(size, IPL_DEPTH_32F, 1);
+	m_tempimage = cvCreateImage(size, IPL_DEPTH_32F, 1);
+	if (!m_lkstate || !m_eigimage || !m_tempimage) return(-1);
+	const int maxfeatures = int(k_maxfeatures);
+	m_prevpts.reserve(maxfeatures);							// no allocation once running
+	m_currpts.reserve(maxfeatures);
+	m_status.reserve(maxfeatures);
+	m_prevground.reserve(maxfeatures);
+	m_currground.reserve(maxfeatures);
+	m_resid.reserve(maxfeatures);
+	m_residsort.reserve(maxfeatures);
+	//	Find the top row that sees ground within range; features are looked for below it.
+	const double pitch = k_campitch*(M_PI/180);
+	const double focal = (size.width*0.5)/tan(k_camfov*(M_PI/360));	// focal length, pixels
+	const double h = k_camheight, r = k_maxrange;
+	const double yc = (h*cos(pitch) - r*sin(pitch))/(r*cos(pitch) + h*sin(pitch));	// ray slope at max range
+	m_horizonrow = std::max(0, std::min(size.height-1, int(ceil((size.height-1)*0.5 + focal*yc))));
+	return(0);
+}
+//
+//	toGround  -- project an image point onto the ground plane, out to tracking range
+//
+bool VisualOdometry::toGround(const IplImage* gray, const CvPoint2D32f& pt, CvPoint2D32f& ground) const
+{	return(toGroundPlane(gray, pt, ground) && ground.x <= k_maxrange);	}
+//
+//	toGroundPlane  -- project an image point onto the ground plane
+//
+//	Result is in vehicle axes relative to the point on the ground below the camera:
+//	x forward, y left, meters. False if the point is at or above the horizon. Like
+//	toImage, works for any image from the camera.
+//
+bool VisualOdometry::toGroundPlane(const IplImage* image, const CvPoint2D32f& pt, CvPoint2D32f& ground) const
+{	const double pitch = k_campitch*(M_PI/180);
+	const double focal = (image->width*0.5)/tan(k_camfov*(M_PI/360));
+	const double row = (image->origin == IPL_ORIGIN_BL) ? (image->height-1 - pt.y) : pt.y;	// top down
+	const double xc = (pt.x - (image->width-1)*0.5)/focal;	// ray, camera axes: x right, y down, z along axis
+	const double yc = (row - (image->height-1)*0.5)/focal;
+	const double down = sin(pitch) + yc*cos(pitch);				// downward part of ray
+	if (down < 0.001) return(false);										// at or above horizon
+	const double t = k_camheight/down;									// ray length to ground
+	ground.x = t*(cos(pitch) - yc*sin(pitch));
+	ground.y = -t*xc;
+	return(true);
+}
+//
+//	toImage  -- project a ground point into the image
+//
+//	The inverse of toGround. False if the point is behind the camera. Works for any
+//	image from the camera, at any scale, as only the field of view matters.
+//
+bool VisualOdometry::toImage(const IplImage* image, const CvPoint2D32f& ground, CvPoint2D32f& pt) const
+{	const double pitch = k_campitch*(M_PI/180);
+	const double focal = (image->width*0.5)/tan(k_camfov*(M_PI/360));
+	const double zc = ground.x*cos(pitch) + k_camheight*sin(pitch);	// along camera axis
+	if (zc < 0.1) return(false);
+	const double yc = k_camheight*cos(pitch) - ground.x*sin(pitch);	// down, in camera axes
+	const double row = (image->height-1)*0.5 + focal*yc/zc;
+	pt.x = (image->width-1)*0.5 - focal*ground.y/zc;
+	pt.y = (image->origin == IPL_ORIGIN_BL) ? (image->height-1 - row) : row;
+	return(true);
+}
+//
+//	predict  -- guess where the features moved, assuming the last motion continues
+//
+//	At speed, points near the vehicle move further between frames than the pyramid
+//	can find from a standing start, so the tracker starts from the guess.
+//
+void VisualOdometry::predict(const IplImage* gray)
+{	const double c = cos(m_lastmotion.m_yaw), s = sin(m_lastmotion.m_yaw);
+	for (size_t i=0; i<m_prevpts.size(); i++)
+	{	m_currpts[i] = m_prevpts[i];										// default is no motion
+		CvPoint2D32f g0, g1, pt;
+		if (!toGround(gray, m_prevpts[i], g0)) continue;
+		const double dx = g0.x - m_lastmotion.m_forward, dy = g0.y - m_lastmotion.m_left;
+		g1.x = c*dx + s*dy;														// R(-yaw)(P - d)
+		g1.y = -s*dx + c*dy;
+		if (!toImage(gray, g1, pt)) continue;
+		if (pt.x < 0 || pt.x > m_size.width-1 || pt.y < 0 || pt.y > m_size.height-1) continue;
+		m_currpts[i] = pt;
+	}
+}
+//
+//	findFeatures  -- pick corners to track, on the ground part of the frame
+//
+void VisualOdometry::findFeatures(const IplImage* gray)
+{	const int rows = m_size.height - m_horizonrow;				// rows that see ground
+	const int y0 = (gray->origin == IPL_ORIGIN_BL) ? 0 : m_horizonrow;	// first such row in memory
+	const CvRect roi = cvRect(0, y0, m_size.width, rows);
+	CvMat img, eig, temp;
+	cvGetSubRect(gray, &img, roi);
+	cvGetSubRect(m_eigimage, &eig, roi);
+	cvGetSubRect(m_tempimage, &temp, roi);
+	int count = int(k_maxfeatures);
+	m_prevpts.resize(count);
+	cvGoodFeaturesToTrack(&img, &eig, &temp, &m_prevpts[0], &count, k_featurequality, k_featurespacing);
+	m_prevpts.resize(count);
+	for (int i=0; i<count; i++) m_prevpts[i].y += y0;			// back to frame coords
+}
+//
+//	fitrigid  -- least squares rotation and translation carrying p onto q
+//
+//	q = R(phi) p + t, over the pairs with use[i] set.
+//
+static bool fitrigid(const std::vector<CvPoint2D32f>& p, const std::vector<CvPoint2D32f>& q,
+	const std::vector<char>& use, double& phi, double& tx, double& ty)
+{	double px = 0, py = 0, qx = 0, qy = 0;
+	int n = 0;
+	for (size_t i=0; i<p.size(); i++)
+	{	if (!use[i]) continue;
+		px += p[i].x; py += p[i].y; qx += q[i].x; qy += q[i].y;
+		n++;
+	}
+	if (n < 2) return(false);
+	px /= n; py /= n; qx /= n; qy /= n;								// centroids
+	double sdot = 0, scross = 0;
+	for (size_t i=0; i<p.size(); i++)
+	{	if (!use[i]) continue;
+		const double ax = p[i].x - px, ay = p[i].y - py;
+		const double bx = q[i].x - qx, by = q[i].y - qy;
+		sdot += ax*bx + ay*by;
+		scross += ax*by - ay*bx;
+	}
+	phi = atan2(scross, sdot);
+	const double c = cos(phi), s = sin(phi);
+	tx = qx - (c*px - s*py);
+	ty = qy - (s*px + c*py);
+	return(true);
+}
+//
+//	fitMotion  -- vehicle motion from ground point pairs
+//
+//	A fixed ground point seen at P, then at Q after the vehicle moves by d and turns
+//	by yaw, is at Q = R(-yaw)(P - d). So the fit Q = R(phi)P + t gives yaw = -phi,
+//	d = -R(phi)'t. The fit is done twice, the second time without points whose
+//	residual is well above the median.
+//
+bool VisualOdometry::fitMotion(Motion& motion)
+{	const size_t n = m_prevground.size();
+	if (int(n) < int(k_minpoints)) return(false);
+	m_status.assign(n, 1);													// all points in use
+	double phi, tx, ty;
+	if (!fitrigid(m_prevground, m_currground, m_status, phi, tx, ty)) return(false);
+	//	Residuals of first fit
+	double c = cos(phi), s = sin(phi);
+	m_resid.resize(n);
+	for (size_t i=0; i<n; i++)
+	{	const CvPoint2D32f& p = m_prevground[i];
+		const CvPoint2D32f& q = m_currground[i];
+		m_resid[i] = hypot(c*p.x - s*p.y + tx - q.x, s*p.x + c*p.y + ty - q.y);
+	}
+	m_residsort = m_resid;
+	std::nth_element(m_residsort.begin(), m_residsort.begin() + n/2, m_residsort.end());
+	const double limit = std::max(3.0*m_residsort[n/2], k_minresidual);
+	int inliers = 0;
+	for (size_t i=0; i<n; i++)
+	{	m_status[i] = (m_resid[i] <= limit);
+		inliers += m_status[i];
+	}
+	if (inliers < int(k_minpoints)) return(false);					// no consistent motion
+	if (!fitrigid(m_prevground, m_currground, m_status, phi, tx, ty)) return(false);
+	//	Uncertainty from the spread of the inliers about the final fit
+	c = cos(phi); s = sin(phi);
+	double sumsq = 0;
+	for (size_t i=0; i<n; i++)
+	{	if (!m_status[i]) continue;
+		const CvPoint2D32f& p = m_prevground[i];
+		const CvPoint2D32f& q = m_currground[i];
+		const double ex = c*p.x - s*p.y + tx - q.x, ey = s*p.x + c*p.y + ty - q.y;
+		sumsq += ex*ex + ey*ey;
+	}
+	motion.m_forward = -(c*tx + s*ty);
+	motion.m_left = -(-s*tx + c*ty);
+	motion.m_yaw = -phi;
+	motion.m_unc = std::max(sqrt(sumsq/inliers)/sqrt(double(inliers)), k_minunc);
+	motion.m_points = inliers;
+	return(true);
+}
+//
+//	processFrame  -- add a frame, and find the motion since the last one
+//
+//	Frame must be 8-bit, one channel, and the same size each time.
+//	The motion between the first two frames of a sequence is not reported. At speed,
+//	it comes only from the distant points, which place the ground poorly; it serves
+//	to predict where the near points go on the next frame.
+//
+bool VisualOdometry::processFrame(const IplImage* gray, uint64_t timestamp, Motion& motion)
+{	if (setup(cvGetSize(gray))) return(false);						// allocate if needed
+	cvUpdatePyrLKState(m_lkstate, gray);								// build pyramid for this frame
+	bool valid = false;
+	if (m_lkstate->frameCount >= 2 && int(m_prevpts.size()) >= int(k_minpoints))
+	{	const int count = m_prevpts.size();
+		m_currpts.resize(count);
+		m_status.resize(count);
+		if (m_havemotion) predict(gray);										// start from where they probably are
+		cvCalcOpticalFlowPyrLKState(m_lkstate, &m_prevpts[0], &m_currpts[0], count, &m_status[0], 0,
+			cvTermCriteria(CV_TERMCRIT_ITER | CV_TERMCRIT_EPS, 20, 0.03),
+			m_havemotion ? CV_LKFLOW_INITIAL_GUESSES : 0);
+		//	Ground positions of the tracked points, both frames. Survivors become next frame's features.
+		m_prevground.clear();
+		m_currground.clear();
+		int kept = 0;
+		for (int i=0; i<count; i++)
+		{	if (!m_status[i]) continue;											// lost
+			CvPoint2D32f g0, g1;
+			if (!toGround(gray, m_prevpts[i], g0) || !toGround(gray, m_currpts[i], g1)) continue;
+			if (!m_havemotion && g0.x < k_coldstartrange) continue;	// near points may have moved too far
+			m_prevground.push_back(g0);
+			m_currground.push_back(g1);
+			m_prevpts[kept++] = m_currpts[i];
+		}
+		m_prevpts.resize(kept);
+		valid = fitMotion(motion);
+		motion.m_dt = (timestamp - m_prevtime)*1e-9;
+	}
+	const bool predicted = m_havemotion;									// tracking started from a prediction
+	m_havemotion = valid;
+	if (valid) m_lastmotion = motion;
+	if (int(m_prevpts.size()) < int(k_maxfeatures)/2)				// running low on features
+	{	findFeatures(gray);	}
+	m_prevtime = timestamp;
+	return(valid && predicted);											// first motion of a sequence only seeds the prediction
+}
@@ -0,0 +1,61 @@
+//
+//	visualodometry.h  --  vehicle motion from the road camera
+//
+//	Corners on the ground ahead are tracked from frame to frame with pyramidal
+//	Lucas-Kanade, projected onto a flat ground plane using the camera height and
+//	tilt, and the rigid motion in the plane that carries the ground points of one
+//	frame onto the next is the motion of the vehicle, reversed.
+//
+//	Team Overbot
+//	October, 2026
+//
+#ifndef VISUALODOMETRY_H
+#define VISUALODOMETRY_H
+
+#include <stdint.h>
+#include <vector>
+#include "../../common/include/cv/cv.h"
+//
+//	class VisualOdometry  --  ground-plane motion from a sequence of gray frames
+//
+class VisualOdometry {
+public:
+	struct Motion {												// motion of vehicle between two frames
+		float m_dt;													// time between frames, seconds
+		float m_forward, m_left;								// displacement, m, in vehicle axes at earlier frame
+		float m_yaw;												// heading change, radians, counterclockwise
+		float m_unc;												// 1-sigma uncertainty of displacement, m
+		int m_points;												// ground points used in fit
+	};
+private:
+	CvPyrLKState* m_lkstate;								// pyramids of previous and current frame
+	IplImage* m_eigimage;									// work images for cvGoodFeaturesToTrack
+	IplImage* m_tempimage;
+	CvSize m_size;												// frame size
+	std::vector<CvPoint2D32f> m_prevpts;			// features in previous frame, image coords
+	std::vector<CvPoint2D32f> m_currpts;			// same features, tracked into current frame
+	std::vector<char> m_status;							// tracking status
+	std::vector<CvPoint2D32f> m_prevground;		// ground points, vehicle coords, previous frame
+	std::vector<CvPoint2D32f> m_currground;		// ground points, vehicle coords, current frame
+	std::vector<float> m_resid;								// fit residuals
+	std::vector<float> m_residsort;						// fit residuals, for finding the median
+	Motion m_lastmotion;										// last motion found, for predicting the next
+	bool m_havemotion;											// m_lastmotion is from the last frame pair
+	uint64_t m_prevtime;										// time of previous frame, ns
+	int m_horizonrow;											// first row (top down) that sees ground in range
+public:
+	VisualOdometry();
+	~VisualOdometry();
+	bool processFrame(const IplImage* gray, uint64_t timestamp, Motion& motion);	// true if motion valid
+	void reset();													// forget previous frame
+	bool toImage(const IplImage* image, const CvPoint2D32f& ground, CvPoint2D32f& pt) const;	// ground point, vehicle coords, to image
+	bool toGroundPlane(const IplImage* image, const CvPoint2D32f& pt, CvPoint2D32f& ground) const;	// image point to ground, any range
+private:
+	int setup(CvSize size);									// allocate for this frame size
+	void findFeatures(const IplImage* gray);			// pick new corners to track
+	bool toGround(const IplImage* gray, const CvPoint2D32f& pt, CvPoint2D32f& ground) const;
+	void predict(const IplImage* gray);					// guess where features went, from last motion
+	bool fitMotion(Motion& motion);						// fit rigid motion to ground point pairs
+};
+
+#endif // VISUALODOMETRY_H
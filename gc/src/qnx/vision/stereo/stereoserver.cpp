@@ -0,0 +1,294 @@
+//
+//	stereoserver.cpp  --  stereo vision obstacle detection, as a QNX program
+//
+//	Reads a pair of FireWire cameras, undistorts and rectifies both images with
+//	the calibration from CvCalibFilter, finds disparity with cvFindStereoCorrespondenceBM,
+//	and projects the disparity into 3D with the rectified scanline geometry of the
+//	calibration. The points are binned into small patches of ground around the
+//	vehicle, and the elevation range in each patch goes to the map server, which
+//	rates it like a LIDAR triangle.
+//
+//	The calibration file is written by CvCalibFilter::SaveCameraParams, from a
+//	chessboard calibration done at the camera resolution used here. The chessboard
+//	square size must be given in meters, since that sets the units of the 3D points.
+//
+//	Team Overbot
+//	October, 2026
+//
+#include <assert.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include <vector>
+#include "iplimagecameraread.h"
+#include "cvaux.h"
+#include "stereoserver.h"
+#include "mapservermsg.h"
+#include "messaging.h"
+#include "logprint.h"
+#include "tuneable.h"
+#include "timeutil.h"
+//
+//	Constants
+//
+const int camimgwidth = 640;								// camera image width in pixels
+const int camimgheight = 480;								// camera image height in pixels
+const int cammode = MODE_640x480_MONO;			// FireWire camera mode, 8-bit gray
+const int camframerate = FRAMERATE_7_5;			// FireWire camera framerate
+const double k_clienttimeout = 0.5;					// client timeout for sending messages
+//
+//	Tuneable parameters
+//
+const Tuneable k_disparities("STEREODISPARITIES", 16, 128, 48, "Disparities searched (pixels)");
+const Tuneable k_sadwindow("STEREOWINDOW", 5, 21, 9, "Block matching window size (pixels, odd)");
+const Tuneable k_uniqueness("STEREOUNIQUENESS", 0, 100, 15, "Best match must be this % better than others");
+const Tuneable k_texture("STEREOTEXTURE", 0, 10000, 10, "Minimum texture in matching window");
+const Tuneable k_pitch("STEREOPITCH", 0.0, 45.0, 10.0, "Camera tilt down from level (deg)");
+const Tuneable k_maxrange("STEREOMAXRANGE", 2.0, 30.0, 15.0, "Ignore stereo points beyond this range (m)");
+const Tuneable k_cellsize("STEREOCELLSIZE", 0.1, 1.0, 0.2, "Size of elevation patches (m)");
+const Tuneable k_mincount("STEREOMINPOINTS", 1, 200, 8, "Points needed in a patch to report it");
+const Tuneable k_stride("STEREOSTRIDE", 1, 8, 2, "Project every Nth disparity pixel");
+//
+static bool verbose = false;									// true if verbose mode
+//
+//	struct StereoPatch  -- points seen in one patch of ground, for one frame
+//
+struct StereoPatch {
+	float m_minz, m_maxz;									// elevation range, relative to camera
+	float m_minrange;										// closest point, m
+	int m_count;												// points in patch
+};
+//
+//	class StereoCameraPair  --  two cameras, calibrated as a pair
+//
+class StereoCameraPair {
+private:
+	IplImageCameraRead m_camera[2];				// left and right camera
+	CvCalibFilter m_calib;								// calibration, undistortion, rectification
+	IplImage* m_raw[2];									// images as read
+	IplImage* m_undist[2];								// undistorted
+	IplImage* m_rect[2];									// rectified
+	CvMat* m_disp;											// disparity, pixels
+	CvStereoBMState* m_bm;							// block matcher
+	MsgClientPort m_mapclientport;					// for sending samples to map server
+	std::vector<StereoPatch> m_patches;			// ground patches, for binning
+	int m_patchcols, m_patchrows;					// patch grid size; rows are along x (forward)
+	StereoServerMsgSTEL m_msg;						// outgoing message
+public:
+	StereoCameraPair();
+	~StereoCameraPair();
+	int open(const char* leftname, const char* rightname, const char* calibfile);
+	int processframe();										// read, match, and send one frame
+private:
+	void project(uint64_t timestamp);					// disparity to elevation samples
+	void sendpatches(uint64_t timestamp);			// send samples to map server
+	void flushmsg();											// send current message
+};
+//
+//	Constructor
+//
+StereoCameraPair::StereoCameraPair()
+: m_disp(0), m_bm(0), m_mapclientport(MAPSERVER_ID, k_clienttimeout), m_patchcols(0), m_patchrows(0)
+{	for (int i=0; i<2; i++)
+	{	m_raw[i] = m_undist[i] = m_rect[i] = 0;
+		m_camera[i].setmode(cammode, camframerate);		// set initial camera mode
+	}
+	m_msg.m_msgtype = StereoServerMsgSTEL::k_msgtype;
+	m_msg.m_samplecount = 0;
+}
+//
+//	Destructor
+//
+StereoCameraPair::~StereoCameraPair()
+{	for (int i=0; i<2; i++)
+	{	m_camera[i].close();
+		cvReleaseImage(&m_raw[i]);
+		cvReleaseImage(&m_undist[i]);
+		cvReleaseImage(&m_rect[i]);
+	}
+	cvReleaseMat(&m_disp);
+	if (m_bm) cvReleaseStereoBMState(&m_bm);
+}
+//
+//	open  -- open cameras and load calibration
+//
+int StereoCameraPair::open(const char* leftname, const char* rightname, const char* calibfile)
+{	if (!m_calib.LoadCameraParams(calibfile))
+	{	logprintf("Unable to load stereo calibration \"%s\"\n", calibfile);
+		return(EINVAL);
+	}
+	const CvStereoCamera* stereo = m_calib.GetStereoParams();
+	if (m_calib.GetCameraCount() != 2 || !stereo || !stereo->lineCoeffs)
+	{	logprintf("\"%s\" is not a stereo calibration.\n", calibfile);
+		return(EINVAL);
+	}
+	if (stereo->needSwapCameras)
+	{	logprintf("WARNING: calibration says the cameras should be swapped. Check camera order.\n");	}
+	const char* names[2] = { leftname, rightname };
+	for (int i=0; i<2; i++)
+	{	int stat = m_camera[i].open(names[i]);
+		if (stat != EOK)
+		{	logprintf("Unable to open camera \"%s\": %s\n", names[i], strerror(stat));
+			return(stat);
+		}
+		m_raw[i] = cvCreateImage(cvSize(camimgwidth, camimgheight), IPL_DEPTH_8U, 1);
+		m_undist[i] = cvCreateImage(cvSize(camimgwidth, camimgheight), IPL_DEPTH_8U, 1);
+		m_rect[i] = cvCreateImage(stereo->warpSize, IPL_DEPTH_8U, 1);
+	}
+	m_disp = cvCreateMat(stereo->warpSize.height, stereo->warpSize.width, CV_32FC1);
+	m_bm = cvCreateStereoBMState(int(k_disparities), int(k_sadwindow) | 1);	// window must be odd
+	if (!m_bm) return(ENOMEM);
+	m_bm->uniquenessRatio = int(k_uniqueness);
+	m_bm->textureThreshold = int(k_texture);
+	//	Patch grid: forward from the camera to max range, and as far to each side
+	m_patchrows = int(ceil(k_maxrange/k_cellsize));
+	m_patchcols = 2*m_patchrows;
+	m_patches.resize(m_patchrows*m_patchcols);
+	return(EOK);
+}
+//
+//	processframe  -- read a frame from each camera, and send what they saw
+//
+int StereoCameraPair::processframe()
+{	const uint64_t starttime = gettimenowns();
+	for (int i=0; i<2; i++)
+	{	int stat = m_camera[i].readframe(*m_raw[i]);		// read a frame
+		if (stat) return(stat);
+	}
+	const uint64_t timestamp = (starttime + gettimenowns())/2;	// frames were taken about now
+	m_calib.Undistort(m_raw, m_undist);						// lens distortion
+	m_calib.Rectify(m_undist, m_rect);						// epipolar lines to rows
+	cvFindStereoCorrespondenceBM(m_rect[0], m_rect[1], m_disp, m_bm);
+	project(timestamp);
+	if (verbose)
+	{	logprintf("Stereo frame %1.3f sec.\n", (gettimenowns() - starttime)*1e-9);	}
+	return(0);
+}
+//
+//	project  -- convert disparity to 3D points, and bin them into patches
+//
+//	icvCompute3DPoint takes the positions of the match along the rectified scanline,
+//	as fractions of the scanline length, and gives the point in left camera coordinates:
+//	x right, y down, z along the optical axis. That is turned into vehicle axes,
+//	x forward, y left, z up, allowing for the camera tilt.
+//
+void StereoCameraPair::project(uint64_t timestamp)
+{	const CvStereoCamera* stereo = m_calib.GetStereoParams();
+	const int width = m_disp->cols;
+	const int height = m_disp->rows;
+	const int stride = int(k_stride);
+	const double pitch = k_pitch*(M_PI/180);
+	const double cp = cos(pitch), sp = sin(pitch);
+	const double maxrange = k_maxrange;
+	const double cellsize = k_cellsize;
+	for (size_t i=0; i<m_patches.size(); i++) m_patches[i].m_count = 0;	// clear patches
+	for (int y=0; y<height; y += stride)
+	{	const float* drow = (const float*)(m_disp->data.ptr + m_disp->step*y);
+		CvStereoLineCoeff* coeffs = &stereo->lineCoeffs[y];
+		for (int x=0; x<width; x += stride)
+		{	const float d = drow[x];
+			if (d <= 0) continue;										// no match, or at infinity
+			CvPoint3D64d p;
+			if (icvCompute3DPoint(double(x)/width, double(x - d)/width, coeffs, &p) != CV_NO_ERR) continue;
+			const double range = sqrt(p.x*p.x + p.y*p.y + p.z*p.z);
+			if (p.z <= 0 || range > maxrange) continue;		// behind camera, or too far to trust
+			const double vx = p.z*cp - p.y*sp;				// camera to vehicle axes
+			const double vy = -p.x;
+			const double vz = -p.z*sp - p.y*cp;
+			const int row = int(vx/cellsize);
+			const int col = int(floor(vy/cellsize)) + m_patchcols/2;
+			if (row < 0 || row >= m_patchrows || col < 0 || col >= m_patchcols) continue;
+			StereoPatch& patch = m_patches[row*m_patchcols + col];
+			if (patch.m_count == 0)
+			{	patch.m_minz = patch.m_maxz = vz;
+				patch.m_minrange = range;
+			} else {
+				patch.m_minz = std::min(patch.m_minz, float(vz));
+				patch.m_maxz = std::max(patch.m_maxz, float(vz));
+				patch.m_minrange = std::min(patch.m_minrange, float(range));
+			}
+			patch.m_count++;
+		}
+	}
+	sendpatches(timestamp);
+}
+//
+//	sendpatches  -- send patches with enough points to the map server
+//
+void StereoCameraPair::sendpatches(uint64_t timestamp)
+{	const double cellsize = k_cellsize;
+	const int mincount = int(k_mincount);
+	m_msg.m_timestamp = timestamp;
+	m_msg.m_samplecount = 0;
+	for (int row=0; row<m_patchrows; row++)
+	{	for (int col=0; col<m_patchcols; col++)
+		{	const StereoPatch& patch = m_patches[row*m_patchcols + col];
+			if (patch.m_count < mincount) continue;			// too few points to trust
+			StereoElevSample& sample = m_msg.m_samples[m_msg.m_samplecount++];
+			sample.m_x = (row + 0.5)*cellsize;					// center of patch
+			sample.m_y = (col - m_patchcols/2 + 0.5)*cellsize;
+			sample.m_minz = patch.m_minz;
+			sample.m_maxz = patch.m_maxz;
+			sample.m_range = uint16_t(std::min(patch.m_minrange*100.0, 65535.0));
+			sample.m_count = uint16_t(std::min(patch.m_count, 65535));
+			if (m_msg.m_samplecount >= StereoServerMsgSTEL::k_maxsamples) flushmsg();	// full, send
+		}
+	}
+	flushmsg();																	// send the rest
+}
+//
+//	flushmsg  -- send the samples collected so far
+//
+void StereoCameraPair::flushmsg()
+{	if (m_msg.m_samplecount == 0) return;							// nothing to send
+	int stat = m_mapclientport.MsgSend(m_msg);				// send to map server
+	if (stat < 0)																	// report error, but can't do much
+	{	logprintf("ERROR sending stereo data to map server: %s\n", strerror(errno));	}
+	m_msg.m_samplecount = 0;
+}
+//
+//	usage  -- print usage and exit
+//
+static void usage()
+{	printf("Usage: stereoserver [options] leftcamera rightcamera calibfile\n");
+	printf("  Options:  -v              verbose\n");
+	exit(1);																		// fails
+}
+//
+//	Main program
+//
+//	Usage: stereoserver [options] leftcamera rightcamera calibfile
+//
+int main(int argc, const char* argv[])
+{	const char* files[3] = { 0, 0, 0 };						// left camera, right camera, calibration
+	int filecount = 0;
+	//	Parse input arguments
+	for (int i=1; i<argc; i++)											// for all args
+	{	const char* arg= argv[i];										// this arg
+		if (arg[0] == '-')													// if flag argument
+		{	switch(arg[1])	{												// interpret flags
+			case 'v': verbose = true;	 break;						// set verbose mode
+			default: usage();												// bad call, fails
+			}
+			continue;															// next arg
+		}
+		if (filecount >= 3) usage();
+		files[filecount++] = arg;
+	}
+	if (filecount != 3) usage();
+	StereoCameraPair cameras;
+	int stat = cameras.open(files[0], files[1], files[2]);
+	if (stat != EOK) exit(1);												// fails
+	fflush(stdout);															// force out any startup messages
+	for (;;)																		// forever
+	{	stat = cameras.processframe();
+		if (stat)
+		{	logprintf("Camera read failed: %s\n", strerror(stat));
+			sleep(1);															// avoid tight loop if repeated trouble
+		}
+	}
+	return(0);
+}